@@ -165,24 +165,12 @@ timer--activate
 	   (integerp (timer--usecs timer))
 	   (integerp (timer--psecs timer))
 	   (timer--function timer))
-      (let ((timers (if idle timer-idle-list timer-list))
-	    last)
-	;; Skip all timers to trigger before the new one.
-	(while (and timers (timer--time-less-p (car timers) timer))
-	  (setq last timers
-		timers (cdr timers)))
-	(if reuse-cell
-	    (progn
-	      (setcar reuse-cell timer)
-	      (setcdr reuse-cell timers))
-	  (setq reuse-cell (cons timer timers)))
-	;; Insert new timer after last which possibly means in front of queue.
-        (setf (cond (last (cdr last))
-                    (idle timer-idle-list)
-                    (t    timer-list))
-              reuse-cell)
+      (progn
 	(setf (timer--triggered timer) triggered-p)
 	(setf (timer--idle-delay timer) idle)
+        ;; Add the timer to the list and to the queue of timers
+        ;; ordered by time.
+        (timer--insert timer idle reuse-cell)
 	nil)
     (error "Invalid or uninitialized timer")))
 
@@ -221,33 +209,23 @@ 'disable-timeout
 (defun cancel-timer (timer)
   "Remove TIMER from the list of active timers."
   (timer--check timer)
-  (setq timer-list (delq timer timer-list))
-  (setq timer-idle-list (delq timer timer-idle-list))
+  (timer--remove timer)
   nil)
 
 (defun cancel-timer-internal (timer)
   "Remove TIMER from the list of active timers or idle timers.
 Only to be used in this file.  It returns the cons cell
 that was removed from the timer list."
-  (let ((cell1 (memq timer timer-list))
-	(cell2 (memq timer timer-idle-list)))
-    (if cell1
-	(setq timer-list (delq timer timer-list)))
-    (if cell2
-	(setq timer-idle-list (delq timer timer-idle-list)))
-    (or cell1 cell2)))
+  (timer--remove timer))
 
 (defun cancel-function-timers (function)
   "Cancel all timers which would run FUNCTION.
 This affects ordinary timers such as are scheduled by `run-at-time',
 and idle timers such as are scheduled by `run-with-idle-timer'."
   (interactive "aCancel timers of function: ")
-  (dolist (timer timer-list)
+  (dolist (timer (append timer-list timer-idle-list))
     (if (eq (timer--function timer) function)
-        (setq timer-list (delq timer timer-list))))
-  (dolist (timer timer-idle-list)
-    (if (eq (timer--function timer) function)
-        (setq timer-idle-list (delq timer timer-idle-list)))))
+        (timer--remove timer))))
 
 ;; Record the last few events, for debugging.
 (defvar timer-event-last nil
@@ -333,9 +311,9 @@ timer-event-handler
                           err)))
         (when (and retrigger
                    ;; If the timer's been canceled, don't "retrigger" it
-                   ;; since it might still be in the copy of timer-list kept
+                   ;; since it might still be in the timer queue kept
                    ;; by keyboard.c:timer_check (bug#14156).
-                   (memq timer timer-list))
+                   (timer--active-p timer))
           (setf (timer--triggered timer) nil))))))
 
 ;; This function is incompatible with the one in levents.el.
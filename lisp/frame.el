@@ -2872,6 +2872,7 @@ set-frame-property--interactive
         line-prefix
         wrap-prefix
         truncate-lines
+        buffer-invisibility-spec
         mode-line-format
         header-line-format
         tab-line-format
@@ -2887,7 +2888,10 @@ set-frame-property--interactive
         display-fill-column-indicator-character
         bidi-paragraph-direction
         bidi-display-reordering
-        bidi-inhibit-bpa))
+        bidi-inhibit-bpa
+        glyphless-char-display
+        indicate-buffer-boundaries
+        fringe-indicator-alist))
 
 (provide 'frame)
 
@@ -408,7 +408,12 @@ initialize-instance
           (setq buffer-read-only t))))
     (setf (jsonrpc--process conn) proc)
     (set-process-buffer proc (get-buffer-create (format " *%s output*" name)))
-    (set-process-filter proc #'jsonrpc--process-filter)
+    (if (and (fboundp 'set-process-message-framing)
+             (fboundp 'json-parse-string))
+        (progn
+          (set-process-message-framing proc 'content-length)
+          (set-process-filter proc #'jsonrpc--message-filter))
+      (set-process-filter proc #'jsonrpc--process-filter))
     (set-process-sentinel proc #'jsonrpc--process-sentinel)
     (with-current-buffer (process-buffer proc)
       (buffer-disable-undo)
@@ -432,17 +437,23 @@ jsonrpc-connection-send
     (plist-put args :method
                (cond ((keywordp method) (substring (symbol-name method) 1))
                      ((and method (symbolp method)) (symbol-name method)))))
-  (let* ( (message `(:jsonrpc "2.0" ,@args))
-          (json (jsonrpc--json-encode message))
-          (headers
-           `(("Content-Length" . ,(format "%d" (string-bytes json)))
-             ;; ("Content-Type" . "application/vscode-jsonrpc; charset=utf-8")
-             )))
-    (process-send-string
-     (jsonrpc--process connection)
-     (cl-loop for (header . value) in headers
-              concat (concat header ": " value "\r\n") into header-section
-              finally return (format "%s\r\n%s" header-section json)))
+  (let ((message `(:jsonrpc "2.0" ,@args)))
+    (if (fboundp 'json-send-to-process)
+        ;; Serialize and frame the message in C, without making a
+        ;; string of it first.
+        (json-send-to-process (jsonrpc--process connection) message
+                              :false-object :json-false
+                              :null-object nil)
+      (let* ((json (jsonrpc--json-encode message))
+             (headers
+              `(("Content-Length" . ,(format "%d" (string-bytes json)))
+                ;; ("Content-Type" . "application/vscode-jsonrpc; charset=utf-8")
+                )))
+        (process-send-string
+         (jsonrpc--process connection)
+         (cl-loop for (header . value) in headers
+                  concat (concat header ": " value "\r\n") into header-section
+                  finally return (format "%s\r\n%s" header-section json)))))
     (jsonrpc--log-event connection message 'client)))
 
 (defun jsonrpc-process-type (conn)
@@ -548,6 +559,29 @@ jsonrpc--process-sentinel
         (delete-process proc)
         (funcall (jsonrpc--on-shutdown connection) connection)))))
 
+(defun jsonrpc--message-filter (proc message)
+  "Called when MESSAGE, the body of a message, has arrived for PROC.
+This is used instead of `jsonrpc--process-filter' when Emacs splits
+the output of PROC into messages itself, see
+`set-process-message-framing'.  The body is parsed here rather than
+with the `json' framing, so that invalid JSON is only warned about."
+  (let* ((connection (process-get proc 'jsonrpc-connection))
+         (json-message
+          (and connection
+               (condition-case-unless-debug oops
+                   (json-parse-string message
+                                      :object-type 'plist
+                                      :null-object nil
+                                      :false-object :json-false)
+                 (json-parse-error
+                  (jsonrpc--warn "Invalid JSON: %s %s" (cdr oops) message)
+                  nil)))))
+    (when json-message
+      ;; Process content in another buffer, shielding proc buffer
+      ;; from tamper
+      (with-temp-buffer
+        (jsonrpc-connection-receive connection json-message)))))
+
 (defun jsonrpc--process-filter (proc string)
   "Called when new data STRING has arrived for PROC."
   (when (buffer-live-p (process-buffer proc))
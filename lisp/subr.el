@@ -6641,7 +6641,8 @@ internal--format-docstring-line
   (internal--fill-string-single-line (apply #'format string objects)))
 
 (defun json-available-p ()
-  "Return non-nil if Emacs has libjansson support."
+  "Return non-nil if Emacs has JSON support.
+Emacs has built-in JSON support, so this always returns non-nil."
   (and (fboundp 'json-serialize)
        (condition-case nil
            (json-serialize t)
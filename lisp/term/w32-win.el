@@ -285,7 +285,6 @@ libgnutls-version
        '(libxml2 "libxml2-2.dll" "libxml2.dll")
        '(zlib "zlib1.dll" "libz-1.dll")
        '(lcms2 "liblcms2-2.dll")
-       '(json "libjansson-4.dll")
        '(gccjit "libgccjit-0.dll")))
 
 ;;; multi-tty support
@@ -1162,6 +1162,8 @@ bidi_init_it (ptrdiff_t charpos, ptrdiff_t bytepos, bool frame_window_p,
   bidi_it->sos = L2R;	 /* FIXME: should it be user-selectable? */
   bidi_it->disp_pos = -1;	/* invalid/unknown */
   bidi_it->disp_prop = 0;
+  bidi_it->ltr_limit = -1;
+  bidi_it->ltr_fast = 0;
   /* We can only shrink the cache if we are at the bottom level of its
      "stack".  */
   if (bidi_cache_start == 0)
@@ -3396,6 +3398,264 @@ bidi_find_other_level_edge (struct bidi_it *bidi_it, int level, bool end_flag)
     }
 }
 
+/* Fast path for left-to-right text.
+
+   In a paragraph whose base direction is L2R, every character of a
+   line that includes no strong R2L characters, no Arabic numbers, and
+   no directional control characters gets resolved to the base
+   embedding level, so such lines need no reordering at all.  Since
+   UAX#9 resolution starts anew after every newline, the decision can
+   be made line by line: we scan the buffer text ahead of the
+   iterator for such lines, and deliver their characters in logical
+   order without running the UBA on them.  The state of the iterator
+   at the end of each line so delivered is the same as if the UBA had
+   been used, so the UBA can take over at the first line that needs
+   it.  It never takes over in the middle of a line, since the levels
+   of the characters already delivered could depend on characters
+   further on, e.g. through bracket pairs.  */
+
+/* How many bytes of buffer text to examine at a time.  */
+#define BIDI_LTR_SCAN_CHUNK 4096
+
+/* Lines longer than this many bytes are always left to the UBA, so
+   that huge lines are not scanned on every redisplay.  */
+#define BIDI_LTR_MAX_LINE (64 * 1024)
+
+/* Return true if a character of bidi TYPE could be resolved to a
+   level other than zero in a paragraph whose base direction is L2R.  */
+static bool
+bidi_ltr_breaking_type_p (bidi_type_t type)
+{
+  return (type == STRONG_R || type == STRONG_AL || type == WEAK_AN
+	  || bidi_get_category (type) == EXPLICIT_FORMATTING);
+}
+
+/* Return a pointer to the first character in multibyte text between P
+   and END that could be resolved to a non-zero level in an L2R
+   paragraph, or END if there's no such character.  */
+static const unsigned char *
+bidi_find_ltr_breaking_char (const unsigned char *p, const unsigned char *end)
+{
+  /* A word with the high bit set in each of its bytes.  */
+  const uintmax_t high_bits = UINTMAX_MAX / UCHAR_MAX * 0x80;
+
+  while (p < end)
+    {
+      /* ASCII characters are never R2L, so skip them a word at a
+	 time.  */
+      while (end - p >= sizeof (uintmax_t))
+	{
+	  uintmax_t word;
+
+	  memcpy (&word, p, sizeof word);
+	  if (word & high_bits)
+	    break;
+	  p += sizeof word;
+	}
+      while (p < end && ASCII_CHAR_P (*p))
+	p++;
+      if (p < end)
+	{
+	  int len;
+	  int ch = string_char_and_length (p, &len);
+
+	  if (bidi_ltr_breaking_type_p (bidi_get_type (ch, NEUTRAL_DIR)))
+	    return p;
+	  p += len;
+	}
+    }
+  return end;
+}
+
+/* Return the byte position of the last newline in the current
+   buffer between FROM and TO, or -1 if there is none.  */
+static ptrdiff_t
+bidi_find_last_newline (ptrdiff_t from, ptrdiff_t to)
+{
+  ptrdiff_t gpt = GPT_BYTE;
+  const unsigned char *nl;
+
+  if (to > gpt && from < to)
+    {
+      ptrdiff_t beg = max (from, gpt);
+
+      nl = memrchr (BYTE_POS_ADDR (beg), '\n', to - beg);
+      if (nl)
+	return beg + (nl - BYTE_POS_ADDR (beg));
+      to = beg;
+    }
+  if (from < to)
+    {
+      nl = memrchr (BYTE_POS_ADDR (from), '\n', to - from);
+      if (nl)
+	return from + (nl - BYTE_POS_ADDR (from));
+    }
+  return -1;
+}
+
+/* Return the byte position of the first character of the current
+   buffer's text between FROM and END that could be resolved to a
+   non-zero level in an L2R paragraph, or END if there's no such
+   character.  END must be at a character boundary.  */
+static ptrdiff_t
+bidi_find_ltr_breaking_pos (ptrdiff_t from, ptrdiff_t end)
+{
+  ptrdiff_t gpt = GPT_BYTE;
+  ptrdiff_t stop = end;
+
+  /* The text between FROM and END can be in two parts, before and
+     after the gap.  */
+  if (from < gpt)
+    {
+      const unsigned char *p = BYTE_POS_ADDR (from);
+      ptrdiff_t part_end = min (end, gpt);
+
+      stop = (from
+	      + (bidi_find_ltr_breaking_char (p, p + (part_end - from)) - p));
+      if (stop == part_end)
+	stop = end;
+    }
+  if (stop == end && end > gpt)
+    {
+      ptrdiff_t beg = max (from, gpt);
+      const unsigned char *p = BYTE_POS_ADDR (beg);
+
+      stop = beg + (bidi_find_ltr_breaking_char (p, p + (end - beg)) - p);
+    }
+  return stop;
+}
+
+/* Scan the current buffer's text from the beginning of a line at
+   BYTEPOS, and return the byte position up to which the text can be
+   displayed without reordering in an L2R paragraph.  The value is
+   either BYTEPOS, or the beginning of a line, or ZV_BYTE + 1 if all
+   the text up to ZV can be so displayed.  */
+static ptrdiff_t
+bidi_scan_ltr_text (ptrdiff_t bytepos)
+{
+  ptrdiff_t from = bytepos;
+  ptrdiff_t limit = min (ZV_BYTE, bytepos + BIDI_LTR_MAX_LINE);
+
+  while (true)
+    {
+      ptrdiff_t end = min (ZV_BYTE, from + BIDI_LTR_SCAN_CHUNK);
+      ptrdiff_t stop, nl;
+
+      while (end < ZV_BYTE && !CHAR_HEAD_P (FETCH_BYTE (end)))
+	end--;
+      stop = bidi_find_ltr_breaking_pos (from, end);
+
+      /* All the text up to ZV is fine, including the end of buffer.  */
+      if (stop == ZV_BYTE)
+	return ZV_BYTE + 1;
+      nl = bidi_find_last_newline (from, stop);
+      if (nl >= 0)
+	return nl + 1;
+
+      /* The line starting at BYTEPOS continues beyond END.  Examine
+	 more of it, unless it's too long or we found a character
+	 that needs the UBA.  */
+      if (stop < end || end >= limit)
+	return bytepos;
+      from = end;
+    }
+}
+
+/* Return true if the next character of BIDI_IT can be delivered by
+   bidi_ltr_next_char, without resolving its level by the UBA.  */
+static bool
+bidi_ltr_fast_p (struct bidi_it *bidi_it)
+{
+  ptrdiff_t next_bytepos;
+
+  if (bidi_it->paragraph_dir != L2R
+      || bidi_it->scan_dir != 1
+      || bidi_cache_idx > bidi_cache_start
+      || bidi_it->string.s || STRINGP (bidi_it->string.lstring))
+    return false;
+
+  if (bidi_it->first_elt)
+    {
+      /* After being reseated, we can only start at the beginning of
+	 a line.  */
+      next_bytepos = max (bidi_it->bytepos, BEGV_BYTE);
+      if (next_bytepos > BEGV_BYTE
+	  && FETCH_BYTE (next_bytepos - 1) != '\n')
+	return false;
+    }
+  else if (bidi_it->charpos >= ZV)
+    return false;
+  else
+    {
+      next_bytepos = bidi_it->bytepos + bidi_it->ch_len;
+      if (next_bytepos < bidi_it->ltr_limit && bidi_it->ltr_fast)
+	return true;
+      /* LTR_LIMIT is always at the beginning of a line, and so must
+	 be the next character for scanning ahead.  */
+      if (bidi_it->ch != '\n')
+	return false;
+    }
+
+  bidi_it->ltr_limit = bidi_scan_ltr_text (next_bytepos);
+  return next_bytepos < bidi_it->ltr_limit;
+}
+
+/* Advance BIDI_IT to the next character in logical order, and resolve
+   its level to the base level of the L2R paragraph.  */
+static void
+bidi_ltr_next_char (struct bidi_it *bidi_it)
+{
+  if (bidi_it->first_elt)
+    {
+      bidi_it->first_elt = 0;
+      if (bidi_it->charpos < BEGV)
+	{
+	  bidi_it->charpos = BEGV;
+	  bidi_it->bytepos = BEGV_BYTE;
+	}
+    }
+  else
+    {
+      bidi_it->charpos += bidi_it->nchars;
+      bidi_it->bytepos += bidi_it->ch_len;
+    }
+
+  bidi_it->ch = bidi_fetch_char (bidi_it->charpos, bidi_it->bytepos,
+				 &bidi_it->disp_pos, &bidi_it->disp_prop,
+				 &bidi_it->string, bidi_it->w,
+				 bidi_it->frame_window_p,
+				 &bidi_it->ch_len, &bidi_it->nchars);
+  bidi_it->orig_type = bidi_get_type (bidi_it->ch, NEUTRAL_DIR);
+  bidi_it->type_after_wn = bidi_it->orig_type;
+  if (bidi_it->orig_type == NEUTRAL_B)
+    {
+      bidi_it->type = NEUTRAL_B;
+      bidi_set_paragraph_end (bidi_it);
+    }
+  else
+    {
+      bidi_it->type = STRONG_L;
+      bidi_it->resolved_level = 0;
+    }
+  bidi_it->ltr_fast = 1;
+}
+
+/* Prepare BIDI_IT for resolving the levels of characters by the UBA
+   after the previous characters were delivered by bidi_ltr_next_char.
+   That only happens at the beginning of a line, where bidi_line_init
+   has already reset most of this, or at the end of the text.  */
+static void
+bidi_ltr_finish (struct bidi_it *bidi_it)
+{
+  bidi_set_sos_type (bidi_it, 0, 0);
+  bidi_it->next_en_pos = 0;
+  bidi_it->next_en_type = UNKNOWN_BT;
+  bidi_it->next_for_ws.charpos = -1;
+  bidi_it->next_for_ws.type = UNKNOWN_BT;
+  bidi_it->bracket_pairing_pos = -1;
+  bidi_it->ltr_fast = 0;
+}
+
 void
 bidi_move_to_visually_next (struct bidi_it *bidi_it)
 {
@@ -3415,6 +3675,15 @@ bidi_move_to_visually_next (struct bidi_it *bidi_it)
       && (bidi_it->ch == '\n' || bidi_it->ch == BIDI_EOB))
     bidi_line_init (bidi_it);
 
+  /* Lines that need no reordering are delivered in logical order.  */
+  if (bidi_ltr_fast_p (bidi_it))
+    {
+      bidi_ltr_next_char (bidi_it);
+      goto paragraph_end;
+    }
+  if (bidi_it->ltr_fast)
+    bidi_ltr_finish (bidi_it);
+
   /* Prepare the sentinel iterator state, and cache it.  When we bump
      into it, scanning backwards, we'll know that the last non-base
      level is exhausted.  */
@@ -3493,6 +3762,7 @@ bidi_move_to_visually_next (struct bidi_it *bidi_it)
       next_level = bidi_level_of_next_char (bidi_it);
     }
 
+ paragraph_end:
   /* Take note when we have just processed the newline that precedes
      the end of the paragraph.  The next time we are about to be
      called, set_iterator_to_next will automatically reinit the
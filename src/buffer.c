@@ -599,6 +599,8 @@ DEFUN ("get-buffer-create", Fget_buffer_create, Sget_buffer_create, 1, 2, 0,
   BUF_OVERLAY_UNCHANGED_MODIFIED (b) = 1;
   BUF_END_UNCHANGED (b) = 0;
   BUF_BEG_UNCHANGED (b) = 0;
+  b->text->hash_unchanged = 0;
+  b->text->hash_cache = NULL;
   *(BUF_GPT_ADDR (b)) = *(BUF_Z_ADDR (b)) = 0; /* Put an anchor '\0'.  */
   b->text->inhibit_shrinking = false;
   b->text->redisplay = false;
@@ -1390,6 +1392,10 @@ DEFUN ("force-mode-line-update", Fforce_mode_line_update,
 menu bar menus and the frame title.  */)
      (Lisp_Object all)
 {
+  /* The caller knows that something the mode lines show has changed,
+     perhaps something they don't depend on visibly.  */
+  invalidate_mode_line_caches ();
+
   if (!NILP (all))
     {
       update_mode_lines = 10;
@@ -1964,6 +1970,10 @@ DEFUN ("kill-buffer", Fkill_buffer, Skill_buffer, 0, 1, "bKill buffer: ",
 
   bset_name (b, Qnil);
 
+  /* Glyph row caches identify buffers by their address, which a
+     buffer created later can reuse.  */
+  invalidate_glyph_row_caches ();
+
   block_input ();
   if (b->base_buffer)
     {
@@ -5141,6 +5151,8 @@ free_buffer_text (struct buffer *b)
     }
 
   BUF_BEG_ADDR (b) = NULL;
+  xfree (b->text->hash_cache);
+  b->text->hash_cache = NULL;
   unblock_input ();
 }
 
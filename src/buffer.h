@@ -267,6 +267,14 @@ #define FETCH_BYTE(n) *(BYTE_POS_ADDR ((n)))
        end_unchanged contain no useful information.  */
     modiff_count overlay_unchanged_modified;
 
+    /* Number of characters at the start of the text that have not
+       changed since `buffer-hash' last hashed it.  */
+    ptrdiff_t hash_unchanged;
+
+    /* The state that `buffer-hash' keeps to hash this text again, or
+       NULL.  */
+    struct buffer_hash_cache *hash_cache;
+
     /* Properties of this buffer's text.  */
     INTERVAL intervals;
 
@@ -963,6 +971,17 @@ BUF_COMPUTE_UNCHANGED (struct buffer *buf, ptrdiff_t start, ptrdiff_t end)
     }
 }
 
+/* Note that the text of BUF may have changed from character position
+   START on, so that `buffer-hash' hashes it again.  This must be done
+   each time the text of BUF is modified.  */
+
+INLINE void
+BUF_COMPUTE_UNHASHED (struct buffer *buf, ptrdiff_t start)
+{
+  if (start - BUF_BEG (buf) < buf->text->hash_unchanged)
+    buf->text->hash_unchanged = start - BUF_BEG (buf);
+}
+
 /* Functions for setting the BEGV, ZV or PT of a given buffer.
 
    The ..._BOTH functions take both a charpos and a bytepos,
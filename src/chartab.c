@@ -508,6 +508,17 @@ DEFUN ("char-table-subtype", Fchar_table_subtype, Schar_table_subtype,
   return XCHAR_TABLE (char_table)->purpose;
 }
 
+/* Note that CHAR_TABLE is about to be changed from Lisp.  Display
+   tables are often modified in place, so glyph rows that redisplay
+   cached while using the old contents must not be reused.  */
+
+void
+char_table_modified (Lisp_Object char_table)
+{
+  if (EQ (XCHAR_TABLE (char_table)->purpose, Qdisplay_table))
+    invalidate_glyph_row_caches ();
+}
+
 DEFUN ("char-table-parent", Fchar_table_parent, Schar_table_parent,
        1, 1, 0,
        doc: /* Return the parent char-table of CHAR-TABLE.
@@ -541,6 +552,7 @@ DEFUN ("set-char-table-parent", Fset_char_table_parent, Sset_char_table_parent,
 	  error ("Attempt to make a chartable be its own parent");
     }
 
+  char_table_modified (char_table);
   set_char_table_parent (char_table, parent);
 
   return parent;
@@ -572,6 +584,7 @@ DEFUN ("set-char-table-extra-slot", Fset_char_table_extra_slot,
       || XFIXNUM (n) >= CHAR_TABLE_EXTRA_SLOTS (XCHAR_TABLE (char_table)))
     args_out_of_range (char_table, n);
 
+  char_table_modified (char_table);
   set_char_table_extras (char_table, XFIXNUM (n), value);
   return value;
 }
@@ -615,6 +628,7 @@ DEFUN ("set-char-table-range", Fset_char_table_range, Sset_char_table_range,
   (Lisp_Object char_table, Lisp_Object range, Lisp_Object value)
 {
   CHECK_CHAR_TABLE (char_table);
+  char_table_modified (char_table);
   if (EQ (range, Qt))
     {
       int i;
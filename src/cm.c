@@ -46,6 +46,7 @@ cmputc (int c)
   if (current_tty->termscript)
     putc (c & 0177, current_tty->termscript);
   putc (c & 0177, current_tty->output);
+  current_tty->output_bytes++;
   return c;
 }
 
@@ -121,6 +122,7 @@ cmcheckmagic (struct tty_display_info *tty)
       if (tty->termscript)
 	putc ('\n', tty->termscript);
       putc ('\n', tty->output);
+      tty->output_bytes += 2;
       curX (tty) = 0;
       curY (tty)++;
     }
@@ -1118,6 +1118,109 @@ #define UTF_8_BOM_1 0xEF
 #define UTF_8_BOM_2 0xBB
 #define UTF_8_BOM_3 0xBF
 
+/* A word with the high bit of each of its bytes set.  A word of
+   source bytes ANDed with this is zero iff all its bytes are ASCII,
+   which lets the functions below skip runs of ASCII a word at a time
+   instead of a byte at a time.  */
+#define UTF_8_WORD_HIGH_BITS (UINTPTR_MAX / 0xFF * 0x80)
+
+/* Return true if the sizeof (uintptr_t) bytes at SRC are all ASCII.  */
+
+static bool
+utf_8_ascii_word_p (const unsigned char *src)
+{
+  uintptr_t word;
+  memcpy (&word, src, sizeof word);
+  return ! (word & UTF_8_WORD_HIGH_BITS);
+}
+
+/* Return the number of bytes at the head of the NBYTES bytes at SRC
+   that form valid UTF-8 of the Unicode range, i.e. without overlong
+   sequences, surrogates, or code points above 0x10FFFF.  Set *NCHARS
+   to the number of characters in those bytes.  This never splits a
+   multibyte sequence.  */
+
+static ptrdiff_t
+utf_8_valid_prefix (const unsigned char *src, ptrdiff_t nbytes,
+		    ptrdiff_t *nchars)
+{
+  const unsigned char *p = src, *end = src + nbytes;
+  ptrdiff_t chars = 0;
+
+  while (p < end)
+    {
+      int c = *p;
+
+      if (UTF_8_1_OCTET_P (c))
+	{
+	  p++;
+	  chars++;
+	  while (end - p >= sizeof (uintptr_t) && utf_8_ascii_word_p (p))
+	    {
+	      p += sizeof (uintptr_t);
+	      chars += sizeof (uintptr_t);
+	    }
+	  continue;
+	}
+
+      if (c < 0xC2 || c > 0xF4)
+	/* A stray continuation byte, an overlong 2-byte sequence, or a
+	   leading byte of a code point above 0x10FFFF.  */
+	break;
+      if (c < 0xE0)
+	{
+	  if (end - p < 2 || ! UTF_8_EXTRA_OCTET_P (p[1]))
+	    break;
+	  p += 2;
+	}
+      else if (c < 0xF0)
+	{
+	  if (end - p < 3
+	      || ! UTF_8_EXTRA_OCTET_P (p[1])
+	      || ! UTF_8_EXTRA_OCTET_P (p[2])
+	      /* Overlong sequences and surrogates.  */
+	      || (c == 0xE0 && p[1] < 0xA0)
+	      || (c == 0xED && p[1] >= 0xA0))
+	    break;
+	  p += 3;
+	}
+      else
+	{
+	  if (end - p < 4
+	      || ! UTF_8_EXTRA_OCTET_P (p[1])
+	      || ! UTF_8_EXTRA_OCTET_P (p[2])
+	      || ! UTF_8_EXTRA_OCTET_P (p[3])
+	      /* Overlong sequences and code points above 0x10FFFF.  */
+	      || (c == 0xF0 && p[1] < 0x90)
+	      || (c == 0xF4 && p[1] >= 0x90))
+	    break;
+	  p += 4;
+	}
+      chars++;
+    }
+
+  *nchars = chars;
+  return p - src;
+}
+
+/* Return true if the NBYTES bytes at SRC are the beginning of a valid
+   multibyte UTF-8 sequence that is cut short by the end of the
+   text.  */
+
+static bool
+utf_8_incomplete_sequence_p (const unsigned char *src, ptrdiff_t nbytes)
+{
+  int c = *src;
+  int len = (c < 0xC2 ? 0 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : c < 0xF5 ? 4 : 0);
+
+  if (nbytes >= len)
+    return false;
+  for (ptrdiff_t i = 1; i < nbytes; i++)
+    if (! UTF_8_EXTRA_OCTET_P (src[i]))
+      return false;
+  return true;
+}
+
 /* Unlike the other detect_coding_XXX, this function counts the number
    of characters and checks the EOL format.  */
 
@@ -1231,8 +1334,6 @@ detect_coding_utf_8 (struct coding_system *coding,
 	   means that we found a valid non-ASCII characters.  */
 	detect_info->found |= CATEGORY_MASK_UTF_8_AUTO | CATEGORY_MASK_UTF_8_NOSIG;
     }
-  coding->detected_utf8_bytes = src_base - coding->source;
-  coding->detected_utf8_chars = nchars;
   return 1;
 }
 
@@ -1335,6 +1436,77 @@ decode_coding_utf_8 (struct coding_system *coding)
 	  if (src != src_base)
 	    continue;
 	}
+      /* Likewise for a unibyte source, where we can also decode valid
+	 multibyte sequences directly, and copy ASCII a word at a time.
+	 Invalid sequences and raw bytes are left to the code below.  */
+      else if (! multibytep && ! eol_dos
+	       && charbuf < charbuf_end - 6 && src < src_end - 6)
+	{
+	  while (charbuf < charbuf_end - 6 && src < src_end - 6)
+	    {
+	      c1 = *src;
+	      if (UTF_8_1_OCTET_P (c1))
+		{
+		  if (charbuf_end - charbuf > sizeof (uintptr_t) + 6
+		      && src_end - src > sizeof (uintptr_t) + 6
+		      && utf_8_ascii_word_p (src))
+		    {
+		      for (int i = 0; i < sizeof (uintptr_t); i++)
+			charbuf[i] = src[i];
+		      charbuf += sizeof (uintptr_t);
+		      src += sizeof (uintptr_t);
+		    }
+		  else
+		    {
+		      *charbuf++ = c1;
+		      src++;
+		    }
+		  continue;
+		}
+	      c2 = src[1];
+	      if (! UTF_8_EXTRA_OCTET_P (c2))
+		break;
+	      if (UTF_8_2_OCTET_LEADING_P (c1))
+		{
+		  c = ((c1 & 0x1F) << 6) | (c2 & 0x3F);
+		  if (c < 128)
+		    break;
+		  src += 2;
+		}
+	      else
+		{
+		  c3 = src[2];
+		  if (! UTF_8_EXTRA_OCTET_P (c3))
+		    break;
+		  if (UTF_8_3_OCTET_LEADING_P (c1))
+		    {
+		      c = (((c1 & 0xF) << 12)
+			   | ((c2 & 0x3F) << 6) | (c3 & 0x3F));
+		      if (c < 0x800 || (c >= 0xd800 && c < 0xe000))
+			break;
+		      src += 3;
+		    }
+		  else if (UTF_8_4_OCTET_LEADING_P (c1))
+		    {
+		      c4 = src[3];
+		      if (! UTF_8_EXTRA_OCTET_P (c4))
+			break;
+		      c = (((c1 & 0x7) << 18) | ((c2 & 0x3F) << 12)
+			   | ((c3 & 0x3F) << 6) | (c4 & 0x3F));
+		      if (c < 0x10000)
+			break;
+		      src += 4;
+		    }
+		  else
+		    break;
+		}
+	      *charbuf++ = c;
+	    }
+	  /* Each byte of a unibyte source is a source character.  */
+	  consumed_chars += src - src_base;
+	  if (src != src_base)
+	    continue;
+	}
 
       if (byte_after_cr >= 0)
 	c1 = byte_after_cr, byte_after_cr = -1;
@@ -5697,6 +5869,7 @@ setup_coding_system (Lisp_Object coding_system, struct coding_system *coding)
   coding->default_char = XFIXNUM (CODING_ATTR_DEFAULT_CHAR (attrs));
   coding->carryover_bytes = 0;
   coding->raw_destination = 0;
+  coding->sampled_detection_id = -1;
 
   coding_type = CODING_ATTR_TYPE (attrs);
   if (EQ (coding_type, Qundecided))
@@ -6226,6 +6399,41 @@ check_ascii (struct coding_system *coding)
 }
 
 
+/* Return the "logical or" of EOL_SEEN_LF, EOL_SEEN_CR, and
+   EOL_SEEN_CRLF for the EOLs in the NBYTES bytes of ASCII-compatible
+   text at SRC.  This uses memchr, so that text without CRs, the
+   common case, is scanned at the speed of the C library.  */
+
+static int
+eol_seen_in_bytes (const unsigned char *src, ptrdiff_t nbytes)
+{
+  const unsigned char *end = src + nbytes;
+  const unsigned char *cr = memchr (src, '\r', nbytes);
+  int eol_seen = EOL_SEEN_NONE;
+
+  while (src < end)
+    {
+      const unsigned char *next = cr ? cr : end;
+
+      if (! (eol_seen & EOL_SEEN_LF) && memchr (src, '\n', next - src))
+	eol_seen |= EOL_SEEN_LF;
+      if (! cr)
+	break;
+      src = cr + 1;
+      if (src < end && *src == '\n')
+	{
+	  eol_seen |= EOL_SEEN_CRLF;
+	  src++;
+	}
+      else
+	eol_seen |= EOL_SEEN_CR;
+      if (eol_seen == (EOL_SEEN_LF | EOL_SEEN_CR | EOL_SEEN_CRLF))
+	break;
+      cr = memchr (src, '\r', end - src);
+    }
+  return eol_seen;
+}
+
 /* Return the number of characters at the source if all the bytes are
    valid UTF-8 (of Unicode range).  Otherwise, return -1.  By side
    effects, update coding->eol_seen.  The value of coding->eol_seen is
@@ -6236,94 +6444,21 @@ check_ascii (struct coding_system *coding)
 static ptrdiff_t
 check_utf_8 (struct coding_system *coding)
 {
-  const unsigned char *src, *end;
-  int eol_seen;
-  ptrdiff_t nchars = coding->head_ascii;
+  const unsigned char *src;
+  ptrdiff_t nbytes, nchars;
 
   if (coding->head_ascii < 0)
     check_ascii (coding);
   else
     coding_set_source (coding);
   src = coding->source + coding->head_ascii;
-  /* We look ahead one byte for CR LF.  */
-  end = coding->source + coding->src_bytes - 1;
-  eol_seen = coding->eol_seen;
-  while (src < end)
-    {
-      int c = *src;
-
-      if (UTF_8_1_OCTET_P (*src))
-	{
-	  src++;
-	  if (c < 0x20)
-	    {
-	      if (c == '\r')
-		{
-		  if (*src == '\n')
-		    {
-		      eol_seen |= EOL_SEEN_CRLF;
-		      src++;
-		      nchars++;
-		    }
-		  else
-		    eol_seen |= EOL_SEEN_CR;
-		}
-	      else if (c == '\n')
-		eol_seen |= EOL_SEEN_LF;
-	    }
-	}
-      else if (UTF_8_2_OCTET_LEADING_P (c))
-	{
-	  if (c < 0xC2		/* overlong sequence */
-	      || src + 1 >= end
-	      || ! UTF_8_EXTRA_OCTET_P (src[1]))
-	    return -1;
-	  src += 2;
-	}
-      else if (UTF_8_3_OCTET_LEADING_P (c))
-	{
-	  if (src + 2 >= end
-	      || ! (UTF_8_EXTRA_OCTET_P (src[1])
-		    && UTF_8_EXTRA_OCTET_P (src[2])))
-	    return -1;
-	  c = (((c & 0xF) << 12)
-	       | ((src[1] & 0x3F) << 6) | (src[2] & 0x3F));
-	  if (c < 0x800			      /* overlong sequence */
-	      || (c >= 0xd800 && c < 0xe000)) /* surrogates (invalid) */
-	    return -1;
-	  src += 3;
-	}
-      else if (UTF_8_4_OCTET_LEADING_P (c))
-	{
-	  if (src + 3 >= end
-	      || ! (UTF_8_EXTRA_OCTET_P (src[1])
-		    && UTF_8_EXTRA_OCTET_P (src[2])
-		    && UTF_8_EXTRA_OCTET_P (src[3])))
-	    return -1;
-	  c = (((c & 0x7) << 18) | ((src[1] & 0x3F) << 12)
-	       | ((src[2] & 0x3F) << 6) | (src[3] & 0x3F));
-	  if (c < 0x10000	/* overlong sequence */
-	      || c >= 0x110000)	/* non-Unicode character  */
-	    return -1;
-	  src += 4;
-	}
-      else
-	return -1;
-      nchars++;
-    }
-
-  if (src == end)
-    {
-      if (! UTF_8_1_OCTET_P (*src))
-	return -1;
-      nchars++;
-      if (*src == '\r')
-	eol_seen |= EOL_SEEN_CR;
-      else if (*src  == '\n')
-	eol_seen |= EOL_SEEN_LF;
-    }
-  coding->eol_seen = eol_seen;
-  return nchars;
+  nbytes = coding->src_bytes - coding->head_ascii;
+  if (utf_8_valid_prefix (src, nbytes, &nchars) < nbytes)
+    return -1;
+  /* check_ascii stops at a non-ASCII byte, so no CR LF can straddle
+     the boundary between the head and the rest.  */
+  coding->eol_seen |= eol_seen_in_bytes (src, nbytes);
+  return coding->head_ascii + nchars;
 }
 
 
@@ -6510,28 +6645,171 @@ adjust_coding_eol_type (struct coding_system *coding, int eol_seen)
   return eol_type;
 }
 
+/* Parameters of detect_coding_by_sampling: the size of each window
+   of the source it examines, the number of windows besides those at
+   the head and tail, and the number of continuation bytes of UTF-8
+   sequences it must see in them to be confident that the source is in
+   UTF-8.  */
+#define DETECT_SAMPLE_WINDOW 4096
+#define DETECT_SAMPLE_STRIDES 32
+#define DETECT_SAMPLE_MIN_UTF_8_BYTES 64
+
+/* Try to decide the coding system of a large source text in CODING,
+   whose coding system is undecided, from samples of it: a window at its
+   head, one at its tail, and one at a pseudo-random offset in each of
+   DETECT_SAMPLE_STRIDES equal strides of the source.  Return the
+   coding system if the samples show UTF-8 text with enough non-ASCII
+   characters for it to be what detect_coding would find if the whole
+   source is valid UTF-8.  Otherwise, return nil, which means the whole
+   source must be examined.
+
+   The samples don't show that the whole source is valid UTF-8, so the
+   caller must check that as it decodes the source, and call
+   redetect_coding if it is not.  */
+
+static Lisp_Object
+detect_coding_by_sampling (struct coding_system *coding)
+{
+  const unsigned char *src, *src_end;
+  ptrdiff_t nbytes = coding->src_bytes;
+  ptrdiff_t utf_8_bytes = 0;
+  unsigned int found = CATEGORY_MASK_UTF_8_AUTO | CATEGORY_MASK_UTF_8_NOSIG;
+  bool prefer_utf_8 = coding->spec.undecided.prefer_utf_8;
+  struct coding_system *this = NULL;
+  unsigned int seed;
+  int i;
+
+  if (! FIXNATP (Vdetect_coding_sample_threshold)
+      || nbytes <= XFIXNAT (Vdetect_coding_sample_threshold)
+      || nbytes < 2 * DETECT_SAMPLE_WINDOW
+      || coding->src_multibyte)
+    return Qnil;
+
+  src = coding->source;
+  src_end = src + nbytes;
+  if (src[0] == UTF_8_BOM_1 && src[1] == UTF_8_BOM_2 && src[2] == UTF_8_BOM_3)
+    found |= CATEGORY_MASK_UTF_8_SIG;
+
+  /* detect_coding chooses the first category in the priority order
+     that accepts the text.  Unless UTF-8 is preferred, give up if a
+     category that might accept UTF-8 text comes before those of
+     UTF-8.  */
+  for (i = 0; i < coding_category_raw_text; i++)
+    {
+      this = coding_categories + coding_priorities[i];
+      if (this->id < 0)
+	continue;
+      if (found & (1 << coding_priorities[i]))
+	break;
+      if (! prefer_utf_8)
+	return Qnil;
+    }
+  if (i == coding_category_raw_text)
+    return Qnil;
+
+  seed = nbytes;
+  for (int window = 0; window < DETECT_SAMPLE_STRIDES + 2; window++)
+    {
+      const unsigned char *beg, *end;
+      ptrdiff_t valid, nchars;
+
+      if (window == 0)
+	beg = src;
+      else if (window == 1)
+	beg = src_end - DETECT_SAMPLE_WINDOW;
+      else
+	{
+	  ptrdiff_t stride = nbytes / DETECT_SAMPLE_STRIDES;
+	  ptrdiff_t room = max (stride - DETECT_SAMPLE_WINDOW, 1);
+
+	  seed = seed * 1103515245 + 12345;
+	  beg = src + (window - 2) * stride + (seed >> 8) % room;
+	}
+      end = min (beg + DETECT_SAMPLE_WINDOW, src_end);
+
+      /* Start the window at a character boundary.  A sequence cut
+	 short by its end is checked by the next window, if any.  */
+      for (int skip = 0; skip < 3 && UTF_8_EXTRA_OCTET_P (*beg); skip++)
+	beg++;
+      valid = utf_8_valid_prefix (beg, end - beg, &nchars);
+      if (valid < end - beg
+	  && (end == src_end
+	      || ! utf_8_incomplete_sequence_p (beg + valid,
+						end - beg - valid)))
+	return Qnil;
+      utf_8_bytes += valid - nchars;
+    }
+  if (utf_8_bytes < DETECT_SAMPLE_MIN_UTF_8_BYTES)
+    return Qnil;
+
+  /* Null bytes and ISO-2022 escapes anywhere in the source make
+     detect_coding examine it more closely, so look for them in the
+     whole source.  memchr is fast enough for that not to matter.  */
+  if ((! inhibit_flag (coding->spec.undecided.inhibit_nbd,
+		       inhibit_null_byte_detection)
+       && memchr (src, 0, nbytes))
+      || (! inhibit_flag (coding->spec.undecided.inhibit_ied,
+			  inhibit_iso_escape_detection)
+	  && (memchr (src, ISO_CODE_ESC, nbytes)
+	      || memchr (src, ISO_CODE_SI, nbytes)
+	      || memchr (src, ISO_CODE_SO, nbytes))))
+    return Qnil;
+
+  if (coding_priorities[i] == coding_category_utf_8_auto)
+    {
+      Lisp_Object coding_systems
+	= AREF (CODING_ID_ATTRS (this->id), coding_attr_utf_bom);
+
+      if (CONSP (coding_systems))
+	return (found & CATEGORY_MASK_UTF_8_SIG
+		? XCAR (coding_systems) : XCDR (coding_systems));
+    }
+  return CODING_ID_NAME (this->id);
+}
+
 /* Detect how a text specified in CODING is encoded.  If a coding
    system is detected, update fields of CODING by the detected coding
-   system.  */
+   system.  If SAMPLE, the coding system of a large text may be
+   decided by detect_coding_by_sampling, in which case
+   CODING->sampled_detection_id is set to the ID of the coding system
+   detection started from.  */
 
 static void
-detect_coding (struct coding_system *coding)
+detect_coding (struct coding_system *coding, bool sample)
 {
   const unsigned char *src, *src_end;
   unsigned int saved_mode = coding->mode;
   Lisp_Object found = Qnil;
   Lisp_Object eol_type = CODING_ID_EOL_TYPE (coding->id);
+  ptrdiff_t undetected_id = coding->id;
+  bool sampled = false;
 
   coding->consumed = coding->consumed_char = 0;
   coding->produced = coding->produced_char = 0;
+  coding->sampled_detection_id = -1;
   coding_set_source (coding);
 
   src_end = coding->source + coding->src_bytes;
 
   coding->eol_seen = EOL_SEEN_NONE;
+  if (sample
+      && EQ (CODING_ATTR_TYPE (CODING_ID_ATTRS (coding->id)), Qundecided))
+    {
+      found = detect_coding_by_sampling (coding);
+      if (! NILP (found))
+	{
+	  sampled = true;
+	  /* The samples tell nothing about the head ASCII bytes and
+	     the EOLs; let the decoder find them out.  */
+	  coding->head_ascii = -1;
+	}
+    }
+
   /* If we have not yet decided the text encoding type, detect it
      now.  */
-  if (EQ (CODING_ATTR_TYPE (CODING_ID_ATTRS (coding->id)), Qundecided))
+  if (sampled)
+    ;
+  else if (EQ (CODING_ATTR_TYPE (CODING_ID_ATTRS (coding->id)), Qundecided))
     {
       int c, i;
       struct coding_detection_info detect_info;
@@ -6771,11 +7049,29 @@ detect_coding (struct coding_system *coding)
       setup_coding_system (found, coding);
       if (specified_eol != EOL_SEEN_NONE)
 	adjust_coding_eol_type (coding, specified_eol);
+      if (sampled)
+	coding->sampled_detection_id = undetected_id;
     }
 
   coding->mode = saved_mode;
 }
 
+/* Detect the coding system of the source text in CODING again, this
+   time from the whole text, because decoding found that it is not
+   valid UTF-8 although detect_coding_by_sampling decided so.  */
+
+static void
+redetect_coding (struct coding_system *coding)
+{
+  unsigned int mode = coding->mode;
+
+  eassert (coding->sampled_detection_id >= 0);
+  setup_coding_system (CODING_ID_NAME (coding->sampled_detection_id), coding);
+  coding->mode = mode;
+  coding->head_ascii = -1;
+  detect_coding (coding, false);
+}
+
 
 static void
 decode_eol (struct coding_system *coding)
@@ -6878,7 +7174,7 @@ decode_eol (struct coding_system *coding)
    attribute vector ATTRS for encoding (if ENCODEP) or decoding (if
    not ENCODEP). */
 
-static Lisp_Object
+Lisp_Object
 get_translation_table (Lisp_Object attrs, bool encodep, int *max_lookup)
 {
   Lisp_Object standard, translation_table;
@@ -7909,6 +8205,7 @@ decode_coding_gap (struct coding_system *coding, ptrdiff_t bytes)
 {
   ptrdiff_t count = SPECPDL_INDEX ();
   Lisp_Object attrs;
+  ptrdiff_t utf_8_chars = -1;
 
   eassert (GPT_BYTE == PT_BYTE);
 
@@ -7925,10 +8222,19 @@ decode_coding_gap (struct coding_system *coding, ptrdiff_t bytes)
            == !NILP (BVAR (current_buffer, enable_multibyte_characters)));
 
   coding->head_ascii = -1;
-  coding->detected_utf8_bytes = coding->detected_utf8_chars = -1;
   coding->eol_seen = EOL_SEEN_NONE;
   if (CODING_REQUIRE_DETECTION (coding))
-    detect_coding (coding);
+    {
+      detect_coding (coding, true);
+      /* If UTF-8 was detected from samples of the text, validate the
+	 whole text now, as we would anyway to insert it in place.  */
+      if (coding->sampled_detection_id >= 0)
+	{
+	  utf_8_chars = check_utf_8 (coding);
+	  if (utf_8_chars < 0)
+	    redetect_coding (coding);
+	}
+    }
   attrs = CODING_ID_ATTRS (coding->id);
   if (! disable_ascii_optimization
       && ! coding->src_multibyte
@@ -7941,15 +8247,15 @@ decode_coding_gap (struct coding_system *coding, ptrdiff_t bytes)
 	chars = check_ascii (coding);
       if (chars != bytes)
 	{
-	  /* There exists a non-ASCII byte.  */
-	  if (EQ (CODING_ATTR_TYPE (attrs), Qutf_8)
-	      && coding->detected_utf8_bytes == coding->src_bytes)
+	  /* There exists a non-ASCII byte.  Validate the UTF-8 here
+	     even if it was detected, as detect_coding_utf_8 accepts
+	     overlong sequences and surrogates, which must not be
+	     inserted as they are.  */
+	  if (EQ (CODING_ATTR_TYPE (attrs), Qutf_8))
 	    {
-	      if (coding->detected_utf8_chars >= 0)
-		chars = coding->detected_utf8_chars;
-	      else
-		chars = check_utf_8 (coding);
-	      if (CODING_UTF_8_BOM (coding) != utf_without_bom
+	      chars = utf_8_chars >= 0 ? utf_8_chars : check_utf_8 (coding);
+	      if (chars >= 0
+		  && CODING_UTF_8_BOM (coding) != utf_without_bom
 		  && coding->head_ascii == 0
 		  && coding->source[0] == UTF_8_BOM_1
 		  && coding->source[1] == UTF_8_BOM_2
@@ -8035,6 +8341,79 @@ decode_coding_gap (struct coding_system *coding, ptrdiff_t bytes)
 }
 
 
+/* Return true if the unibyte source text of CODING is valid UTF-8,
+   except perhaps for an incomplete sequence at its end if more text is
+   to come.  Set *NCHARS and *NBYTES to the numbers of characters and
+   bytes before that sequence.  */
+
+static bool
+utf_8_source_p (struct coding_system *coding,
+		ptrdiff_t *nchars, ptrdiff_t *nbytes)
+{
+  const unsigned char *src;
+  ptrdiff_t tail;
+
+  coding_set_source (coding);
+  src = coding->source;
+  *nbytes = utf_8_valid_prefix (src, coding->src_bytes, nchars);
+  tail = coding->src_bytes - *nbytes;
+  return (tail == 0
+	  || (! (coding->mode & CODING_MODE_LAST_BLOCK)
+	      && utf_8_incomplete_sequence_p (src + *nbytes, tail)));
+}
+
+/* Decode the source text of CODING into a new string set in
+   CODING->dst_object without going through a work buffer, if it is
+   unibyte text in valid UTF-8 that needs no EOL conversion.  A
+   trailing incomplete sequence is saved in CODING->carryover as
+   decode_coding does.  Return true if the text was decoded, false if
+   it must be decoded by decode_coding.  */
+
+static bool
+decode_coding_utf_8_to_string (struct coding_system *coding)
+{
+  Lisp_Object attrs = CODING_ID_ATTRS (coding->id);
+  Lisp_Object eol_type = CODING_ID_EOL_TYPE (coding->id);
+  const unsigned char *src;
+  ptrdiff_t bytes, nchars, tail;
+
+  if (disable_ascii_optimization
+      || coding->src_multibyte
+      || ! EQ (CODING_ATTR_TYPE (attrs), Qutf_8)
+      || CODING_UTF_8_BOM (coding) != utf_without_bom
+      || ! NILP (CODING_ATTR_POST_READ (attrs))
+      || ! NILP (get_translation_table (attrs, 0, NULL)))
+    return false;
+
+  coding_set_source (coding);
+  src = coding->source;
+  if (! EQ (eol_type, Qunix) && ! inhibit_eol_conversion
+      && memchr (src, '\r', coding->src_bytes))
+    return false;
+  if (! utf_8_source_p (coding, &nchars, &bytes))
+    return false;
+  if (VECTORP (eol_type) && ! inhibit_eol_conversion
+      && memchr (src, '\n', bytes))
+    adjust_coding_eol_type (coding, EOL_SEEN_LF);
+
+  tail = coding->src_bytes - bytes;
+  coding->dst_multibyte = true;
+  coding->dst_object = make_multibyte_string ((const char *) src,
+					      nchars, bytes);
+  coding->consumed = coding->src_bytes;
+  coding->consumed_char = bytes;
+  coding->produced = bytes;
+  coding->produced_char = nchars;
+  coding->chars_at_source = 0;
+  coding->carryover_bytes = tail;
+  memcpy (coding->carryover, src + bytes, tail);
+  record_conversion_result (coding, (tail > 0
+				     ? CODING_RESULT_INSUFFICIENT_SRC
+				     : CODING_RESULT_SUCCESS));
+  return true;
+}
+
+
 /* Decode the text in the range FROM/FROM_BYTE and TO/TO_BYTE in
    SRC_OBJECT into DST_OBJECT by coding context CODING.
 
@@ -8129,7 +8508,19 @@ decode_coding_object (struct coding_system *coding,
     }
 
   if (CODING_REQUIRE_DETECTION (coding))
-    detect_coding (coding);
+    detect_coding (coding, true);
+
+  if (EQ (dst_object, Qt) && decode_coding_utf_8_to_string (coding))
+    return;
+  /* Otherwise, if UTF-8 was detected from samples of the text, make
+     sure it is right before decoding.  */
+  if (coding->sampled_detection_id >= 0)
+    {
+      ptrdiff_t nchars, nbytes;
+
+      if (! utf_8_source_p (coding, &nchars, &nbytes))
+	redetect_coding (coding);
+    }
   attrs = CODING_ID_ATTRS (coding->id);
 
   if (EQ (dst_object, Qt)
@@ -12155,6 +12546,21 @@ system (e.g. `iso-2022-7bit').
 decode text as usual.  */);
   inhibit_null_byte_detection = 0;
 
+  DEFVAR_LISP ("detect-coding-sample-threshold",
+	       Vdetect_coding_sample_threshold,
+	       doc: /* Size of text above which code detection looks only at samples of it.
+When Emacs detects how a text larger than this many bytes is encoded,
+it first looks at some windows of it, at its beginning, its end, and
+places in between.  If they show that the text is encoded in UTF-8,
+and UTF-8 has the highest priority (see `prefer-coding-system') or is
+preferred by the coding system being used, the text is decoded as
+UTF-8, and the detection is redone on the whole text if it turns out
+not to be valid UTF-8 after all.  The result is the same as if the
+whole text were examined, but a large UTF-8 text is read faster.
+
+The value nil means always examine the whole text.  */);
+  Vdetect_coding_sample_threshold = make_fixnum (1024 * 1024);
+
   DEFVAR_BOOL ("disable-ascii-optimization", disable_ascii_optimization,
 	       doc: /* If non-nil, Emacs does not optimize code decoder for ASCII files.
 Internal use only.  Remove after the experimental optimizer becomes stable.  */);
@@ -456,9 +456,11 @@ #define CODING_MODE_SAFE_ENCODING		0x10
      the eol format.  */
   ptrdiff_t head_ascii;
 
-  /* How many bytes/chars at the source are detected as valid utf-8
-     sequence.  Set by detect_coding_utf_8.  */
-  ptrdiff_t detected_utf8_bytes, detected_utf8_chars;
+  /* If detect_coding decided the coding system from samples of the
+     source text, the ID of the coding system it started from, so
+     that the decoder can have the detection redone if the whole text
+     doesn't bear out the samples.  Otherwise -1.  */
+  ptrdiff_t sampled_detection_id;
 
   /* The following members are set by encoding/decoding routine.  */
   ptrdiff_t produced, produced_char, consumed, consumed_char;
@@ -697,6 +699,7 @@ #define UTF_16_LOW_SURROGATE_P(val) \
 extern bool raw_text_coding_system_p (struct coding_system *);
 extern Lisp_Object coding_inherit_eol_type (Lisp_Object, Lisp_Object);
 extern Lisp_Object complement_process_encoding_system (Lisp_Object);
+extern Lisp_Object get_translation_table (Lisp_Object, bool, int *);
 extern Lisp_Object make_string_from_utf8 (const char *, ptrdiff_t);
 
 extern void decode_coding_gap (struct coding_system *, ptrdiff_t);
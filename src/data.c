@@ -2468,6 +2468,7 @@ DEFUN ("aset", Faset, Saset, 3, 3, 0,
   else if (CHAR_TABLE_P (array))
     {
       CHECK_CHARACTER (idx);
+      char_table_modified (array);
       CHAR_TABLE_SET (array, idxval, newelt);
     }
   else if (RECORDP (array))
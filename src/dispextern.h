@@ -1262,7 +1262,108 @@ #define MATRIX_ROW_OVERLAPS_SUCC_P(ROW)		\
 /* True means last display completed.  False means it was preempted.  */
 
 extern bool display_completed;
+
+/* Everything, apart from the start position, that the glyph rows in a
+   window's glyph row cache depend on.  All rows in the cache have
+   been produced under the same stamp; see glyph_row_cache_validate.  */
+
+struct glyph_row_cache_stamp
+{
+  /* The buffer displayed, its accessible portion, and its
+     modification counters.  The buffer is identified by its address;
+     since killing a buffer invalidates all glyph row caches, a buffer
+     created later at the same address never matches a stale stamp.  */
+  struct buffer *buffer;
+  ptrdiff_t begv, zv;
+  modiff_count modiff, overlay_modiff;
+
+  /* Generation of the frame's face cache, see struct face_cache.  */
+  unsigned face_generation;
+
+  /* Settings of the display iterator that determine the layout of
+     rows.  */
+  int first_visible_x, last_visible_x;
+  int left_margin_cols, right_margin_cols;
+  int tab_width, extra_line_spacing, base_face_id;
+  ptrdiff_t selective;
+  struct Lisp_Char_Table *dp;
+  int line_wrap;
+  int paragraph_embedding;
+  bool_bf ctl_arrow_p : 1;
+  bool_bf bidi_p : 1;
+  bool_bf selective_display_ellipsis_p : 1;
+
+  /* Other variables that affect the glyphs produced for text.
+     NOBREAK_CHAR_DISPLAY is 0, 1 or 2 for a value of nil, t or
+     anything else of `nobreak-char-display'.  */
+  int nobreak_char_display;
+  bool_bf show_trailing_whitespace_p : 1;
+  bool_bf indicate_empty_lines_p : 1;
+  bool_bf raw_bytes_as_hex_p : 1;
+  bool_bf wrap_by_category_p : 1;
+};
 
+/* The ways in which redisplay can produce the display of a window.
+   Used for the statistics reported by `redisplay-statistics'.  */
+
+enum redisplay_method
+{
+  /* try_cursor_movement succeeded.  */
+  REDISPLAY_CURSOR_MOVEMENT,
+
+  /* The single-line optimization of redisplay_internal succeeded.  */
+  REDISPLAY_SINGLE_LINE,
+
+  /* try_window_reusing_current_matrix succeeded.  */
+  REDISPLAY_REUSE_CURRENT_MATRIX,
+
+  /* try_window_id succeeded.  */
+  REDISPLAY_TRY_WINDOW_ID,
+
+  /* try_window was called to redisplay the window from scratch.  */
+  REDISPLAY_TRY_WINDOW,
+
+  REDISPLAY_NMETHODS
+};
+
+/* Redisplay statistics, accumulated either for a window or for one or
+   more calls of redisplay_internal.  */
+
+struct redisplay_counters
+{
+  /* Number of times the window or the frames were redisplayed.  */
+  intmax_t count;
+
+  /* Number of windows redisplayed.  Not used for windows.  */
+  intmax_t windows;
+
+  /* Number of times each redisplay method was used.  */
+  intmax_t methods[REDISPLAY_NMETHODS];
+
+  /* Number of glyph rows produced by display_line.  */
+  intmax_t rows;
+
+  /* Number of glyph rows copied from the glyph row cache instead.  */
+  intmax_t cached_rows;
+
+  /* Number of mode lines, header lines and tab lines displayed, and
+     how many of them were copied from the mode line cache.  */
+  intmax_t mode_lines, cached_mode_lines;
+
+  /* Number of times the face of text was computed from its `face'
+     property alone, and how many of these were found in the face
+     merge cache of the frame.  */
+  intmax_t face_merges, cached_face_merges;
+
+  /* Time spent in redisplay, and the part of it spent in update_frame
+     including terminal output.  The latter is not used for windows.  */
+  struct timespec time, update_time;
+
+  /* Number of bytes sent to text terminals by update_frame, and the
+     number of times their output was flushed.  Not used for windows.  */
+  intmax_t output_bytes, output_flushes;
+};
+
 /************************************************************************
 			  Glyph Strings
  ************************************************************************/
@@ -1852,6 +1953,14 @@ #define MAX_FACE_ID  ((1 << FACE_ID_BITS) - 1)
   ptrdiff_t size;
   int used;
 
+  /* Incremented whenever realized faces are freed, so that code
+     remembering face IDs from this cache can tell they are stale.  */
+  unsigned generation;
+
+  /* Face IDs recently computed by face_at_buffer_position for face
+     property values, or NULL.  See lookup_merged_face.  */
+  struct face_merge_cache *merge_cache;
+
   /* Flag indicating that attributes of the `menu' face have been
      changed.  */
   bool_bf menu_face_changed_p : 1;
@@ -2046,9 +2155,12 @@ #define BIDI_MAXDEPTH 125
   struct window *w;		/* the window being displayed */
   bidi_dir_t paragraph_dir;	/* current paragraph direction */
   ptrdiff_t separator_limit;	/* where paragraph separator should end */
+  ptrdiff_t ltr_limit;		/* buffer text before this byte position
+				   needs no reordering */
   bool_bf first_elt : 1;	/* if true, examine current char first */
   bool_bf new_paragraph : 1;	/* if true, we expect a new paragraph */
   bool_bf frame_window_p : 1;	/* true if displaying on a GUI frame */
+  bool_bf ltr_fast : 1;		/* true if this char was not resolved by UBA */
 };
 
 /* Value is non-zero when the bidi iterator is at base paragraph
@@ -3124,6 +3236,12 @@ #define CENTERED_IMAGE_ASCENT -1
   /* True means that loading the image failed.  Don't try again.  */
   bool load_failed_p;
 
+  /* True means that the image is being loaded asynchronously, and
+     its pixels are not available yet.  Its size is then provisional.
+     LOAD_JOB is the request to load it.  */
+  bool load_pending_p;
+  struct image_load_job *load_job;
+
   /* A place for image types to store additional data.  It is marked
      during GC.  */
   Lisp_Object lisp_data;
@@ -3134,6 +3252,10 @@ #define CENTERED_IMAGE_ASCENT -1
   /* Image id of this image.  */
   ptrdiff_t id;
 
+  /* Number of bytes of pixel data of this image, as counted in the
+     `bytes' member of its image cache.  */
+  size_t nbytes;
+
   /* Hash collision chain.  */
   struct image *next, *prev;
 };
@@ -3158,6 +3280,14 @@ #define CENTERED_IMAGE_ASCENT -1
 
   /* Reference count (number of frames sharing this cache).  */
   ptrdiff_t refcount;
+
+  /* Number of bytes of pixel data of the images in the cache, and
+     the largest value it has had.  */
+  size_t bytes, peak_bytes;
+
+  /* Number of times the pixel data of an image was freed to keep
+     `bytes' within `image-cache-size-limit'.  */
+  intmax_t evictions;
 };
 
 /* Size of bucket vector of image caches.  Should be prime.  */
@@ -3322,6 +3452,11 @@ #define TTY_CAP_STRIKE_THROUGH	0x20
 
 /* Defined in xdisp.c */
 
+void count_redisplay_update_time (struct timespec);
+void count_redisplay_output (intmax_t, intmax_t);
+void count_face_merge (struct window *, bool);
+void free_mode_line_cache (struct window *);
+void invalidate_mode_line_caches (void);
 struct glyph_row *row_containing_pos (struct window *, ptrdiff_t,
                                       struct glyph_row *,
                                       struct glyph_row *, int);
@@ -3484,9 +3619,12 @@ #define TRY_WINDOW_IGNORE_FONTS_CHANGE	(1 << 1)
 struct image_cache *make_image_cache (void);
 void free_image_cache (struct frame *);
 void clear_image_caches (Lisp_Object);
+void limit_image_caches (void);
 void mark_image_cache (struct image_cache *);
 bool valid_image_p (Lisp_Object);
 void prepare_image_for_display (struct frame *, struct image *);
+void image_wait_for_load (struct image *);
+void image_finish_loads (void);
 ptrdiff_t lookup_image (struct frame *, Lisp_Object, int);
 
 #if defined HAVE_X_WINDOWS || defined USE_CAIRO || defined HAVE_NS
@@ -3531,6 +3669,7 @@ #define RGB_PIXEL_COLOR COLORREF
 
 Lisp_Object tty_color_name (struct frame *, int);
 void clear_face_cache (bool);
+void forget_merged_faces (void);
 unsigned long load_color (struct frame *, struct face *, Lisp_Object,
                           enum lface_attribute_index);
 char *choose_face_font (struct frame *, Lisp_Object *, Lisp_Object,
@@ -3621,6 +3760,15 @@ #define IMAGE_BACKGROUND_TRANSPARENT(img, f, mask)			      \
 extern void adjust_frame_glyphs (struct frame *);
 void free_glyphs (struct frame *);
 void free_window_matrices (struct window *);
+void free_glyph_row_cache (struct window *);
+bool glyph_row_cache_validate (struct window *,
+			       const struct glyph_row_cache_stamp *);
+struct glyph_row *glyph_row_cache_lookup (struct window *,
+					  struct display_pos *, int);
+void glyph_row_cache_store (struct window *, struct glyph_row *);
+bool copy_cached_glyph_row (struct glyph_row *, struct glyph_row *);
+void save_glyph_row (struct glyph_row *, struct glyph **, ptrdiff_t *,
+		     struct glyph_row *);
 void check_glyph_memory (void);
 void mirrored_line_dance (struct glyph_matrix *, int, int, int *, char *);
 void clear_glyph_matrix (struct glyph_matrix *);
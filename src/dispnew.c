@@ -23,6 +23,7 @@ Copyright (C) 1985-1988, 1993-1995, 1997-2021 Free Software Foundation,
 #include "sysstdio.h"
 #include <stdlib.h>
 #include <unistd.h>
+#include <flexmember.h>
 
 #include "lisp.h"
 #include "termchar.h"
@@ -2347,6 +2348,8 @@ free_window_matrices (struct window *w)
 	  free_glyph_matrix (w->current_matrix);
 	  free_glyph_matrix (w->desired_matrix);
 	  w->current_matrix = w->desired_matrix = NULL;
+	  free_glyph_row_cache (w);
+	  free_mode_line_cache (w);
 	}
 
       /* Next window on same level.  */
@@ -2355,6 +2358,287 @@ free_window_matrices (struct window *w)
 }
 
 
+
+/***********************************************************************
+			     Glyph Row Cache
+ ***********************************************************************/
+
+/* A window's glyph row cache holds copies of glyph rows that
+   display_line produced for the window, so that try_window can reuse
+   them when the same text is displayed again, e.g. after scrolling
+   back or switching back to a window configuration.  Rows are looked
+   up by their start position.  Everything else a row depends on is
+   summarized by the cache's stamp; glyph_row_cache_validate flushes
+   the cache when redisplay runs under a different stamp.
+
+   The cache is direct-mapped, so it never holds more than
+   redisplay-glyph-row-cache-size rows.  */
+
+struct glyph_row_cache_entry
+{
+  /* The cached row.  Its glyph pointers point into GLYPHS.  */
+  struct glyph_row row;
+
+  /* Glyph memory of ROW, and its allocated size in glyphs.  */
+  struct glyph *glyphs;
+  ptrdiff_t nglyphs;
+
+  /* True if ROW is valid.  */
+  bool_bf valid_p : 1;
+};
+
+struct glyph_row_cache
+{
+  /* The conditions under which all rows in the cache were produced.  */
+  struct glyph_row_cache_stamp stamp;
+
+  /* Value of glyph_row_cache_tick when STAMP was recorded.  */
+  unsigned tick;
+
+  /* Number of entries.  */
+  ptrdiff_t size;
+
+  struct glyph_row_cache_entry entries[FLEXIBLE_ARRAY_MEMBER];
+};
+
+/* Incremented to invalidate all glyph row caches, when something that
+   is not part of the stamps might have changed.  */
+
+static unsigned glyph_row_cache_tick;
+
+/* Free the glyph row cache of window W, if any.  */
+
+void
+free_glyph_row_cache (struct window *w)
+{
+  struct glyph_row_cache *c = w->glyph_row_cache;
+
+  if (c)
+    {
+      for (ptrdiff_t i = 0; i < c->size; i++)
+	xfree (c->entries[i].glyphs);
+      xfree (c);
+      w->glyph_row_cache = NULL;
+    }
+}
+
+/* Make all glyph row caches invalid.  */
+
+void
+invalidate_glyph_row_caches (void)
+{
+  glyph_row_cache_tick++;
+}
+
+static bool
+glyph_row_cache_stamp_equal (const struct glyph_row_cache_stamp *a,
+			     const struct glyph_row_cache_stamp *b)
+{
+  return (a->buffer == b->buffer
+	  && a->begv == b->begv
+	  && a->zv == b->zv
+	  && a->modiff == b->modiff
+	  && a->overlay_modiff == b->overlay_modiff
+	  && a->face_generation == b->face_generation
+	  && a->first_visible_x == b->first_visible_x
+	  && a->last_visible_x == b->last_visible_x
+	  && a->left_margin_cols == b->left_margin_cols
+	  && a->right_margin_cols == b->right_margin_cols
+	  && a->tab_width == b->tab_width
+	  && a->extra_line_spacing == b->extra_line_spacing
+	  && a->base_face_id == b->base_face_id
+	  && a->selective == b->selective
+	  && a->dp == b->dp
+	  && a->line_wrap == b->line_wrap
+	  && a->paragraph_embedding == b->paragraph_embedding
+	  && a->ctl_arrow_p == b->ctl_arrow_p
+	  && a->bidi_p == b->bidi_p
+	  && a->selective_display_ellipsis_p == b->selective_display_ellipsis_p
+	  && a->nobreak_char_display == b->nobreak_char_display
+	  && a->show_trailing_whitespace_p == b->show_trailing_whitespace_p
+	  && a->indicate_empty_lines_p == b->indicate_empty_lines_p
+	  && a->raw_bytes_as_hex_p == b->raw_bytes_as_hex_p
+	  && a->wrap_by_category_p == b->wrap_by_category_p);
+}
+
+/* Prepare the glyph row cache of window W for a redisplay of W under
+   the conditions described by STAMP.  Rows cached under different
+   conditions are discarded.  Value is true if W has a glyph row cache,
+   false if caching glyph rows is disabled.  */
+
+bool
+glyph_row_cache_validate (struct window *w,
+			  const struct glyph_row_cache_stamp *stamp)
+{
+  struct glyph_row_cache *c = w->glyph_row_cache;
+  ptrdiff_t size = clip_to_bounds (0, redisplay_glyph_row_cache_size,
+				   min (PTRDIFF_MAX, SIZE_MAX) / 2
+				   / sizeof *c->entries);
+
+  if (c && c->size != size)
+    {
+      free_glyph_row_cache (w);
+      c = NULL;
+    }
+
+  if (size == 0)
+    return false;
+
+  if (!c)
+    {
+      c = xzalloc (FLEXSIZEOF (struct glyph_row_cache, entries,
+			       size * sizeof *c->entries));
+      c->size = size;
+      w->glyph_row_cache = c;
+    }
+  else if (c->tick == glyph_row_cache_tick
+	   && glyph_row_cache_stamp_equal (&c->stamp, stamp))
+    return true;
+
+  for (ptrdiff_t i = 0; i < c->size; i++)
+    c->entries[i].valid_p = false;
+  c->stamp = *stamp;
+  c->tick = glyph_row_cache_tick;
+  return true;
+}
+
+/* Return the entry of cache C for rows starting at buffer position
+   CHARPOS with continuation lines width CONTINUATION_LINES_WIDTH.  */
+
+static struct glyph_row_cache_entry *
+glyph_row_cache_entry (struct glyph_row_cache *c, ptrdiff_t charpos,
+		       int continuation_lines_width)
+{
+  size_t hash = charpos * 2654435761u + continuation_lines_width;
+  return &c->entries[hash % c->size];
+}
+
+/* Return the row cached for window W that starts at POS with
+   continuation lines width CONTINUATION_LINES_WIDTH, or NULL if there
+   is none.  Only positions in buffer text, not in strings or display
+   vectors, can be found.  */
+
+struct glyph_row *
+glyph_row_cache_lookup (struct window *w, struct display_pos *pos,
+			int continuation_lines_width)
+{
+  struct glyph_row_cache *c = w->glyph_row_cache;
+  struct glyph_row_cache_entry *e;
+
+  if (!c
+      || pos->overlay_string_index >= 0
+      || pos->dpvec_index >= 0
+      || CHARPOS (pos->string_pos) >= 0)
+    return NULL;
+
+  e = glyph_row_cache_entry (c, CHARPOS (pos->pos), continuation_lines_width);
+  if (e->valid_p
+      && CHARPOS (e->row.start.pos) == CHARPOS (pos->pos)
+      && BYTEPOS (e->row.start.pos) == BYTEPOS (pos->pos)
+      && e->row.continuation_lines_width == continuation_lines_width)
+    return &e->row;
+  return NULL;
+}
+
+/* Store a copy of glyph row ROW of window W in W's glyph row cache,
+   replacing whatever row was cached in its slot.  Do nothing if ROW
+   contains glyphs that refer to data that might be freed while the
+   row is in the cache, i.e. images, compositions, xwidgets, or
+   glyphs produced from strings, which are not marked by GC.  */
+
+void
+glyph_row_cache_store (struct window *w, struct glyph_row *row)
+{
+  struct glyph_row_cache *c = w->glyph_row_cache;
+  struct glyph_row_cache_entry *e;
+  int area;
+
+  if (!c
+      || row->start.overlay_string_index >= 0
+      || row->start.dpvec_index >= 0
+      || CHARPOS (row->start.string_pos) >= 0)
+    return;
+
+  for (area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
+    {
+      struct glyph *glyph = row->glyphs[area];
+      struct glyph *end = glyph + row->used[area];
+
+      for (; glyph < end; ++glyph)
+	if ((glyph->type != CHAR_GLYPH
+	     && glyph->type != STRETCH_GLYPH
+	     && glyph->type != GLYPHLESS_GLYPH)
+	    || STRINGP (glyph->object))
+	  return;
+    }
+
+  e = glyph_row_cache_entry (c, CHARPOS (row->start.pos),
+			     row->continuation_lines_width);
+  save_glyph_row (&e->row, &e->glyphs, &e->nglyphs, row);
+  e->valid_p = true;
+}
+
+/* Make TO a copy of glyph row FROM whose glyphs are stored in
+   *GLYPHS, which has room for *NGLYPHS glyphs and is reallocated if
+   that is not enough.  */
+
+void
+save_glyph_row (struct glyph_row *to, struct glyph **glyphs,
+		ptrdiff_t *nglyphs, struct glyph_row *from)
+{
+  ptrdiff_t n = 0;
+  int area;
+
+  for (area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
+    n += from->used[area];
+
+  /* Allocate one glyph more than used, because the position of the
+     first glyph in the text area is consulted even if the text area
+     is empty.  */
+  if (*nglyphs < n + 1)
+    {
+      xfree (*glyphs);
+      *glyphs = xnmalloc (n + 1, sizeof **glyphs);
+      *nglyphs = n + 1;
+    }
+
+  *to = *from;
+  to->glyphs[LEFT_MARGIN_AREA] = *glyphs;
+  for (area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
+    {
+      int used = from->used[area] + (area == TEXT_AREA && !from->used[area]);
+      memcpy (to->glyphs[area], from->glyphs[area], used * sizeof **glyphs);
+      to->glyphs[area + 1] = to->glyphs[area] + used;
+    }
+}
+
+/* Copy the cached glyph row FROM to the glyph row TO of a desired
+   matrix, including its glyphs.  Value is false if TO does not have
+   room for all of FROM's glyphs, in which case TO is unchanged.  */
+
+bool
+copy_cached_glyph_row (struct glyph_row *to, struct glyph_row *from)
+{
+  int area;
+
+  for (area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
+    if (to->glyphs[area + 1] - to->glyphs[area] < from->used[area])
+      return false;
+
+  struct glyph *glyphs[1 + LAST_AREA];
+  memcpy (glyphs, to->glyphs, sizeof glyphs);
+  *to = *from;
+  memcpy (to->glyphs, glyphs, sizeof glyphs);
+
+  for (area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
+    memcpy (to->glyphs[area], from->glyphs[area],
+	    from->used[area] * sizeof *to->glyphs[area]);
+  if (!from->used[TEXT_AREA]
+      && to->glyphs[TEXT_AREA] < to->glyphs[TEXT_AREA + 1])
+    to->glyphs[TEXT_AREA][0] = from->glyphs[TEXT_AREA][0];
+  return true;
+}
+
 /* Check glyph memory leaks.  This function is called from
    shut_down_emacs.  Note that frames are not destroyed when Emacs
    exits.  We therefore free all glyph memory for all active frames
@@ -3164,6 +3448,7 @@ update_frame (struct frame *f, bool force_p, bool inhibit_hairy_id_p)
   /* True means display has been paused because of pending input.  */
   bool paused_p;
   struct window *root_window = XWINDOW (f->root_window);
+  struct timespec start = current_timespec ();
 
   if (redisplay_dont_pause)
     force_p = true;
@@ -3258,9 +3543,15 @@ update_frame (struct frame *f, bool force_p, bool inhibit_hairy_id_p)
         paused_p = false;
       else
         {
+	  struct tty_display_info *tty = FRAME_TTY (f);
+	  intmax_t output_bytes = tty->output_bytes;
+	  intmax_t output_flushes = tty->output_flushes;
+
           update_begin (f);
           paused_p = update_frame_1 (f, force_p, inhibit_hairy_id_p, 1, false);
           update_end (f);
+	  count_redisplay_output (tty->output_bytes - output_bytes,
+				  tty->output_flushes - output_flushes);
         }
 
       if (FRAME_TERMCAP_P (f) || FRAME_MSDOS_P (f))
@@ -3283,6 +3574,7 @@ update_frame (struct frame *f, bool force_p, bool inhibit_hairy_id_p)
   set_window_update_flags (root_window, false);
 
   display_completed = !paused_p;
+  count_redisplay_update_time (timespec_sub (current_timespec (), start));
   return paused_p;
 }
 
@@ -4845,19 +5137,23 @@ update_frame_1 (struct frame *f, bool force_p, bool inhibit_id_p,
     {
       if (MATRIX_ROW_ENABLED_P (desired_matrix, i))
 	{
-	  if (FRAME_TERMCAP_P (f))
+	  if (FRAME_TERMCAP_P (f) && !tty_write_updates_at_once)
 	    {
 	      /* Flush out every so many lines.
 		 Also flush out if likely to have more than 1k buffered
 		 otherwise.   I'm told that some telnet connections get
 		 really screwed by more than 1k output at once.  */
-	      FILE *display_output = FRAME_TTY (f)->output;
+	      struct tty_display_info *tty = FRAME_TTY (f);
+	      FILE *display_output = tty->output;
 	      if (display_output)
 		{
 		  ptrdiff_t outq = __fpending (display_output);
 		  if (outq > 900
 		      || (outq > 20 && ((i - 1) % preempt_count == 0)))
-		    fflush (display_output);
+		    {
+		      fflush (display_output);
+		      tty->output_flushes++;
+		    }
 		}
 	    }
 
@@ -6697,6 +6993,22 @@ syms_of_display (void)
      beginning of the next redisplay).  */
   redisplay_dont_pause = true;
 
+  DEFVAR_INT ("redisplay-glyph-row-cache-size", redisplay_glyph_row_cache_size,
+	      doc: /* Number of glyph rows to cache per window for reuse.
+When this is positive, redisplay remembers up to that many screen
+lines it has produced for each window, and reuses them instead of
+laying out the same text again when it shows that text again under
+the same conditions, for example after scrolling back or switching
+back to a window configuration.  Lines showing point are never
+reused.  The value zero disables the cache.
+
+This is an experimental feature: changes that affect the display of
+text without modifying the buffer, its overlays, its faces or the
+variables in the list that `set-buffer-redisplay' is watching, might
+not be shown until the next change of that kind, unless
+`force-window-update' is called.  */);
+  redisplay_glyph_row_cache_size = 0;
+
   DEFVAR_LISP ("tab-bar-position", Vtab_bar_position,
 	       doc: /* Specify on which side from the tool bar the tab bar shall be.
 Possible values are t (below the tool bar), nil (above the tool bar).
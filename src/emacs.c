@@ -1880,10 +1880,6 @@ main (int argc, char **argv)
     init_xfaces ();
 #endif
 
-#if defined HAVE_JSON && !defined WINDOWSNT
-  init_json ();
-#endif
-
   if (!initialized)
     syms_of_comp ();
 
@@ -2237,9 +2233,7 @@ main (int argc, char **argv)
       syms_of_profiler ();
       syms_of_pdumper ();
 
-#ifdef HAVE_JSON
       syms_of_json ();
-#endif
 
       keys_of_keyboard ();
 
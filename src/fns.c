@@ -24,6 +24,7 @@ Copyright (C) 1985-1987, 1993-1995, 1997-2021 Free Software Foundation,
 #include <sys/random.h>
 #include <unistd.h>
 #include <filevercmp.h>
+#include <flexmember.h>
 #include <intprops.h>
 #include <vla.h>
 #include <errno.h>
@@ -3414,7 +3415,7 @@ #define MIME_LINE_LENGTH 76
 
 /* Tables of base64 values for bytes.  -1 means ignorable, 0 invalid,
    positive means 1 + the represented value.  */
-static signed char const base64_char_to_value[2][UCHAR_MAX] =
+static signed char const base64_char_to_value[2][UCHAR_MAX + 1] =
 {
  /* base64 */
  {
@@ -3452,6 +3453,12 @@ #define MIME_LINE_LENGTH 76
  }
 };
 
+/* Tables of the pairs of characters coding each 12-bit value, so that
+   two lookups encode a triplet of octets.  base64_encode_1 makes them
+   on first use.  */
+static char base64_value_to_pair[2][1 << 12][2];
+static bool base64_value_to_pair_made[2];
+
 /* The following diagram shows the logical steps by which three octets
    get transformed into four base64 characters.
 
@@ -3474,7 +3481,7 @@ #define MIME_LINE_LENGTH 76
 static ptrdiff_t base64_encode_1 (const char *, char *, ptrdiff_t, bool, bool,
 				  bool, bool);
 static ptrdiff_t base64_decode_1 (const char *, char *, ptrdiff_t, bool,
-				  bool, ptrdiff_t *);
+				  bool, bool, ptrdiff_t *);
 
 static Lisp_Object base64_encode_region_1 (Lisp_Object, Lisp_Object, bool,
 					   bool, bool);
@@ -3645,9 +3652,47 @@ base64_encode_1 (const char *from, char *to, ptrdiff_t length,
   unsigned int value;
   int bytes;
   char const *b64_value_to_char = base64_value_to_char[base64url];
+  char const (*b64_value_to_pair)[2] = base64_value_to_pair[base64url];
+
+  if (!base64_value_to_pair_made[base64url])
+    {
+      for (int v = 0; v < 1 << 12; v++)
+	{
+	  base64_value_to_pair[base64url][v][0] = b64_value_to_char[v >> 6];
+	  base64_value_to_pair[base64url][v][1] = b64_value_to_char[v & 0x3f];
+	}
+      base64_value_to_pair_made[base64url] = true;
+    }
 
   while (i < length)
     {
+      /* Encode whole triplets of plain bytes in one go, without the
+	 checks below.  In multibyte text, that means ASCII bytes.  */
+      while (length - i >= 3)
+	{
+	  unsigned char const *p = (unsigned char const *) from + i;
+
+	  if (multibyte && (p[0] | p[1] | p[2]) & 0x80)
+	    break;
+	  if (line_break)
+	    {
+	      if (counter < MIME_LINE_LENGTH / 4)
+		counter++;
+	      else
+		{
+		  *e++ = '\n';
+		  counter = 1;
+		}
+	    }
+	  value = p[0] << 16 | p[1] << 8 | p[2];
+	  memcpy (e, b64_value_to_pair[value >> 12], 2);
+	  memcpy (e + 2, b64_value_to_pair[0xfff & value], 2);
+	  e += 4;
+	  i += 3;
+	}
+      if (i == length)
+	break;
+
       if (multibyte)
 	{
 	  c = string_char_and_length ((unsigned char *) from + i, &bytes);
@@ -3737,7 +3782,7 @@ base64_encode_1 (const char *from, char *to, ptrdiff_t length,
 
 
 DEFUN ("base64-decode-region", Fbase64_decode_region, Sbase64_decode_region,
-       2, 3, "r",
+       2, 4, "r",
        doc: /* Base64-decode the region between BEG and END.
 Return the length of the decoded data.
 
@@ -3748,8 +3793,11 @@ DEFUN ("base64-decode-region", Fbase64_decode_region, Sbase64_decode_region,
 
 If the region can't be decoded, signal an error and don't modify the buffer.
 Optional third argument BASE64URL determines whether to use the URL variant
-of the base 64 encoding, as defined in RFC 4648.  */)
-     (Lisp_Object beg, Lisp_Object end, Lisp_Object base64url)
+of the base 64 encoding, as defined in RFC 4648.
+If optional fourth argument IGNORE-INVALID is non-nil invalid characters
+are ignored instead of signaling an error.  */)
+     (Lisp_Object beg, Lisp_Object end, Lisp_Object base64url,
+      Lisp_Object ignore_invalid)
 {
   ptrdiff_t ibeg, iend, length, allength;
   char *decoded;
@@ -3775,7 +3823,8 @@ DEFUN ("base64-decode-region", Fbase64_decode_region, Sbase64_decode_region,
   move_gap_both (XFIXNAT (beg), ibeg);
   decoded_length = base64_decode_1 ((char *) BYTE_POS_ADDR (ibeg),
 				    decoded, length, !NILP (base64url),
-				    multibyte, &inserted_chars);
+				    multibyte, !NILP (ignore_invalid),
+				    &inserted_chars);
   if (decoded_length > allength)
     emacs_abort ();
 
@@ -3808,11 +3857,13 @@ DEFUN ("base64-decode-region", Fbase64_decode_region, Sbase64_decode_region,
 }
 
 DEFUN ("base64-decode-string", Fbase64_decode_string, Sbase64_decode_string,
-       1, 2, 0,
+       1, 3, 0,
        doc: /* Base64-decode STRING and return the result as a string.
 Optional argument BASE64URL determines whether to use the URL variant of
-the base 64 encoding, as defined in RFC 4648.  */)
-     (Lisp_Object string, Lisp_Object base64url)
+the base 64 encoding, as defined in RFC 4648.
+If optional third argument IGNORE-INVALID is non-nil invalid characters are
+ignored instead of signaling an error.  */)
+     (Lisp_Object string, Lisp_Object base64url, Lisp_Object ignore_invalid)
 {
   char *decoded;
   ptrdiff_t length, decoded_length;
@@ -3828,7 +3879,8 @@ DEFUN ("base64-decode-string", Fbase64_decode_string, Sbase64_decode_string,
   /* The decoded result should be unibyte. */
   ptrdiff_t decoded_chars;
   decoded_length = base64_decode_1 (SSDATA (string), decoded, length,
-				    !NILP (base64url), 0, &decoded_chars);
+				    !NILP (base64url), false,
+				    !NILP (ignore_invalid), &decoded_chars);
   if (decoded_length > length)
     emacs_abort ();
   else if (decoded_length >= 0)
@@ -3845,12 +3897,13 @@ DEFUN ("base64-decode-string", Fbase64_decode_string, Sbase64_decode_string,
 
 /* Base64-decode the data at FROM of LENGTH bytes into TO.  If
    MULTIBYTE, the decoded result should be in multibyte
-   form.  Store the number of produced characters in *NCHARS_RETURN.  */
+   form.  If IGNORE_INVALID, ignore invalid base64 characters.
+   Store the number of produced characters in *NCHARS_RETURN.  */
 
 static ptrdiff_t
 base64_decode_1 (const char *from, char *to, ptrdiff_t length,
-		 bool base64url,
-		 bool multibyte, ptrdiff_t *nchars_return)
+		 bool base64url, bool multibyte, bool ignore_invalid,
+		 ptrdiff_t *nchars_return)
 {
   char const *f = from;
   char const *flim = from + length;
@@ -3864,6 +3917,39 @@ base64_decode_1 (const char *from, char *to, ptrdiff_t length,
       unsigned char c;
       int v1;
 
+      /* Decode whole quadruplets of base64 characters in one go,
+	 without the checks below.  Anything else, such as a line
+	 break or padding, is left to them.  */
+      while (flim - f >= 4)
+	{
+	  unsigned char const *p = (unsigned char const *) f;
+	  int w0 = b64_char_to_value[p[0]], w1 = b64_char_to_value[p[1]];
+	  int w2 = b64_char_to_value[p[2]], w3 = b64_char_to_value[p[3]];
+
+	  if ((w0 <= 0) | (w1 <= 0) | (w2 <= 0) | (w3 <= 0))
+	    break;
+	  unsigned int value = ((w0 - 1) << 18 | (w1 - 1) << 12
+				| (w2 - 1) << 6 | (w3 - 1));
+	  if (value & (multibyte_bit * 0x10101))
+	    for (int shift = 16; shift >= 0; shift -= 8)
+	      {
+		c = value >> shift & 0xff;
+		if (c & multibyte_bit)
+		  e += BYTE8_STRING (c, (unsigned char *) e);
+		else
+		  *e++ = c;
+	      }
+	  else
+	    {
+	      e[0] = value >> 16;
+	      e[1] = value >> 8;
+	      e[2] = value;
+	      e += 3;
+	    }
+	  nchars += 3;
+	  f += 4;
+	}
+
       /* Process first byte of a quadruplet. */
 
       do
@@ -3876,7 +3962,7 @@ base64_decode_1 (const char *from, char *to, ptrdiff_t length,
 	  c = *f++;
 	  v1 = b64_char_to_value[c];
 	}
-      while (v1 < 0);
+      while (v1 < 0 || (v1 == 0 && ignore_invalid));
 
       if (v1 == 0)
 	return -1;
@@ -3887,11 +3973,16 @@ base64_decode_1 (const char *from, char *to, ptrdiff_t length,
       do
 	{
 	  if (f == flim)
-	    return -1;
+	    {
+	      if (!ignore_invalid)
+		return -1;
+	      *nchars_return = nchars;
+	      return e - to;
+	    }
 	  c = *f++;
 	  v1 = b64_char_to_value[c];
 	}
-      while (v1 < 0);
+      while (v1 < 0 || (v1 == 0 && ignore_invalid));
 
       if (v1 == 0)
 	return -1;
@@ -3910,7 +4001,7 @@ base64_decode_1 (const char *from, char *to, ptrdiff_t length,
 	{
 	  if (f == flim)
 	    {
-	      if (!base64url)
+	      if (!base64url && !ignore_invalid)
 		return -1;
 	      *nchars_return = nchars;
 	      return e - to;
@@ -3918,17 +4009,23 @@ base64_decode_1 (const char *from, char *to, ptrdiff_t length,
 	  c = *f++;
 	  v1 = b64_char_to_value[c];
 	}
-      while (v1 < 0);
+      while (v1 < 0 || (v1 == 0 && c != '=' && ignore_invalid));
 
       if (c == '=')
 	{
 	  do
 	    {
 	      if (f == flim)
-		return -1;
+		{
+		  if (!ignore_invalid)
+		    return -1;
+		  *nchars_return = nchars;
+		  return e - to;
+		}
 	      c = *f++;
 	    }
-	  while (b64_char_to_value[c] < 0);
+	  while (b64_char_to_value[c] < 0
+		 || (b64_char_to_value[c] == 0 && c != '=' && ignore_invalid));
 
 	  if (c != '=')
 	    return -1;
@@ -3952,7 +4049,7 @@ base64_decode_1 (const char *from, char *to, ptrdiff_t length,
 	{
 	  if (f == flim)
 	    {
-	      if (!base64url)
+	      if (!base64url && !ignore_invalid)
 		return -1;
 	      *nchars_return = nchars;
 	      return e - to;
@@ -3960,7 +4057,7 @@ base64_decode_1 (const char *from, char *to, ptrdiff_t length,
 	  c = *f++;
 	  v1 = b64_char_to_value[c];
 	}
-      while (v1 < 0);
+      while (v1 < 0 || (v1 == 0 && c != '=' && ignore_invalid));
 
       if (c == '=')
 	continue;
@@ -5336,6 +5433,93 @@ DEFUN ("secure-hash-algorithms", Fsecure_hash_algorithms,
   return list (Qmd5, Qsha1, Qsha224, Qsha256, Qsha384, Qsha512);
 }
 
+/* Find the region of the current buffer, OBJECT, between START and
+   END, and the coding system to encode it with, as described for
+   extract_data_from_object.  Store the region in *PB and *PE, and
+   return the coding system.  */
+static Lisp_Object
+extract_buffer_region (Lisp_Object object, Lisp_Object start, Lisp_Object end,
+		       Lisp_Object coding_system, Lisp_Object noerror,
+		       EMACS_INT *pb, EMACS_INT *pe)
+{
+  EMACS_INT b = !NILP (start) ? fix_position (start) : BEGV;
+  EMACS_INT e = !NILP (end) ? fix_position (end) : ZV;
+  if (b > e)
+    {
+      EMACS_INT temp = b;
+      b = e;
+      e = temp;
+    }
+
+  if (!(BEGV <= b && e <= ZV))
+    args_out_of_range (start, end);
+
+  if (NILP (coding_system))
+    {
+      /* Decide the coding-system to encode the data with.
+	 See fileio.c:Fwrite-region */
+
+      if (!NILP (Vcoding_system_for_write))
+	coding_system = Vcoding_system_for_write;
+      else
+	{
+	  bool force_raw_text = false;
+
+	  coding_system = BVAR (XBUFFER (object), buffer_file_coding_system);
+	  if (NILP (coding_system)
+	      || NILP (Flocal_variable_p (Qbuffer_file_coding_system, Qnil)))
+	    {
+	      coding_system = Qnil;
+	      if (NILP (BVAR (current_buffer, enable_multibyte_characters)))
+		force_raw_text = true;
+	    }
+
+	  if (NILP (coding_system) && !NILP (Fbuffer_file_name (object)))
+	    {
+	      /* Check file-coding-system-alist.  */
+	      Lisp_Object val = CALLN (Ffind_operation_coding_system,
+				       Qwrite_region,
+				       make_fixnum (b), make_fixnum (e),
+				       Fbuffer_file_name (object));
+	      if (CONSP (val) && !NILP (XCDR (val)))
+		coding_system = XCDR (val);
+	    }
+
+	  if (NILP (coding_system)
+	      && !NILP (BVAR (XBUFFER (object), buffer_file_coding_system)))
+	    {
+	      /* If we still have not decided a coding system, use the
+		 default value of buffer-file-coding-system.  */
+	      coding_system = BVAR (XBUFFER (object), buffer_file_coding_system);
+	    }
+
+	  if (!force_raw_text
+	      && !NILP (Ffboundp (Vselect_safe_coding_system_function)))
+	    /* Confirm that VAL can surely encode the current region.  */
+	    coding_system = call4 (Vselect_safe_coding_system_function,
+				   make_fixnum (b), make_fixnum (e),
+				   coding_system, Qnil);
+
+	  if (force_raw_text)
+	    coding_system = Qraw_text;
+	}
+
+      if (NILP (Fcoding_system_p (coding_system)))
+	{
+	  /* Invalid coding system.  */
+
+	  if (!NILP (noerror))
+	    coding_system = Qraw_text;
+	  else
+	    xsignal1 (Qcoding_system_error, coding_system);
+	}
+    }
+
+  *pb = b;
+  *pe = e;
+  return coding_system;
+}
+
 /* Extract data from a string or a buffer. SPEC is a list of
 (BUFFER-OR-STRING-OR-SYMBOL START END CODING-SYSTEM NOERROR) which behave as
 specified with `secure-hash' and in Info node
@@ -5404,78 +5588,8 @@ extract_data_from_object (Lisp_Object spec,
       struct buffer *bp = XBUFFER (object);
       set_buffer_internal (bp);
 
-      b = !NILP (start) ? fix_position (start) : BEGV;
-      e = !NILP (end) ? fix_position (end) : ZV;
-      if (b > e)
-	{
-	  EMACS_INT temp = b;
-	  b = e;
-	  e = temp;
-	}
-
-      if (!(BEGV <= b && e <= ZV))
-	args_out_of_range (start, end);
-
-      if (NILP (coding_system))
-	{
-	  /* Decide the coding-system to encode the data with.
-	     See fileio.c:Fwrite-region */
-
-	  if (!NILP (Vcoding_system_for_write))
-	    coding_system = Vcoding_system_for_write;
-	  else
-	    {
-	      bool force_raw_text = false;
-
-	      coding_system = BVAR (XBUFFER (object), buffer_file_coding_system);
-	      if (NILP (coding_system)
-		  || NILP (Flocal_variable_p (Qbuffer_file_coding_system, Qnil)))
-		{
-		  coding_system = Qnil;
-		  if (NILP (BVAR (current_buffer, enable_multibyte_characters)))
-		    force_raw_text = true;
-		}
-
-	      if (NILP (coding_system) && !NILP (Fbuffer_file_name (object)))
-		{
-		  /* Check file-coding-system-alist.  */
-		  Lisp_Object val = CALLN (Ffind_operation_coding_system,
-					   Qwrite_region,
-					   make_fixnum (b), make_fixnum (e),
-					   Fbuffer_file_name (object));
-		  if (CONSP (val) && !NILP (XCDR (val)))
-		    coding_system = XCDR (val);
-		}
-
-	      if (NILP (coding_system)
-		  && !NILP (BVAR (XBUFFER (object), buffer_file_coding_system)))
-		{
-		  /* If we still have not decided a coding system, use the
-		     default value of buffer-file-coding-system.  */
-		  coding_system = BVAR (XBUFFER (object), buffer_file_coding_system);
-		}
-
-	      if (!force_raw_text
-		  && !NILP (Ffboundp (Vselect_safe_coding_system_function)))
-		/* Confirm that VAL can surely encode the current region.  */
-		coding_system = call4 (Vselect_safe_coding_system_function,
-				       make_fixnum (b), make_fixnum (e),
-				       coding_system, Qnil);
-
-	      if (force_raw_text)
-		coding_system = Qraw_text;
-	    }
-
-	  if (NILP (Fcoding_system_p (coding_system)))
-	    {
-	      /* Invalid coding system.  */
-
-	      if (!NILP (noerror))
-		coding_system = Qraw_text;
-	      else
-		xsignal1 (Qcoding_system_error, coding_system);
-	    }
-	}
+      coding_system = extract_buffer_region (object, start, end,
+					     coding_system, noerror, &b, &e);
 
       object = make_buffer_string (b, e, false);
       set_buffer_internal (prev);
@@ -5521,67 +5635,223 @@ extract_data_from_object (Lisp_Object spec,
 }
 
 
-/* ALGORITHM is a symbol: md5, sha1, sha224 and so on. */
+/* The state of a hash computation by secure_hash.  */
 
-static Lisp_Object
-secure_hash (Lisp_Object algorithm, Lisp_Object object, Lisp_Object start,
-	     Lisp_Object end, Lisp_Object coding_system, Lisp_Object noerror,
-	     Lisp_Object binary)
+struct secure_hash_ctx
 {
-  ptrdiff_t start_byte, end_byte;
-  int digest_size;
-  void *(*hash_func) (const char *, size_t, void *);
-  Lisp_Object digest;
-
-  CHECK_SYMBOL (algorithm);
-
-  Lisp_Object spec = list5 (object, start, end, coding_system, noerror);
-
-  const char *input = extract_data_from_object (spec, &start_byte, &end_byte);
+  /* The algorithm, a symbol: md5, sha1, sha224 and so on.  */
+  Lisp_Object algorithm;
+  union
+  {
+    struct md5_ctx md5;
+    struct sha1_ctx sha1;
+    struct sha256_ctx sha256;
+    struct sha512_ctx sha512;
+  } u;
+};
 
-  if (input == NULL)
-    error ("secure_hash: failed to extract data from object, aborting!");
+/* Start hashing with ALGORITHM into CTX.  Return the size of the
+   digest.  */
 
+static int
+secure_hash_init (struct secure_hash_ctx *ctx, Lisp_Object algorithm)
+{
+  ctx->algorithm = algorithm;
   if (EQ (algorithm, Qmd5))
     {
-      digest_size = MD5_DIGEST_SIZE;
-      hash_func	  = md5_buffer;
+      md5_init_ctx (&ctx->u.md5);
+      return MD5_DIGEST_SIZE;
     }
   else if (EQ (algorithm, Qsha1))
     {
-      digest_size = SHA1_DIGEST_SIZE;
-      hash_func	  = sha1_buffer;
+      sha1_init_ctx (&ctx->u.sha1);
+      return SHA1_DIGEST_SIZE;
     }
   else if (EQ (algorithm, Qsha224))
     {
-      digest_size = SHA224_DIGEST_SIZE;
-      hash_func	  = sha224_buffer;
+      sha224_init_ctx (&ctx->u.sha256);
+      return SHA224_DIGEST_SIZE;
     }
   else if (EQ (algorithm, Qsha256))
     {
-      digest_size = SHA256_DIGEST_SIZE;
-      hash_func	  = sha256_buffer;
+      sha256_init_ctx (&ctx->u.sha256);
+      return SHA256_DIGEST_SIZE;
     }
   else if (EQ (algorithm, Qsha384))
     {
-      digest_size = SHA384_DIGEST_SIZE;
-      hash_func	  = sha384_buffer;
+      sha384_init_ctx (&ctx->u.sha512);
+      return SHA384_DIGEST_SIZE;
     }
   else if (EQ (algorithm, Qsha512))
     {
-      digest_size = SHA512_DIGEST_SIZE;
-      hash_func	  = sha512_buffer;
+      sha512_init_ctx (&ctx->u.sha512);
+      return SHA512_DIGEST_SIZE;
     }
   else
     error ("Invalid algorithm arg: %s", SDATA (Fsymbol_name (algorithm)));
+}
+
+/* Hash the LEN bytes at BUFFER into CTX.  */
+
+static void
+secure_hash_process (struct secure_hash_ctx *ctx, const char *buffer,
+		     ptrdiff_t len)
+{
+  if (EQ (ctx->algorithm, Qmd5))
+    md5_process_bytes (buffer, len, &ctx->u.md5);
+  else if (EQ (ctx->algorithm, Qsha1))
+    sha1_process_bytes (buffer, len, &ctx->u.sha1);
+  else if (EQ (ctx->algorithm, Qsha224) || EQ (ctx->algorithm, Qsha256))
+    sha256_process_bytes (buffer, len, &ctx->u.sha256);
+  else
+    sha512_process_bytes (buffer, len, &ctx->u.sha512);
+}
+
+/* Finish hashing into CTX, and store the digest into DIGEST.  */
+
+static void
+secure_hash_finish (struct secure_hash_ctx *ctx, char *digest)
+{
+  if (EQ (ctx->algorithm, Qmd5))
+    md5_finish_ctx (&ctx->u.md5, digest);
+  else if (EQ (ctx->algorithm, Qsha1))
+    sha1_finish_ctx (&ctx->u.sha1, digest);
+  else if (EQ (ctx->algorithm, Qsha224))
+    sha224_finish_ctx (&ctx->u.sha256, digest);
+  else if (EQ (ctx->algorithm, Qsha256))
+    sha256_finish_ctx (&ctx->u.sha256, digest);
+  else if (EQ (ctx->algorithm, Qsha384))
+    sha384_finish_ctx (&ctx->u.sha512, digest);
+  else
+    sha512_finish_ctx (&ctx->u.sha512, digest);
+}
+
+/* Maximum number of characters that secure_hash_buffer encodes at a
+   time.  */
+
+enum { SECURE_HASH_ENCODE_MAX = 64 * 1024 };
+
+static void
+free_coding_destination (void *coding)
+{
+  xfree (((struct coding_system *) coding)->destination);
+}
+
+/* Hash into CTX the text of the buffer OBJECT between START and END,
+   encoded as described for extract_data_from_object.  Unlike that
+   function, don't copy the text: hash it in place on both sides of
+   the gap, or encode it a chunk at a time.  */
+
+static void
+secure_hash_buffer (struct secure_hash_ctx *ctx, Lisp_Object object,
+		    Lisp_Object start, Lisp_Object end,
+		    Lisp_Object coding_system, Lisp_Object noerror)
+{
+  ptrdiff_t count = SPECPDL_INDEX ();
+  struct coding_system coding;
+  EMACS_INT b, e;
+
+  record_unwind_current_buffer ();
+  set_buffer_internal (XBUFFER (object));
+
+  coding_system = extract_buffer_region (object, start, end,
+					 coding_system, noerror, &b, &e);
+  bool multibyte = !NILP (BVAR (current_buffer, enable_multibyte_characters));
+  if (multibyte)
+    setup_coding_system (coding_system, &coding);
+
+  /* The text, in a part before the gap and one after it.  */
+  ptrdiff_t b_byte = CHAR_TO_BYTE (b), e_byte = CHAR_TO_BYTE (e);
+  ptrdiff_t gap_byte = clip_to_bounds (b_byte, GPT_BYTE, e_byte);
+  char const *part[2] = { (char *) BYTE_POS_ADDR (b_byte),
+			  (char *) BYTE_POS_ADDR (gap_byte) };
+  ptrdiff_t part_bytes[2] = { gap_byte - b_byte, e_byte - gap_byte };
+
+  /* Text that extract_data_from_object would not encode, or that
+     code_convert_string would find needs no encoding, is hashed as
+     is.  */
+  if (!multibyte
+      || (e - b == e_byte - b_byte
+	  && !NILP (CODING_ATTR_ASCII_COMPAT (CODING_ID_ATTRS (coding.id)))
+	  && (EQ (CODING_ID_EOL_TYPE (coding.id), Qunix)
+	      || inhibit_eol_conversion
+	      || !(memchr (part[0], '\n', part_bytes[0])
+		   || memchr (part[1], '\n', part_bytes[1])))))
+    {
+      secure_hash_process (ctx, part[0], part_bytes[0]);
+      secure_hash_process (ctx, part[1], part_bytes[1]);
+      if (multibyte)
+	Vlast_coding_system_used = coding_system;
+    }
+  else
+    {
+      ptrdiff_t chunk = SECURE_HASH_ENCODE_MAX;
+
+      /* A pre-write conversion must see the whole text at once.  */
+      if (!NILP (CODING_ATTR_PRE_WRITE (CODING_ID_ATTRS (coding.id))))
+	chunk = max (1, e - b);
+      coding.dst_bytes = max (1, min (chunk, e - b));
+      coding.destination = xmalloc (coding.dst_bytes);
+      record_unwind_protect_ptr (free_coding_destination, &coding);
+
+      /* As in e_write, the coding context carries the state of the
+	 encoder from one chunk to the next, and only the last chunk
+	 is flushed.  Empty text is encoded too, as it might need a
+	 BOM.  */
+      ptrdiff_t pos = b;
+      do
+	{
+	  ptrdiff_t next = pos + min (e - pos, chunk);
+	  if (next == e)
+	    coding.mode |= CODING_MODE_LAST_BLOCK;
+	  encode_coding_object (&coding, object, pos, CHAR_TO_BYTE (pos),
+				next, CHAR_TO_BYTE (next), Qnil);
+	  secure_hash_process (ctx, (char *) coding.destination,
+			       coding.produced);
+	  pos = next;
+	}
+      while (pos < e);
+      Vlast_coding_system_used = CODING_ID_NAME (coding.id);
+    }
+
+  unbind_to (count, Qnil);
+}
+
+/* ALGORITHM is a symbol: md5, sha1, sha224 and so on. */
+
+static Lisp_Object
+secure_hash (Lisp_Object algorithm, Lisp_Object object, Lisp_Object start,
+	     Lisp_Object end, Lisp_Object coding_system, Lisp_Object noerror,
+	     Lisp_Object binary)
+{
+  struct secure_hash_ctx ctx;
+  int digest_size;
+  Lisp_Object digest;
+
+  CHECK_SYMBOL (algorithm);
+
+  digest_size = secure_hash_init (&ctx, algorithm);
+
+  if (BUFFERP (object))
+    secure_hash_buffer (&ctx, object, start, end, coding_system, noerror);
+  else
+    {
+      ptrdiff_t start_byte, end_byte;
+      Lisp_Object spec = list5 (object, start, end, coding_system, noerror);
+      const char *input = extract_data_from_object (spec, &start_byte,
+						    &end_byte);
+
+      if (input == NULL)
+	error ("secure_hash: failed to extract data from object, aborting!");
+
+      secure_hash_process (&ctx, input + start_byte, end_byte - start_byte);
+    }
 
   /* allocate 2 x digest_size so that it can be re-used to hold the
      hexified value */
   digest = make_uninit_string (digest_size * 2);
 
-  hash_func (input + start_byte,
-	     end_byte - start_byte,
-	     SSDATA (digest));
+  secure_hash_finish (&ctx, SSDATA (digest));
 
   if (NILP (binary))
     return make_digest_string (digest, digest_size);
@@ -5650,6 +5920,27 @@ DEFUN ("secure-hash", Fsecure_hash, Ssecure_hash, 2, 5, 0,
   return secure_hash (algorithm, object, start, end, Qnil, Qnil, binary);
 }
 
+/* Number of bytes of buffer text after which buffer-hash remembers
+   the state of the hash, so that it can start there again when only
+   later text changes.  A multiple of the SHA-1 block size.  */
+
+enum { BUFFER_HASH_BLOCK = 64 * 1024 };
+
+/* What buffer-hash remembers about the text of a buffer.  */
+
+struct buffer_hash_cache
+{
+  /* The length of the text, and its digest.  */
+  ptrdiff_t nbytes;
+  char digest[SHA1_DIGEST_SIZE];
+
+  /* CTX[I] is the state of the hash after the first I *
+     BUFFER_HASH_BLOCK bytes of the text, for I below NSTATES.  CTX
+     has room for SIZE states.  */
+  ptrdiff_t nstates, size;
+  struct sha1_ctx ctx[FLEXIBLE_ARRAY_MEMBER];
+};
+
 DEFUN ("buffer-hash", Fbuffer_hash, Sbuffer_hash, 0, 1, 0,
        doc: /* Return a hash of the contents of BUFFER-OR-NAME.
 This hash is performed on the raw internal format of the buffer,
@@ -5659,6 +5950,9 @@ DEFUN ("buffer-hash", Fbuffer_hash, Sbuffer_hash, 0, 1, 0,
 Emacs, but is not guaranteed to return the same hash between different
 Emacs versions.  It should be somewhat more efficient on larger
 buffers than `secure-hash' is, and should not allocate more memory.
+It remembers the state of the hash at intervals of the text, so
+calling it again after changes near the end of a large buffer only
+hashes the text from the first change on.
 
 It should not be used for anything security-related.  See
 `secure-hash' for these applications.  */ )
@@ -5666,6 +5960,7 @@ DEFUN ("buffer-hash", Fbuffer_hash, Sbuffer_hash, 0, 1, 0,
 {
   Lisp_Object buffer;
   struct buffer *b;
+  struct buffer_hash_cache *cache;
   struct sha1_ctx ctx;
 
   if (NILP (buffer_or_name))
@@ -5676,22 +5971,75 @@ DEFUN ("buffer-hash", Fbuffer_hash, Sbuffer_hash, 0, 1, 0,
     nsberror (buffer_or_name);
 
   b = XBUFFER (buffer);
-  sha1_init_ctx (&ctx);
+  cache = b->text->hash_cache;
+  ptrdiff_t nbytes = BUF_Z_BYTE (b) - BUF_BEG_BYTE (b);
 
-  /* Process the first part of the buffer. */
-  sha1_process_bytes (BUF_BEG_ADDR (b),
-		      BUF_GPT_BYTE (b) - BUF_BEG_BYTE (b),
-		      &ctx);
+  /* Find how many of the states in the cache are still valid: those
+     that hashed only bytes that have not changed since.  */
+  ptrdiff_t nvalid = 0;
+  if (cache)
+    {
+      ptrdiff_t unchanged = min (b->text->hash_unchanged,
+				 BUF_Z (b) - BUF_BEG (b));
+      ptrdiff_t unchanged_bytes
+	= buf_charpos_to_bytepos (b, BUF_BEG (b) + unchanged) - BUF_BEG_BYTE (b);
+      if (unchanged_bytes == nbytes && nbytes == cache->nbytes)
+	{
+	  Lisp_Object digest = make_uninit_string (SHA1_DIGEST_SIZE * 2);
+	  memcpy (SSDATA (digest), cache->digest, SHA1_DIGEST_SIZE);
+	  return make_digest_string (digest, SHA1_DIGEST_SIZE);
+	}
+      nvalid = min (cache->nstates, unchanged_bytes / BUFFER_HASH_BLOCK + 1);
+    }
 
-  /* If the gap is before the end of the buffer, process the last half
-     of the buffer. */
-  if (BUF_GPT_BYTE (b) < BUF_Z_BYTE (b))
-    sha1_process_bytes (BUF_GAP_END_ADDR (b),
-			BUF_Z_ADDR (b) - BUF_GAP_END_ADDR (b),
-			&ctx);
+  ptrdiff_t nstates = nbytes / BUFFER_HASH_BLOCK + 1;
+  if (!cache || cache->size < nstates)
+    {
+      ptrdiff_t size = cache ? cache->size : 0;
+      if (PTRDIFF_MAX / 2 - size < nstates)
+	memory_full (SIZE_MAX);
+      size = max (nstates, 2 * size);
+      cache = xrealloc (cache, FLEXSIZEOF (struct buffer_hash_cache, ctx,
+					   size * sizeof *cache->ctx));
+      cache->size = size;
+      b->text->hash_cache = cache;
+    }
+
+  if (nvalid == 0)
+    {
+      sha1_init_ctx (&cache->ctx[0]);
+      nvalid = 1;
+    }
+  ctx = cache->ctx[nvalid - 1];
+
+  /* Hash the rest of the text a block at a time, from one side of the
+     gap or the other or both, remembering the state after each
+     block.  */
+  ptrdiff_t gpt = BUF_GPT_BYTE (b) - BUF_BEG_BYTE (b);
+  for (ptrdiff_t from = (nvalid - 1) * BUFFER_HASH_BLOCK; from < nbytes; )
+    {
+      ptrdiff_t to = min (from + BUFFER_HASH_BLOCK, nbytes);
+      if (from < gpt)
+	sha1_process_bytes (BUF_BEG_ADDR (b) + from, min (to, gpt) - from,
+			    &ctx);
+      if (gpt < to)
+	{
+	  ptrdiff_t after = max (from, gpt);
+	  sha1_process_bytes (BUF_GAP_END_ADDR (b) + (after - gpt),
+			      to - after, &ctx);
+	}
+      from = to;
+      if (from % BUFFER_HASH_BLOCK == 0)
+	cache->ctx[from / BUFFER_HASH_BLOCK] = ctx;
+    }
+
+  cache->nstates = nstates;
+  cache->nbytes = nbytes;
+  sha1_finish_ctx (&ctx, cache->digest);
+  b->text->hash_unchanged = BUF_Z (b) - BUF_BEG (b);
 
   Lisp_Object digest = make_uninit_string (SHA1_DIGEST_SIZE * 2);
-  sha1_finish_ctx (&ctx, SSDATA (digest));
+  memcpy (SSDATA (digest), cache->digest, SHA1_DIGEST_SIZE);
   return make_digest_string (digest, SHA1_DIGEST_SIZE);
 }
 
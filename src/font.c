@@ -246,6 +246,7 @@ font_build_object (int vectorsize, Lisp_Object type,
 static Lisp_Object font_matching_entity (struct frame *, Lisp_Object *,
                                          Lisp_Object);
 static unsigned font_encode_char (Lisp_Object, int);
+static void shaping_cache_clear (void);
 
 /* Number of registered font drivers.  */
 static int num_font_drivers;
@@ -4559,6 +4560,7 @@ DEFUN ("clear-font-cache", Fclear_font_cache, Sclear_font_cache, 0, 0, 0,
 
   FOR_EACH_FRAME (list, frame)
     clear_font_cache (XFRAME (frame));
+  shaping_cache_clear ();
 
   return Qnil;
 }
@@ -4579,6 +4581,218 @@ font_fill_lglyph_metrics (Lisp_Object glyph, struct font *font, unsigned int cod
 }
 
 
+/* Cache of shaping results.
+
+   Shaping the same run of characters with the same font always gives
+   the same glyphs, but the glyph-strings cached by composite.c are
+   discarded whenever their font object is closed, and they don't
+   record the direction in which the text was shaped.  The shaping
+   cache remembers the glyphs produced by the font driver's shape
+   method for recently shaped runs, keyed by the font's name and size,
+   the font driver, the direction, the language, and a string of the
+   characters, so that a run need not be reshaped when it is displayed
+   again with another font object opened for the same font.
+
+   The cache is a hash table whose values are entries of the form
+   [KEY GLYPHS PREV NEXT BYTES], where GLYPHS is a vector of copies of
+   the shaped LGLYPHs, PREV and NEXT link the entries in order of
+   their last use, and BYTES estimates the memory used by the entry.
+   The least recently used entries are discarded when the total
+   exceeds `font-shaping-cache-size'.  */
+
+enum shaping_entry_indices
+  {
+    SHAPING_ENTRY_KEY, SHAPING_ENTRY_GLYPHS, SHAPING_ENTRY_PREV,
+    SHAPING_ENTRY_NEXT, SHAPING_ENTRY_BYTES,
+    /* Not an index.  */
+    SHAPING_ENTRY_SIZE
+  };
+
+static Lisp_Object shaping_cache;
+static Lisp_Object shaping_cache_first, shaping_cache_last;
+static intmax_t shaping_cache_bytes, shaping_cache_hits, shaping_cache_misses;
+
+/* Return the approximate number of bytes used by a vector of size N.  */
+
+static ptrdiff_t
+shaping_vector_bytes (ptrdiff_t n)
+{
+  return header_size + n * word_size;
+}
+
+/* Return the shaping cache key for shaping GSTRING in DIRECTION.
+   The characters are put into a string rather than into the key
+   vector itself, since sxhash_vector only looks at the first few
+   elements of a vector, whereas strings are hashed in full.  */
+
+static Lisp_Object
+shaping_cache_key (Lisp_Object gstring, Lisp_Object direction)
+{
+  Lisp_Object font_object = LGSTRING_FONT (gstring);
+  struct font *font = XFONT_OBJECT (font_object);
+  Lisp_Object name = AREF (font_object, FONT_NAME_INDEX);
+  ptrdiff_t nchars = LGSTRING_CHAR_LEN (gstring);
+  unsigned char *buf, *p;
+  USE_SAFE_ALLOCA;
+
+  /* Shapers ignore DIRECTION if the buffer isn't reordered.  */
+  if (NILP (BVAR (current_buffer, bidi_display_reordering)))
+    direction = Qnil;
+
+  SAFE_NALLOCA (buf, MAX_MULTIBYTE_LENGTH, nchars);
+  p = buf;
+  for (ptrdiff_t i = 0; i < nchars; i++)
+    p += CHAR_STRING (XFIXNAT (LGSTRING_CHAR (gstring, i)), p);
+  Lisp_Object chars = make_multibyte_string ((char *) buf, nchars, p - buf);
+  SAFE_FREE ();
+
+  return CALLN (Fvector, STRINGP (name) ? name : font_object,
+		font->driver->type, make_fixnum (font->pixel_size),
+		direction, Vcurrent_iso639_language, chars);
+}
+
+/* Remove ENTRY from the list of shaping cache entries.  */
+
+static void
+shaping_cache_unlink (Lisp_Object entry)
+{
+  Lisp_Object prev = AREF (entry, SHAPING_ENTRY_PREV);
+  Lisp_Object next = AREF (entry, SHAPING_ENTRY_NEXT);
+
+  if (NILP (prev))
+    shaping_cache_first = next;
+  else
+    ASET (prev, SHAPING_ENTRY_NEXT, next);
+  if (NILP (next))
+    shaping_cache_last = prev;
+  else
+    ASET (next, SHAPING_ENTRY_PREV, prev);
+}
+
+/* Make ENTRY the most recently used shaping cache entry.  */
+
+static void
+shaping_cache_link_first (Lisp_Object entry)
+{
+  ASET (entry, SHAPING_ENTRY_PREV, Qnil);
+  ASET (entry, SHAPING_ENTRY_NEXT, shaping_cache_first);
+  if (NILP (shaping_cache_first))
+    shaping_cache_last = entry;
+  else
+    ASET (shaping_cache_first, SHAPING_ENTRY_PREV, entry);
+  shaping_cache_first = entry;
+}
+
+static void
+shaping_cache_clear (void)
+{
+  Fclrhash (shaping_cache);
+  shaping_cache_first = shaping_cache_last = Qnil;
+  shaping_cache_bytes = 0;
+}
+
+/* Return the vector of glyphs cached for KEY, or nil.  */
+
+static Lisp_Object
+shaping_cache_lookup (Lisp_Object key)
+{
+  struct Lisp_Hash_Table *h = XHASH_TABLE (shaping_cache);
+  ptrdiff_t i = hash_lookup (h, key, NULL);
+
+  if (i < 0)
+    {
+      shaping_cache_misses++;
+      return Qnil;
+    }
+
+  Lisp_Object entry = HASH_VALUE (h, i);
+  shaping_cache_hits++;
+  if (!EQ (entry, shaping_cache_first))
+    {
+      shaping_cache_unlink (entry);
+      shaping_cache_link_first (entry);
+    }
+  return AREF (entry, SHAPING_ENTRY_GLYPHS);
+}
+
+/* Remember the first LEN glyphs of GSTRING as the result of shaping
+   for KEY, and discard the least recently used entries if the cache
+   grows too large.  */
+
+static void
+shaping_cache_put (Lisp_Object key, Lisp_Object gstring, ptrdiff_t len)
+{
+  struct Lisp_Hash_Table *h = XHASH_TABLE (shaping_cache);
+  Lisp_Object hash;
+
+  if (font_shaping_cache_size <= 0
+      || hash_lookup (h, key, &hash) >= 0)
+    return;
+
+  Lisp_Object glyphs = make_nil_vector (len);
+  ptrdiff_t bytes = (shaping_vector_bytes (SHAPING_ENTRY_SIZE)
+		     + shaping_vector_bytes (ASIZE (key))
+		     + sizeof (struct Lisp_String)
+		     + SBYTES (AREF (key, ASIZE (key) - 1))
+		     + shaping_vector_bytes (len)
+		     + 4 * word_size);
+  for (ptrdiff_t i = 0; i < len; i++)
+    {
+      Lisp_Object g = Fcopy_sequence (LGSTRING_GLYPH (gstring, i));
+
+      ASET (glyphs, i, g);
+      bytes += shaping_vector_bytes (LGLYPH_SIZE);
+      if (VECTORP (LGLYPH_ADJUSTMENT (g)))
+	bytes += shaping_vector_bytes (ASIZE (LGLYPH_ADJUSTMENT (g)));
+    }
+
+  Lisp_Object entry = make_nil_vector (SHAPING_ENTRY_SIZE);
+  ASET (entry, SHAPING_ENTRY_KEY, key);
+  ASET (entry, SHAPING_ENTRY_GLYPHS, glyphs);
+  ASET (entry, SHAPING_ENTRY_BYTES, make_fixnum (bytes));
+  hash_put (h, key, entry, hash);
+  shaping_cache_link_first (entry);
+  shaping_cache_bytes += bytes;
+
+  while (shaping_cache_bytes > font_shaping_cache_size
+	 && !EQ (shaping_cache_last, entry))
+    {
+      Lisp_Object last = shaping_cache_last;
+
+      shaping_cache_unlink (last);
+      hash_remove_from_table (h, AREF (last, SHAPING_ENTRY_KEY));
+      shaping_cache_bytes -= XFIXNUM (AREF (last, SHAPING_ENTRY_BYTES));
+    }
+}
+
+DEFUN ("font-shaping-cache-statistics", Ffont_shaping_cache_statistics,
+       Sfont_shaping_cache_statistics, 0, 1, 0,
+       doc: /* Return statistics about the cache of font shaping results.
+The value is a property list with the following properties:
+
+  :entries  The number of shaped character sequences in the cache.
+  :bytes    The approximate memory used by the cache, in bytes.
+  :hits     How many times shaping was avoided by using the cache.
+  :misses   How many times text had to be shaped by a font driver.
+
+If CLEAR is non-nil, empty the cache and reset the counts of hits and
+misses after computing the value.  See also `font-shaping-cache-size'.  */)
+  (Lisp_Object clear)
+{
+  Lisp_Object value
+    = list (QCentries, make_fixnum (XHASH_TABLE (shaping_cache)->count),
+	    QCbytes, make_int (shaping_cache_bytes),
+	    QChits, make_int (shaping_cache_hits),
+	    QCmisses, make_int (shaping_cache_misses));
+
+  if (!NILP (clear))
+    {
+      shaping_cache_clear ();
+      shaping_cache_hits = shaping_cache_misses = 0;
+    }
+  return value;
+}
+
 DEFUN ("font-shape-gstring", Ffont_shape_gstring, Sfont_shape_gstring, 2, 2, 0,
        doc: /* Shape the glyph-string GSTRING subject to bidi DIRECTION.
 Shaping means substituting glyphs and/or adjusting positions of glyphs
@@ -4614,6 +4828,22 @@ DEFUN ("font-shape-gstring", Ffont_shape_gstring, Sfont_shape_gstring, 2, 2, 0,
   if (! font->driver->shape)
     return Qnil;
 
+  Lisp_Object key = shaping_cache_key (gstring, direction);
+  Lisp_Object glyphs = shaping_cache_lookup (key);
+  if (! NILP (glyphs))
+    {
+      ptrdiff_t len = ASIZE (glyphs);
+
+      if (LGSTRING_GLYPH_LEN (gstring) < len)
+	gstring = larger_vector (gstring,
+				 len - LGSTRING_GLYPH_LEN (gstring), -1);
+      for (i = 0; i < len; i++)
+	LGSTRING_SET_GLYPH (gstring, i, Fcopy_sequence (AREF (glyphs, i)));
+      if (len < LGSTRING_GLYPH_LEN (gstring))
+	LGSTRING_SET_GLYPH (gstring, len, Qnil);
+      return composition_gstring_put_cache (gstring, len);
+    }
+
   /* Try at most three times with larger gstring each time.  */
   for (i = 0; i < 3; i++)
     {
@@ -4660,6 +4890,7 @@ DEFUN ("font-shape-gstring", Ffont_shape_gstring, Sfont_shape_gstring, 2, 2, 0,
       from = LGLYPH_FROM (glyph);
       to = LGLYPH_TO (glyph);
     }
+  shaping_cache_put (key, gstring, XFIXNUM (n));
   return composition_gstring_put_cache (gstring, XFIXNUM (n));
 
  shaper_error:
@@ -5595,6 +5826,16 @@ syms_of_font (void)
 #endif	/* HAVE_LIBOTF */
 #endif	/* 0 */
 
+  staticpro (&shaping_cache);
+  shaping_cache = CALLN (Fmake_hash_table, QCtest, Qequal);
+  staticpro (&shaping_cache_first);
+  staticpro (&shaping_cache_last);
+  shaping_cache_first = shaping_cache_last = Qnil;
+  DEFSYM (QCentries, ":entries");
+  DEFSYM (QCbytes, ":bytes");
+  DEFSYM (QChits, ":hits");
+  DEFSYM (QCmisses, ":misses");
+
   defsubr (&Sfontp);
   defsubr (&Sfont_spec);
   defsubr (&Sfont_get);
@@ -5608,6 +5849,7 @@ syms_of_font (void)
   defsubr (&Sfont_xlfd_name);
   defsubr (&Sclear_font_cache);
   defsubr (&Sfont_shape_gstring);
+  defsubr (&Sfont_shaping_cache_statistics);
   defsubr (&Sfont_variation_glyphs);
   defsubr (&Sinternal_char_font);
 #if 0
@@ -5693,6 +5935,15 @@ syms_of_font (void)
 EMACS_FONT_LOG is set at startup, it defaults to nil.  */);
   Vfont_log = Qnil;
 
+  DEFVAR_INT ("font-shaping-cache-size", font_shaping_cache_size,
+	     doc: /* Maximum memory used for caching the results of font shaping.
+The value is an approximate size in bytes.  When the results of
+shaping character sequences with fonts use more memory than this, the
+least recently used results are discarded.  If the value is zero or
+negative, no shaping results are cached.  See also
+`font-shaping-cache-statistics'.  */);
+  font_shaping_cache_size = 1024 * 1024;
+
   DEFVAR_BOOL ("inhibit-compacting-font-caches", inhibit_compacting_font_caches,
 	       doc: /*
 If non-nil, don't compact font caches during GC.
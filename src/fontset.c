@@ -96,7 +96,7 @@ Copyright (C) 2003, 2006
    range of characters in this fontset, but may be available in the
    fallback font-group or in the default fontset.
 
-   A fontset has 8 extra slots.
+   A fontset has 9 extra slots.
 
    The 1st slot:
 	base: the ID number of the fontset
@@ -132,6 +132,12 @@ Copyright (C) 2003, 2006
 	base: Same as element value (but for fallback fonts).
 	realized: Likewise.
 
+   The 9th slot:
+	base: nil
+	realized: nil, or a vector caching the results of fontset_font
+		  for recently displayed characters.  See
+		  fontset_font_cached.
+
    All fontsets are recorded in the vector Vfontset_table.
 
 
@@ -250,6 +256,13 @@ set_fontset_fallback (Lisp_Object fontset, Lisp_Object fallback)
   set_char_table_extras (fontset, 7, fallback);
 }
 
+#define FONTSET_CHAR_CACHE(fontset) XCHAR_TABLE (fontset)->extras[8]
+static void
+set_fontset_char_cache (Lisp_Object fontset, Lisp_Object cache)
+{
+  set_char_table_extras (fontset, 8, cache);
+}
+
 #define BASE_FONTSET_P(fontset) (NILP (FONTSET_BASE (fontset)))
 
 /* Definitions for FONT-DEF and RFONT-DEF of fontset.  */
@@ -791,6 +804,7 @@ fontset_font (Lisp_Object fontset, int c, struct face *face, int id)
   if (! EQ (rfont_def, Qt))
     {
       FONT_DEFERRED_LOG ("current fallback: font for", make_fixnum (c), Qnil);
+      fontset_fallback_searches++;
       rfont_def = fontset_find_font (fontset, c, face, id, 1);
       if (VECTORP (rfont_def))
 	return rfont_def;
@@ -803,6 +817,7 @@ fontset_font (Lisp_Object fontset, int c, struct face *face, int id)
       && ! EQ (default_rfont_def, Qt))
     {
       FONT_DEFERRED_LOG ("default fallback: font for", make_fixnum (c), Qnil);
+      fontset_fallback_searches++;
       rfont_def = fontset_find_font (FONTSET_DEFAULT (fontset), c, face, id, 1);
       if (VECTORP (rfont_def))
 	return rfont_def;
@@ -813,6 +828,54 @@ fontset_font (Lisp_Object fontset, int c, struct face *face, int id)
   return Qnil;
 }
 
+/* Number of characters whose fonts are cached by each realized
+   fontset.  */
+#define FONTSET_CHAR_CACHE_SIZE 128
+
+/* Like fontset_font, but for characters not preferring any charset,
+   and remember the result in the cache of FONTSET.  Characters that
+   need no fallback font are found quickly in the font groups anyway,
+   but for the others, fontset_font has to search several font groups
+   each time.
+
+   The cache is a vector whose first element is the low bits of
+   charset_ordered_list_tick when the cache was filled, followed by
+   pairs of a character and the value of fontset_font for it.  It is
+   discarded with the realized fontset when faces or fontsets
+   change.  */
+
+static Lisp_Object
+fontset_font_cached (Lisp_Object fontset, int c, struct face *face)
+{
+  Lisp_Object cache = FONTSET_CHAR_CACHE (fontset);
+  Lisp_Object tick
+    = make_fixnum (charset_ordered_list_tick & MOST_POSITIVE_FIXNUM);
+  int i = 1 + 2 * (c % FONTSET_CHAR_CACHE_SIZE);
+  Lisp_Object rfont_def;
+
+  if (NILP (cache))
+    {
+      cache = make_nil_vector (1 + 2 * FONTSET_CHAR_CACHE_SIZE);
+      ASET (cache, 0, tick);
+      set_fontset_char_cache (fontset, cache);
+    }
+  else if (!EQ (AREF (cache, 0), tick))
+    {
+      /* The charset priorities changed, which affects the order in
+	 which fonts are tried.  */
+      for (int j = 1; j < ASIZE (cache); j++)
+	ASET (cache, j, Qnil);
+      ASET (cache, 0, tick);
+    }
+  else if (EQ (AREF (cache, i), make_fixnum (c)))
+    return AREF (cache, i + 1);
+
+  rfont_def = fontset_font (fontset, c, face, -1);
+  ASET (cache, i, make_fixnum (c));
+  ASET (cache, i + 1, rfont_def);
+  return rfont_def;
+}
+
 /* Return a newly created fontset with NAME.  If BASE is nil, make a
    base fontset.  Otherwise make a realized fontset whose base is
    BASE.  */
@@ -993,7 +1056,9 @@ face_for_char (struct frame *f, struct face *face, int c,
 	id = -1;
     }
 
-  rfont_def = fontset_font (fontset, c, face, id);
+  rfont_def = (id < 0
+	       ? fontset_font_cached (fontset, c, face)
+	       : fontset_font (fontset, c, face, id));
   if (VECTORP (rfont_def))
     {
       if (FIXNUMP (RFONT_DEF_FACE (rfont_def)))
@@ -1060,7 +1125,9 @@ font_for_char (struct face *face, int c, ptrdiff_t pos, Lisp_Object object)
 	id = -1;
     }
 
-  rfont_def = fontset_font (fontset, c, face, id);
+  rfont_def = (id < 0
+	       ? fontset_font_cached (fontset, c, face)
+	       : fontset_font (fontset, c, face, id));
   return (VECTORP (rfont_def)
 	  ? RFONT_DEF_OBJECT (rfont_def)
 	  : Qnil);
@@ -2115,7 +2182,7 @@ DEFUN ("fontset-list-all", Ffontset_list_all, Sfontset_list_all, 0, 0, 0,
 syms_of_fontset (void)
 {
   DEFSYM (Qfontset, "fontset");
-  Fput (Qfontset, Qchar_table_extra_slots, make_fixnum (8));
+  Fput (Qfontset, Qchar_table_extra_slots, make_fixnum (9));
   DEFSYM (Qfontset_info, "fontset-info");
   Fput (Qfontset_info, Qchar_table_extra_slots, make_fixnum (1));
 
@@ -2141,6 +2208,13 @@ syms_of_fontset (void)
   auto_fontset_alist = Qnil;
   staticpro (&auto_fontset_alist);
 
+  DEFVAR_INT ("fontset-fallback-searches", fontset_fallback_searches,
+	     doc: /* Number of times a fallback font for a character was searched.
+This counts the searches of the fallback font groups of fontsets, done
+when no font specified for a character by a fontset supports it.
+Each search can involve listing and opening fonts.  */);
+  fontset_fallback_searches = 0;
+
   DEFVAR_LISP ("font-encoding-charset-alist", Vfont_encoding_charset_alist,
 	       doc: /*
 Alist of charsets vs the charsets to determine the preferred font encoding.
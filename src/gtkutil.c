@@ -5109,6 +5109,8 @@ update_frame_tool_bar (struct frame *f)
           img_id = lookup_image (f, image, -1);
           img = IMAGE_FROM_ID (f, img_id);
           prepare_image_for_display (f, img);
+          if (img->load_pending_p)
+            image_wait_for_load (img);
 
           if (img->load_failed_p
 #ifdef USE_CAIRO
@@ -31,6 +31,7 @@ Copyright (C) 1989, 1992-2021 Free Software Foundation, Inc.
 #include <setjmp.h>
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <c-ctype.h>
 #include <flexmember.h>
 
@@ -46,6 +47,7 @@ Copyright (C) 1989, 1992-2021 Free Software Foundation, Inc.
 #include <epaths.h>
 #include "coding.h"
 #include "termhooks.h"
+#include "keyboard.h"
 #include "font.h"
 #include "pdumper.h"
 
@@ -135,6 +137,19 @@ #define PIX_MASK_DRAW	1
 # define COLOR_TABLE_SUPPORT 1
 #endif
 
+/* PNG and JPEG images can be decoded by worker threads; see
+   `image-load-asynchronously'.  */
+#if (defined THREADS_ENABLED && (defined HAVE_PNG || defined HAVE_JPEG) \
+     && !defined WINDOWSNT)
+# define USE_ASYNC_IMAGE_LOAD 1
+#endif
+
+#ifdef USE_ASYNC_IMAGE_LOAD
+static bool image_start_async_load (struct frame *, struct image *,
+				    int *, int *);
+static void image_cancel_load (struct image *);
+#endif
+
 static void image_disable_image (struct frame *, struct image *);
 static void image_edge_detection (struct frame *, struct image *, Lisp_Object,
                                   Lisp_Object);
@@ -1113,6 +1128,10 @@ DEFUN ("image-mask-p", Fimage_mask_p, Simage_mask_p, 1, 2, 0,
       struct frame *f = decode_window_system_frame (frame);
       ptrdiff_t id = lookup_image (f, spec, -1);
       struct image *img = IMAGE_FROM_ID (f, id);
+      /* Reload the pixels of IMG if they were evicted.  */
+      prepare_image_for_display (f, img);
+      if (img->load_pending_p)
+	image_wait_for_load (img);
       if (img->mask)
 	mask = Qt;
     }
@@ -1189,6 +1208,12 @@ free_image (struct frame *f, struct image *img)
 	img->next->prev = img->prev;
 
       c->images[img->id] = NULL;
+      c->bytes -= img->nbytes;
+
+#ifdef USE_ASYNC_IMAGE_LOAD
+      if (img->load_job)
+	image_cancel_load (img);
+#endif
 
 #if !defined USE_CAIRO && defined HAVE_XRENDER
       if (img->picture)
@@ -1204,35 +1229,50 @@ free_image (struct frame *f, struct image *img)
     }
 }
 
-/* Return true if the given widths and heights are valid for display.  */
+/* Store in *MAX_WIDTH and *MAX_HEIGHT the largest size of an image
+   to be displayed on frame F, according to `max-image-size'.  */
 
-static bool
-check_image_size (struct frame *f, int width, int height)
+static void
+image_size_limits (struct frame *f, int *max_width, int *max_height)
 {
-  int w, h;
-
-  if (width <= 0 || height <= 0)
-    return 0;
-
   if (FIXNUMP (Vmax_image_size))
-    return (width <= XFIXNUM (Vmax_image_size)
-	    && height <= XFIXNUM (Vmax_image_size));
+    *max_width = *max_height = clip_to_bounds (0, XFIXNUM (Vmax_image_size),
+					       INT_MAX);
   else if (FLOATP (Vmax_image_size))
     {
+      double w, h;
       if (f != NULL)
 	{
-	  w = FRAME_PIXEL_WIDTH (f);
-	  h = FRAME_PIXEL_HEIGHT (f);
+	  w = XFLOAT_DATA (Vmax_image_size) * FRAME_PIXEL_WIDTH (f);
+	  h = XFLOAT_DATA (Vmax_image_size) * FRAME_PIXEL_HEIGHT (f);
 	}
       else
-	w = h = 1024;  /* Arbitrary size for unknown frame. */
-      return (width <= XFLOAT_DATA (Vmax_image_size) * w
-	      && height <= XFLOAT_DATA (Vmax_image_size) * h);
+	/* Arbitrary size for unknown frame. */
+	w = h = XFLOAT_DATA (Vmax_image_size) * 1024;
+      *max_width = ! (w >= 0) ? 0 : w < INT_MAX ? w : INT_MAX;
+      *max_height = ! (h >= 0) ? 0 : h < INT_MAX ? h : INT_MAX;
     }
   else
-    return 1;
+    *max_width = *max_height = INT_MAX;
+}
+
+/* Return true if the given widths and heights are valid for display.  */
+
+static bool
+check_image_size (struct frame *f, int width, int height)
+{
+  int max_width, max_height;
+
+  if (width <= 0 || height <= 0)
+    return 0;
+
+  image_size_limits (f, &max_width, &max_height);
+  return width <= max_width && height <= max_height;
 }
 
+static void postprocess_loaded_image (struct frame *, struct image *);
+static void image_cache_count_bytes (struct image_cache *, struct image *);
+
 /* Prepare image IMG for display on frame F.  Must be called before
    drawing an image.  */
 
@@ -1242,10 +1282,27 @@ prepare_image_for_display (struct frame *f, struct image *img)
   /* We're about to display IMG, so set its timestamp to `now'.  */
   img->timestamp = current_timespec ();
 
+  /* Until an asynchronously loaded image has its pixels, it is
+     drawn as an empty box.  */
+  if (img->load_pending_p)
+    return;
+
   /* If IMG doesn't have a pixmap yet, load it now, using the image
-     type dependent loader function.  */
+     type dependent loader function.  This also reloads images whose
+     pixels were evicted by limit_image_cache.  */
   if (img->pixmap == NO_PIXMAP && !img->load_failed_p)
-    img->load_failed_p = ! img->type->load_img (f, img);
+    {
+#ifdef USE_ASYNC_IMAGE_LOAD
+      int width, height;
+      if (image_start_async_load (f, img, &width, &height))
+	return;
+#endif
+      block_input ();
+      img->load_failed_p = ! img->type->load_img (f, img);
+      if (!img->load_failed_p)
+	postprocess_loaded_image (f, img);
+      unblock_input ();
+    }
 
 #ifdef USE_CAIRO
   if (!img->load_failed_p)
@@ -1275,6 +1332,8 @@ prepare_image_for_display (struct frame *f, struct image *img)
       unblock_input ();
     }
 #endif
+
+  image_cache_count_bytes (FRAME_IMAGE_CACHE (f), img);
 }
 
 
@@ -1588,6 +1647,8 @@ make_image_cache (void)
 
   c->size = 50;
   c->used = c->refcount = 0;
+  c->bytes = c->peak_bytes = 0;
+  c->evictions = 0;
   c->images = xmalloc (c->size * sizeof *c->images);
   c->buckets = xzalloc (IMAGE_CACHE_BUCKETS_SIZE * sizeof *c->buckets);
   return c;
@@ -1839,6 +1900,178 @@ image_size_in_bytes (struct image *img)
   return size;
 }
 
+/* Update the number of bytes of pixel data of image IMG, and of its
+   image cache C, after IMG has been loaded or its pixels freed.  */
+
+static void
+image_cache_count_bytes (struct image_cache *c, struct image *img)
+{
+  if (c)
+    {
+      c->bytes -= img->nbytes;
+      img->nbytes = image_size_in_bytes (img);
+      c->bytes += img->nbytes;
+      c->peak_bytes = max (c->peak_bytes, c->bytes);
+    }
+}
+
+/* Free the pixels of image IMG on frame F, but keep the rest of IMG,
+   including its size and specification, so that it can still be
+   laid out; prepare_image_for_display loads the pixels again when
+   redisplay next produces a glyph for IMG.  Unlike the free_img
+   function of IMG's type, this keeps IMG's Lisp data, since it
+   describes the image itself rather than its pixels.  */
+
+static void
+evict_image_pixels (struct frame *f, struct image *img)
+{
+#if !defined USE_CAIRO && defined HAVE_XRENDER
+  if (img->picture)
+    {
+      XRenderFreePicture (FRAME_X_DISPLAY (f), img->picture);
+      img->picture = 0;
+    }
+  if (img->mask_picture)
+    {
+      XRenderFreePicture (FRAME_X_DISPLAY (f), img->mask_picture);
+      img->mask_picture = 0;
+    }
+#endif
+
+  image_clear_image (f, img);
+  image_cache_count_bytes (FRAME_IMAGE_CACHE (f), img);
+}
+
+/* Compare the timestamps of images *A and *B, for qsort.  */
+
+static int
+compare_image_timestamps (const void *a, const void *b)
+{
+  struct image *img1 = *(struct image *const *) a;
+  struct image *img2 = *(struct image *const *) b;
+  return timespec_cmp (img1->timestamp, img2->timestamp);
+}
+
+/* Set DISPLAYED[ID] for the id ID of each image in the current glyph
+   matrices of WINDOW, its siblings following it, and their subwindows.
+   NIMAGES is the number of elements of DISPLAYED.  */
+
+static void
+image_mark_displayed (Lisp_Object window, bool *displayed,
+		      ptrdiff_t nimages)
+{
+  while (WINDOWP (window))
+    {
+      struct window *w = XWINDOW (window);
+
+      if (WINDOWP (w->contents))
+	image_mark_displayed (w->contents, displayed, nimages);
+      else if (w->current_matrix)
+	{
+	  struct glyph_matrix *matrix = w->current_matrix;
+
+	  for (int i = 0; i < matrix->nrows; ++i)
+	    {
+	      struct glyph_row *row = matrix->rows + i;
+
+	      for (int area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
+		{
+		  struct glyph *glyph = row->glyphs[area];
+		  struct glyph *end = glyph + row->used[area];
+
+		  for (; glyph < end; ++glyph)
+		    if (glyph->type == IMAGE_GLYPH
+			&& 0 <= glyph->u.img_id && glyph->u.img_id < nimages)
+		      displayed[glyph->u.img_id] = true;
+		}
+	    }
+	}
+
+      window = w->next;
+    }
+}
+
+/* If the pixels of the images in the image cache of frame F take more
+   than `image-cache-size-limit' bytes, free the pixels of the least
+   recently displayed images until they don't.
+
+   Images shown in the current glyph matrix of any window using the
+   cache are never evicted, because they may have to be drawn again
+   when a frame is exposed, and drawing must not load images.  The
+   most recently displayed image is never evicted either, so that an
+   image larger than the limit is not loaded anew each time it is
+   displayed.  PostScript images are never evicted, because they are
+   rendered asynchronously by Ghostscript.  */
+
+static void
+limit_image_cache (struct frame *f)
+{
+  struct image_cache *c = FRAME_IMAGE_CACHE (f);
+
+  if (!c || f->inhibit_clear_image_cache
+      || !FIXNATP (Vimage_cache_size_limit)
+      || c->bytes <= XFIXNAT (Vimage_cache_size_limit))
+    return;
+
+  size_t limit = XFIXNAT (Vimage_cache_size_limit);
+  struct image **images;
+  bool *displayed;
+  ptrdiff_t i, nimages = 0;
+  Lisp_Object tail, frame;
+  USE_SAFE_ALLOCA;
+  SAFE_NALLOCA (images, 1, c->used);
+  SAFE_NALLOCA (displayed, 1, c->used);
+  memset (displayed, 0, c->used * sizeof *displayed);
+
+  FOR_EACH_FRAME (tail, frame)
+    {
+      struct frame *f1 = XFRAME (frame);
+
+      if (FRAME_WINDOW_P (f1) && FRAME_IMAGE_CACHE (f1) == c)
+	{
+	  /* The minibuffer window follows the root window.  */
+	  image_mark_displayed (FRAME_ROOT_WINDOW (f1), displayed, c->used);
+	  image_mark_displayed (f1->tab_bar_window, displayed, c->used);
+#ifndef HAVE_EXT_TOOL_BAR
+	  image_mark_displayed (f1->tool_bar_window, displayed, c->used);
+#endif
+	}
+    }
+
+  for (i = 0; i < c->used; ++i)
+    {
+      struct image *img = c->images[i];
+      if (img && img->nbytes && !displayed[i]
+	  && !EQ (builtin_lisp_symbol (img->type->type), Qpostscript))
+	images[nimages++] = img;
+    }
+  qsort (images, nimages, sizeof *images, compare_image_timestamps);
+
+  block_input ();
+  for (i = 0; i < nimages - 1 && limit < c->bytes; ++i)
+    {
+      evict_image_pixels (f, images[i]);
+      c->evictions++;
+    }
+  unblock_input ();
+
+  SAFE_FREE ();
+}
+
+/* Apply `image-cache-size-limit' to the image caches of all frames.
+   Called at the end of redisplay_internal.  */
+
+void
+limit_image_caches (void)
+{
+  Lisp_Object tail, frame;
+
+  if (FIXNATP (Vimage_cache_size_limit))
+    FOR_EACH_FRAME (tail, frame)
+      if (FRAME_WINDOW_P (XFRAME (frame)))
+	limit_image_cache (XFRAME (frame));
+}
+
 static size_t
 image_frame_cache_size (struct frame *f)
 {
@@ -1869,6 +2102,66 @@ DEFUN ("image-cache-size", Fimage_cache_size, Simage_cache_size, 0, 0, 0,
   return make_int (total);
 }
 
+DEFUN ("image-cache-statistics", Fimage_cache_statistics,
+       Simage_cache_statistics, 0, 1, 0,
+       doc: /* Return statistics about the image caches of all frames.
+The value is a property list with the following properties:
+
+  :images      The number of images in the caches.
+  :bytes       The number of bytes of pixel data of those images.
+  :peak-bytes  The largest value :bytes has had.
+  :evictions   How many times the pixels of an image were freed
+               because of `image-cache-size-limit'.
+
+Frames on the same display share their image cache; it is counted only
+once.  If CLEAR is non-nil, reset the value of :peak-bytes to that of
+:bytes, and the number of evictions to zero, after computing the
+value.  */)
+  (Lisp_Object clear)
+{
+  Lisp_Object tail, frame;
+  ptrdiff_t nimages = 0;
+  size_t bytes = 0, peak_bytes = 0;
+  intmax_t evictions = 0;
+
+  FOR_EACH_FRAME (tail, frame)
+    {
+      struct frame *f = XFRAME (frame);
+      struct image_cache *c;
+      Lisp_Object tail1, frame1;
+
+      if (!FRAME_WINDOW_P (f) || !(c = FRAME_IMAGE_CACHE (f)))
+	continue;
+
+      /* Skip caches already counted for an earlier frame.  */
+      FOR_EACH_FRAME (tail1, frame1)
+	if (EQ (frame1, frame)
+	    || (FRAME_WINDOW_P (XFRAME (frame1))
+		&& FRAME_IMAGE_CACHE (XFRAME (frame1)) == c))
+	  break;
+      if (!EQ (frame1, frame))
+	continue;
+
+      for (ptrdiff_t i = 0; i < c->used; ++i)
+	if (c->images[i])
+	  nimages++;
+      bytes += c->bytes;
+      peak_bytes += c->peak_bytes;
+      evictions += c->evictions;
+
+      if (!NILP (clear))
+	{
+	  c->peak_bytes = c->bytes;
+	  c->evictions = 0;
+	}
+    }
+
+  return list (QCimages, make_int (nimages),
+	       QCbytes, make_uint (bytes),
+	       QCpeak_bytes, make_uint (peak_bytes),
+	       QCevictions, make_int (evictions));
+}
+
 
 DEFUN ("image-flush", Fimage_flush, Simage_flush,
        1, 2, 0,
@@ -2418,6 +2711,34 @@ image_set_transform (struct frame *f, struct image *img)
 
 #endif /* HAVE_IMAGEMAGICK || HAVE_NATIVE_TRANSFORMS */
 
+#ifdef USE_ASYNC_IMAGE_LOAD
+
+/* Give image IMG, whose pixels are being loaded asynchronously and
+   which has the native size WIDTH x HEIGHT, the size it will have
+   once it has been loaded and transformed according to its
+   specification.  */
+
+static void
+image_set_placeholder_size (struct image *img, int width, int height)
+{
+  img->width = width;
+  img->height = height;
+
+# ifdef HAVE_NATIVE_TRANSFORMS
+  double rotation = 0.0;
+  compute_image_size (width, height, img, &img->width, &img->height);
+  compute_image_rotation (img, &rotation);
+  if (rotation == 90 || rotation == 270)
+    {
+      int tem = img->width;
+      img->width = img->height;
+      img->height = tem;
+    }
+# endif
+}
+
+#endif /* USE_ASYNC_IMAGE_LOAD */
+
 /* Return the id of image with Lisp specification SPEC on frame F.
    SPEC must be a valid Lisp image specification (see valid_image_p).  */
 
@@ -2466,7 +2787,13 @@ lookup_image (struct frame *f, Lisp_Object spec, int face_id)
       img->face_font_size = font_size;
       img->face_font_family = xmalloc (strlen (font_family) + 1);
       strcpy (img->face_font_family, font_family);
-      img->load_failed_p = ! img->type->load_img (f, img);
+#ifdef USE_ASYNC_IMAGE_LOAD
+      int width, height;
+      if (image_start_async_load (f, img, &width, &height))
+	image_set_placeholder_size (img, width, height);
+      else
+#endif
+	img->load_failed_p = ! img->type->load_img (f, img);
 
       /* If we can't load the image, and we don't have a width and
 	 height, use some arbitrary width and height so that we can
@@ -2485,9 +2812,8 @@ lookup_image (struct frame *f, Lisp_Object spec, int face_id)
       else
 	{
 	  /* Handle image type independent image attributes
-	     `:ascent ASCENT', `:margin MARGIN', `:relief RELIEF',
-	     `:background COLOR'.  */
-	  Lisp_Object ascent, margin, relief, bg;
+	     `:ascent ASCENT', `:margin MARGIN', `:relief RELIEF'.  */
+	  Lisp_Object ascent, margin, relief;
 	  int relief_bound;
 
 	  ascent = image_spec_value (spec, QCascent, NULL);
@@ -2514,40 +2840,58 @@ lookup_image (struct frame *f, Lisp_Object spec, int face_id)
 	      img->vmargin += eabs (img->relief);
 	    }
 
-	  if (! img->background_valid)
-	    {
-	      bg = image_spec_value (img->spec, QCbackground, NULL);
-	      if (!NILP (bg))
-		{
-		  img->background
-		    = image_alloc_image_color (f, img, bg, background);
-		  img->background_valid = 1;
-		}
-	    }
-
-	  /* Do image transformations and compute masks, unless we
-	     don't have the image yet.  */
-	  if (!EQ (builtin_lisp_symbol (img->type->type), Qpostscript))
-	    postprocess_image (f, img);
-
-          /* postprocess_image above may modify the image or the mask,
-             relying on the image's real width and height, so
-             image_set_transform must be called after it.  */
-#ifdef HAVE_NATIVE_TRANSFORMS
-          image_set_transform (f, img);
-#endif
+	  if (!img->load_pending_p)
+	    postprocess_loaded_image (f, img);
 	}
 
+      image_cache_count_bytes (FRAME_IMAGE_CACHE (f), img);
       unblock_input ();
     }
 
   /* We're using IMG, so set its timestamp to `now'.  */
   img->timestamp = current_timespec ();
 
+  /* Images looked up outside of redisplay, for example to compute
+     their sizes, are not limited by redisplay_internal.  */
+  if (!redisplaying_p)
+    limit_image_cache (f);
+
   /* Value is the image id.  */
   return img->id;
 }
 
+/* Process the pixels of image IMG on frame F, which have just been
+   loaded, according to the image type independent attributes
+   `:background COLOR', `:conversion', `:mask' and the transformation
+   attributes of its specification.  */
+
+static void
+postprocess_loaded_image (struct frame *f, struct image *img)
+{
+  if (! img->background_valid)
+    {
+      Lisp_Object bg = image_spec_value (img->spec, QCbackground, NULL);
+      if (!NILP (bg))
+	{
+	  img->background
+	    = image_alloc_image_color (f, img, bg, img->face_background);
+	  img->background_valid = 1;
+	}
+    }
+
+  /* Do image transformations and compute masks, unless we
+     don't have the image yet.  */
+  if (!EQ (builtin_lisp_symbol (img->type->type), Qpostscript))
+    postprocess_image (f, img);
+
+  /* postprocess_image above may modify the image or the mask,
+     relying on the image's real width and height, so
+     image_set_transform must be called after it.  */
+#ifdef HAVE_NATIVE_TRANSFORMS
+  image_set_transform (f, img);
+#endif
+}
+
 
 /* Cache image IMG in the image cache of frame F.  */
 
@@ -6495,69 +6839,253 @@ native_image_load (struct frame *f, struct image *img)
 
 
 /***********************************************************************
-				 PNG
+			     Decoded images
  ***********************************************************************/
 
-#if defined (HAVE_PNG)
-
-/* Indices of image specification fields in png_format, below.  */
-
-enum png_keyword_index
-{
-  PNG_TYPE,
-  PNG_DATA,
-  PNG_FILE,
-  PNG_ASCENT,
-  PNG_MARGIN,
-  PNG_RELIEF,
-  PNG_ALGORITHM,
-  PNG_HEURISTIC_MASK,
-  PNG_MASK,
-  PNG_BACKGROUND,
-  PNG_LAST
+#if defined HAVE_PNG || defined HAVE_JPEG
+
+/* The pixels of a PNG or JPEG image as decoded by the image library.
+   Decoding doesn't look at Lisp objects, frames or images, so that it
+   can also be done by the worker threads of asynchronous loading;
+   image_put_decoded_pixels then makes the pixmaps of the image in the
+   main thread.  */
+
+struct decoded_image
+{
+  /* The largest size of image to decode; see image_size_limits.  If
+     BG_P, the color with which to combine the alpha channel of a PNG
+     image, with 16 bits per component.  */
+  int max_width, max_height;
+  bool bg_p;
+  unsigned short bg[3];
+
+  /* An image of WIDTH x HEIGHT pixels of CHANNELS bytes each, in rows
+     of ROW_BYTES bytes, allocated with malloc.  A pixel of one byte
+     is an index into COLORMAP, which has NCOLORS entries; otherwise
+     it has 8-bit RGB components, and if MASK_P, its fourth byte is
+     zero for transparent pixels.  */
+  int width, height, channels;
+  ptrdiff_t row_bytes;
+  unsigned char *pixels;
+  bool mask_p;
+  int ncolors;
+  unsigned char colormap[256][3];
+
+  /* If BACKGROUND_P, the background color recorded in the image.  */
+  bool background_p;
+  unsigned short background[3];
+
+  /* If decoding failed, TOO_LARGE_P if the image exceeds the maximum
+     size, or else a description of the error.  The first warning of
+     the image library, if any.  */
+  bool too_large_p;
+  char error[256];
+  char warning[256];
 };
 
-/* Vector of image_keyword structures describing the format
-   of valid user-defined image specifications.  */
+/* Prepare D for decoding an image to be displayed on frame F.  */
 
-static const struct image_keyword png_format[PNG_LAST] =
+static void
+init_decoded_image (struct decoded_image *d, struct frame *f)
 {
-  {":type",		IMAGE_SYMBOL_VALUE,			1},
-  {":data",		IMAGE_STRING_VALUE,			0},
-  {":file",		IMAGE_STRING_VALUE,			0},
-  {":ascent",		IMAGE_ASCENT_VALUE,			0},
-  {":margin",		IMAGE_NON_NEGATIVE_INTEGER_VALUE_OR_PAIR, 0},
-  {":relief",		IMAGE_INTEGER_VALUE,			0},
-  {":conversion",	IMAGE_DONT_CHECK_VALUE_TYPE,		0},
-  {":heuristic-mask",	IMAGE_DONT_CHECK_VALUE_TYPE,		0},
-  {":mask",		IMAGE_DONT_CHECK_VALUE_TYPE,		0},
-  {":background",	IMAGE_STRING_OR_NIL_VALUE,		0}
-};
+  memset (d, 0, sizeof *d);
+  image_size_limits (f, &d->max_width, &d->max_height);
+}
 
-/* Return true if OBJECT is a valid PNG image specification.  */
+/* Make the pixmaps of image IMG on frame F from the pixels decoded
+   into D, and report the errors and warnings of decoding.  Value is
+   true if successful.  */
 
 static bool
-png_image_p (Lisp_Object object)
+image_put_decoded_pixels (struct frame *f, struct image *img,
+			  struct decoded_image *d)
 {
-  struct image_keyword fmt[PNG_LAST];
-  memcpy (fmt, png_format, sizeof fmt);
-
-  if (!parse_image_spec (object, fmt, PNG_LAST, Qpng))
-    return 0;
+  int width = d->width, height = d->height;
+  Emacs_Pix_Container ximg, mask_img = NULL;
+  unsigned long *colors = NULL;
 
-  /* Must specify either the :data or :file keyword.  */
-  return fmt[PNG_FILE].count + fmt[PNG_DATA].count == 1;
-}
+  if (d->warning[0])
+    image_error ("%s", build_string (d->warning));
+  if (!d->pixels)
+    {
+      if (d->too_large_p)
+	image_size_error ();
+      else
+	image_error ("Error reading image `%s': %s",
+		     img->spec, build_string (d->error));
+      return false;
+    }
 
-#endif /* HAVE_PNG */
+  if (!check_image_size (f, width, height))
+    {
+      image_size_error ();
+      return false;
+    }
 
+  if (!image_create_x_image_and_pixmap (f, img, width, height, 0, &ximg, 0))
+    return false;
+  if (d->mask_p
+      && !image_create_x_image_and_pixmap (f, img, width, height, 1,
+					   &mask_img, 1))
+    {
+      image_destroy_x_image (ximg);
+      image_clear_image_1 (f, img, CLEAR_IMAGE_PIXMAP);
+      return false;
+    }
 
-#ifdef HAVE_PNG
+  /* Use the color table mechanism because it handles colors that
+     cannot be allocated nicely.  Such colors will be replaced with
+     a default color, and we don't have to care about which colors
+     can be freed safely, and which can't.  */
+  init_color_table ();
+  USE_SAFE_ALLOCA;
+  if (d->channels == 1)
+    {
+      /* Multiply RGB values with 256 because X expects RGB values
+	 in the range 0..0xffff.  */
+      SAFE_NALLOCA (colors, 1, d->ncolors);
+      for (int i = 0; i < d->ncolors; i++)
+	colors[i] = lookup_rgb_color (f, d->colormap[i][0] << 8,
+				      d->colormap[i][1] << 8,
+				      d->colormap[i][2] << 8);
+    }
 
-# ifdef WINDOWSNT
-/* PNG library details.  */
+  for (int y = 0; y < height; y++)
+    {
+      unsigned char *p = d->pixels + y * d->row_bytes;
 
-DEF_DLL_FN (png_voidp, png_get_io_ptr, (png_structp));
+      for (int x = 0; x < width; x++, p += d->channels)
+	if (colors)
+	  PUT_PIXEL (ximg, x, y, colors[*p]);
+	else
+	  {
+	    PUT_PIXEL (ximg, x, y,
+		       lookup_rgb_color (f, p[0] << 8, p[1] << 8, p[2] << 8));
+	    if (mask_img)
+	      PUT_PIXEL (mask_img, x, y,
+			 p[3] > 0 ? PIX_MASK_DRAW : PIX_MASK_RETAIN);
+	  }
+    }
+
+  img->width = width;
+  img->height = height;
+
+  if (NILP (image_spec_value (img->spec, QCbackground, NULL)))
+    /* Set IMG's background color from the image, unless the user
+       overrode it.  */
+    {
+      if (d->background_p)
+	{
+#ifndef USE_CAIRO
+	  img->background = lookup_rgb_color (f, d->background[0],
+					      d->background[1],
+					      d->background[2]);
+#else  /* USE_CAIRO */
+	  char color_name[30];
+	  sprintf (color_name, "#%04x%04x%04x", d->background[0],
+		   d->background[1], d->background[2]);
+	  img->background
+	    = image_alloc_image_color (f, img, build_string (color_name), 0);
+#endif /* USE_CAIRO */
+	  img->background_valid = 1;
+	}
+
+      /* Maybe fill in the background field while we have ximg handy.
+	 Casting avoids a GCC warning.  */
+      IMAGE_BACKGROUND (img, f, (Emacs_Pix_Context) ximg);
+    }
+
+#ifdef COLOR_TABLE_SUPPORT
+  /* Remember colors allocated for this image.  */
+  img->colors = colors_in_color_table (&img->ncolors);
+  free_color_table ();
+#endif /* COLOR_TABLE_SUPPORT */
+
+  /* Put ximg into the image.  */
+  image_put_x_image (f, img, ximg, 0);
+
+  /* Same for the mask.  */
+  if (mask_img)
+    {
+      /* Fill in the background_transparent field while we have the
+	 mask handy.  Casting avoids a GCC warning.  */
+      image_background_transparent (img, f, (Emacs_Pix_Context) mask_img);
+
+      image_put_x_image (f, img, mask_img, 1);
+    }
+
+  SAFE_FREE ();
+  return true;
+}
+
+#endif /* HAVE_PNG || HAVE_JPEG */
+
+
+/***********************************************************************
+				 PNG
+ ***********************************************************************/
+
+#if defined (HAVE_PNG)
+
+/* Indices of image specification fields in png_format, below.  */
+
+enum png_keyword_index
+{
+  PNG_TYPE,
+  PNG_DATA,
+  PNG_FILE,
+  PNG_ASCENT,
+  PNG_MARGIN,
+  PNG_RELIEF,
+  PNG_ALGORITHM,
+  PNG_HEURISTIC_MASK,
+  PNG_MASK,
+  PNG_BACKGROUND,
+  PNG_LAST
+};
+
+/* Vector of image_keyword structures describing the format
+   of valid user-defined image specifications.  */
+
+static const struct image_keyword png_format[PNG_LAST] =
+{
+  {":type",		IMAGE_SYMBOL_VALUE,			1},
+  {":data",		IMAGE_STRING_VALUE,			0},
+  {":file",		IMAGE_STRING_VALUE,			0},
+  {":ascent",		IMAGE_ASCENT_VALUE,			0},
+  {":margin",		IMAGE_NON_NEGATIVE_INTEGER_VALUE_OR_PAIR, 0},
+  {":relief",		IMAGE_INTEGER_VALUE,			0},
+  {":conversion",	IMAGE_DONT_CHECK_VALUE_TYPE,		0},
+  {":heuristic-mask",	IMAGE_DONT_CHECK_VALUE_TYPE,		0},
+  {":mask",		IMAGE_DONT_CHECK_VALUE_TYPE,		0},
+  {":background",	IMAGE_STRING_OR_NIL_VALUE,		0}
+};
+
+/* Return true if OBJECT is a valid PNG image specification.  */
+
+static bool
+png_image_p (Lisp_Object object)
+{
+  struct image_keyword fmt[PNG_LAST];
+  memcpy (fmt, png_format, sizeof fmt);
+
+  if (!parse_image_spec (object, fmt, PNG_LAST, Qpng))
+    return 0;
+
+  /* Must specify either the :data or :file keyword.  */
+  return fmt[PNG_FILE].count + fmt[PNG_DATA].count == 1;
+}
+
+#endif /* HAVE_PNG */
+
+
+#ifdef HAVE_PNG
+
+# ifdef WINDOWSNT
+/* PNG library details.  */
+
+DEF_DLL_FN (png_voidp, png_get_error_ptr, (png_structp));
+DEF_DLL_FN (png_voidp, png_get_io_ptr, (png_structp));
 DEF_DLL_FN (int, png_sig_cmp, (png_bytep, png_size_t, png_size_t));
 DEF_DLL_FN (png_structp, png_create_read_struct,
 	    (png_const_charp, png_voidp, png_error_ptr, png_error_ptr));
@@ -6603,6 +7131,7 @@ init_png_functions (void)
   if (!(library = w32_delayed_load (Qpng)))
     return 0;
 
+  LOAD_DLL_FN (library, png_get_error_ptr);
   LOAD_DLL_FN (library, png_get_io_ptr);
   LOAD_DLL_FN (library, png_sig_cmp);
   LOAD_DLL_FN (library, png_create_read_struct);
@@ -6643,6 +7172,7 @@ init_png_functions (void)
 #  undef png_get_bKGD
 #  undef png_get_channels
 #  undef png_get_IHDR
+#  undef png_get_error_ptr
 #  undef png_get_io_ptr
 #  undef png_get_rowbytes
 #  undef png_get_tRNS
@@ -6668,6 +7198,7 @@ init_png_functions (void)
 #  define png_get_bKGD fn_png_get_bKGD
 #  define png_get_channels fn_png_get_channels
 #  define png_get_IHDR fn_png_get_IHDR
+#  define png_get_error_ptr fn_png_get_error_ptr
 #  define png_get_io_ptr fn_png_get_io_ptr
 #  define png_get_rowbytes fn_png_get_rowbytes
 #  define png_get_tRNS fn_png_get_tRNS
@@ -6711,15 +7242,14 @@ init_png_functions (void)
 # endif
 
 /* Error and warning handlers installed when the PNG library
-   is initialized.  */
+   is initialized.  They record the message in the decoded_image
+   that is the error pointer of PNG_PTR.  */
 
 static AVOID
 my_png_error (png_struct *png_ptr, const char *msg)
 {
-  eassert (png_ptr != NULL);
-  /* Avoid compiler warning about deprecated direct access to
-     png_ptr's fields in libpng versions 1.4.x.  */
-  image_error ("PNG error: %s", build_string (msg));
+  struct decoded_image *d = png_get_error_ptr (png_ptr);
+  snprintf (d->error, sizeof d->error, "PNG error: %s", msg);
   PNG_LONGJMP (png_ptr);
 }
 
@@ -6727,8 +7257,9 @@ my_png_error (png_struct *png_ptr, const char *msg)
 static void
 my_png_warning (png_struct *png_ptr, const char *msg)
 {
-  eassert (png_ptr != NULL);
-  image_error ("PNG warning: %s", build_string (msg));
+  struct decoded_image *d = png_get_error_ptr (png_ptr);
+  if (!d->warning[0])
+    snprintf (d->warning, sizeof d->warning, "PNG warning: %s", msg);
 }
 
 /* Memory source for PNG decoding.  */
@@ -6772,100 +7303,52 @@ png_read_from_file (png_structp png_ptr, png_bytep data, png_size_t length)
 }
 
 
-/* Load PNG image IMG for use on frame F.  Value is true if
-   successful.  */
-
 struct png_load_context
 {
   /* These are members so that longjmp doesn't munge local variables.  */
   png_struct *png_ptr;
   png_info *info_ptr;
   png_info *end_info;
-  FILE *fp;
-  png_byte *pixels;
   png_byte **rows;
 };
 
+/* Decode the PNG image read from FP, or else the SIZE bytes at DATA,
+   into D.  Value is true if successful.  This neither looks at Lisp
+   objects nor allocates them, so that it can be called by the worker
+   threads of asynchronous loading.  */
+
 static bool
-png_load_body (struct frame *f, struct image *img, struct png_load_context *c)
+png_decode (struct decoded_image *d, struct png_load_context *c,
+	    FILE *fp, unsigned char *data, ptrdiff_t size)
 {
-  Lisp_Object specified_file, specified_data;
-  FILE *fp = NULL;
-  int x, y;
   ptrdiff_t i;
   png_struct *png_ptr;
   png_info *info_ptr = NULL, *end_info = NULL;
   png_byte sig[8];
-  png_byte *pixels = NULL;
-  png_byte **rows = NULL;
   png_uint_32 width, height;
   int bit_depth, color_type, interlace_type;
-  png_byte channels;
-  png_uint_32 row_bytes;
   bool transparent_p;
   struct png_memory_storage tbr;  /* Data to be read */
   ptrdiff_t nbytes;
-  Emacs_Pix_Container ximg, mask_img = NULL;
-
-  /* Find out what file to load.  */
-  specified_file = image_spec_value (img->spec, QCfile, NULL);
-  specified_data = image_spec_value (img->spec, QCdata, NULL);
 
-  if (NILP (specified_data))
+  /* Check PNG signature.  */
+  if (fp
+      ? (fread (sig, 1, sizeof sig, fp) != sizeof sig
+	 || png_sig_cmp (sig, 0, sizeof sig))
+      : (size < sizeof sig || png_sig_cmp (data, 0, sizeof sig)))
     {
-      int fd;
-      Lisp_Object file = image_find_image_fd (specified_file, &fd);
-      if (!STRINGP (file))
-	{
-	  image_error ("Cannot find image file `%s'", specified_file);
-	  return 0;
-	}
-
-      /* Open the image file.  */
-      fp = fdopen (fd, "rb");
-      if (!fp)
-	{
-	  image_error ("Cannot open image file `%s'", file);
-	  return 0;
-	}
-
-      /* Check PNG signature.  */
-      if (fread (sig, 1, sizeof sig, fp) != sizeof sig
-	  || png_sig_cmp (sig, 0, sizeof sig))
-	{
-	  fclose (fp);
-	  image_error ("Not a PNG file: `%s'", file);
-	  return 0;
-	}
+      snprintf (d->error, sizeof d->error, "Not a PNG image");
+      return false;
     }
-  else
-    {
-      if (!STRINGP (specified_data))
-	{
-	  image_error ("Invalid image data `%s'", specified_data);
-	  return 0;
-	}
-
-      /* Read from memory.  */
-      tbr.bytes = SDATA (specified_data);
-      tbr.len = SBYTES (specified_data);
-      tbr.index = 0;
-
-      /* Check PNG signature.  */
-      if (tbr.len < sizeof sig
-	  || png_sig_cmp (tbr.bytes, 0, sizeof sig))
-	{
-	  image_error ("Not a PNG image: `%s'", img->spec);
-	  return 0;
-	}
 
-      /* Need to skip past the signature.  */
-      tbr.bytes += sizeof (sig);
-    }
+  /* Read from memory, skipping past the signature.  */
+  tbr.bytes = fp ? NULL : data + sizeof sig;
+  tbr.len = size - sizeof sig;
+  tbr.index = 0;
 
   /* Initialize read and info structs for PNG lib.  */
   png_ptr = png_create_read_struct (PNG_LIBPNG_VER_STRING,
-				       NULL, my_png_error,
+				       d, my_png_error,
 				       my_png_warning);
   if (png_ptr)
     {
@@ -6876,58 +7359,43 @@ png_load_body (struct frame *f, struct image *img, struct png_load_context *c)
   c->png_ptr = png_ptr;
   c->info_ptr = info_ptr;
   c->end_info = end_info;
-  c->fp = fp;
-  c->pixels = pixels;
-  c->rows = rows;
+  c->rows = NULL;
 
   if (! (info_ptr && end_info))
     {
       png_destroy_read_struct (&c->png_ptr, &c->info_ptr, &c->end_info);
-      png_ptr = 0;
-    }
-  if (! png_ptr)
-    {
-      if (fp) fclose (fp);
-      return 0;
+      snprintf (d->error, sizeof d->error, "Memory exhausted");
+      return false;
     }
 
   /* Set error jump-back.  We come back here when the PNG library
      detects an error.  */
   if (FAST_SETJMP (PNG_JMPBUF (png_ptr)))
     {
-    error:
-      if (c->png_ptr)
-	png_destroy_read_struct (&c->png_ptr, &c->info_ptr, &c->end_info);
-      xfree (c->pixels);
-      xfree (c->rows);
-      if (c->fp)
-	fclose (c->fp);
-      return 0;
+      png_destroy_read_struct (&c->png_ptr, &c->info_ptr, &c->end_info);
+      free (c->rows);
+      free (d->pixels);
+      d->pixels = NULL;
+      return false;
     }
 
   /* Read image info.  */
-  if (!NILP (specified_data))
-    png_set_read_fn (png_ptr, &tbr, png_read_from_memory);
-  else
+  if (fp)
     png_set_read_fn (png_ptr, fp, png_read_from_file);
+  else
+    png_set_read_fn (png_ptr, &tbr, png_read_from_memory);
 
   png_set_sig_bytes (png_ptr, sizeof sig);
   png_read_info (png_ptr, info_ptr);
   png_get_IHDR (png_ptr, info_ptr, &width, &height, &bit_depth, &color_type,
 		&interlace_type, NULL, NULL);
 
-  if (! (width <= INT_MAX && height <= INT_MAX
-	 && check_image_size (f, width, height)))
+  if (! (width <= d->max_width && height <= d->max_height))
     {
-      image_size_error ();
-      goto error;
+      d->too_large_p = true;
+      png_error (png_ptr, "Image too large");
     }
 
-  /* Create the X image and pixmap now, so that the work below can be
-     omitted if the image is too large for X.  */
-  if (!image_create_x_image_and_pixmap (f, img, width, height, 0, &ximg, 0))
-    goto error;
-
   /* If image contains simply transparency data, we prefer to
      construct a clipping mask.  */
   transparent_p = false;
@@ -6967,35 +7435,16 @@ png_load_body (struct frame *f, struct image *img, struct png_load_context *c)
   /* Handle alpha channel by combining the image with a background
      color.  Do this only if a real alpha channel is supplied.  For
      simple transparency, we prefer a clipping mask.  */
-  if (!transparent_p)
-    {
-      /* png_color_16 *image_bg; */
-      Lisp_Object specified_bg
-	= image_spec_value (img->spec, QCbackground, NULL);
-      Emacs_Color color;
-
-      /* If the user specified a color, try to use it; if not, use the
-	 current frame background, ignoring any default background
-	 color set by the image.  */
-      if (STRINGP (specified_bg)
-	  ? FRAME_TERMINAL (f)->defined_color_hook (f,
-                                                    SSDATA (specified_bg),
-                                                    &color,
-                                                    false,
-                                                    false)
-	  : (FRAME_TERMINAL (f)->query_frame_background_color (f, &color),
-             true))
-	/* The user specified `:background', use that.  */
-	{
-	  int shift = bit_depth == 16 ? 0 : 8;
-	  png_color_16 bg = { 0 };
-	  bg.red = color.red >> shift;
-	  bg.green = color.green >> shift;
-	  bg.blue = color.blue >> shift;
+  if (!transparent_p && d->bg_p)
+    {
+      int shift = bit_depth == 16 ? 0 : 8;
+      png_color_16 bg = { 0 };
+      bg.red = d->bg[0] >> shift;
+      bg.green = d->bg[1] >> shift;
+      bg.blue = d->bg[2] >> shift;
 
-	  png_set_background (png_ptr, &bg,
-			      PNG_BACKGROUND_GAMMA_SCREEN, 0, 1.0);
-	}
+      png_set_background (png_ptr, &bg,
+			  PNG_BACKGROUND_GAMMA_SCREEN, 0, 1.0);
     }
 
   png_set_interlace_handling (png_ptr);
@@ -7006,146 +7455,156 @@ png_load_body (struct frame *f, struct image *img, struct png_load_context *c)
      information (alpha channel), 3 for RGB images, and 4 for RGB
      images with alpha channel, i.e. RGBA.  If conversions above were
      sufficient we should only have 3 or 4 channels here.  */
-  channels = png_get_channels (png_ptr, info_ptr);
-  eassert (channels == 3 || channels == 4);
+  d->channels = png_get_channels (png_ptr, info_ptr);
+  eassert (d->channels == 3 || d->channels == 4);
 
   /* Number of bytes needed for one row of the image.  */
-  row_bytes = png_get_rowbytes (png_ptr, info_ptr);
+  d->row_bytes = png_get_rowbytes (png_ptr, info_ptr);
 
   /* Allocate memory for the image.  */
-  if (INT_MULTIPLY_WRAPV (row_bytes, sizeof *pixels, &nbytes)
-      || INT_MULTIPLY_WRAPV (nbytes, height, &nbytes))
-    memory_full (SIZE_MAX);
-  c->pixels = pixels = xmalloc (nbytes);
-  c->rows = rows = xmalloc (height * sizeof *rows);
+  if (INT_MULTIPLY_WRAPV (d->row_bytes, height, &nbytes)
+      || SIZE_MAX / sizeof *c->rows < height
+      || ! (d->pixels = malloc (max (nbytes, 1)))
+      || ! (c->rows = malloc (height * sizeof *c->rows)))
+    png_error (png_ptr, "Memory exhausted");
   for (i = 0; i < height; ++i)
-    rows[i] = pixels + i * row_bytes;
+    c->rows[i] = d->pixels + i * d->row_bytes;
 
   /* Read the entire image.  */
-  png_read_image (png_ptr, rows);
+  png_read_image (png_ptr, c->rows);
   png_read_end (png_ptr, info_ptr);
-  if (fp)
-    {
-      fclose (fp);
-      c->fp = NULL;
-    }
-
-  /* Create an image and pixmap serving as mask if the PNG image
-     contains an alpha channel.  */
-  if (channels == 4
-      && transparent_p
-      && !image_create_x_image_and_pixmap (f, img, width, height, 1,
-					   &mask_img, 1))
-    {
-      image_destroy_x_image (ximg);
-      image_clear_image_1 (f, img, CLEAR_IMAGE_PIXMAP);
-      goto error;
-    }
-
-  /* Fill the X image and mask from PNG data.  */
-  init_color_table ();
 
-  for (y = 0; y < height; ++y)
-    {
-      png_byte *p = rows[y];
+  /* An alpha channel, aka mask channel, associates variable
+     transparency with an image.  Where other image formats
+     support binary transparency---fully transparent or fully
+     opaque---PNG allows up to 254 levels of partial transparency.
+     The PNG library implements partial transparency by combining
+     the image with a specified background color.
 
-      for (x = 0; x < width; ++x)
-	{
-	  int r, g, b;
+     I'm not sure how to handle this here nicely: because the
+     background on which the image is displayed may change, for
+     real alpha channel support, it would be necessary to create
+     a new image for each possible background.
 
-	  r = *p++ << 8;
-	  g = *p++ << 8;
-	  b = *p++ << 8;
-	  PUT_PIXEL (ximg, x, y, lookup_rgb_color (f, r, g, b));
-	  /* An alpha channel, aka mask channel, associates variable
-	     transparency with an image.  Where other image formats
-	     support binary transparency---fully transparent or fully
-	     opaque---PNG allows up to 254 levels of partial transparency.
-	     The PNG library implements partial transparency by combining
-	     the image with a specified background color.
-
-	     I'm not sure how to handle this here nicely: because the
-	     background on which the image is displayed may change, for
-	     real alpha channel support, it would be necessary to create
-	     a new image for each possible background.
-
-	     What I'm doing now is that a mask is created if we have
-	     boolean transparency information.  Otherwise I'm using
-	     the frame's background color to combine the image with.  */
-
-	  if (channels == 4)
-	    {
-	      if (mask_img)
-		PUT_PIXEL (mask_img, x, y, *p > 0 ? PIX_MASK_DRAW : PIX_MASK_RETAIN);
-	      ++p;
-	    }
-	}
-    }
+     What I'm doing now is that a mask is created if we have
+     boolean transparency information.  Otherwise I'm using
+     the frame's background color to combine the image with.  */
+  d->mask_p = d->channels == 4 && transparent_p;
 
-  if (NILP (image_spec_value (img->spec, QCbackground, NULL)))
-    /* Set IMG's background color from the PNG image, unless the user
-       overrode it.  */
+  png_color_16 *bg;
+  if (png_get_bKGD (png_ptr, info_ptr, &bg))
     {
-      png_color_16 *bg;
-      if (png_get_bKGD (png_ptr, info_ptr, &bg))
-	{
-#ifndef USE_CAIRO
-	  img->background = lookup_rgb_color (f, bg->red, bg->green, bg->blue);
-#else  /* USE_CAIRO */
-	  char color_name[30];
-	  sprintf (color_name, "#%04x%04x%04x", bg->red, bg->green, bg->blue);
-	  img->background
-	    = image_alloc_image_color (f, img, build_string (color_name), 0);
-#endif /* USE_CAIRO */
-	  img->background_valid = 1;
-	}
+      d->background_p = true;
+      d->background[0] = bg->red;
+      d->background[1] = bg->green;
+      d->background[2] = bg->blue;
     }
 
-# ifdef COLOR_TABLE_SUPPORT
-  /* Remember colors allocated for this image.  */
-  img->colors = colors_in_color_table (&img->ncolors);
-  free_color_table ();
-# endif /* COLOR_TABLE_SUPPORT */
+  d->width = width;
+  d->height = height;
 
   /* Clean up.  */
   png_destroy_read_struct (&c->png_ptr, &c->info_ptr, &c->end_info);
-  xfree (rows);
-  xfree (pixels);
-
-  img->width = width;
-  img->height = height;
+  free (c->rows);
+  return true;
+}
 
-  /* Maybe fill in the background field while we have ximg handy.
-     Casting avoids a GCC warning.  */
-  IMAGE_BACKGROUND (img, f, (Emacs_Pix_Context)ximg);
+/* Set the color with which PNG image IMG on frame F is combined with
+   its alpha channel when it is decoded into D.  */
 
-  /* Put ximg into the image.  */
-  image_put_x_image (f, img, ximg, 0);
+static void
+png_decode_background (struct frame *f, struct image *img,
+		       struct decoded_image *d)
+{
+  Lisp_Object specified_bg
+    = image_spec_value (img->spec, QCbackground, NULL);
+  Emacs_Color color;
 
-  /* Same for the mask.  */
-  if (mask_img)
+  /* If the user specified a color, try to use it; if not, use the
+     current frame background, ignoring any default background
+     color set by the image.  */
+  if (STRINGP (specified_bg)
+      ? FRAME_TERMINAL (f)->defined_color_hook (f,
+						SSDATA (specified_bg),
+						&color,
+						false,
+						false)
+      : (FRAME_TERMINAL (f)->query_frame_background_color (f, &color),
+	 true))
     {
-      /* Fill in the background_transparent field while we have the
-	 mask handy.  Casting avoids a GCC warning.  */
-      image_background_transparent (img, f, (Emacs_Pix_Context)mask_img);
-
-      image_put_x_image (f, img, mask_img, 1);
+      d->bg_p = true;
+      d->bg[0] = color.red;
+      d->bg[1] = color.green;
+      d->bg[2] = color.blue;
     }
-
-  return 1;
 }
 
+/* Load PNG image IMG for use on frame F.  Value is true if
+   successful.  */
+
 static bool
-png_load (struct frame *f, struct image *img)
+png_load_body (struct frame *f, struct image *img, struct png_load_context *c)
 {
-  struct png_load_context c;
-  return png_load_body (f, img, &c);
-}
-
-#endif /* HAVE_PNG */
+  Lisp_Object specified_file, specified_data;
+  FILE *fp = NULL;
+  struct decoded_image d;
+  bool ok;
 
+  /* Find out what file to load.  */
+  specified_file = image_spec_value (img->spec, QCfile, NULL);
+  specified_data = image_spec_value (img->spec, QCdata, NULL);
 
-
+  if (NILP (specified_data))
+    {
+      int fd;
+      Lisp_Object file = image_find_image_fd (specified_file, &fd);
+      if (!STRINGP (file))
+	{
+	  image_error ("Cannot find image file `%s'", specified_file);
+	  return 0;
+	}
+
+      /* Open the image file.  */
+      fp = fdopen (fd, "rb");
+      if (!fp)
+	{
+	  image_error ("Cannot open image file `%s'", file);
+	  return 0;
+	}
+    }
+  else if (!STRINGP (specified_data))
+    {
+      image_error ("Invalid image data `%s'", specified_data);
+      return 0;
+    }
+
+  init_decoded_image (&d, f);
+  png_decode_background (f, img, &d);
+  if (fp)
+    {
+      png_decode (&d, c, fp, NULL, 0);
+      fclose (fp);
+    }
+  else
+    png_decode (&d, c, NULL, SDATA (specified_data),
+		SBYTES (specified_data));
+
+  ok = image_put_decoded_pixels (f, img, &d);
+  free (d.pixels);
+  return ok;
+}
+
+static bool
+png_load (struct frame *f, struct image *img)
+{
+  struct png_load_context c;
+  return png_load_body (f, img, &c);
+}
+
+#endif /* HAVE_PNG */
+
+
+
 /***********************************************************************
 				 JPEG
  ***********************************************************************/
@@ -7312,8 +7771,7 @@ jpeg_resync_to_restart_wrapper (j_decompress_ptr cinfo, int desired)
   enum
     {
       MY_JPEG_ERROR_EXIT,
-      MY_JPEG_INVALID_IMAGE_SIZE,
-      MY_JPEG_CANNOT_CREATE_X
+      MY_JPEG_INVALID_IMAGE_SIZE
     } failure_code;
 };
 
@@ -7348,9 +7806,11 @@ our_common_term_source (j_decompress_ptr cinfo)
 
 /* Fill input buffer method for JPEG data source manager.  Called
    whenever more data is needed.  We read the whole image in one step,
-   so this only adds a fake end of input marker at the end.  */
+   so this only adds a fake end of input marker at the end.  The
+   marker is constant, so that images can be decoded by several
+   threads at once.  */
 
-static JOCTET our_memory_buffer[2];
+static JOCTET const our_memory_buffer[2] = { 0xFF, JPEG_EOI };
 
 static boolean
 our_memory_fill_input_buffer (j_decompress_ptr cinfo)
@@ -7358,9 +7818,6 @@ our_memory_fill_input_buffer (j_decompress_ptr cinfo)
   /* Insert a fake EOI marker.  */
   struct jpeg_source_mgr *src = cinfo->src;
 
-  our_memory_buffer[0] = (JOCTET) 0xFF;
-  our_memory_buffer[1] = (JOCTET) JPEG_EOI;
-
   src->next_input_byte = our_memory_buffer;
   src->bytes_in_buffer = 2;
   return 1;
@@ -7414,297 +7871,958 @@ jpeg_memory_src (j_decompress_ptr cinfo, JOCTET *data, ptrdiff_t len)
 }
 
 
-struct jpeg_stdio_mgr
+struct jpeg_stdio_mgr
+{
+  struct jpeg_source_mgr mgr;
+  boolean finished;
+  FILE *file;
+  JOCTET *buffer;
+};
+
+
+/* Size of buffer to read JPEG from file.
+   Not too big, as we want to use alloc_small.  */
+#define JPEG_STDIO_BUFFER_SIZE 8192
+
+
+/* Fill input buffer method for JPEG data source manager.  Called
+   whenever more data is needed.  The data is read from a FILE *.  */
+
+static boolean
+our_stdio_fill_input_buffer (j_decompress_ptr cinfo)
+{
+  struct jpeg_stdio_mgr *src;
+
+  src = (struct jpeg_stdio_mgr *) cinfo->src;
+  if (!src->finished)
+    {
+      ptrdiff_t bytes;
+
+      bytes = fread (src->buffer, 1, JPEG_STDIO_BUFFER_SIZE, src->file);
+      if (bytes > 0)
+        src->mgr.bytes_in_buffer = bytes;
+      else
+        {
+          WARNMS (cinfo, JWRN_JPEG_EOF);
+          src->finished = 1;
+          src->buffer[0] = (JOCTET) 0xFF;
+          src->buffer[1] = (JOCTET) JPEG_EOI;
+          src->mgr.bytes_in_buffer = 2;
+        }
+      src->mgr.next_input_byte = src->buffer;
+    }
+
+  return 1;
+}
+
+
+/* Method to skip over NUM_BYTES bytes in the image data.  CINFO->src
+   is the JPEG data source manager.  */
+
+static void
+our_stdio_skip_input_data (j_decompress_ptr cinfo, long int num_bytes)
+{
+  struct jpeg_stdio_mgr *src;
+  src = (struct jpeg_stdio_mgr *) cinfo->src;
+
+  while (num_bytes > 0 && !src->finished)
+    {
+      if (num_bytes <= src->mgr.bytes_in_buffer)
+        {
+          src->mgr.bytes_in_buffer -= num_bytes;
+          src->mgr.next_input_byte += num_bytes;
+          break;
+        }
+      else
+        {
+          num_bytes -= src->mgr.bytes_in_buffer;
+          src->mgr.bytes_in_buffer = 0;
+          src->mgr.next_input_byte = NULL;
+
+          our_stdio_fill_input_buffer (cinfo);
+        }
+    }
+}
+
+
+/* Set up the JPEG lib for reading an image from a FILE *.
+   CINFO is the decompression info structure created for
+   reading the image.  */
+
+static void
+jpeg_file_src (j_decompress_ptr cinfo, FILE *fp)
+{
+  struct jpeg_stdio_mgr *src = (struct jpeg_stdio_mgr *) cinfo->src;
+
+  if (! src)
+    {
+      /* First time for this JPEG object?  */
+      src = cinfo->mem->alloc_small ((j_common_ptr) cinfo,
+				     JPOOL_PERMANENT, sizeof *src);
+      cinfo->src = (struct jpeg_source_mgr *) src;
+      src->buffer = cinfo->mem->alloc_small ((j_common_ptr) cinfo,
+					     JPOOL_PERMANENT,
+					     JPEG_STDIO_BUFFER_SIZE);
+    }
+
+  src->file = fp;
+  src->finished = 0;
+  src->mgr.init_source = our_common_init_source;
+  src->mgr.fill_input_buffer = our_stdio_fill_input_buffer;
+  src->mgr.skip_input_data = our_stdio_skip_input_data;
+  src->mgr.resync_to_restart = jpeg_resync_to_restart; /* Use default.  */
+  src->mgr.term_source = our_common_term_source;
+  src->mgr.bytes_in_buffer = 0;
+  src->mgr.next_input_byte = NULL;
+}
+
+/* Decode the JPEG image read from FP, or else the SIZE bytes at DATA,
+   into D.  Value is true if successful.  Like png_decode, this can
+   be called by the worker threads of asynchronous loading.
+   Patterned after example.c from the JPEG lib.  */
+
+static bool
+jpeg_decode (struct decoded_image *d, struct my_jpeg_error_mgr *mgr,
+	     FILE *fp, unsigned char *data, ptrdiff_t size)
+{
+  int i, ir, ig, ib;
+  ptrdiff_t nbytes;
+
+  /* Customize libjpeg's error handling to call my_error_exit when an
+     error is detected.  This function will perform a longjmp.  */
+  mgr->cinfo.err = jpeg_std_error (&mgr->pub);
+  mgr->pub.error_exit = my_error_exit;
+  if (sys_setjmp (mgr->setjmp_buffer))
+    {
+      switch (mgr->failure_code)
+	{
+	case MY_JPEG_ERROR_EXIT:
+	  {
+	    char buf[JMSG_LENGTH_MAX];
+	    mgr->cinfo.err->format_message ((j_common_ptr) &mgr->cinfo, buf);
+	    snprintf (d->error, sizeof d->error, "JPEG error: %s", buf);
+	    break;
+	  }
+
+	case MY_JPEG_INVALID_IMAGE_SIZE:
+	  d->too_large_p = true;
+	  break;
+	}
+
+      /* Destroy the JPEG object and the pixels read so far.  */
+      jpeg_destroy_decompress (&mgr->cinfo);
+      free (d->pixels);
+      d->pixels = NULL;
+      return false;
+    }
+
+  /* Create the JPEG decompression object.  Let it read from fp.
+	 Read the JPEG image header.  */
+  jpeg_CreateDecompress (&mgr->cinfo, JPEG_LIB_VERSION, sizeof *&mgr->cinfo);
+
+  if (fp)
+    jpeg_file_src (&mgr->cinfo, fp);
+  else
+    jpeg_memory_src (&mgr->cinfo, data, size);
+
+  jpeg_read_header (&mgr->cinfo, 1);
+
+  /* Customize decompression so that color quantization will be used.
+	 Start decompression.  */
+  mgr->cinfo.quantize_colors = 1;
+  jpeg_start_decompress (&mgr->cinfo);
+
+  if (! (mgr->cinfo.output_width <= d->max_width
+	 && mgr->cinfo.output_height <= d->max_height))
+    {
+      mgr->failure_code = MY_JPEG_INVALID_IMAGE_SIZE;
+      sys_longjmp (mgr->setjmp_buffer, 1);
+    }
+
+  /* Record the colors.  When color quantization is used,
+     mgr->cinfo.actual_number_of_colors has been set with the number of
+     colors generated, and mgr->cinfo.colormap is a two-dimensional array
+     of color indices in the range 0..mgr->cinfo.actual_number_of_colors.
+     No more than 256 colors will be generated.  */
+  if (mgr->cinfo.out_color_components > 2)
+    ir = 0, ig = 1, ib = 2;
+  else if (mgr->cinfo.out_color_components > 1)
+    ir = 0, ig = 1, ib = 0;
+  else
+    ir = 0, ig = 0, ib = 0;
+
+  d->ncolors = min (mgr->cinfo.actual_number_of_colors,
+		    (int) ARRAYELTS (d->colormap));
+  for (i = 0; i < d->ncolors; ++i)
+    {
+      d->colormap[i][0] = mgr->cinfo.colormap[ir][i];
+      d->colormap[i][1] = mgr->cinfo.colormap[ig][i];
+      d->colormap[i][2] = mgr->cinfo.colormap[ib][i];
+    }
+
+  /* Read pixels, which are indices into the colormap.  */
+  d->width = mgr->cinfo.output_width;
+  d->height = mgr->cinfo.output_height;
+  d->channels = 1;
+  d->row_bytes = d->width * mgr->cinfo.output_components;
+  if (INT_MULTIPLY_WRAPV (d->row_bytes, d->height, &nbytes)
+      || ! (d->pixels = malloc (max (nbytes, 1))))
+    ERREXIT (&mgr->cinfo, JERR_OUT_OF_MEMORY);
+  while (mgr->cinfo.output_scanline < mgr->cinfo.output_height)
+    {
+      JSAMPROW row = d->pixels + mgr->cinfo.output_scanline * d->row_bytes;
+      jpeg_read_scanlines (&mgr->cinfo, &row, 1);
+    }
+
+  /* Clean up.  */
+  jpeg_finish_decompress (&mgr->cinfo);
+  jpeg_destroy_decompress (&mgr->cinfo);
+  return true;
+}
+
+/* Load JPEG image IMG for use on frame F.  Value is true if
+   successful.  */
+
+static bool
+jpeg_load_body (struct frame *f, struct image *img,
+		struct my_jpeg_error_mgr *mgr)
+{
+  Lisp_Object specified_file, specified_data;
+  FILE *fp = NULL;
+  struct decoded_image d;
+  bool ok;
+
+  /* Open the JPEG file.  */
+  specified_file = image_spec_value (img->spec, QCfile, NULL);
+  specified_data = image_spec_value (img->spec, QCdata, NULL);
+
+  if (NILP (specified_data))
+    {
+      int fd;
+      Lisp_Object file = image_find_image_fd (specified_file, &fd);
+      if (!STRINGP (file))
+	{
+	  image_error ("Cannot find image file `%s'", specified_file);
+	  return 0;
+	}
+
+      fp = fdopen (fd, "rb");
+      if (fp == NULL)
+	{
+	  image_error ("Cannot open `%s'", file);
+	  return 0;
+	}
+    }
+  else if (!STRINGP (specified_data))
+    {
+      image_error ("Invalid image data `%s'", specified_data);
+      return 0;
+    }
+
+  init_decoded_image (&d, f);
+  if (fp)
+    {
+      jpeg_decode (&d, mgr, fp, NULL, 0);
+      fclose (fp);
+    }
+  else
+    jpeg_decode (&d, mgr, NULL, SDATA (specified_data),
+		 SBYTES (specified_data));
+
+  ok = image_put_decoded_pixels (f, img, &d);
+  free (d.pixels);
+  return ok;
+}
+
+static bool
+jpeg_load (struct frame *f, struct image *img)
+{
+  struct my_jpeg_error_mgr mgr;
+  return jpeg_load_body (f, img, &mgr);
+}
+
+#endif /* !HAVE_JPEG */
+
+
+
+/***********************************************************************
+			   Asynchronous loading
+ ***********************************************************************/
+
+#ifdef USE_ASYNC_IMAGE_LOAD
+
+/* When `image-load-asynchronously' says so, the pixels of PNG and
+   JPEG images are decoded by a pool of worker threads, so that
+   redisplay doesn't wait for large images.  lookup_image reads the
+   size of the image from its header and queues a job to decode it;
+   until the job has finished, the image has no pixmap and is drawn
+   as an empty box of its final size.  When a worker has decoded the
+   pixels, it writes to a pipe, and image_load_callback stores an
+   IMAGE_LOADED_EVENT; when the command loop reads it,
+   image_finish_loads creates the pixmaps in the main thread, outside
+   of redisplay, and the command loop redisplays.
+
+   The workers never look at Lisp objects, frames or images.  Their
+   input is copied into the job when it is queued, and their output
+   is a plain array of pixels, so they need no lock except the one
+   protecting the job lists.  */
+
+/* The number of worker threads.  */
+#define IMAGE_LOAD_THREADS 4
+
+/* How many bytes at the start of an image file to read when looking
+   for its size.  JPEG files can have large Exif segments before the
+   frame header.  */
+#define IMAGE_HEADER_BYTES (128 * 1024)
+
+enum image_load_kind
+{
+  IMAGE_LOAD_PNG,
+  IMAGE_LOAD_JPEG
+};
+
+struct image_load_job
+{
+  /* The next job in image_load_queue or image_load_done.  */
+  struct image_load_job *next;
+
+  /* The image whose pixels are loaded, and its image cache.  IMG is
+     set to null when the pixels have been put into the image, or if
+     the image is freed before that.  Only the main thread looks at
+     these.  */
+  struct image *img;
+  struct image_cache *cache;
+
+  /* True if the result of the job is no longer needed, and true if
+     the job has finished.  Protected by image_load_mutex.  */
+  bool cancelled, done;
+
+  /* What kind of image to decode, and either a file descriptor open
+     on the image file, or a copy of the image data of SIZE bytes.  */
+  enum image_load_kind kind;
+  int fd;
+  unsigned char *data;
+  ptrdiff_t size;
+
+  /* The input and the result of decoding.  */
+  struct decoded_image decoded;
+
+  /* True if image_wait_for_load has put the pixels into IMG, and
+     the frames showing it must be redrawn.  Only the main thread
+     looks at this.  */
+  bool redraw_p;
+};
+
+static sys_mutex_t image_load_mutex;
+
+/* Signaled when a job is queued, and when a job has finished.  */
+static sys_cond_t image_load_queued;
+static sys_cond_t image_load_finished;
+
+/* The jobs waiting for a worker, oldest first, and the finished jobs
+   not yet seen by the main thread.  */
+static struct image_load_job *image_load_queue, *image_load_queue_tail;
+static struct image_load_job *image_load_done;
+
+/* The workers write a byte to the pipe IMAGE_LOAD_PIPE when they
+   finish a job.  */
+static int image_load_pipe[2] = { -1, -1 };
+static int image_load_nthreads;
+
+/* Return the size of the image of kind KIND whose first LEN bytes
+   are P, by looking at its header.  Store the width and height in
+   *WIDTH and *HEIGHT.  Value is false if the size could not be
+   found.  */
+
+static bool
+image_header_size (enum image_load_kind kind, unsigned char const *p,
+		   ptrdiff_t len, int *width, int *height)
+{
+  unsigned int w = 0, h = 0;
+
+  if (kind == IMAGE_LOAD_PNG)
+    {
+      /* The IHDR chunk must come right after the signature.  */
+      static unsigned char const png_signature[8]
+	= { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+      if (len < 24 || memcmp (p, png_signature, sizeof png_signature)
+	  || memcmp (p + 12, "IHDR", 4))
+	return false;
+      w = (unsigned) p[16] << 24 | p[17] << 16 | p[18] << 8 | p[19];
+      h = (unsigned) p[20] << 24 | p[21] << 16 | p[22] << 8 | p[23];
+    }
+  else
+    {
+      /* Skip the segments before the first start of frame marker,
+	 which holds the size.  */
+      ptrdiff_t i = 2;
+      if (len < 4 || p[0] != 0xFF || p[1] != 0xD8)
+	return false;
+      while (i + 4 <= len && !w)
+	{
+	  int marker = p[i + 1];
+	  if (p[i] != 0xFF)
+	    return false;
+	  if (marker == 0xFF)
+	    {
+	      /* A fill byte.  */
+	      i++;
+	      continue;
+	    }
+	  i += 2;
+	  if (marker == 0x01 || (0xD0 <= marker && marker <= 0xD7))
+	    /* A marker without a segment.  */
+	    continue;
+	  if (marker == 0xD9 || marker == 0xDA)
+	    /* End of image, or start of scan.  */
+	    return false;
+	  if (0xC0 <= marker && marker <= 0xCF
+	      && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+	    {
+	      if (len < i + 7)
+		return false;
+	      h = p[i + 3] << 8 | p[i + 4];
+	      w = p[i + 5] << 8 | p[i + 6];
+	      if (!w)
+		return false;
+	    }
+	  else
+	    i += p[i] << 8 | p[i + 1];
+	}
+    }
+
+  if (! (0 < w && w <= INT_MAX && 0 < h && h <= INT_MAX))
+    return false;
+  *width = w;
+  *height = h;
+  return true;
+}
+
+/* Decode the image of JOB.  Called in a worker thread.  */
+
+static void
+image_decode_job (struct image_load_job *job)
+{
+  FILE *fp = NULL;
+
+  if (job->fd >= 0)
+    {
+      fp = fdopen (job->fd, "rb");
+      if (!fp)
+	{
+	  emacs_close (job->fd);
+	  job->fd = -1;
+	  snprintf (job->decoded.error, sizeof job->decoded.error,
+		    "Cannot open image file");
+	  return;
+	}
+      job->fd = -1;
+    }
+
+  switch (job->kind)
+    {
+#ifdef HAVE_PNG
+    case IMAGE_LOAD_PNG:
+      {
+	struct png_load_context c;
+	png_decode (&job->decoded, &c, fp, job->data, job->size);
+	break;
+      }
+#endif
+#ifdef HAVE_JPEG
+    case IMAGE_LOAD_JPEG:
+      {
+	struct my_jpeg_error_mgr mgr;
+	jpeg_decode (&job->decoded, &mgr, fp, job->data, job->size);
+	break;
+      }
+#endif
+    default:
+      snprintf (job->decoded.error, sizeof job->decoded.error,
+		"Unsupported image type");
+      break;
+    }
+
+  if (fp)
+    fclose (fp);
+}
+
+/* The function run by the worker threads.  */
+
+static void *
+image_load_thread (void *arg)
+{
+  sys_thread_set_name ("emacs-image");
+  sys_mutex_lock (&image_load_mutex);
+
+  while (true)
+    {
+      struct image_load_job *job;
+
+      while (!image_load_queue)
+	sys_cond_wait (&image_load_queued, &image_load_mutex);
+      job = image_load_queue;
+      image_load_queue = job->next;
+
+      if (!job->cancelled)
+	{
+	  sys_mutex_unlock (&image_load_mutex);
+	  image_decode_job (job);
+	  sys_mutex_lock (&image_load_mutex);
+	}
+
+      job->done = true;
+      job->next = image_load_done;
+      image_load_done = job;
+      sys_cond_broadcast (&image_load_finished);
+      emacs_write (image_load_pipe[1], "", 1);
+    }
+
+  return NULL;
+}
+
+/* Put the pixels decoded by JOB into its image, as the load functions
+   of the image types do.  Value is true if successful.  */
+
+static bool
+image_install_job (struct image_load_job *job)
+{
+  struct image *img = job->img;
+  struct frame *f = NULL;
+  Lisp_Object tail, frame;
+  bool ok;
+
+  FOR_EACH_FRAME (tail, frame)
+    if (FRAME_WINDOW_P (XFRAME (frame))
+	&& FRAME_IMAGE_CACHE (XFRAME (frame)) == job->cache)
+      {
+	f = XFRAME (frame);
+	break;
+      }
+
+  img->load_pending_p = false;
+  img->load_job = NULL;
+  job->img = NULL;
+
+  block_input ();
+  ok = f && image_put_decoded_pixels (f, img, &job->decoded);
+  if (ok)
+    {
+      postprocess_loaded_image (f, img);
+      image_cache_count_bytes (job->cache, img);
+    }
+  else
+    {
+      /* As after a failed synchronous load, IMG is not loaded again
+	 until the image cache is cleared; it keeps the size of its
+	 placeholder.  */
+      img->load_failed_p = true;
+      if (f)
+	image_clear_image (f, img);
+    }
+  unblock_input ();
+
+  free (job->decoded.pixels);
+  job->decoded.pixels = NULL;
+  return ok;
+}
+
+/* Put the pixels of the finished jobs into their images, and arrange
+   for the frames showing them to be redrawn.  This clears the
+   current matrices of those frames, so it must not be called during
+   redisplay; it is called when the command loop reads the
+   IMAGE_LOADED_EVENT stored by image_load_callback.  */
+
+void
+image_finish_loads (void)
+{
+  struct image_load_job *job, *next;
+
+  if (image_load_pipe[0] < 0)
+    return;
+
+  sys_mutex_lock (&image_load_mutex);
+  job = image_load_done;
+  image_load_done = NULL;
+  sys_mutex_unlock (&image_load_mutex);
+
+  for (; job; job = next)
+    {
+      next = job->next;
+      if (job->img)
+	job->redraw_p = image_install_job (job);
+
+      /* The glyphs of the image were drawn as empty boxes, and their
+	 rows must be redrawn.  */
+      if (job->redraw_p)
+	{
+	  Lisp_Object tail, frame;
+
+	  FOR_EACH_FRAME (tail, frame)
+	    if (FRAME_WINDOW_P (XFRAME (frame))
+		&& FRAME_IMAGE_CACHE (XFRAME (frame)) == job->cache)
+	      {
+		clear_current_matrices (XFRAME (frame));
+		fset_redisplay (XFRAME (frame));
+	      }
+	}
+
+      xfree (job->data);
+      free (job->decoded.pixels);
+      xfree (job);
+    }
+}
+
+/* Called when the workers have written to the pipe FD.  This may
+   happen during redisplay, so the finished jobs are left to
+   image_finish_loads.  */
+
+static void
+image_load_callback (int fd, void *data)
 {
-  struct jpeg_source_mgr mgr;
-  boolean finished;
-  FILE *file;
-  JOCTET *buffer;
-};
+  char buf[64];
+  bool done;
 
+  while (0 < emacs_read (fd, buf, sizeof buf))
+    continue;
 
-/* Size of buffer to read JPEG from file.
-   Not too big, as we want to use alloc_small.  */
-#define JPEG_STDIO_BUFFER_SIZE 8192
+  sys_mutex_lock (&image_load_mutex);
+  done = image_load_done != NULL;
+  sys_mutex_unlock (&image_load_mutex);
 
+  if (done)
+    {
+      struct input_event event;
 
-/* Fill input buffer method for JPEG data source manager.  Called
-   whenever more data is needed.  The data is read from a FILE *.  */
+      EVENT_INIT (event);
+      event.kind = IMAGE_LOADED_EVENT;
+      event.frame_or_window = selected_frame;
+      event.arg = Qnil;
+      kbd_buffer_store_event (&event);
+    }
+}
 
-static boolean
-our_stdio_fill_input_buffer (j_decompress_ptr cinfo)
-{
-  struct jpeg_stdio_mgr *src;
+/* Start the worker threads, if not yet done.  Value is false if no
+   worker could be started.  */
 
-  src = (struct jpeg_stdio_mgr *) cinfo->src;
-  if (!src->finished)
+static bool
+image_load_start_threads (void)
+{
+  if (image_load_pipe[0] < 0)
     {
-      ptrdiff_t bytes;
+      if (emacs_pipe (image_load_pipe) != 0)
+	return false;
+      fcntl (image_load_pipe[0], F_SETFL, O_NONBLOCK);
+      fcntl (image_load_pipe[1], F_SETFL, O_NONBLOCK);
+      add_read_fd (image_load_pipe[0], image_load_callback, NULL);
 
-      bytes = fread (src->buffer, 1, JPEG_STDIO_BUFFER_SIZE, src->file);
-      if (bytes > 0)
-        src->mgr.bytes_in_buffer = bytes;
-      else
-        {
-          WARNMS (cinfo, JWRN_JPEG_EOF);
-          src->finished = 1;
-          src->buffer[0] = (JOCTET) 0xFF;
-          src->buffer[1] = (JOCTET) JPEG_EOI;
-          src->mgr.bytes_in_buffer = 2;
-        }
-      src->mgr.next_input_byte = src->buffer;
+      sys_mutex_init (&image_load_mutex);
+      sys_cond_init (&image_load_queued);
+      sys_cond_init (&image_load_finished);
     }
 
-  return 1;
-}
+  while (image_load_nthreads < IMAGE_LOAD_THREADS)
+    {
+      sys_thread_t thread;
+      if (!sys_thread_create (&thread, image_load_thread, NULL))
+	break;
+      image_load_nthreads++;
+    }
 
+  return image_load_nthreads > 0;
+}
 
-/* Method to skip over NUM_BYTES bytes in the image data.  CINFO->src
-   is the JPEG data source manager.  */
+/* Store in *KIND how the worker threads decode images of type TYPE.
+   Value is false if they can't.  */
 
-static void
-our_stdio_skip_input_data (j_decompress_ptr cinfo, long int num_bytes)
+static bool
+image_load_kind (Lisp_Object type, enum image_load_kind *kind)
 {
-  struct jpeg_stdio_mgr *src;
-  src = (struct jpeg_stdio_mgr *) cinfo->src;
-
-  while (num_bytes > 0 && !src->finished)
+#ifdef HAVE_PNG
+  if (EQ (type, Qpng))
     {
-      if (num_bytes <= src->mgr.bytes_in_buffer)
-        {
-          src->mgr.bytes_in_buffer -= num_bytes;
-          src->mgr.next_input_byte += num_bytes;
-          break;
-        }
-      else
-        {
-          num_bytes -= src->mgr.bytes_in_buffer;
-          src->mgr.bytes_in_buffer = 0;
-          src->mgr.next_input_byte = NULL;
-
-          our_stdio_fill_input_buffer (cinfo);
-        }
+      *kind = IMAGE_LOAD_PNG;
+      return true;
+    }
+#endif
+#ifdef HAVE_JPEG
+  if (EQ (type, Qjpeg))
+    {
+      *kind = IMAGE_LOAD_JPEG;
+      return true;
     }
+#endif
+  return false;
 }
 
-
-/* Set up the JPEG lib for reading an image from a FILE *.
-   CINFO is the decompression info structure created for
-   reading the image.  */
+/* Give JOB to the worker threads.  */
 
 static void
-jpeg_file_src (j_decompress_ptr cinfo, FILE *fp)
+image_queue_job (struct image_load_job *job)
 {
-  struct jpeg_stdio_mgr *src = (struct jpeg_stdio_mgr *) cinfo->src;
+  sys_mutex_lock (&image_load_mutex);
+  if (image_load_queue)
+    image_load_queue_tail->next = job;
+  else
+    image_load_queue = job;
+  image_load_queue_tail = job;
+  sys_cond_signal (&image_load_queued);
+  sys_mutex_unlock (&image_load_mutex);
+}
 
-  if (! src)
-    {
-      /* First time for this JPEG object?  */
-      src = cinfo->mem->alloc_small ((j_common_ptr) cinfo,
-				     JPOOL_PERMANENT, sizeof *src);
-      cinfo->src = (struct jpeg_source_mgr *) src;
-      src->buffer = cinfo->mem->alloc_small ((j_common_ptr) cinfo,
-					     JPOOL_PERMANENT,
-					     JPEG_STDIO_BUFFER_SIZE);
-    }
+/* Wait until a worker has finished JOB, and take it out of the list
+   of finished jobs.  */
 
-  src->file = fp;
-  src->finished = 0;
-  src->mgr.init_source = our_common_init_source;
-  src->mgr.fill_input_buffer = our_stdio_fill_input_buffer;
-  src->mgr.skip_input_data = our_stdio_skip_input_data;
-  src->mgr.resync_to_restart = jpeg_resync_to_restart; /* Use default.  */
-  src->mgr.term_source = our_common_term_source;
-  src->mgr.bytes_in_buffer = 0;
-  src->mgr.next_input_byte = NULL;
+static void
+image_take_finished_job (struct image_load_job *job)
+{
+  struct image_load_job **p;
+
+  sys_mutex_lock (&image_load_mutex);
+  while (!job->done)
+    sys_cond_wait (&image_load_finished, &image_load_mutex);
+  for (p = &image_load_done; *p != job; p = &(*p)->next)
+    continue;
+  *p = job->next;
+  sys_mutex_unlock (&image_load_mutex);
 }
 
-/* Load image IMG for use on frame F.  Patterned after example.c
-   from the JPEG lib.  */
+/* Start loading the pixels of image IMG on frame F in a worker
+   thread, if `image-load-asynchronously' says so and IMG is a PNG or
+   JPEG image whose size can be read from its header.  Store the
+   native width and height of IMG in *WIDTH and *HEIGHT.  Value is
+   false if the image should be loaded synchronously.  */
 
 static bool
-jpeg_load_body (struct frame *f, struct image *img,
-		struct my_jpeg_error_mgr *mgr)
+image_start_async_load (struct frame *f, struct image *img,
+			int *width, int *height)
 {
-  Lisp_Object specified_file, specified_data;
-  FILE *volatile fp = NULL;
-  JSAMPARRAY buffer;
-  int row_stride, x, y;
-  int width, height;
-  int i, ir, ig, ib;
-  unsigned long *colors;
-  Emacs_Pix_Container ximg = NULL;
+  Lisp_Object data, file;
+  enum image_load_kind kind;
+  unsigned char *header;
+  ptrdiff_t size, header_size;
+  int fd = -1;
+  bool ok;
 
-  /* Open the JPEG file.  */
-  specified_file = image_spec_value (img->spec, QCfile, NULL);
-  specified_data = image_spec_value (img->spec, QCdata, NULL);
+  if (NILP (Vimage_load_asynchronously))
+    return false;
 
-  if (NILP (specified_data))
+  if (!image_load_kind (builtin_lisp_symbol (img->type->type), &kind))
+    return false;
+
+  data = image_spec_value (img->spec, QCdata, NULL);
+  if (NILP (data))
     {
-      int fd;
-      Lisp_Object file = image_find_image_fd (specified_file, &fd);
+      struct stat st;
+
+      file = image_find_image_fd (image_spec_value (img->spec, QCfile, NULL),
+				  &fd);
       if (!STRINGP (file))
+	return false;
+      if (fstat (fd, &st) != 0 || !S_ISREG (st.st_mode))
 	{
-	  image_error ("Cannot find image file `%s'", specified_file);
-	  return 0;
+	  emacs_close (fd);
+	  return false;
 	}
+      size = st.st_size;
+    }
+  else if (STRINGP (data))
+    size = SBYTES (data);
+  else
+    return false;
 
-      fp = fdopen (fd, "rb");
-      if (fp == NULL)
-	{
-	  image_error ("Cannot open `%s'", file);
-	  return 0;
-	}
+  /* Small images are loaded faster than a job is started.  */
+  if ((FIXNATP (Vimage_load_asynchronously)
+       && size < XFIXNAT (Vimage_load_asynchronously))
+      || !image_load_start_threads ())
+    {
+      if (0 <= fd)
+	emacs_close (fd);
+      return false;
     }
-  else if (!STRINGP (specified_data))
+
+  if (0 <= fd)
     {
-      image_error ("Invalid image data `%s'", specified_data);
-      return 0;
+      header = xmalloc (IMAGE_HEADER_BYTES);
+      header_size = emacs_read (fd, header, IMAGE_HEADER_BYTES);
+      ok = (image_header_size (kind, header, header_size, width, height)
+	    && lseek (fd, 0, SEEK_SET) == 0);
+      xfree (header);
     }
+  else
+    ok = image_header_size (kind, SDATA (data), SBYTES (data),
+			    width, height);
 
-  /* Customize libjpeg's error handling to call my_error_exit when an
-     error is detected.  This function will perform a longjmp.  */
-  mgr->cinfo.err = jpeg_std_error (&mgr->pub);
-  mgr->pub.error_exit = my_error_exit;
-  if (sys_setjmp (mgr->setjmp_buffer))
+  if (!ok || !check_image_size (f, *width, *height))
     {
-      switch (mgr->failure_code)
-	{
-	case MY_JPEG_ERROR_EXIT:
-	  {
-	    char buf[JMSG_LENGTH_MAX];
-	    mgr->cinfo.err->format_message ((j_common_ptr) &mgr->cinfo, buf);
-	    image_error ("Error reading JPEG image `%s': %s",
-			 img->spec, build_string (buf));
-	    break;
-	  }
+      if (0 <= fd)
+	emacs_close (fd);
+      return false;
+    }
 
-	case MY_JPEG_INVALID_IMAGE_SIZE:
-	  image_size_error ();
-	  break;
+  struct image_load_job *job = xzalloc (sizeof *job);
+  job->img = img;
+  job->cache = FRAME_IMAGE_CACHE (f);
+  job->kind = kind;
+  job->fd = fd;
+  if (fd < 0)
+    {
+      job->size = SBYTES (data);
+      job->data = xmalloc (job->size);
+      memcpy (job->data, SDATA (data), job->size);
+    }
 
-	case MY_JPEG_CANNOT_CREATE_X:
-	  break;
-	}
+  init_decoded_image (&job->decoded, f);
+#ifdef HAVE_PNG
+  if (kind == IMAGE_LOAD_PNG)
+    png_decode_background (f, img, &job->decoded);
+#endif
 
-      /* Close the input file and destroy the JPEG object.  */
-      if (fp)
-	fclose (fp);
-      jpeg_destroy_decompress (&mgr->cinfo);
+  img->load_pending_p = true;
+  img->load_job = job;
+  image_queue_job (job);
+  return true;
+}
 
-      /* If we already have an XImage, free that.  */
-      image_destroy_x_image (ximg);
-      /* Free pixmap and colors.  */
-      image_clear_image (f, img);
-      return 0;
-    }
+/* Wait until the pixels of image IMG, which is being loaded
+   asynchronously, have been loaded, and put them into IMG.  This may
+   be called during redisplay, so the frames showing IMG are redrawn
+   later by image_finish_loads.  */
 
-  /* Create the JPEG decompression object.  Let it read from fp.
-	 Read the JPEG image header.  */
-  jpeg_CreateDecompress (&mgr->cinfo, JPEG_LIB_VERSION, sizeof *&mgr->cinfo);
+void
+image_wait_for_load (struct image *img)
+{
+  struct image_load_job *job = img->load_job;
 
-  if (NILP (specified_data))
-    jpeg_file_src (&mgr->cinfo, fp);
-  else
-    jpeg_memory_src (&mgr->cinfo, SDATA (specified_data),
-		     SBYTES (specified_data));
+  image_take_finished_job (job);
+  job->redraw_p = image_install_job (job);
 
-  jpeg_read_header (&mgr->cinfo, 1);
+  /* Give the job back to image_finish_loads.  */
+  sys_mutex_lock (&image_load_mutex);
+  job->next = image_load_done;
+  image_load_done = job;
+  sys_mutex_unlock (&image_load_mutex);
+  emacs_write (image_load_pipe[1], "", 1);
+}
 
-  /* Customize decompression so that color quantization will be used.
-	 Start decompression.  */
-  mgr->cinfo.quantize_colors = 1;
-  jpeg_start_decompress (&mgr->cinfo);
-  width = img->width = mgr->cinfo.output_width;
-  height = img->height = mgr->cinfo.output_height;
+/* Forget about the asynchronous load of image IMG, which is being
+   freed.  */
 
-  if (!check_image_size (f, width, height))
+static void
+image_cancel_load (struct image *img)
+{
+  struct image_load_job *job = img->load_job;
+
+  sys_mutex_lock (&image_load_mutex);
+  job->cancelled = true;
+  sys_mutex_unlock (&image_load_mutex);
+  job->img = NULL;
+  img->load_job = NULL;
+  img->load_pending_p = false;
+}
+
+DEFUN ("image--decode-asynchronously", Fimage__decode_asynchronously,
+       Simage__decode_asynchronously, 1, 1, 0,
+       doc: /* Decode the images of SPECS concurrently in background threads.
+SPECS is a list of PNG and JPEG image specifications.  Value is a list
+with an element for each of them: (WIDTH . HEIGHT) if the image was
+decoded, or else a string describing the error.
+
+This is an internal function for testing the threads used by
+`image-load-asynchronously'; it needs no frame, and the pixels are
+discarded.  */)
+  (Lisp_Object specs)
+{
+  Lisp_Object tail, result = Qnil;
+  ptrdiff_t i, n = list_length (specs);
+  struct image_load_job **jobs;
+  USE_SAFE_ALLOCA;
+
+  for (tail = specs; CONSP (tail); tail = XCDR (tail))
     {
-      mgr->failure_code = MY_JPEG_INVALID_IMAGE_SIZE;
-      sys_longjmp (mgr->setjmp_buffer, 1);
+      Lisp_Object spec = XCAR (tail);
+      enum image_load_kind kind;
+      if (! (valid_image_p (spec)
+	     && image_load_kind (image_spec_value (spec, QCtype, NULL),
+				 &kind)))
+	signal_error ("Invalid PNG or JPEG image specification", spec);
     }
+  if (!image_load_start_threads ())
+    error ("Cannot start image decoding threads");
 
-  /* Create X image and pixmap.  */
-  if (!image_create_x_image_and_pixmap (f, img, width, height, 0, &ximg, 0))
+  SAFE_NALLOCA (jobs, 1, n);
+  for (i = 0, tail = specs; i < n; i++, tail = XCDR (tail))
     {
-      mgr->failure_code = MY_JPEG_CANNOT_CREATE_X;
-      sys_longjmp (mgr->setjmp_buffer, 1);
+      Lisp_Object spec = XCAR (tail);
+      Lisp_Object data = image_spec_value (spec, QCdata, NULL);
+      int fd = -1;
+
+      if (NILP (data)
+	  && !STRINGP (image_find_image_fd (image_spec_value (spec, QCfile,
+							      NULL),
+					    &fd)))
+	{
+	  jobs[i] = NULL;
+	  continue;
+	}
+
+      struct image_load_job *job = xzalloc (sizeof *job);
+      image_load_kind (image_spec_value (spec, QCtype, NULL), &job->kind);
+      job->fd = fd;
+      if (fd < 0)
+	{
+	  job->size = SBYTES (data);
+	  job->data = xmalloc (job->size);
+	  memcpy (job->data, SDATA (data), job->size);
+	}
+      init_decoded_image (&job->decoded, NULL);
+      jobs[i] = job;
+      image_queue_job (job);
     }
 
-  /* Allocate colors.  When color quantization is used,
-     mgr->cinfo.actual_number_of_colors has been set with the number of
-     colors generated, and mgr->cinfo.colormap is a two-dimensional array
-     of color indices in the range 0..mgr->cinfo.actual_number_of_colors.
-     No more than 255 colors will be generated.  */
-  USE_SAFE_ALLOCA;
-  {
-    if (mgr->cinfo.out_color_components > 2)
-      ir = 0, ig = 1, ib = 2;
-    else if (mgr->cinfo.out_color_components > 1)
-      ir = 0, ig = 1, ib = 0;
-    else
-      ir = 0, ig = 0, ib = 0;
-
-    /* Use the color table mechanism because it handles colors that
-       cannot be allocated nicely.  Such colors will be replaced with
-       a default color, and we don't have to care about which colors
-       can be freed safely, and which can't.  */
-    init_color_table ();
-    SAFE_NALLOCA (colors, 1, mgr->cinfo.actual_number_of_colors);
+  for (i = n - 1; 0 <= i; i--)
+    {
+      struct image_load_job *job = jobs[i];
+      Lisp_Object value;
 
-    for (i = 0; i < mgr->cinfo.actual_number_of_colors; ++i)
-      {
-	/* Multiply RGB values with 255 because X expects RGB values
-	   in the range 0..0xffff.  */
-	int r = mgr->cinfo.colormap[ir][i] << 8;
-	int g = mgr->cinfo.colormap[ig][i] << 8;
-	int b = mgr->cinfo.colormap[ib][i] << 8;
-	colors[i] = lookup_rgb_color (f, r, g, b);
-      }
+      if (!job)
+	{
+	  result = Fcons (build_string ("Cannot find image file"), result);
+	  continue;
+	}
 
-#ifdef COLOR_TABLE_SUPPORT
-    /* Remember those colors actually allocated.  */
-    img->colors = colors_in_color_table (&img->ncolors);
-    free_color_table ();
-#endif /* COLOR_TABLE_SUPPORT */
-  }
+      image_take_finished_job (job);
+      if (job->decoded.pixels)
+	value = Fcons (make_fixnum (job->decoded.width),
+		       make_fixnum (job->decoded.height));
+      else if (job->decoded.too_large_p)
+	value = build_string ("Image too large");
+      else
+	value = build_string (job->decoded.error);
+      result = Fcons (value, result);
 
-  /* Read pixels.  */
-  row_stride = width * mgr->cinfo.output_components;
-  buffer = mgr->cinfo.mem->alloc_sarray ((j_common_ptr) &mgr->cinfo,
-					 JPOOL_IMAGE, row_stride, 1);
-  for (y = 0; y < height; ++y)
-    {
-      jpeg_read_scanlines (&mgr->cinfo, buffer, 1);
-      for (x = 0; x < mgr->cinfo.output_width; ++x)
-	PUT_PIXEL (ximg, x, y, colors[buffer[0][x]]);
+      xfree (job->data);
+      free (job->decoded.pixels);
+      xfree (job);
     }
 
-  /* Clean up.  */
-  jpeg_finish_decompress (&mgr->cinfo);
-  jpeg_destroy_decompress (&mgr->cinfo);
-  if (fp)
-    fclose (fp);
+  SAFE_FREE ();
+  return result;
+}
 
-  /* Maybe fill in the background field while we have ximg handy. */
-  if (NILP (image_spec_value (img->spec, QCbackground, NULL)))
-    /* Casting avoids a GCC warning.  */
-    IMAGE_BACKGROUND (img, f, (Emacs_Pix_Context)ximg);
+#else  /* !USE_ASYNC_IMAGE_LOAD */
 
-  /* Put ximg into the image.  */
-  image_put_x_image (f, img, ximg, 0);
-  SAFE_FREE ();
-  return 1;
+void
+image_wait_for_load (struct image *img)
+{
 }
 
-static bool
-jpeg_load (struct frame *f, struct image *img)
+void
+image_finish_loads (void)
 {
-  struct my_jpeg_error_mgr mgr;
-  return jpeg_load_body (f, img, &mgr);
 }
 
-#endif /* !HAVE_JPEG */
+#endif /* !USE_ASYNC_IMAGE_LOAD */
 
 
 
@@ -11098,6 +12216,12 @@ syms_of_image (void)
   DEFSYM (QCcolor_adjustment, ":color-adjustment");
   DEFSYM (QCmask, ":mask");
 
+  /* Keywords used in the value of `image-cache-statistics'.  */
+  DEFSYM (QCimages, ":images");
+  DEFSYM (QCbytes, ":bytes");
+  DEFSYM (QCpeak_bytes, ":peak-bytes");
+  DEFSYM (QCevictions, ":evictions");
+
   /* Other symbols.  */
   DEFSYM (Qlaplace, "laplace");
   DEFSYM (Qemboss, "emboss");
@@ -11232,6 +12356,7 @@ syms_of_image (void)
   defsubr (&Simage_mask_p);
   defsubr (&Simage_metadata);
   defsubr (&Simage_cache_size);
+  defsubr (&Simage_cache_statistics);
 
 #ifdef GLYPH_DEBUG
   defsubr (&Simagep);
@@ -11239,6 +12364,9 @@ syms_of_image (void)
 #endif
 
   defsubr (&Simage_transforms_p);
+#ifdef USE_ASYNC_IMAGE_LOAD
+  defsubr (&Simage__decode_asynchronously);
+#endif
 
   DEFVAR_BOOL ("cross-disabled-images", cross_disabled_images,
     doc: /* Non-nil means always draw a cross over disabled images.
@@ -11259,6 +12387,28 @@ syms_of_image (void)
 
 The function `clear-image-cache' disregards this variable.  */);
   Vimage_cache_eviction_delay = make_fixnum (300);
+
+  DEFVAR_LISP ("image-cache-size-limit", Vimage_cache_size_limit,
+    doc: /* Maximum number of bytes of pixel data in an image cache.
+When the decoded pixels of the images in the image cache of a display
+take more than this many bytes, Emacs frees the pixels of the least
+recently displayed images, but keeps their size and specification; the
+pixels are decoded again when the images are next displayed.  The
+value can also be nil, meaning there is no limit.
+
+See also `image-cache-eviction-delay' and `image-cache-statistics'.  */);
+  Vimage_cache_size_limit = make_fixnum (256 * 1024 * 1024);
+
+  DEFVAR_LISP ("image-load-asynchronously", Vimage_load_asynchronously,
+    doc: /* Whether to decode images in background threads.
+If non-nil, the pixels of PNG and JPEG images whose size can be found
+in their header are decoded by background threads, so that redisplay
+doesn't have to wait for them.  Until an image has been decoded, an
+empty box of its size is displayed in its place.  If the value is an
+integer, only images of at least that many bytes are decoded in the
+background.  This variable has no effect if Emacs was built without
+support for threads.  */);
+  Vimage_load_asynchronously = Qnil;
 #ifdef HAVE_IMAGEMAGICK
   DEFVAR_INT ("imagemagick-render-type", imagemagick_render_type,
     doc: /* Integer indicating which ImageMagick rendering method to use.
@@ -911,6 +911,7 @@ insert_1_both (const char *string,
   record_insert (PT, nchars);
   modiff_incr (&MODIFF);
   CHARS_MODIFF = MODIFF;
+  BUF_COMPUTE_UNHASHED (current_buffer, PT);
 
   memcpy (GPT_ADDR, string, nbytes);
 
@@ -1039,6 +1040,7 @@ insert_from_string_1 (Lisp_Object string, ptrdiff_t pos, ptrdiff_t pos_byte,
   record_insert (PT, nchars);
   modiff_incr (&MODIFF);
   CHARS_MODIFF = MODIFF;
+  BUF_COMPUTE_UNHASHED (current_buffer, PT);
 
   GAP_SIZE -= outgoing_nbytes;
   GPT += nchars;
@@ -1088,6 +1090,7 @@ insert_from_gap_1 (ptrdiff_t nchars, ptrdiff_t nbytes, bool text_at_gap_tail)
   eassert (NILP (BVAR (current_buffer, enable_multibyte_characters))
            ? nchars == nbytes : nchars <= nbytes);
 
+  BUF_COMPUTE_UNHASHED (current_buffer, GPT);
   GAP_SIZE -= nbytes;
   if (! text_at_gap_tail)
     {
@@ -1143,6 +1146,34 @@ insert_from_gap (ptrdiff_t nchars, ptrdiff_t nbytes, bool text_at_gap_tail)
   check_markers ();
 }
 
+/* Finish an insertion at FROM / FROM_BYTE of the text up to TO /
+   TO_BYTE, which insert_from_gap has made part of the buffer, so that
+   it looks like an insertion before markers at point: relocate point
+   and the markers at FROM to TO, and record the change of the
+   buffer's characters.  */
+
+void
+adjust_after_insert_before_markers (ptrdiff_t from, ptrdiff_t from_byte,
+				    ptrdiff_t to, ptrdiff_t to_byte)
+{
+  struct Lisp_Marker *m;
+
+  for (m = BUF_MARKERS (current_buffer); m; m = m->next)
+    if (m->bytepos == from_byte)
+      {
+	m->bytepos = to_byte;
+	m->charpos = to;
+      }
+  if (PT == from)
+    adjust_point (to - from, to_byte - from_byte);
+
+  CHARS_MODIFF = MODIFF;
+  if (Z - to < END_UNCHANGED)
+    END_UNCHANGED = Z - to;
+
+  check_markers ();
+}
+
 /* Insert text from BUF, NCHARS characters starting at CHARPOS, into the
    current buffer.  If the text in BUF has properties, they are absorbed
    into the current buffer.
@@ -1252,6 +1283,7 @@ insert_from_buffer_1 (struct buffer *buf,
   record_insert (PT, nchars);
   modiff_incr (&MODIFF);
   CHARS_MODIFF = MODIFF;
+  BUF_COMPUTE_UNHASHED (current_buffer, PT);
 
   GAP_SIZE -= outgoing_nbytes;
   GPT += nchars;
@@ -1353,6 +1385,7 @@ adjust_after_replace (ptrdiff_t from, ptrdiff_t from_byte,
     evaporate_overlays (from);
   modiff_incr (&MODIFF);
   CHARS_MODIFF = MODIFF;
+  BUF_COMPUTE_UNHASHED (current_buffer, from);
 }
 
 /* Record undo information, adjust markers and position keepers for an
@@ -1548,6 +1581,7 @@ replace_range (ptrdiff_t from, ptrdiff_t to, Lisp_Object new,
 
   modiff_incr (&MODIFF);
   CHARS_MODIFF = MODIFF;
+  BUF_COMPUTE_UNHASHED (current_buffer, from);
 
   if (adjust_match_data)
     update_search_regs (from, to, from + SCHARS (new));
@@ -1682,6 +1716,7 @@ replace_range_2 (ptrdiff_t from, ptrdiff_t from_byte,
 
   modiff_incr (&MODIFF);
   CHARS_MODIFF = MODIFF;
+  BUF_COMPUTE_UNHASHED (current_buffer, from);
 }
 
 /* Delete characters in current buffer
@@ -1857,6 +1892,7 @@ del_range_2 (ptrdiff_t from, ptrdiff_t from_byte,
 
   modiff_incr (&MODIFF);
   CHARS_MODIFF = MODIFF;
+  BUF_COMPUTE_UNHASHED (current_buffer, from);
 
   /* Relocate point as if it were a marker.  */
   if (from < PT)
@@ -2030,6 +2066,7 @@ invalidate_buffer_caches (struct buffer *buf, ptrdiff_t start, ptrdiff_t end)
      need to consider the caches of their base buffer.  */
   if (buf->base_buffer)
     buf = buf->base_buffer;
+  BUF_COMPUTE_UNHASHED (buf, start);
   /* The bidi_paragraph_cache must be invalidated first, because doing
      so might need to use the newline_cache (via find_newline_no_quit,
      see below).  */
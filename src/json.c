@@ -19,907 +19,1567 @@ Copyright (C) 2017-2021 Free Software Foundation, Inc.
 
 #include <config.h>
 
-#include <errno.h>
+#include <math.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 
-#include <jansson.h>
+#include <ftoastr.h>
 
 #include "lisp.h"
 #include "buffer.h"
+#include "character.h"
 #include "coding.h"
+#include "composite.h"
+#include "process.h"
 
-#define JSON_HAS_ERROR_CODE (JANSSON_VERSION_HEX >= 0x020B00)
-
-#ifdef WINDOWSNT
-# include <windows.h>
-# include "w32common.h"
-# include "w32.h"
-
-DEF_DLL_FN (void, json_set_alloc_funcs,
-	    (json_malloc_t malloc_fn, json_free_t free_fn));
-DEF_DLL_FN (void, json_delete, (json_t *json));
-DEF_DLL_FN (json_t *, json_array, (void));
-DEF_DLL_FN (int, json_array_append_new, (json_t *array, json_t *value));
-DEF_DLL_FN (size_t, json_array_size, (const json_t *array));
-DEF_DLL_FN (json_t *, json_object, (void));
-DEF_DLL_FN (int, json_object_set_new,
-	    (json_t *object, const char *key, json_t *value));
-DEF_DLL_FN (json_t *, json_null, (void));
-DEF_DLL_FN (json_t *, json_true, (void));
-DEF_DLL_FN (json_t *, json_false, (void));
-DEF_DLL_FN (json_t *, json_integer, (json_int_t value));
-DEF_DLL_FN (json_t *, json_real, (double value));
-DEF_DLL_FN (json_t *, json_stringn, (const char *value, size_t len));
-DEF_DLL_FN (char *, json_dumps, (const json_t *json, size_t flags));
-DEF_DLL_FN (int, json_dump_callback,
-	    (const json_t *json, json_dump_callback_t callback, void *data,
-	     size_t flags));
-DEF_DLL_FN (json_int_t, json_integer_value, (const json_t *integer));
-DEF_DLL_FN (double, json_real_value, (const json_t *real));
-DEF_DLL_FN (const char *, json_string_value, (const json_t *string));
-DEF_DLL_FN (size_t, json_string_length, (const json_t *string));
-DEF_DLL_FN (json_t *, json_array_get, (const json_t *array, size_t index));
-DEF_DLL_FN (json_t *, json_object_get, (const json_t *object, const char *key));
-DEF_DLL_FN (size_t, json_object_size, (const json_t *object));
-DEF_DLL_FN (const char *, json_object_iter_key, (void *iter));
-DEF_DLL_FN (void *, json_object_iter, (json_t *object));
-DEF_DLL_FN (json_t *, json_object_iter_value, (void *iter));
-DEF_DLL_FN (void *, json_object_key_to_iter, (const char *key));
-DEF_DLL_FN (void *, json_object_iter_next, (json_t *object, void *iter));
-DEF_DLL_FN (json_t *, json_loads,
-	    (const char *input, size_t flags, json_error_t *error));
-DEF_DLL_FN (json_t *, json_load_callback,
-	    (json_load_callback_t callback, void *data, size_t flags,
-	     json_error_t *error));
-
-/* This is called by json_decref, which is an inline function.  */
-void json_delete(json_t *json)
+/* Return a unibyte string containing the sequence of UTF-8 encoding
+   units of the UTF-8 representation of STRING.  If STRING does not
+   represent a sequence of Unicode scalar values, return a string with
+   unspecified contents.  */
+
+static Lisp_Object
+json_encode (Lisp_Object string)
 {
-  fn_json_delete (json);
+  /* FIXME: Raise an error if STRING is not a scalar value
+     sequence.  */
+  return encode_string_utf_8 (string, Qnil, false, Qt, Qt);
 }
 
-static bool json_initialized;
+/* Signal an error if OBJECT is not a string, or if OBJECT contains
+   embedded null characters.  */
 
-static bool
-init_json_functions (void)
+static void
+check_string_without_embedded_nulls (Lisp_Object object)
 {
-  HMODULE library = w32_delayed_load (Qjson);
+  CHECK_STRING (object);
+  CHECK_TYPE (memchr (SDATA (object), '\0', SBYTES (object)) == NULL,
+              Qstring_without_embedded_nulls_p, object);
+}
 
-  if (!library)
-    return false;
+enum json_object_type {
+  json_object_hashtable,
+  json_object_alist,
+  json_object_plist
+};
 
-  LOAD_DLL_FN (library, json_set_alloc_funcs);
-  LOAD_DLL_FN (library, json_delete);
-  LOAD_DLL_FN (library, json_array);
-  LOAD_DLL_FN (library, json_array_append_new);
-  LOAD_DLL_FN (library, json_array_size);
-  LOAD_DLL_FN (library, json_object);
-  LOAD_DLL_FN (library, json_object_set_new);
-  LOAD_DLL_FN (library, json_null);
-  LOAD_DLL_FN (library, json_true);
-  LOAD_DLL_FN (library, json_false);
-  LOAD_DLL_FN (library, json_integer);
-  LOAD_DLL_FN (library, json_real);
-  LOAD_DLL_FN (library, json_stringn);
-  LOAD_DLL_FN (library, json_dumps);
-  LOAD_DLL_FN (library, json_dump_callback);
-  LOAD_DLL_FN (library, json_integer_value);
-  LOAD_DLL_FN (library, json_real_value);
-  LOAD_DLL_FN (library, json_string_value);
-  LOAD_DLL_FN (library, json_string_length);
-  LOAD_DLL_FN (library, json_array_get);
-  LOAD_DLL_FN (library, json_object_get);
-  LOAD_DLL_FN (library, json_object_size);
-  LOAD_DLL_FN (library, json_object_iter_key);
-  LOAD_DLL_FN (library, json_object_iter);
-  LOAD_DLL_FN (library, json_object_iter_value);
-  LOAD_DLL_FN (library, json_object_key_to_iter);
-  LOAD_DLL_FN (library, json_object_iter_next);
-  LOAD_DLL_FN (library, json_loads);
-  LOAD_DLL_FN (library, json_load_callback);
-
-  init_json ();
+enum json_array_type {
+  json_array_array,
+  json_array_list
+};
 
-  return true;
-}
+struct json_configuration {
+  enum json_object_type object_type;
+  enum json_array_type array_type;
+  Lisp_Object null_object;
+  Lisp_Object false_object;
+};
 
-#define json_set_alloc_funcs fn_json_set_alloc_funcs
-#define json_array fn_json_array
-#define json_array_append_new fn_json_array_append_new
-#define json_array_size fn_json_array_size
-#define json_object fn_json_object
-#define json_object_set_new fn_json_object_set_new
-#define json_null fn_json_null
-#define json_true fn_json_true
-#define json_false fn_json_false
-#define json_integer fn_json_integer
-#define json_real fn_json_real
-#define json_stringn fn_json_stringn
-#define json_dumps fn_json_dumps
-#define json_dump_callback fn_json_dump_callback
-#define json_integer_value fn_json_integer_value
-#define json_real_value fn_json_real_value
-#define json_string_value fn_json_string_value
-#define json_string_length fn_json_string_length
-#define json_array_get fn_json_array_get
-#define json_object_get fn_json_object_get
-#define json_object_size fn_json_object_size
-#define json_object_iter_key fn_json_object_iter_key
-#define json_object_iter fn_json_object_iter
-#define json_object_iter_value fn_json_object_iter_value
-#define json_object_key_to_iter fn_json_object_key_to_iter
-#define json_object_iter_next fn_json_object_iter_next
-#define json_loads fn_json_loads
-#define json_load_callback fn_json_load_callback
-
-#endif	/* WINDOWSNT */
-
-/* We install a custom allocator so that we can avoid objects larger
-   than PTRDIFF_MAX.  Such objects wouldn't play well with the rest of
-   Emacs's codebase, which generally uses ptrdiff_t for sizes and
-   indices.  The other functions in this file also generally assume
-   that size_t values never exceed PTRDIFF_MAX.
-
-   In addition, we need to use a custom allocator because on
-   MS-Windows we replace malloc/free with our own functions, see
-   w32heap.c, so we must force the library to use our allocator, or
-   else we won't be able to free storage allocated by the library.  */
-
-static void *
-json_malloc (size_t size)
+static void
+json_parse_args (ptrdiff_t nargs,
+                 Lisp_Object *args,
+                 struct json_configuration *conf,
+                 bool parse_object_types)
 {
-  if (size > PTRDIFF_MAX)
-    {
-      errno = ENOMEM;
-      return NULL;
-    }
-  return malloc (size);
+  if ((nargs % 2) != 0)
+    wrong_type_argument (Qplistp, Flist (nargs, args));
+
+  /* Start from the back so keyword values appearing
+     first take precedence. */
+  for (ptrdiff_t i = nargs; i > 0; i -= 2) {
+    Lisp_Object key = args[i - 2];
+    Lisp_Object value = args[i - 1];
+    if (parse_object_types && EQ (key, QCobject_type))
+      {
+        if (EQ (value, Qhash_table))
+          conf->object_type = json_object_hashtable;
+        else if (EQ (value, Qalist))
+          conf->object_type = json_object_alist;
+        else if (EQ (value, Qplist))
+          conf->object_type = json_object_plist;
+        else
+          wrong_choice (list3 (Qhash_table, Qalist, Qplist), value);
+      }
+    else if (parse_object_types && EQ (key, QCarray_type))
+      {
+        if (EQ (value, Qarray))
+          conf->array_type = json_array_array;
+        else if (EQ (value, Qlist))
+          conf->array_type = json_array_list;
+        else
+          wrong_choice (list2 (Qarray, Qlist), value);
+      }
+    else if (EQ (key, QCnull_object))
+      conf->null_object = value;
+    else if (EQ (key, QCfalse_object))
+      conf->false_object = value;
+    else if (parse_object_types)
+      wrong_choice (list4 (QCobject_type,
+                           QCarray_type,
+                           QCnull_object,
+                           QCfalse_object),
+                    value);
+    else
+      wrong_choice (list2 (QCnull_object,
+                           QCfalse_object),
+                    value);
+  }
 }
 
-static void
-json_free (void *ptr)
+/* Return the length of the UTF-8 sequence that starts with the byte
+   C, which is not ASCII, or 0 if C can't start a sequence.  */
+
+static int
+json_utf8_sequence_length (int c)
 {
-  free (ptr);
+  return (c < 0xC2 ? 0
+	  : c < 0xE0 ? 2
+	  : c < 0xF0 ? 3
+	  : c < 0xF5 ? 4
+	  : 0);
 }
 
-void
-init_json (void)
+/* Return true if the LEN bytes at P, whose first byte has been
+   checked by json_utf8_sequence_length, encode a Unicode scalar
+   value.  This rejects overlong sequences, surrogates and code
+   points beyond U+10FFFF.  */
+
+static bool
+json_utf8_sequence_valid_p (const unsigned char *p, int len)
 {
-  json_set_alloc_funcs (json_malloc, json_free);
+  int lo = p[0] == 0xE0 ? 0xA0 : p[0] == 0xF0 ? 0x90 : 0x80;
+  int hi = p[0] == 0xED ? 0x9F : p[0] == 0xF4 ? 0x8F : 0xBF;
+  if (! (lo <= p[1] && p[1] <= hi))
+    return false;
+  for (int i = 2; i < len; i++)
+    if ((p[i] & 0xC0) != 0x80)
+      return false;
+  return true;
 }
 
-#if !JSON_HAS_ERROR_CODE
+/* The JSON serializer.
 
-/* Return whether STRING starts with PREFIX.  */
+   Lisp objects are written as compact JSON text straight into an
+   output area, without building an intermediate tree.  The output
+   area is either memory allocated with xmalloc, which then becomes a
+   string or is sent to a process, or the gap of the current buffer,
+   where the text can be made part of the buffer as it is.  The text
+   is always valid UTF-8, which is also the internal representation of
+   the characters it encodes, so it never needs to be decoded; its
+   characters are counted while it is written.
 
-static bool
-json_has_prefix (const char *string, const char *prefix)
+   Like the parser, the serializer never calls Lisp.  */
+
+/* The number of bytes of a string that are escaped after making room
+   for the output at once.  */
+enum { JSON_OUT_STRING_CHUNK = 1024 };
+
+/* An object key that has been written.  */
+
+struct json_out_key
+{
+  /* Where the key, with its quotes, is in the output.  */
+  ptrdiff_t offset;
+  ptrdiff_t nbytes;
+
+  /* A hash of the bytes of the key.  */
+  unsigned int hash;
+
+  /* The key written before it with the same hash bucket, or -1.  */
+  ptrdiff_t next;
+};
+
+struct json_out
+{
+  /* True if the output goes into the gap of the current buffer, which
+     starts at GPT_ADDR; otherwise it goes into BUFFER, which has room
+     for CAPACITY bytes.  */
+  bool to_gap;
+  unsigned char *buffer;
+  ptrdiff_t capacity;
+
+  /* The number of bytes written, and how many of them don't start a
+     character, so that SIZE - CHARS_DELTA is the number of characters
+     written.  */
+  ptrdiff_t size;
+  ptrdiff_t chars_delta;
+
+  const struct json_configuration *conf;
+
+  /* The keys of the objects being written, outermost object first,
+     which are used to detect duplicate keys.  */
+  struct json_out_key *keys;
+  ptrdiff_t keys_size;
+  ptrdiff_t keys_current;
+
+  /* The most recently written key of each hash bucket, or -1.  The
+     number of buckets is a power of 2.  The keys of a bucket are
+     chained in the reverse order of KEYS, so that the keys of the
+     innermost object come first.  */
+  ptrdiff_t *key_buckets;
+  ptrdiff_t key_buckets_size;
+};
+
+static void
+json_out_init (struct json_out *out, const struct json_configuration *conf,
+	       bool to_gap)
+{
+  out->to_gap = to_gap;
+  out->buffer = NULL;
+  out->capacity = 0;
+  out->size = 0;
+  out->chars_delta = 0;
+  out->conf = conf;
+  out->keys = NULL;
+  out->keys_size = 0;
+  out->keys_current = 0;
+  out->key_buckets = NULL;
+  out->key_buckets_size = 0;
+}
+
+static void
+json_out_done (void *out)
 {
-  return strncmp (string, prefix, strlen (prefix)) == 0;
+  struct json_out *o = out;
+  xfree (o->buffer);
+  xfree (o->keys);
+  xfree (o->key_buckets);
 }
 
-/* Return whether STRING ends with SUFFIX.  */
+/* Return the address of the byte at OFFSET in the output of OUT.  */
 
-static bool
-json_has_suffix (const char *string, const char *suffix)
+static unsigned char *
+json_out_address (struct json_out *out, ptrdiff_t offset)
 {
-  size_t string_len = strlen (string);
-  size_t suffix_len = strlen (suffix);
-  return string_len >= suffix_len
-    && memcmp (string + string_len - suffix_len, suffix, suffix_len) == 0;
+  return (out->to_gap ? GPT_ADDR : out->buffer) + offset;
 }
 
-#endif
+/* Make room for NBYTES more bytes of output, and return the address
+   where they go.  */
 
-/* Note that all callers of make_string_from_utf8 and build_string_from_utf8
-   below either pass only value UTF-8 strings or use the functionf for
-   formatting error messages; in the latter case correctness isn't
-   critical.  */
+static unsigned char *
+json_out_reserve (struct json_out *out, ptrdiff_t nbytes)
+{
+  if (out->to_gap)
+    {
+      if (GAP_SIZE - out->size < nbytes)
+	make_gap (nbytes - (GAP_SIZE - out->size));
+    }
+  else if (out->capacity - out->size < nbytes)
+    out->buffer = xpalloc (out->buffer, &out->capacity,
+			   nbytes - (out->capacity - out->size), -1, 1);
+  return json_out_address (out, out->size);
+}
 
-/* Return a unibyte string containing the sequence of UTF-8 encoding
-   units of the UTF-8 representation of STRING.  If STRING does not
-   represent a sequence of Unicode scalar values, return a string with
-   unspecified contents.  */
+static void
+json_out_byte (struct json_out *out, unsigned char c)
+{
+  *json_out_reserve (out, 1) = c;
+  out->size++;
+}
 
-static Lisp_Object
-json_encode (Lisp_Object string)
+/* Write the NBYTES ASCII characters at TEXT.  */
+
+static void
+json_out_ascii (struct json_out *out, const char *text, ptrdiff_t nbytes)
 {
-  /* FIXME: Raise an error if STRING is not a scalar value
-     sequence.  */
-  return encode_string_utf_8 (string, Qnil, false, Qt, Qt);
+  memcpy (json_out_reserve (out, nbytes), text, nbytes);
+  out->size += nbytes;
 }
 
-static AVOID
-json_out_of_memory (void)
+/* Write the NBYTES bytes at P as the contents of a JSON string,
+   escaping quotes, backslashes and control characters.  Return false
+   if they are not valid UTF-8 encoding Unicode scalar values; in that
+   case, part of them may have been written.  */
+
+static bool
+json_out_string_bytes (struct json_out *out, const unsigned char *p,
+		       ptrdiff_t nbytes)
 {
-  xsignal0 (Qjson_out_of_memory);
+  static char const hexdigits[] = "0123456789ABCDEF";
+  const unsigned char *end = p + nbytes;
+  while (p < end)
+    {
+      /* No byte is written as more than 6 bytes, and the last
+	 sequence may extend past the end of the chunk.  */
+      ptrdiff_t chunk = min (end - p, JSON_OUT_STRING_CHUNK);
+      const unsigned char *chunk_end = p + chunk;
+      unsigned char *dest
+	= json_out_reserve (out, 6 * chunk + MAX_MULTIBYTE_LENGTH);
+      unsigned char *d = dest;
+      while (p < chunk_end)
+	{
+	  int c = *p;
+	  if (c >= 0x80)
+	    {
+	      int len = json_utf8_sequence_length (c);
+	      if (len == 0 || end - p < len
+		  || !json_utf8_sequence_valid_p (p, len))
+		return false;
+	      memcpy (d, p, len);
+	      d += len;
+	      p += len;
+	      out->chars_delta += len - 1;
+	      continue;
+	    }
+	  p++;
+	  if (c >= 0x20 && c != '"' && c != '\\')
+	    {
+	      *d++ = c;
+	      continue;
+	    }
+	  *d++ = '\\';
+	  switch (c)
+	    {
+	    case '"': case '\\':
+	      *d++ = c;
+	      break;
+	    case '\b':
+	      *d++ = 'b';
+	      break;
+	    case '\f':
+	      *d++ = 'f';
+	      break;
+	    case '\n':
+	      *d++ = 'n';
+	      break;
+	    case '\r':
+	      *d++ = 'r';
+	      break;
+	    case '\t':
+	      *d++ = 't';
+	      break;
+	    default:
+	      d[0] = 'u';
+	      d[1] = '0';
+	      d[2] = '0';
+	      d[3] = hexdigits[c >> 4];
+	      d[4] = hexdigits[c & 0xF];
+	      d += 5;
+	    }
+	}
+      out->size += d - dest;
+    }
+  return true;
 }
 
-/* Signal a Lisp error corresponding to the JSON ERROR.  */
+/* Write STRING as a JSON string, without its first SKIP bytes, which
+   must be ASCII.  Signal an error of type `wrong-type-argument' if it
+   can't be encoded as UTF-8.  */
 
-static AVOID
-json_parse_error (const json_error_t *error)
+static void
+json_out_string (struct json_out *out, Lisp_Object string, ptrdiff_t skip)
 {
-  Lisp_Object symbol;
-#if JSON_HAS_ERROR_CODE
-  switch (json_error_code (error))
+  ptrdiff_t size = out->size;
+  ptrdiff_t chars_delta = out->chars_delta;
+  json_out_byte (out, '"');
+  if (!json_out_string_bytes (out, SDATA (string) + skip,
+			      SBYTES (string) - skip))
     {
-    case json_error_premature_end_of_input:
-      symbol = Qjson_end_of_file;
-      break;
-    case json_error_end_of_input_expected:
-      symbol = Qjson_trailing_content;
-      break;
-    default:
-      symbol = Qjson_parse_error;
-      break;
+      /* The string isn't valid UTF-8 as it is, but if it is multibyte,
+	 its raw 8-bit bytes may still encode valid UTF-8 together with
+	 the rest, so try again with the bytes encoding would produce.
+	 This is rare, and what `json-serialize' always did.  */
+      Lisp_Object encoded = json_encode (string);
+      out->size = size + 1;
+      out->chars_delta = chars_delta;
+      if (! (STRING_MULTIBYTE (string)
+	     && json_out_string_bytes (out, SDATA (encoded) + skip,
+				       SBYTES (encoded) - skip)))
+	wrong_type_argument (Qutf_8_string_p, encoded);
     }
-#else
-  if (json_has_suffix (error->text, "expected near end of file"))
-    symbol = Qjson_end_of_file;
-  else if (json_has_prefix (error->text, "end of file expected"))
-    symbol = Qjson_trailing_content;
-  else
-    symbol = Qjson_parse_error;
-#endif
-  xsignal (symbol,
-           list5 (build_string_from_utf8 (error->text),
-                  build_string_from_utf8 (error->source),
-		  INT_TO_INTEGER (error->line),
-                  INT_TO_INTEGER (error->column),
-		  INT_TO_INTEGER (error->position)));
+  json_out_byte (out, '"');
 }
 
 static void
-json_release_object (void *object)
+json_out_integer (struct json_out *out, Lisp_Object number)
 {
-  json_decref (object);
+  if (FIXNUMP (number))
+    {
+      char *p = (char *) json_out_reserve (out,
+					   INT_BUFSIZE_BOUND (EMACS_INT));
+      out->size += sprintf (p, "%"pI"d", XFIXNUM (number));
+    }
+  else
+    {
+      ptrdiff_t size = bignum_bufsize (number, 10);
+      char *p = (char *) json_out_reserve (out, size);
+      out->size += bignum_to_c_string (p, size, number, 10);
+    }
 }
 
-/* Signal an error if OBJECT is not a string, or if OBJECT contains
-   embedded null characters.  */
+/* Write NUMBER, a float, in the shortest form that reads back as the
+   same number.  Signal an error of type `wrong-type-argument' if it
+   is infinite or a NaN, which JSON can't represent.  */
 
 static void
-check_string_without_embedded_nulls (Lisp_Object object)
+json_out_float (struct json_out *out, Lisp_Object number)
 {
-  CHECK_STRING (object);
-  CHECK_TYPE (memchr (SDATA (object), '\0', SBYTES (object)) == NULL,
-              Qstring_without_embedded_nulls_p, object);
+  double value = XFLOAT_DATA (number);
+  if (!isfinite (value))
+    wrong_type_argument (Qjson_value_p, number);
+  char *p = (char *) json_out_reserve (out, DBL_BUFSIZE_BOUND + 2);
+  int len = dtoastr (p, DBL_BUFSIZE_BOUND, 0, 0, value);
+  /* Make integral values read back as floats, like the Lisp printer
+     does.  */
+  if (!memchr (p, '.', len) && !memchr (p, 'e', len))
+    {
+      p[len++] = '.';
+      p[len++] = '0';
+    }
+  out->size += len;
 }
 
-/* Signal an error of type `json-out-of-memory' if OBJECT is
-   NULL.  */
+/* Record the key that has just been written at OFFSET, NBYTES bytes
+   long, as a key of the object whose keys start at FIRST in the keys
+   of OUT.  Return false, and record nothing, if that object already
+   has this key.  */
 
-static json_t *
-json_check (json_t *object)
+static bool
+json_out_add_key (struct json_out *out, ptrdiff_t first,
+		  ptrdiff_t offset, ptrdiff_t nbytes)
 {
-  if (object == NULL)
-    json_out_of_memory ();
-  return object;
+  if (out->keys_current == out->keys_size)
+    {
+      out->keys = xpalloc (out->keys, &out->keys_size, 1, -1,
+			   sizeof *out->keys);
+      if (out->key_buckets_size < out->keys_size)
+	{
+	  ptrdiff_t size = max (out->key_buckets_size, 16);
+	  while (size < out->keys_size)
+	    size *= 2;
+	  ptrdiff_t *buckets = xnmalloc (size, sizeof *buckets);
+	  xfree (out->key_buckets);
+	  out->key_buckets = buckets;
+	  out->key_buckets_size = size;
+	  for (ptrdiff_t i = 0; i < size; i++)
+	    buckets[i] = -1;
+	  for (ptrdiff_t i = 0; i < out->keys_current; i++)
+	    {
+	      ptrdiff_t *bucket = &buckets[out->keys[i].hash & (size - 1)];
+	      out->keys[i].next = *bucket;
+	      *bucket = i;
+	    }
+	}
+    }
+
+  const unsigned char *key = json_out_address (out, offset);
+  unsigned int hash = nbytes;
+  for (ptrdiff_t i = 0; i < nbytes; i++)
+    hash = hash * 31 + key[i];
+  ptrdiff_t *bucket
+    = &out->key_buckets[hash & (out->key_buckets_size - 1)];
+  for (ptrdiff_t i = *bucket; i >= first; i = out->keys[i].next)
+    if (out->keys[i].hash == hash && out->keys[i].nbytes == nbytes
+	&& memcmp (json_out_address (out, out->keys[i].offset), key,
+		   nbytes) == 0)
+      return false;
+
+  struct json_out_key *k = &out->keys[out->keys_current];
+  k->offset = offset;
+  k->nbytes = nbytes;
+  k->hash = hash;
+  k->next = *bucket;
+  *bucket = out->keys_current++;
+  return true;
 }
 
-/* If STRING is not a valid UTF-8 string, signal an error of type
-   `wrong-type-argument'.  STRING must be a unibyte string.  */
+/* Forget the keys from FIRST on, which belong to an object that has
+   been written.  */
 
 static void
-json_check_utf8 (Lisp_Object string)
+json_out_pop_keys (struct json_out *out, ptrdiff_t first)
 {
-  CHECK_TYPE (utf8_string_p (string), Qutf_8_string_p, string);
+  while (out->keys_current > first)
+    {
+      struct json_out_key *k = &out->keys[--out->keys_current];
+      out->key_buckets[k->hash & (out->key_buckets_size - 1)] = k->next;
+    }
 }
 
-enum json_object_type {
-  json_object_hashtable,
-  json_object_alist,
-  json_object_plist
-};
-
-enum json_array_type {
-  json_array_array,
-  json_array_list
-};
+/* Write the separator before a member of the object whose keys start
+   at FIRST, if needed, then KEY without its first SKIP bytes, and the
+   colon.  Return false, having written nothing, if the object already
+   has that key.  */
 
-struct json_configuration {
-  enum json_object_type object_type;
-  enum json_array_type array_type;
-  Lisp_Object null_object;
-  Lisp_Object false_object;
-};
+static bool
+json_out_member_key (struct json_out *out, ptrdiff_t first,
+		     Lisp_Object key, ptrdiff_t skip)
+{
+  ptrdiff_t size = out->size;
+  ptrdiff_t chars_delta = out->chars_delta;
+  if (out->keys_current > first)
+    json_out_byte (out, ',');
+  ptrdiff_t offset = out->size;
+  json_out_string (out, key, skip);
+  if (!json_out_add_key (out, first, offset, out->size - offset))
+    {
+      out->size = size;
+      out->chars_delta = chars_delta;
+      return false;
+    }
+  json_out_byte (out, ':');
+  return true;
+}
 
-static json_t *lisp_to_json (Lisp_Object,
-                             const struct json_configuration *conf);
+static void json_out_value (struct json_out *, Lisp_Object);
 
-/* Convert a Lisp object to a nonscalar JSON object (array or object).  */
+/* Write LISP, a vector, hashtable, alist or plist, as a JSON array or
+   object.  Signal an error of type `wrong-type-argument' if it is
+   none of those.  */
 
-static json_t *
-lisp_to_json_nonscalar_1 (Lisp_Object lisp,
-                          const struct json_configuration *conf)
+static void
+json_out_nonscalar (struct json_out *out, Lisp_Object lisp)
 {
-  json_t *json;
-  ptrdiff_t count;
+  if (++lisp_eval_depth > max_lisp_eval_depth)
+    xsignal0 (Qjson_object_too_deep);
 
+  ptrdiff_t first = out->keys_current;
   if (VECTORP (lisp))
     {
       ptrdiff_t size = ASIZE (lisp);
-      json = json_check (json_array ());
-      count = SPECPDL_INDEX ();
-      record_unwind_protect_ptr (json_release_object, json);
+      json_out_byte (out, '[');
       for (ptrdiff_t i = 0; i < size; ++i)
-        {
-          int status
-            = json_array_append_new (json, lisp_to_json (AREF (lisp, i),
-                                                         conf));
-          if (status == -1)
-            json_out_of_memory ();
-        }
-      eassert (json_array_size (json) == size);
+	{
+	  rarely_quit (i);
+	  if (i > 0)
+	    json_out_byte (out, ',');
+	  json_out_value (out, AREF (lisp, i));
+	}
+      json_out_byte (out, ']');
     }
   else if (HASH_TABLE_P (lisp))
     {
       struct Lisp_Hash_Table *h = XHASH_TABLE (lisp);
-      json = json_check (json_object ());
-      count = SPECPDL_INDEX ();
-      record_unwind_protect_ptr (json_release_object, json);
+      json_out_byte (out, '{');
       for (ptrdiff_t i = 0; i < HASH_TABLE_SIZE (h); ++i)
-        {
-          Lisp_Object key = HASH_KEY (h, i);
-          if (!EQ (key, Qunbound))
-            {
-              CHECK_STRING (key);
-              Lisp_Object ekey = json_encode (key);
-              /* We can't specify the length, so the string must be
-		 null-terminated.  */
-              check_string_without_embedded_nulls (ekey);
-              const char *key_str = SSDATA (ekey);
-              /* Reject duplicate keys.  These are possible if the hash
+	{
+	  Lisp_Object key = HASH_KEY (h, i);
+	  if (!EQ (key, Qunbound))
+	    {
+	      rarely_quit (i);
+	      check_string_without_embedded_nulls (key);
+	      /* Reject duplicate keys.  These are possible if the hash
 		 table test is not `equal'.  */
-              if (json_object_get (json, key_str) != NULL)
-                wrong_type_argument (Qjson_value_p, lisp);
-              int status
-                = json_object_set_new (json, key_str,
-                                       lisp_to_json (HASH_VALUE (h, i), conf));
-              if (status == -1)
-                {
-                  /* A failure can be caused either by an invalid key or
-                   by low memory.  */
-                  json_check_utf8 (ekey);
-                  json_out_of_memory ();
-                }
-            }
-        }
+	      if (!json_out_member_key (out, first, key, 0))
+		wrong_type_argument (Qjson_value_p, lisp);
+	      json_out_value (out, HASH_VALUE (h, i));
+	    }
+	}
+      json_out_byte (out, '}');
     }
   else if (NILP (lisp))
-    return json_check (json_object ());
+    json_out_ascii (out, "{}", 2);
   else if (CONSP (lisp))
     {
       Lisp_Object tail = lisp;
-      json = json_check (json_object ());
-      count = SPECPDL_INDEX ();
-      record_unwind_protect_ptr (json_release_object, json);
+      json_out_byte (out, '{');
       bool is_plist = !CONSP (XCAR (tail));
       FOR_EACH_TAIL (tail)
-        {
-          const char *key_str;
-          Lisp_Object value;
-          Lisp_Object key_symbol;
-          if (is_plist)
-            {
-              key_symbol = XCAR (tail);
-              tail = XCDR (tail);
-              CHECK_CONS (tail);
-              value = XCAR (tail);
-            }
-          else
-            {
-              Lisp_Object pair = XCAR (tail);
-              CHECK_CONS (pair);
-              key_symbol = XCAR (pair);
-              value = XCDR (pair);
-            }
-          CHECK_SYMBOL (key_symbol);
-          Lisp_Object key = SYMBOL_NAME (key_symbol);
-          /* We can't specify the length, so the string must be
-             null-terminated.  */
-          check_string_without_embedded_nulls (key);
-          key_str = SSDATA (key);
-          /* In plists, ensure leading ":" in keys is stripped.  It
-             will be reconstructed later in `json_to_lisp'.*/
-          if (is_plist && ':' == key_str[0] && key_str[1])
-            {
-              key_str = &key_str[1];
-            }
-          /* Only add element if key is not already present.  */
-          if (json_object_get (json, key_str) == NULL)
-            {
-              int status
-                = json_object_set_new (json, key_str, lisp_to_json (value,
-                                                                    conf));
-              if (status == -1)
-                json_out_of_memory ();
-            }
-        }
+	{
+	  Lisp_Object value;
+	  Lisp_Object key_symbol;
+	  if (is_plist)
+	    {
+	      key_symbol = XCAR (tail);
+	      tail = XCDR (tail);
+	      CHECK_CONS (tail);
+	      value = XCAR (tail);
+	    }
+	  else
+	    {
+	      Lisp_Object pair = XCAR (tail);
+	      CHECK_CONS (pair);
+	      key_symbol = XCAR (pair);
+	      value = XCDR (pair);
+	    }
+	  CHECK_SYMBOL (key_symbol);
+	  Lisp_Object key = SYMBOL_NAME (key_symbol);
+	  check_string_without_embedded_nulls (key);
+	  /* In plists, ensure leading ":" in keys is stripped.  It
+	     will be reconstructed later in `json_parse_object_key'.  */
+	  ptrdiff_t skip = (is_plist && SBYTES (key) > 1
+			    && SREF (key, 0) == ':');
+	  /* Only add element if key is not already present.  */
+	  if (json_out_member_key (out, first, key, skip))
+	    json_out_value (out, value);
+	}
       CHECK_LIST_END (tail, lisp);
+      json_out_byte (out, '}');
     }
   else
     wrong_type_argument (Qjson_value_p, lisp);
+  json_out_pop_keys (out, first);
 
-  clear_unwind_protect (count);
-  unbind_to (count, Qnil);
-  return json;
-}
-
-/* Convert LISP to a nonscalar JSON object (array or object).  Signal
-   an error of type `wrong-type-argument' if LISP is not a vector,
-   hashtable, alist, or plist.  */
-
-static json_t *
-lisp_to_json_nonscalar (Lisp_Object lisp,
-                        const struct json_configuration *conf)
-{
-  if (++lisp_eval_depth > max_lisp_eval_depth)
-    xsignal0 (Qjson_object_too_deep);
-  json_t *json = lisp_to_json_nonscalar_1 (lisp, conf);
   --lisp_eval_depth;
-  return json;
 }
 
-/* Convert LISP to any JSON object.  Signal an error of type
-   `wrong-type-argument' if the type of LISP can't be converted to a
-   JSON object.  */
+/* Write LISP as JSON.  Signal an error of type `wrong-type-argument'
+   if it, or an element of it, can't be converted to JSON.  */
 
-static json_t *
-lisp_to_json (Lisp_Object lisp, const struct json_configuration *conf)
+static void
+json_out_value (struct json_out *out, Lisp_Object lisp)
 {
-  if (EQ (lisp, conf->null_object))
-    return json_check (json_null ());
-  else if (EQ (lisp, conf->false_object))
-    return json_check (json_false ());
+  if (EQ (lisp, out->conf->null_object))
+    json_out_ascii (out, "null", 4);
+  else if (EQ (lisp, out->conf->false_object))
+    json_out_ascii (out, "false", 5);
   else if (EQ (lisp, Qt))
-    return json_check (json_true ());
+    json_out_ascii (out, "true", 4);
   else if (INTEGERP (lisp))
-    {
-      intmax_t low = TYPE_MINIMUM (json_int_t);
-      intmax_t high = TYPE_MAXIMUM (json_int_t);
-      intmax_t value = check_integer_range (lisp, low, high);
-      return json_check (json_integer (value));
-    }
+    json_out_integer (out, lisp);
   else if (FLOATP (lisp))
-    return json_check (json_real (XFLOAT_DATA (lisp)));
+    json_out_float (out, lisp);
   else if (STRINGP (lisp))
-    {
-      Lisp_Object encoded = json_encode (lisp);
-      json_t *json = json_stringn (SSDATA (encoded), SBYTES (encoded));
-      if (json == NULL)
-        {
-          /* A failure can be caused either by an invalid string or by
-             low memory.  */
-          json_check_utf8 (encoded);
-          json_out_of_memory ();
-        }
-      return json;
-    }
+    json_out_string (out, lisp, 0);
+  else
+    json_out_nonscalar (out, lisp);
+}
+
+DEFUN ("json-serialize", Fjson_serialize, Sjson_serialize, 1, MANY,
+       NULL,
+       doc: /* Return the JSON representation of OBJECT as a string.
+
+OBJECT must be t, a number, string, vector, hashtable, alist, plist,
+or the Lisp equivalents to the JSON null and false values, and its
+elements must recursively consist of the same kinds of values.  t will
+be converted to the JSON true value.  Vectors will be converted to
+JSON arrays, whereas hashtables, alists and plists are converted to
+JSON objects.  Hashtable keys must be strings without embedded null
+characters and must be unique within each object.  Alist and plist
+keys must be symbols; if a key is duplicate, the first instance is
+used.
+
+The Lisp equivalents to the JSON null and false values are
+configurable in the arguments ARGS, a list of keyword/argument pairs:
+
+The keyword argument `:null-object' specifies which object to use
+to represent a JSON null value.  It defaults to `:null'.
+
+The keyword argument `:false-object' specifies which object to use to
+represent a JSON false value.  It defaults to `:false'.
+
+In you specify the same value for `:null-object' and `:false-object',
+a potentially ambiguous situation, the JSON output will not contain
+any JSON false values.
+usage: (json-serialize OBJECT &rest ARGS)  */)
+     (ptrdiff_t nargs, Lisp_Object *args)
+{
+  ptrdiff_t count = SPECPDL_INDEX ();
+
+  struct json_configuration conf =
+    {json_object_hashtable, json_array_array, QCnull, QCfalse};
+  json_parse_args (nargs - 1, args + 1, &conf, false);
+
+  struct json_out out;
+  json_out_init (&out, &conf, false);
+  record_unwind_protect_ptr (json_out_done, &out);
+  json_out_value (&out, args[0]);
+
+  return unbind_to (count,
+		    make_multibyte_string ((char *) out.buffer,
+					   out.size - out.chars_delta,
+					   out.size));
+}
+
+DEFUN ("json-insert", Fjson_insert, Sjson_insert, 1, MANY,
+       NULL,
+       doc: /* Insert the JSON representation of OBJECT before point.
+This is the same as (insert (json-serialize OBJECT)), but potentially
+faster.  See the function `json-serialize' for allowed values of
+OBJECT.
+usage: (json-insert OBJECT &rest ARGS)  */)
+     (ptrdiff_t nargs, Lisp_Object *args)
+{
+  ptrdiff_t count = SPECPDL_INDEX ();
 
-  /* LISP now must be a vector, hashtable, alist, or plist.  */
-  return lisp_to_json_nonscalar (lisp, conf);
+  struct json_configuration conf =
+    {json_object_hashtable, json_array_array, QCnull, QCfalse};
+  json_parse_args (nargs - 1, args + 1, &conf, false);
+
+  prepare_to_modify_buffer (PT, PT, NULL);
+  move_gap_both (PT, PT_BYTE);
+
+  /* Write the text into the gap, and then make it part of the buffer
+     as it is.  */
+  struct json_out out;
+  json_out_init (&out, &conf, true);
+  record_unwind_protect_ptr (json_out_done, &out);
+  json_out_value (&out, args[0]);
+
+  ptrdiff_t inserted_bytes = out.size;
+  ptrdiff_t inserted
+    = (NILP (BVAR (current_buffer, enable_multibyte_characters))
+       ? inserted_bytes : inserted_bytes - out.chars_delta);
+  insert_from_gap_1 (inserted, inserted_bytes, false);
+  invalidate_buffer_caches (current_buffer, PT, PT + inserted);
+  adjust_after_insert (PT, PT_BYTE, PT + inserted, PT_BYTE + inserted_bytes,
+		       inserted);
+
+  /* Call after-change hooks.  */
+  signal_after_change (PT, 0, inserted);
+  update_compositions (PT, PT, CHECK_BORDER);
+  /* Move point to after the inserted text.  */
+  SET_PT_BOTH (PT + inserted, PT_BYTE + inserted_bytes);
+
+  return unbind_to (count, Qnil);
+}
+
+#ifdef subprocesses
+
+DEFUN ("json-send-to-process", Fjson_send_to_process, Sjson_send_to_process,
+       2, MANY, NULL,
+       doc: /* Send PROCESS the JSON representation of OBJECT as a message.
+The message is framed as in JSON-RPC over streams, for instance by the
+Language Server Protocol: it consists of a "Content-Length" header with
+the number of bytes of the JSON text, an empty line, and the JSON text
+in UTF-8.  It is sent as it is, regardless of the coding system of
+PROCESS.
+
+PROCESS may be a process, a buffer, the name of a process or buffer, or
+nil, indicating the current buffer's process.  See the function
+`json-serialize' for allowed values of OBJECT and ARGS.
+usage: (json-send-to-process PROCESS OBJECT &rest ARGS)  */)
+     (ptrdiff_t nargs, Lisp_Object *args)
+{
+  ptrdiff_t count = SPECPDL_INDEX ();
+
+  Lisp_Object proc = get_process (args[0]);
+  struct json_configuration conf =
+    {json_object_hashtable, json_array_array, QCnull, QCfalse};
+  json_parse_args (nargs - 2, args + 2, &conf, false);
+
+  /* Write the JSON text after room for the longest header, so that
+     the message can be sent from where it is.  */
+  enum { HEADER_ROOM = (sizeof "Content-Length: \r\n\r\n" - 1
+			+ INT_STRLEN_BOUND (ptrdiff_t)) };
+  struct json_out out;
+  json_out_init (&out, &conf, false);
+  record_unwind_protect_ptr (json_out_done, &out);
+  json_out_reserve (&out, HEADER_ROOM);
+  out.size = HEADER_ROOM;
+  json_out_value (&out, args[1]);
+
+  ptrdiff_t nbytes = out.size - HEADER_ROOM;
+  char header[HEADER_ROOM + 1];
+  int header_size = sprintf (header, "Content-Length: %"pD"d\r\n\r\n",
+			     nbytes);
+  char *message = (char *) out.buffer + HEADER_ROOM - header_size;
+  memcpy (message, header, header_size);
+  send_process_bytes (proc, message, header_size + nbytes);
+
+  return unbind_to (count, Qnil);
 }
 
+#endif	/* subprocesses */
+
+/* The JSON parser.
+
+   JSON text is parsed in a single pass, creating the Lisp objects as
+   their syntax is recognized; there is no intermediate tree.  Strings
+   are validated as UTF-8 while they are scanned, and since valid UTF-8
+   is also the internal representation of the characters it encodes,
+   their bytes can then be copied into multibyte Lisp strings as they
+   are.  Object keys go through a small cache first, so that a key
+   repeated in many objects, as in a large array of records, is turned
+   into a string or interned only once.
+
+   The parser never calls Lisp, so no garbage collection can happen
+   while it runs.  This is what allows the elements of the arrays and
+   objects still being built to be kept in a workspace allocated with
+   xmalloc, which the garbage collector doesn't know about.  */
+
+/* The number of entries in the cache of object keys, a power of 2.  */
+enum { JSON_KEY_CACHE_SIZE = 64 };
+
+/* Keys longer than this many bytes are not cached.  */
+enum { JSON_KEY_CACHE_MAX_BYTES = 64 };
+
+/* Objects with up to this many members are checked for duplicate
+   keys by comparing each key with all the previous ones.  */
+enum { JSON_SMALL_OBJECT_SIZE = 16 };
+
+struct json_parser
+{
+  /* The input segment being read.  */
+  const unsigned char *input_begin;
+  const unsigned char *input_current;
+  const unsigned char *input_end;
+
+  /* The input segment that follows it, or NULL if there is none.
+     When parsing a buffer, this is the text after the gap.  */
+  const unsigned char *secondary_input_begin;
+  const unsigned char *secondary_input_end;
+
+  /* The number of input bytes before INPUT_BEGIN.  */
+  ptrdiff_t input_offset;
+
+  /* Where the input comes from, and the line and the byte position
+     of the start of that line we are on, for error messages.  */
+  const char *source;
+  ptrdiff_t current_line;
+  ptrdiff_t point_of_current_line;
+
+  const struct json_configuration *conf;
+
+  /* Room for the bytes of strings that can't be used from the input
+     as they are, because they contain escape sequences or straddle
+     the gap, and for the text of numbers.  */
+  unsigned char *byte_workspace;
+  ptrdiff_t byte_workspace_size;
+
+  /* A stack of the elements of the arrays, and the keys and values
+     of the objects, that are being parsed.  */
+  Lisp_Object *object_workspace;
+  ptrdiff_t object_workspace_size;
+  ptrdiff_t object_workspace_current;
+
+  /* Recently seen object keys, as the Lisp strings or symbols they
+     were turned into, indexed by a hash of their bytes.  */
+  Lisp_Object key_cache[JSON_KEY_CACHE_SIZE];
+};
+
 static void
-json_parse_args (ptrdiff_t nargs,
-                 Lisp_Object *args,
-                 struct json_configuration *conf,
-                 bool parse_object_types)
+json_parser_init (struct json_parser *parser,
+		  const struct json_configuration *conf, const char *source,
+		  const unsigned char *input, const unsigned char *input_end,
+		  const unsigned char *secondary_input,
+		  const unsigned char *secondary_input_end)
 {
-  if ((nargs % 2) != 0)
-    wrong_type_argument (Qplistp, Flist (nargs, args));
+  parser->input_begin = input;
+  parser->input_current = input;
+  parser->input_end = input_end;
+  if (secondary_input == secondary_input_end)
+    secondary_input = secondary_input_end = NULL;
+  parser->secondary_input_begin = secondary_input;
+  parser->secondary_input_end = secondary_input_end;
+  parser->input_offset = 0;
+  parser->source = source;
+  parser->current_line = 1;
+  parser->point_of_current_line = 0;
+  parser->conf = conf;
+  parser->byte_workspace = NULL;
+  parser->byte_workspace_size = 0;
+  parser->object_workspace = NULL;
+  parser->object_workspace_size = 0;
+  parser->object_workspace_current = 0;
+  for (int i = 0; i < JSON_KEY_CACHE_SIZE; i++)
+    parser->key_cache[i] = Qnil;
+}
 
-  /* Start from the back so keyword values appearing
-     first take precedence. */
-  for (ptrdiff_t i = nargs; i > 0; i -= 2) {
-    Lisp_Object key = args[i - 2];
-    Lisp_Object value = args[i - 1];
-    if (parse_object_types && EQ (key, QCobject_type))
-      {
-        if (EQ (value, Qhash_table))
-          conf->object_type = json_object_hashtable;
-        else if (EQ (value, Qalist))
-          conf->object_type = json_object_alist;
-        else if (EQ (value, Qplist))
-          conf->object_type = json_object_plist;
-        else
-          wrong_choice (list3 (Qhash_table, Qalist, Qplist), value);
-      }
-    else if (parse_object_types && EQ (key, QCarray_type))
-      {
-        if (EQ (value, Qarray))
-          conf->array_type = json_array_array;
-        else if (EQ (value, Qlist))
-          conf->array_type = json_array_list;
-        else
-          wrong_choice (list2 (Qarray, Qlist), value);
-      }
-    else if (EQ (key, QCnull_object))
-      conf->null_object = value;
-    else if (EQ (key, QCfalse_object))
-      conf->false_object = value;
-    else if (parse_object_types)
-      wrong_choice (list4 (QCobject_type,
-                           QCarray_type,
-                           QCnull_object,
-                           QCfalse_object),
-                    value);
-    else
-      wrong_choice (list2 (QCnull_object,
-                           QCfalse_object),
-                    value);
-  }
+static void
+json_parser_done (void *parser)
+{
+  struct json_parser *p = parser;
+  xfree (p->byte_workspace);
+  xfree (p->object_workspace);
+}
+
+/* Return the number of input bytes that PARSER has consumed.  */
+
+static ptrdiff_t
+json_input_position (struct json_parser *parser)
+{
+  return parser->input_offset + (parser->input_current - parser->input_begin);
+}
+
+/* Signal an ERROR, a symbol whose conditions include
+   `json-parse-error', at the current position of PARSER.  The error
+   data are MESSAGE, the source of the input, and the line, column and
+   byte offset where the error was found.  */
+
+static AVOID
+json_signal_error (struct json_parser *parser, Lisp_Object error,
+		   const char *message)
+{
+  ptrdiff_t position = json_input_position (parser);
+  xsignal (error,
+	   list5 (build_string (message), build_string (parser->source),
+		  INT_TO_INTEGER (parser->current_line),
+		  INT_TO_INTEGER (position - parser->point_of_current_line),
+		  INT_TO_INTEGER (position)));
 }
 
-DEFUN ("json-serialize", Fjson_serialize, Sjson_serialize, 1, MANY,
-       NULL,
-       doc: /* Return the JSON representation of OBJECT as a string.
+static AVOID
+json_signal_end_of_file (struct json_parser *parser)
+{
+  json_signal_error (parser, Qjson_end_of_file, "unexpected end of input");
+}
 
-OBJECT must be t, a number, string, vector, hashtable, alist, plist,
-or the Lisp equivalents to the JSON null and false values, and its
-elements must recursively consist of the same kinds of values.  t will
-be converted to the JSON true value.  Vectors will be converted to
-JSON arrays, whereas hashtables, alists and plists are converted to
-JSON objects.  Hashtable keys must be strings without embedded null
-characters and must be unique within each object.  Alist and plist
-keys must be symbols; if a key is duplicate, the first instance is
-used.
+/* Return the next byte of input and move past it.  Return -1 if
+   there is no more input.  */
 
-The Lisp equivalents to the JSON null and false values are
-configurable in the arguments ARGS, a list of keyword/argument pairs:
+static int
+json_input_get (struct json_parser *parser)
+{
+  if (parser->input_current == parser->input_end)
+    {
+      if (!parser->secondary_input_begin)
+	return -1;
+      parser->input_offset += parser->input_end - parser->input_begin;
+      parser->input_begin = parser->secondary_input_begin;
+      parser->input_current = parser->input_begin;
+      parser->input_end = parser->secondary_input_end;
+      parser->secondary_input_begin = parser->secondary_input_end = NULL;
+    }
+  return *parser->input_current++;
+}
 
-The keyword argument `:null-object' specifies which object to use
-to represent a JSON null value.  It defaults to `:null'.
+/* Like json_input_get, but signal an error if there is no more
+   input.  */
 
-The keyword argument `:false-object' specifies which object to use to
-represent a JSON false value.  It defaults to `:false'.
+static int
+json_input_get_required (struct json_parser *parser)
+{
+  int c = json_input_get (parser);
+  if (c < 0)
+    json_signal_end_of_file (parser);
+  return c;
+}
 
-In you specify the same value for `:null-object' and `:false-object',
-a potentially ambiguous situation, the JSON output will not contain
-any JSON false values.
-usage: (json-serialize OBJECT &rest ARGS)  */)
-     (ptrdiff_t nargs, Lisp_Object *args)
+/* Undo the last json_input_get, which must have returned a byte.  */
+
+static void
+json_input_put_back (struct json_parser *parser)
 {
-  ptrdiff_t count = SPECPDL_INDEX ();
+  parser->input_current--;
+}
 
-#ifdef WINDOWSNT
-  if (!json_initialized)
+/* Skip whitespace, and return the byte that follows it, or -1 if
+   there is no more input.  */
+
+static int
+json_skip_whitespace (struct json_parser *parser)
+{
+  for (;;)
     {
-      Lisp_Object status;
-      json_initialized = init_json_functions ();
-      status = json_initialized ? Qt : Qnil;
-      Vlibrary_cache = Fcons (Fcons (Qjson, status), Vlibrary_cache);
+      int c = json_input_get (parser);
+      if (c == '\n')
+	{
+	  parser->current_line++;
+	  parser->point_of_current_line = json_input_position (parser);
+	}
+      else if (! (c == ' ' || c == '\t' || c == '\r'))
+	return c;
     }
-  if (!json_initialized)
-    Fsignal (Qjson_unavailable,
-	     list1 (build_unibyte_string ("jansson library not found")));
-#endif
-
-  struct json_configuration conf =
-    {json_object_hashtable, json_array_array, QCnull, QCfalse};
-  json_parse_args (nargs - 1, args + 1, &conf, false);
+}
 
-  json_t *json = lisp_to_json (args[0], &conf);
-  record_unwind_protect_ptr (json_release_object, json);
+static int
+json_skip_whitespace_required (struct json_parser *parser)
+{
+  int c = json_skip_whitespace (parser);
+  if (c < 0)
+    json_signal_end_of_file (parser);
+  return c;
+}
 
-  char *string = json_dumps (json, JSON_COMPACT | JSON_ENCODE_ANY);
-  if (string == NULL)
-    json_out_of_memory ();
-  record_unwind_protect_ptr (json_free, string);
+/* Make room for at least SIZE bytes in the byte workspace of
+   PARSER.  */
 
-  return unbind_to (count, build_string_from_utf8 (string));
+static void
+json_byte_workspace_reserve (struct json_parser *parser, ptrdiff_t size)
+{
+  if (parser->byte_workspace_size < size)
+    parser->byte_workspace
+      = xpalloc (parser->byte_workspace, &parser->byte_workspace_size,
+		 size - parser->byte_workspace_size, -1, 1);
 }
 
-struct json_buffer_and_size
+static void
+json_object_workspace_push (struct json_parser *parser, Lisp_Object value)
 {
-  const char *buffer;
-  ptrdiff_t size;
-  /* This tracks how many bytes were inserted by the callback since
-     json_dump_callback was called.  */
-  ptrdiff_t inserted_bytes;
-};
+  if (parser->object_workspace_current == parser->object_workspace_size)
+    parser->object_workspace
+      = xpalloc (parser->object_workspace, &parser->object_workspace_size,
+		 1, -1, sizeof *parser->object_workspace);
+  parser->object_workspace[parser->object_workspace_current++] = value;
+}
 
-static Lisp_Object
-json_insert (void *data)
+/* Read the four hexadecimal digits of a \u escape sequence.  */
+
+static int
+json_parse_hex4 (struct json_parser *parser)
 {
-  struct json_buffer_and_size *buffer_and_size = data;
-  ptrdiff_t len = buffer_and_size->size;
-  ptrdiff_t inserted_bytes = buffer_and_size->inserted_bytes;
-  ptrdiff_t gap_size = GAP_SIZE - inserted_bytes;
-
-  /* Enlarge the gap if necessary.  */
-  if (gap_size < len)
-    make_gap (len - gap_size);
-
-  /* Copy this chunk of data into the gap.  */
-  memcpy ((char *) BEG_ADDR + PT_BYTE - BEG_BYTE + inserted_bytes,
-	  buffer_and_size->buffer, len);
-  buffer_and_size->inserted_bytes += len;
-  return Qnil;
+  int value = 0;
+  for (int i = 0; i < 4; i++)
+    {
+      int digit = char_hexdigit (json_input_get_required (parser));
+      if (digit < 0)
+	json_signal_error (parser, Qjson_parse_error,
+			   "invalid escape sequence");
+      value = (value << 4) + digit;
+    }
+  return value;
 }
 
-static Lisp_Object
-json_handle_nonlocal_exit (enum nonlocal_exit type, Lisp_Object data)
+/* Read the rest of an escape sequence whose backslash has been
+   consumed, and store the UTF-8 encoding of the character it stands
+   for at P.  Return the number of bytes stored.  */
+
+static int
+json_parse_escape (struct json_parser *parser, unsigned char *p)
 {
-  switch (type)
+  int c = json_input_get_required (parser);
+  switch (c)
     {
-    case NONLOCAL_EXIT_SIGNAL:
-      return data;
-    case NONLOCAL_EXIT_THROW:
-      return Fcons (Qno_catch, data);
+    case '"': case '\\': case '/':
+      break;
+    case 'b':
+      c = '\b';
+      break;
+    case 'f':
+      c = '\f';
+      break;
+    case 'n':
+      c = '\n';
+      break;
+    case 'r':
+      c = '\r';
+      break;
+    case 't':
+      c = '\t';
+      break;
+    case 'u':
+      c = json_parse_hex4 (parser);
+      if (0xD800 <= c && c <= 0xDBFF)
+	{
+	  /* A high surrogate must be followed by a low one.  */
+	  if (json_input_get_required (parser) != '\\'
+	      || json_input_get_required (parser) != 'u')
+	    json_signal_error (parser, Qjson_parse_error,
+			       "invalid Unicode surrogate pair");
+	  int low = json_parse_hex4 (parser);
+	  if (! (0xDC00 <= low && low <= 0xDFFF))
+	    json_signal_error (parser, Qjson_parse_error,
+			       "invalid Unicode surrogate pair");
+	  c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+	}
+      else if (0xDC00 <= c && c <= 0xDFFF)
+	json_signal_error (parser, Qjson_parse_error,
+			   "invalid Unicode surrogate pair");
+      else if (c == 0)
+	/* Lisp strings could represent this, but the strings that the
+	   parser used to return were null-terminated.  */
+	json_signal_error (parser, Qjson_parse_error,
+			   "\\u0000 is not allowed");
+      return CHAR_STRING (c, p);
     default:
-      eassume (false);
+      json_signal_error (parser, Qjson_parse_error,
+			 "invalid escape sequence");
     }
+  *p = c;
+  return 1;
 }
 
-struct json_insert_data
+/* Scan a JSON string whose opening quote has been consumed.  Set
+   *DATA, *NBYTES and *NCHARS to its UTF-8 text, and the numbers of
+   bytes and characters in that.  *DATA points either into the input
+   or into the byte workspace of PARSER, and is valid until the next
+   string or number is scanned.  */
+
+static void
+json_scan_string (struct json_parser *parser, const unsigned char **data,
+		  ptrdiff_t *nbytes, ptrdiff_t *nchars)
 {
-  /* This tracks how many bytes were inserted by the callback since
-     json_dump_callback was called.  */
-  ptrdiff_t inserted_bytes;
-  /* nil if json_insert succeeded, otherwise the symbol
-     Qcatch_all_memory_full or a cons (ERROR-SYMBOL . ERROR-DATA).  */
-  Lisp_Object error;
-};
+  /* Usually, the string contains no escape sequences and lies within
+     the current input segment, so it can be used where it is.  */
+  const unsigned char *begin = parser->input_current;
+  const unsigned char *end = parser->input_end;
+  const unsigned char *p = begin;
+  ptrdiff_t chars = 0;
+  while (p < end)
+    {
+      int c = *p;
+      if (c == '"')
+	{
+	  parser->input_current = p + 1;
+	  *data = begin;
+	  *nbytes = p - begin;
+	  *nchars = chars;
+	  return;
+	}
+      if (c < 0x80)
+	{
+	  if (c == '\\' || c < 0x20)
+	    break;
+	  p++;
+	}
+      else
+	{
+	  int len = json_utf8_sequence_length (c);
+	  if (len == 0 || end - p < len
+	      || !json_utf8_sequence_valid_p (p, len))
+	    break;
+	  p += len;
+	}
+      chars++;
+    }
 
-/* Callback for json_dump_callback that inserts a JSON representation
-   as a unibyte string into the gap.  DATA must point to a structure
-   of type json_insert_data.  This function may not exit nonlocally.
-   It catches all nonlocal exits and stores them in data->error for
-   reraising.  */
+  /* Otherwise, collect the text in the workspace, starting with what
+     has been scanned so far.  */
+  ptrdiff_t size = p - begin;
+  json_byte_workspace_reserve (parser, size + MAX_MULTIBYTE_LENGTH);
+  memcpy (parser->byte_workspace, begin, size);
+  parser->input_current = p;
+  for (;;)
+    {
+      int c = json_input_get_required (parser);
+      if (c == '"')
+	break;
+      json_byte_workspace_reserve (parser, size + MAX_MULTIBYTE_LENGTH);
+      unsigned char *dest = parser->byte_workspace + size;
+      if (c == '\\')
+	size += json_parse_escape (parser, dest);
+      else if (c < 0x20)
+	json_signal_error (parser, Qjson_parse_error,
+			   "control character in string");
+      else if (c < 0x80)
+	{
+	  *dest = c;
+	  size++;
+	}
+      else
+	{
+	  int len = json_utf8_sequence_length (c);
+	  if (len == 0)
+	    json_signal_error (parser, Qjson_parse_error,
+			       "invalid UTF-8 in string");
+	  dest[0] = c;
+	  for (int i = 1; i < len; i++)
+	    dest[i] = json_input_get_required (parser);
+	  if (!json_utf8_sequence_valid_p (dest, len))
+	    json_signal_error (parser, Qjson_parse_error,
+			       "invalid UTF-8 in string");
+	  size += len;
+	}
+      chars++;
+    }
+  *data = parser->byte_workspace;
+  *nbytes = size;
+  *nchars = chars;
+}
 
-static int
-json_insert_callback (const char *buffer, size_t size, void *data)
+static Lisp_Object
+json_parse_string (struct json_parser *parser)
 {
-  struct json_insert_data *d = data;
-  struct json_buffer_and_size buffer_and_size
-    = {.buffer = buffer, .size = size, .inserted_bytes = d->inserted_bytes};
-  d->error = internal_catch_all (json_insert, &buffer_and_size,
-                                 json_handle_nonlocal_exit);
-  d->inserted_bytes = buffer_and_size.inserted_bytes;
-  return NILP (d->error) ? 0 : -1;
+  const unsigned char *data;
+  ptrdiff_t nbytes, nchars;
+  json_scan_string (parser, &data, &nbytes, &nchars);
+  return make_multibyte_string ((const char *) data, nchars, nbytes);
 }
 
-DEFUN ("json-insert", Fjson_insert, Sjson_insert, 1, MANY,
-       NULL,
-       doc: /* Insert the JSON representation of OBJECT before point.
-This is the same as (insert (json-serialize OBJECT)), but potentially
-faster.  See the function `json-serialize' for allowed values of
-OBJECT.
-usage: (json-insert OBJECT &rest ARGS)  */)
-     (ptrdiff_t nargs, Lisp_Object *args)
-{
-  ptrdiff_t count = SPECPDL_INDEX ();
+/* Parse an object key whose opening quote has been consumed, and
+   return it as a string or as a symbol, depending on the object type
+   of PARSER.  Keys are looked up in the key cache first; this means
+   that the string keys of different hash tables may be the same
+   object.  */
 
-#ifdef WINDOWSNT
-  if (!json_initialized)
+static Lisp_Object
+json_parse_object_key (struct json_parser *parser)
+{
+  const unsigned char *data;
+  ptrdiff_t nbytes, nchars;
+  json_scan_string (parser, &data, &nbytes, &nchars);
+
+  /* Plist keys are keywords, whose names have a leading colon.  */
+  bool keyword = parser->conf->object_type == json_object_plist;
+  Lisp_Object *slot = NULL;
+  if (nbytes <= JSON_KEY_CACHE_MAX_BYTES)
     {
-      Lisp_Object status;
-      json_initialized = init_json_functions ();
-      status = json_initialized ? Qt : Qnil;
-      Vlibrary_cache = Fcons (Fcons (Qjson, status), Vlibrary_cache);
+      unsigned int hash = nbytes;
+      for (ptrdiff_t i = 0; i < nbytes; i++)
+	hash = hash * 31 + data[i];
+      slot = &parser->key_cache[hash % JSON_KEY_CACHE_SIZE];
+      Lisp_Object cached = *slot;
+      if (!NILP (cached))
+	{
+	  Lisp_Object name = SYMBOLP (cached) ? SYMBOL_NAME (cached) : cached;
+	  if (SBYTES (name) == keyword + nbytes
+	      && memcmp (SDATA (name) + keyword, data, nbytes) == 0)
+	    return cached;
+	}
     }
-  if (!json_initialized)
-    Fsignal (Qjson_unavailable,
-	     list1 (build_unibyte_string ("jansson library not found")));
-#endif
 
-  struct json_configuration conf =
-    {json_object_hashtable, json_array_array, QCnull, QCfalse};
-  json_parse_args (nargs - 1, args + 1, &conf, false);
+  Lisp_Object key;
+  switch (parser->conf->object_type)
+    {
+    case json_object_hashtable:
+      key = make_multibyte_string ((const char *) data, nchars, nbytes);
+      break;
+    case json_object_alist:
+      key = Fintern (make_multibyte_string ((const char *) data,
+					    nchars, nbytes),
+		     Qnil);
+      break;
+    case json_object_plist:
+      {
+	USE_SAFE_ALLOCA;
+	char *name = SAFE_ALLOCA (1 + nbytes);
+	name[0] = ':';
+	memcpy (name + 1, data, nbytes);
+	key = Fintern (make_multibyte_string (name, 1 + nchars, 1 + nbytes),
+		       Qnil);
+	SAFE_FREE ();
+	break;
+      }
+    default:
+      /* Can't get here.  */
+      emacs_abort ();
+    }
+  if (slot)
+    *slot = key;
+  return key;
+}
 
-  json_t *json = lisp_to_json (args[0], &conf);
-  record_unwind_protect_ptr (json_release_object, json);
+/* Parse a JSON number whose first byte C has been consumed.  */
 
-  prepare_to_modify_buffer (PT, PT, NULL);
-  move_gap_both (PT, PT_BYTE);
-  struct json_insert_data data;
-  data.inserted_bytes = 0;
-  /* Could have used json_dumpb, but that became available only in
-     Jansson 2.10, whereas we want to support 2.7 and upward.  */
-  int status = json_dump_callback (json, json_insert_callback, &data,
-                                   JSON_COMPACT | JSON_ENCODE_ANY);
-  if (status == -1)
+static Lisp_Object
+json_parse_number (struct json_parser *parser, int c)
+{
+  enum { MAX_FIXNUM_DIGITS = 18 };
+  ptrdiff_t size = 0;
+  bool negative = c == '-';
+  bool is_float = false;
+
+#define JSON_NUMBER_PUSH(c)						\
+  do {									\
+    json_byte_workspace_reserve (parser, size + 2);			\
+    parser->byte_workspace[size++] = (c);				\
+  } while (false)
+
+  if (negative)
     {
-      if (CONSP (data.error))
-        xsignal (XCAR (data.error), XCDR (data.error));
-      else
-        json_out_of_memory ();
+      JSON_NUMBER_PUSH (c);
+      c = json_input_get_required (parser);
+    }
+  if (c == '0')
+    {
+      JSON_NUMBER_PUSH (c);
+      c = json_input_get (parser);
     }
+  else if ('1' <= c && c <= '9')
+    do
+      {
+	JSON_NUMBER_PUSH (c);
+	c = json_input_get (parser);
+      }
+    while ('0' <= c && c <= '9');
+  else
+    json_signal_error (parser, Qjson_parse_error, "invalid number");
+  ptrdiff_t integer_size = size;
 
-  ptrdiff_t inserted = 0;
-  ptrdiff_t inserted_bytes = data.inserted_bytes;
-  if (inserted_bytes > 0)
+  if (c == '.')
     {
-      /* If required, decode the stuff we've read into the gap.  */
-      struct coding_system coding;
-      /* JSON strings are UTF-8 encoded strings.  If for some reason
-	 the text returned by the Jansson library includes invalid
-	 byte sequences, they will be represented by raw bytes in the
-	 buffer text.  */
-      setup_coding_system (Qutf_8_unix, &coding);
-      coding.dst_multibyte =
-	!NILP (BVAR (current_buffer, enable_multibyte_characters));
-      if (CODING_MAY_REQUIRE_DECODING (&coding))
+      is_float = true;
+      JSON_NUMBER_PUSH (c);
+      c = json_input_get_required (parser);
+      if (! ('0' <= c && c <= '9'))
+	json_signal_error (parser, Qjson_parse_error, "invalid number");
+      do
 	{
-          /* Now we have all the new bytes at the beginning of the gap,
-             but `decode_coding_gap` needs them at the end of the gap, so
-             we need to move them.  */
-          memmove (GAP_END_ADDR - inserted_bytes, GPT_ADDR, inserted_bytes);
-	  decode_coding_gap (&coding, inserted_bytes);
-	  inserted = coding.produced_char;
+	  JSON_NUMBER_PUSH (c);
+	  c = json_input_get (parser);
 	}
-      else
+      while ('0' <= c && c <= '9');
+    }
+  if (c == 'e' || c == 'E')
+    {
+      is_float = true;
+      JSON_NUMBER_PUSH (c);
+      c = json_input_get_required (parser);
+      if (c == '+' || c == '-')
+	{
+	  JSON_NUMBER_PUSH (c);
+	  c = json_input_get_required (parser);
+	}
+      if (! ('0' <= c && c <= '9'))
+	json_signal_error (parser, Qjson_parse_error, "invalid number");
+      do
 	{
-          /* Make the inserted text part of the buffer, as unibyte text.  */
-          eassert (NILP (BVAR (current_buffer, enable_multibyte_characters)));
-          insert_from_gap_1 (inserted_bytes, inserted_bytes, false);
-
-	  /* The target buffer is unibyte, so we don't need to decode.  */
-	  invalidate_buffer_caches (current_buffer,
-				    PT, PT + inserted_bytes);
-	  adjust_after_insert (PT, PT_BYTE,
-			       PT + inserted_bytes,
-			       PT_BYTE + inserted_bytes,
-			       inserted_bytes);
-	  inserted = inserted_bytes;
+	  JSON_NUMBER_PUSH (c);
+	  c = json_input_get (parser);
 	}
+      while ('0' <= c && c <= '9');
     }
+  if (c >= 0)
+    json_input_put_back (parser);
+  JSON_NUMBER_PUSH ('\0');
 
-  /* Call after-change hooks.  */
-  signal_after_change (PT, 0, inserted);
-  if (inserted > 0)
+#undef JSON_NUMBER_PUSH
+
+  char *text = (char *) parser->byte_workspace;
+  if (is_float)
+    return make_float (strtod (text, NULL));
+  if (integer_size - negative <= MAX_FIXNUM_DIGITS)
     {
-      update_compositions (PT, PT, CHECK_BORDER);
-      /* Move point to after the inserted text.  */
-      SET_PT_BOTH (PT + inserted, PT_BYTE + inserted_bytes);
+      intmax_t value = 0;
+      for (ptrdiff_t i = negative; i < integer_size; i++)
+	value = value * 10 + (text[i] - '0');
+      return make_int (negative ? -value : value);
     }
+  return string_to_number (text, 10, NULL);
+}
 
-  return unbind_to (count, Qnil);
+/* Consume the rest of the literal LITERAL, whose first byte has been
+   consumed.  */
+
+static void
+json_parse_literal (struct json_parser *parser, const char *literal)
+{
+  for (const char *p = literal + 1; *p; p++)
+    if (json_input_get_required (parser) != *p)
+      json_signal_error (parser, Qjson_parse_error, "invalid token");
 }
 
-/* Convert a JSON object to a Lisp object.  */
+static Lisp_Object json_parse_value (struct json_parser *, int);
+
+/* Parse a JSON array whose opening bracket has been consumed.  */
 
-static Lisp_Object ARG_NONNULL ((1))
-json_to_lisp (json_t *json, const struct json_configuration *conf)
+static Lisp_Object
+json_parse_array (struct json_parser *parser)
 {
-  switch (json_typeof (json))
-    {
-    case JSON_NULL:
-      return conf->null_object;
-    case JSON_FALSE:
-      return conf->false_object;
-    case JSON_TRUE:
-      return Qt;
-    case JSON_INTEGER:
+  if (++lisp_eval_depth > max_lisp_eval_depth)
+    xsignal0 (Qjson_object_too_deep);
+
+  ptrdiff_t first = parser->object_workspace_current;
+  int c = json_skip_whitespace_required (parser);
+  if (c != ']')
+    for (ptrdiff_t i = 0; ; i++)
       {
-	json_int_t i = json_integer_value (json);
-	return INT_TO_INTEGER (i);
+	rarely_quit (i);
+	Lisp_Object value = json_parse_value (parser, c);
+	json_object_workspace_push (parser, value);
+	c = json_skip_whitespace_required (parser);
+	if (c == ']')
+	  break;
+	if (c != ',')
+	  json_signal_error (parser, Qjson_parse_error,
+			     "',' or ']' expected");
+	c = json_skip_whitespace_required (parser);
       }
-    case JSON_REAL:
-      return make_float (json_real_value (json));
-    case JSON_STRING:
-      return make_string_from_utf8 (json_string_value (json),
-				    json_string_length (json));
-    case JSON_ARRAY:
+
+  Lisp_Object *elements = parser->object_workspace + first;
+  ptrdiff_t size = parser->object_workspace_current - first;
+  Lisp_Object result;
+  switch (parser->conf->array_type)
+    {
+    case json_array_array:
+      result = make_uninit_vector (size);
+      if (size > 0)
+	memcpy (XVECTOR (result)->contents, elements,
+		size * sizeof *elements);
+      break;
+    case json_array_list:
+      result = Qnil;
+      for (ptrdiff_t i = size - 1; i >= 0; i--)
+	result = Fcons (elements[i], result);
+      break;
+    default:
+      /* Can't get here.  */
+      emacs_abort ();
+    }
+  parser->object_workspace_current = first;
+
+  --lisp_eval_depth;
+  return result;
+}
+
+/* Of the NPAIRS keys and values at PAIRS, whose keys are symbols,
+   merge those with the same key: keep the position of the first
+   occurrence and the value of the last one.  The keys of the
+   occurrences merged away are replaced by Qunbound.  */
+
+static void
+json_merge_duplicate_keys (Lisp_Object *pairs, ptrdiff_t npairs)
+{
+  if (npairs <= JSON_SMALL_OBJECT_SIZE)
+    {
+      for (ptrdiff_t i = 1; i < npairs; i++)
+	for (ptrdiff_t j = 0; j < i; j++)
+	  if (EQ (pairs[2 * j], pairs[2 * i]))
+	    {
+	      pairs[2 * j + 1] = pairs[2 * i + 1];
+	      pairs[2 * i] = Qunbound;
+	      break;
+	    }
+      return;
+    }
+
+  Lisp_Object table = CALLN (Fmake_hash_table, QCtest, Qeq, QCsize,
+			     make_fixed_natnum (npairs));
+  struct Lisp_Hash_Table *h = XHASH_TABLE (table);
+  for (ptrdiff_t i = 0; i < npairs; i++)
+    {
+      Lisp_Object hash;
+      ptrdiff_t j = hash_lookup (h, pairs[2 * i], &hash);
+      if (j < 0)
+	hash_put (h, pairs[2 * i], make_fixnum (i), hash);
+      else
+	{
+	  pairs[2 * XFIXNUM (HASH_VALUE (h, j)) + 1] = pairs[2 * i + 1];
+	  pairs[2 * i] = Qunbound;
+	}
+    }
+}
+
+/* Parse a JSON object whose opening brace has been consumed.  */
+
+static Lisp_Object
+json_parse_object (struct json_parser *parser)
+{
+  if (++lisp_eval_depth > max_lisp_eval_depth)
+    xsignal0 (Qjson_object_too_deep);
+
+  ptrdiff_t first = parser->object_workspace_current;
+  int c = json_skip_whitespace_required (parser);
+  if (c != '}')
+    for (ptrdiff_t i = 0; ; i++)
       {
-        if (++lisp_eval_depth > max_lisp_eval_depth)
-          xsignal0 (Qjson_object_too_deep);
-        size_t size = json_array_size (json);
-        if (PTRDIFF_MAX < size)
-          overflow_error ();
-        Lisp_Object result;
-        switch (conf->array_type)
-          {
-          case json_array_array:
-            {
-              result = make_vector (size, Qunbound);
-              for (ptrdiff_t i = 0; i < size; ++i)
-                {
-                  rarely_quit (i);
-                  ASET (result, i,
-                        json_to_lisp (json_array_get (json, i), conf));
-                }
-              break;
-            }
-          case json_array_list:
-            {
-              result = Qnil;
-              for (ptrdiff_t i = size - 1; i >= 0; --i)
-                {
-                  rarely_quit (i);
-                  result = Fcons (json_to_lisp (json_array_get (json, i), conf),
-                                  result);
-                }
-              break;
-            }
-          default:
-            /* Can't get here.  */
-            emacs_abort ();
-          }
-        --lisp_eval_depth;
-        return result;
+	rarely_quit (i);
+	if (c != '"')
+	  json_signal_error (parser, Qjson_parse_error,
+			     "string or '}' expected");
+	Lisp_Object key = json_parse_object_key (parser);
+	if (json_skip_whitespace_required (parser) != ':')
+	  json_signal_error (parser, Qjson_parse_error, "':' expected");
+	c = json_skip_whitespace_required (parser);
+	Lisp_Object value = json_parse_value (parser, c);
+	json_object_workspace_push (parser, key);
+	json_object_workspace_push (parser, value);
+	c = json_skip_whitespace_required (parser);
+	if (c == '}')
+	  break;
+	if (c != ',')
+	  json_signal_error (parser, Qjson_parse_error,
+			     "',' or '}' expected");
+	c = json_skip_whitespace_required (parser);
       }
-    case JSON_OBJECT:
+
+  Lisp_Object *pairs = parser->object_workspace + first;
+  ptrdiff_t npairs = (parser->object_workspace_current - first) / 2;
+  Lisp_Object result;
+  switch (parser->conf->object_type)
+    {
+    case json_object_hashtable:
       {
-        if (++lisp_eval_depth > max_lisp_eval_depth)
-          xsignal0 (Qjson_object_too_deep);
-        Lisp_Object result;
-        switch (conf->object_type)
-          {
-          case json_object_hashtable:
-            {
-              size_t size = json_object_size (json);
-              if (FIXNUM_OVERFLOW_P (size))
-                overflow_error ();
-              result = CALLN (Fmake_hash_table, QCtest, Qequal, QCsize,
-                              make_fixed_natnum (size));
-              struct Lisp_Hash_Table *h = XHASH_TABLE (result);
-              const char *key_str;
-              json_t *value;
-              json_object_foreach (json, key_str, value)
-                {
-		  Lisp_Object key = build_string_from_utf8 (key_str), hash;
-                  ptrdiff_t i = hash_lookup (h, key, &hash);
-                  /* Keys in JSON objects are unique, so the key can't
-                     be present yet.  */
-                  eassert (i < 0);
-                  hash_put (h, key, json_to_lisp (value, conf), hash);
-                }
-              break;
-            }
-          case json_object_alist:
-            {
-              result = Qnil;
-              const char *key_str;
-              json_t *value;
-              json_object_foreach (json, key_str, value)
-                {
-                  Lisp_Object key
-		    = Fintern (build_string_from_utf8 (key_str), Qnil);
-                  result
-                    = Fcons (Fcons (key, json_to_lisp (value, conf)),
-                             result);
-                }
-              result = Fnreverse (result);
-              break;
-            }
-          case json_object_plist:
-            {
-              result = Qnil;
-              const char *key_str;
-              json_t *value;
-              json_object_foreach (json, key_str, value)
-                {
-                  USE_SAFE_ALLOCA;
-                  ptrdiff_t key_str_len = strlen (key_str);
-                  char *keyword_key_str = SAFE_ALLOCA (1 + key_str_len + 1);
-                  keyword_key_str[0] = ':';
-                  strcpy (&keyword_key_str[1], key_str);
-                  Lisp_Object key = intern_1 (keyword_key_str, key_str_len + 1);
-                  /* Build the plist as value-key since we're going to
-                     reverse it in the end.*/
-                  result = Fcons (key, result);
-                  result = Fcons (json_to_lisp (value, conf), result);
-                  SAFE_FREE ();
-                }
-              result = Fnreverse (result);
-              break;
-            }
-          default:
-            /* Can't get here.  */
-            emacs_abort ();
-          }
-        --lisp_eval_depth;
-        return result;
+	result = CALLN (Fmake_hash_table, QCtest, Qequal, QCsize,
+			make_fixed_natnum (npairs));
+	struct Lisp_Hash_Table *h = XHASH_TABLE (result);
+	for (ptrdiff_t i = 0; i < npairs; i++)
+	  {
+	    Lisp_Object hash;
+	    ptrdiff_t j = hash_lookup (h, pairs[2 * i], &hash);
+	    if (j < 0)
+	      hash_put (h, pairs[2 * i], pairs[2 * i + 1], hash);
+	    else
+	      set_hash_value_slot (h, j, pairs[2 * i + 1]);
+	  }
+	break;
       }
+    case json_object_alist:
+      json_merge_duplicate_keys (pairs, npairs);
+      result = Qnil;
+      for (ptrdiff_t i = npairs - 1; i >= 0; i--)
+	if (!EQ (pairs[2 * i], Qunbound))
+	  result = Fcons (Fcons (pairs[2 * i], pairs[2 * i + 1]), result);
+      break;
+    case json_object_plist:
+      json_merge_duplicate_keys (pairs, npairs);
+      result = Qnil;
+      for (ptrdiff_t i = npairs - 1; i >= 0; i--)
+	if (!EQ (pairs[2 * i], Qunbound))
+	  result = Fcons (pairs[2 * i], Fcons (pairs[2 * i + 1], result));
+      break;
+    default:
+      /* Can't get here.  */
+      emacs_abort ();
+    }
+  parser->object_workspace_current = first;
+
+  --lisp_eval_depth;
+  return result;
+}
+
+/* Parse the JSON value whose first byte C has been consumed.  C is
+   -1 if there is no more input.  */
+
+static Lisp_Object
+json_parse_value (struct json_parser *parser, int c)
+{
+  if (c == '-' || ('0' <= c && c <= '9'))
+    return json_parse_number (parser, c);
+  switch (c)
+    {
+    case '{':
+      return json_parse_object (parser);
+    case '[':
+      return json_parse_array (parser);
+    case '"':
+      return json_parse_string (parser);
+    case 't':
+      json_parse_literal (parser, "true");
+      return Qt;
+    case 'f':
+      json_parse_literal (parser, "false");
+      return parser->conf->false_object;
+    case 'n':
+      json_parse_literal (parser, "null");
+      return parser->conf->null_object;
+    case -1:
+      json_signal_end_of_file (parser);
+    default:
+      json_signal_error (parser, Qjson_parse_error, "invalid token");
+    }
+}
+
+/* Parse the JSON value at the start of the input of PARSER, which may
+   be preceded by whitespace.  */
+
+static Lisp_Object
+json_parse (struct json_parser *parser)
+{
+  return json_parse_value (parser, json_skip_whitespace (parser));
+}
+
+/* Signal an error if the NARGS keyword arguments ARGS are not valid
+   for json-parse-string.  */
+
+void
+json_check_parse_args (ptrdiff_t nargs, Lisp_Object *args)
+{
+  struct json_configuration conf =
+    {json_object_hashtable, json_array_array, QCnull, QCfalse};
+  json_parse_args (nargs, args, &conf, true);
+}
+
+/* Parse the NBYTES bytes of UTF-8 at INPUT as a single JSON value, as
+   json-parse-string does with the NARGS keyword arguments ARGS.
+   SOURCE says where the input comes from, for error messages.  */
+
+Lisp_Object
+json_parse_bytes (const char *source, const unsigned char *input,
+		  ptrdiff_t nbytes, ptrdiff_t nargs, Lisp_Object *args)
+{
+  ptrdiff_t count = SPECPDL_INDEX ();
+
+  struct json_configuration conf =
+    {json_object_hashtable, json_array_array, QCnull, QCfalse};
+  json_parse_args (nargs, args, &conf, true);
+
+  struct json_parser parser;
+  json_parser_init (&parser, &conf, source, input, input + nbytes,
+		    NULL, NULL);
+  record_unwind_protect_ptr (json_parser_done, &parser);
+
+  Lisp_Object result = json_parse (&parser);
+  if (json_skip_whitespace (&parser) >= 0)
+    {
+      json_input_put_back (&parser);
+      json_signal_error (&parser, Qjson_trailing_content,
+			 "end of input expected");
     }
-  /* Can't get here.  */
-  emacs_abort ();
+
+  return unbind_to (count, result);
 }
 
 DEFUN ("json-parse-string", Fjson_parse_string, Sjson_parse_string, 1, MANY,
@@ -950,69 +1610,14 @@ DEFUN ("json-parse-string", Fjson_parse_string, Sjson_parse_string, 1, MANY,
 usage: (json-parse-string STRING &rest ARGS) */)
   (ptrdiff_t nargs, Lisp_Object *args)
 {
-  ptrdiff_t count = SPECPDL_INDEX ();
-
-#ifdef WINDOWSNT
-  if (!json_initialized)
-    {
-      Lisp_Object status;
-      json_initialized = init_json_functions ();
-      status = json_initialized ? Qt : Qnil;
-      Vlibrary_cache = Fcons (Fcons (Qjson, status), Vlibrary_cache);
-    }
-  if (!json_initialized)
-    Fsignal (Qjson_unavailable,
-	     list1 (build_unibyte_string ("jansson library not found")));
-#endif
-
   Lisp_Object string = args[0];
   CHECK_STRING (string);
-  Lisp_Object encoded = json_encode (string);
+  /* Strings whose internal representation is already UTF-8 are
+     parsed where they are.  */
+  Lisp_Object encoded = encode_string_utf_8 (string, Qnil, true, Qt, Qt);
   check_string_without_embedded_nulls (encoded);
-  struct json_configuration conf =
-    {json_object_hashtable, json_array_array, QCnull, QCfalse};
-  json_parse_args (nargs - 1, args + 1, &conf, true);
-
-  json_error_t error;
-  json_t *object
-    = json_loads (SSDATA (encoded), JSON_DECODE_ANY, &error);
-  if (object == NULL)
-    json_parse_error (&error);
-
-  /* Avoid leaking the object in case of further errors.  */
-  if (object != NULL)
-    record_unwind_protect_ptr (json_release_object, object);
-
-  return unbind_to (count, json_to_lisp (object, &conf));
-}
-
-struct json_read_buffer_data
-{
-  /* Byte position of position to read the next chunk from.  */
-  ptrdiff_t point;
-};
-
-/* Callback for json_load_callback that reads from the current buffer.
-   DATA must point to a structure of type json_read_buffer_data.
-   data->point must point to the byte position to read from; after
-   reading, data->point is advanced accordingly.  The buffer point
-   itself is ignored.  This function may not exit nonlocally.  */
-
-static size_t
-json_read_buffer_callback (void *buffer, size_t buflen, void *data)
-{
-  struct json_read_buffer_data *d = data;
-
-  /* First, parse from point to the gap or the end of the accessible
-     portion, whatever is closer.  */
-  ptrdiff_t point = d->point;
-  ptrdiff_t end = BUFFER_CEILING_OF (point) + 1;
-  ptrdiff_t count = end - point;
-  if (buflen < count)
-    count = buflen;
-  memcpy (buffer, BYTE_POS_ADDR (point), count);
-  d->point += count;
-  return count;
+  return json_parse_bytes ("<string>", SDATA (encoded), SBYTES (encoded),
+			   nargs - 1, args + 1);
 }
 
 DEFUN ("json-parse-buffer", Fjson_parse_buffer, Sjson_parse_buffer,
@@ -1049,45 +1654,38 @@ DEFUN ("json-parse-buffer", Fjson_parse_buffer, Sjson_parse_buffer,
 {
   ptrdiff_t count = SPECPDL_INDEX ();
 
-#ifdef WINDOWSNT
-  if (!json_initialized)
-    {
-      Lisp_Object status;
-      json_initialized = init_json_functions ();
-      status = json_initialized ? Qt : Qnil;
-      Vlibrary_cache = Fcons (Fcons (Qjson, status), Vlibrary_cache);
-    }
-  if (!json_initialized)
-    Fsignal (Qjson_unavailable,
-	     list1 (build_unibyte_string ("jansson library not found")));
-#endif
-
   struct json_configuration conf =
     {json_object_hashtable, json_array_array, QCnull, QCfalse};
   json_parse_args (nargs, args, &conf, true);
 
-  ptrdiff_t point = PT_BYTE;
-  struct json_read_buffer_data data = {.point = point};
-  json_error_t error;
-  json_t *object
-    = json_load_callback (json_read_buffer_callback, &data,
-                          JSON_DECODE_ANY | JSON_DISABLE_EOF_CHECK,
-                          &error);
-
-  if (object == NULL)
-    json_parse_error (&error);
+#ifdef REL_ALLOC
+  /* Prevent ralloc.c from relocating the current buffer while it is
+     being parsed.  */
+  r_alloc_inhibit_buffer_relocation (1);
+  record_unwind_protect_int (r_alloc_inhibit_buffer_relocation, 0);
+#endif
 
-  /* Avoid leaking the object in case of further errors.  */
-  record_unwind_protect_ptr (json_release_object, object);
+  /* Parse the text from point to the end of the accessible portion,
+     in two segments if the gap is in between.  */
+  ptrdiff_t point = PT_BYTE;
+  ptrdiff_t end = ZV_BYTE;
+  const unsigned char *input = BYTE_POS_ADDR (point);
+  struct json_parser parser;
+  if (point < GPT_BYTE && GPT_BYTE < end)
+    json_parser_init (&parser, &conf, "<buffer>", input, GPT_ADDR,
+		      GAP_END_ADDR, GAP_END_ADDR + (end - GPT_BYTE));
+  else
+    json_parser_init (&parser, &conf, "<buffer>",
+		      input, input + (end - point), NULL, NULL);
+  record_unwind_protect_ptr (json_parser_done, &parser);
 
-  /* Convert and then move point only if everything succeeded.  */
-  Lisp_Object lisp = json_to_lisp (object, &conf);
+  Lisp_Object result = json_parse (&parser);
 
-  /* Adjust point by how much we just read.  */
-  point += error.position;
+  /* Move point only if everything succeeded.  */
+  point += json_input_position (&parser);
   SET_PT_BOTH (BYTE_TO_CHAR (point), point);
 
-  return unbind_to (count, lisp);
+  return unbind_to (count, result);
 }
 
 /* Simplified version of 'define-error' that works with pure
@@ -1136,8 +1734,8 @@ syms_of_json (void)
   DEFSYM (Qpure, "pure");
   DEFSYM (Qside_effect_free, "side-effect-free");
 
-  DEFSYM (Qjson_serialize, "json-serialize");
   DEFSYM (Qjson_parse_string, "json-parse-string");
+  DEFSYM (Qjson_serialize, "json-serialize");
   Fput (Qjson_serialize, Qpure, Qt);
   Fput (Qjson_serialize, Qside_effect_free, Qt);
   Fput (Qjson_parse_string, Qpure, Qt);
@@ -1153,6 +1751,9 @@ syms_of_json (void)
 
   defsubr (&Sjson_serialize);
   defsubr (&Sjson_insert);
+#ifdef subprocesses
+  defsubr (&Sjson_send_to_process);
+#endif
   defsubr (&Sjson_parse_string);
   defsubr (&Sjson_parse_buffer);
 }
@@ -3476,7 +3476,11 @@ readable_events (int flags)
 		      && (event->kind == FOCUS_IN_EVENT
 			  || event->kind == FOCUS_OUT_EVENT))
 		     || (input_pending_p_filter_events
-			 && is_ignored_event (event))))
+			 && is_ignored_event (event))
+#ifdef HAVE_WINDOW_SYSTEM
+		     || event->kind == IMAGE_LOADED_EVENT
+#endif
+		     ))
 #ifdef USE_TOOLKIT_SCROLL_BARS
 		  && !((flags & READABLE_EVENTS_IGNORE_SQUEEZABLES)
 		       && (event->kind == SCROLL_BAR_CLICK_EVENT
@@ -3981,6 +3985,7 @@ kbd_buffer_get_event (KBOARD **kbp,
       case ICONIFY_EVENT:
       case DEICONIFY_EVENT:
       case MOVE_FRAME_EVENT:
+      case IMAGE_LOADED_EVENT:
 #endif
 #ifdef USE_FILE_NOTIFY
       case FILE_NOTIFY_EVENT:
@@ -4184,6 +4189,436 @@ swallow_events (bool do_display)
     redisplay_preserve_echo_area (7);
 }
 
+/* Timer queues.
+
+   Active timers are kept in the lists `timer-list' and
+   `timer-idle-list', which Lisp code may inspect, and, to find the
+   next timer quickly, in a binary heap for each list, ordered by the
+   time the timer is due.  New timers are pushed on the front of a
+   list, so the lists are not sorted.
+
+   An eq hash table maps each timer in a list to a vector holding its
+   position in the heap and the cons preceding it in the list, so that
+   timer--insert and timer--remove take O(log N) time.  The heaps and
+   tables are rebuilt from the lists when Lisp code sets the list
+   variables directly.  If a list holds invalid timers, or a timer
+   more than once, timers are removed from it by searching it.  */
+
+/* The slots of the vectors mapped to the timers by the hash table of
+   a timer heap: the timer, its index in the heap or -1 if it is not
+   in the heap, and the cons before it in the list, or nil if it is
+   the first element.  */
+enum { TIMER_INFO_TIMER, TIMER_INFO_INDEX, TIMER_INFO_PREV, TIMER_INFO_SLOTS };
+
+struct timer_heap_entry
+{
+  /* When the timer was due when the entry was made.  */
+  struct timespec time;
+
+  /* Order in which entries were made, to break ties and to tell
+     which timers were added while timers were being run.  */
+  intmax_t seq;
+
+  /* The vector describing the timer.  It is protected from GC by the
+     hash table of the heap.  */
+  Lisp_Object info;
+};
+
+struct timer_heap
+{
+  /* The list of the timers, `timer-list' or `timer-idle-list'.  */
+  Lisp_Object *list;
+
+  /* The entries, and the number of entries used and allocated.  */
+  struct timer_heap_entry *entries;
+  ptrdiff_t used, size;
+
+  /* The hash table mapping the timers in LIST to their vectors, or
+     nil if not made yet.  */
+  Lisp_Object table;
+
+  /* The number of elements of LIST that are invalid timers, or
+     timers that occur earlier in LIST.  */
+  ptrdiff_t junk;
+};
+
+static struct timer_heap timer_heap = { &Vtimer_list };
+static struct timer_heap idle_timer_heap = { &Vtimer_idle_list };
+
+/* Sequence number of the next heap entry.  */
+static intmax_t timer_heap_seq;
+
+/* True if `timer-list' or `timer-idle-list' was set by Lisp code,
+   so that the heaps must be rebuilt.  */
+static bool timer_heaps_stale;
+
+/* Statistics about timers that were run, see `timer-statistics'.  */
+static struct
+{
+  intmax_t dispatched, idle_dispatched;
+  struct timespec total_latency, max_latency;
+} timer_statistics;
+
+/* Store in *RESULT the time of TIMER, disregarding whether it was
+   triggered.  Value is false if TIMER is not a valid timer.  */
+
+static bool
+timer_time (Lisp_Object timer, struct timespec *result)
+{
+  Lisp_Object *vec;
+
+  if (! (VECTORP (timer) && ASIZE (timer) == 10))
+    return false;
+  vec = XVECTOR (timer)->contents;
+  if (! FIXNUMP (vec[2]))
+    return false;
+  return list4_to_timespec (vec[1], vec[2], vec[3], vec[8], result);
+}
+
+/* Return the vector describing TIMER in heap H, or nil if TIMER is
+   not in the list of H.  */
+
+static Lisp_Object
+timer_info (struct timer_heap *h, Lisp_Object timer)
+{
+  return NILP (h->table) ? Qnil : Fgethash (timer, h->table, Qnil);
+}
+
+static bool
+timer_heap_less (struct timer_heap_entry *a, struct timer_heap_entry *b)
+{
+  int c = timespec_cmp (a->time, b->time);
+  return c < 0 || (c == 0 && a->seq < b->seq);
+}
+
+/* Store entry E at index I of heap H.  */
+
+static void
+timer_heap_set (struct timer_heap *h, ptrdiff_t i, struct timer_heap_entry e)
+{
+  h->entries[i] = e;
+  ASET (e.info, TIMER_INFO_INDEX, make_fixnum (i));
+}
+
+static void
+timer_heap_swap (struct timer_heap *h, ptrdiff_t i, ptrdiff_t j)
+{
+  struct timer_heap_entry e = h->entries[i];
+
+  timer_heap_set (h, i, h->entries[j]);
+  timer_heap_set (h, j, e);
+}
+
+static void
+timer_heap_sift_up (struct timer_heap *h, ptrdiff_t i)
+{
+  while (i > 0)
+    {
+      ptrdiff_t parent = (i - 1) / 2;
+      if (!timer_heap_less (&h->entries[i], &h->entries[parent]))
+	break;
+      timer_heap_swap (h, i, parent);
+      i = parent;
+    }
+}
+
+static void
+timer_heap_sift_down (struct timer_heap *h, ptrdiff_t i)
+{
+  for (;;)
+    {
+      ptrdiff_t least = i, left = 2 * i + 1, right = left + 1;
+
+      if (left < h->used
+	  && timer_heap_less (&h->entries[left], &h->entries[least]))
+	least = left;
+      if (right < h->used
+	  && timer_heap_less (&h->entries[right], &h->entries[least]))
+	least = right;
+      if (least == i)
+	break;
+      timer_heap_swap (h, i, least);
+      i = least;
+    }
+}
+
+/* Add an entry for the timer described by INFO, which is due at TIME,
+   to heap H.  */
+
+static void
+timer_heap_push (struct timer_heap *h, Lisp_Object info, struct timespec time)
+{
+  if (h->used == h->size)
+    h->entries = xpalloc (h->entries, &h->size, 1, -1, sizeof *h->entries);
+
+  struct timer_heap_entry e = { time, timer_heap_seq++, info };
+  timer_heap_set (h, h->used, e);
+  timer_heap_sift_up (h, h->used++);
+}
+
+/* Remove the entry at index I of heap H.  Its timer stays in the
+   list of H.  */
+
+static void
+timer_heap_delete (struct timer_heap *h, ptrdiff_t i)
+{
+  ASET (h->entries[i].info, TIMER_INFO_INDEX, make_fixnum (-1));
+  if (i < --h->used)
+    {
+      timer_heap_set (h, i, h->entries[h->used]);
+      timer_heap_sift_up (h, i);
+      timer_heap_sift_down (h, i);
+    }
+}
+
+/* Make heap H describe the timers in its list again.  */
+
+static void
+timer_heap_rebuild (struct timer_heap *h)
+{
+  Lisp_Object prev = Qnil, tail = *h->list;
+
+  h->used = h->junk = 0;
+  if (NILP (h->table))
+    h->table = make_hash_table (hashtest_eq, DEFAULT_HASH_SIZE,
+				DEFAULT_REHASH_SIZE, DEFAULT_REHASH_THRESHOLD,
+				Qnil, false);
+  else
+    Fclrhash (h->table);
+
+  FOR_EACH_TAIL_SAFE (tail)
+    {
+      Lisp_Object timer = XCAR (tail);
+      struct timespec time;
+
+      if (timer_time (timer, &time) && NILP (timer_info (h, timer)))
+	{
+	  Lisp_Object info = make_nil_vector (TIMER_INFO_SLOTS);
+	  ASET (info, TIMER_INFO_TIMER, timer);
+	  ASET (info, TIMER_INFO_PREV, prev);
+	  Fputhash (timer, info, h->table);
+	  timer_heap_push (h, info, time);
+	}
+      else
+	h->junk++;
+      prev = tail;
+    }
+}
+
+/* Variable watcher for `timer-list' and `timer-idle-list'.  */
+
+static Lisp_Object
+watch_timer_list (Lisp_Object symbol, Lisp_Object newval,
+		  Lisp_Object operation, Lisp_Object where)
+{
+  timer_heaps_stale = true;
+  return Qnil;
+}
+
+/* Rebuild the heaps if Lisp code has set the timer lists.  */
+
+static void
+rebuild_stale_timer_heaps (void)
+{
+  if (timer_heaps_stale)
+    {
+      timer_heaps_stale = false;
+      timer_heap_rebuild (&timer_heap);
+      timer_heap_rebuild (&idle_timer_heap);
+    }
+}
+
+/* Remove TIMER from the list of heap H.  Value is the cons that held
+   TIMER, or nil if TIMER was not in the list.  */
+
+static Lisp_Object
+timer_heap_remove (struct timer_heap *h, Lisp_Object timer)
+{
+  Lisp_Object info, prev = Qnil, cell = Qnil, next, next_info;
+
+  info = h->junk ? Qnil : timer_info (h, timer);
+  if (!NILP (info))
+    {
+      prev = AREF (info, TIMER_INFO_PREV);
+      cell = NILP (prev) ? *h->list : CONSP (prev) ? XCDR (prev) : Qnil;
+      if (! (CONSP (cell) && EQ (XCAR (cell), timer)))
+	{
+	  /* Lisp code has modified the list destructively.  */
+	  timer_heap_rebuild (h);
+	  info = h->junk ? Qnil : timer_info (h, timer);
+	  if (!NILP (info))
+	    {
+	      prev = AREF (info, TIMER_INFO_PREV);
+	      cell = NILP (prev) ? *h->list : XCDR (prev);
+	    }
+	}
+    }
+
+  if (h->junk)
+    {
+      /* TIMER may be in the list more than once.  */
+      cell = Fmemq (timer, *h->list);
+      if (CONSP (cell))
+	{
+	  *h->list = Fdelq (timer, *h->list);
+	  timer_heap_rebuild (h);
+	}
+      return cell;
+    }
+  if (NILP (info))
+    return Qnil;
+
+  /* Unlink CELL, leaving its cdr alone like `delq' does, so that
+     loops over the list aren't disturbed.  */
+  next = XCDR (cell);
+  if (NILP (prev))
+    *h->list = next;
+  else
+    XSETCDR (prev, next);
+  if (CONSP (next))
+    {
+      next_info = timer_info (h, XCAR (next));
+      if (!NILP (next_info) && EQ (AREF (next_info, TIMER_INFO_PREV), cell))
+	ASET (next_info, TIMER_INFO_PREV, prev);
+    }
+
+  if (XFIXNUM (AREF (info, TIMER_INFO_INDEX)) >= 0)
+    timer_heap_delete (h, XFIXNUM (AREF (info, TIMER_INFO_INDEX)));
+  Fremhash (timer, h->table);
+  return cell;
+}
+
+DEFUN ("timer--insert", Ftimer__insert, Stimer__insert, 2, 3, 0,
+       doc: /* Add TIMER to `timer-list', or to `timer-idle-list' if IDLE.
+If REUSE-CELL is a cons, use it as the new cons of the list.
+This is an internal function; use `timer-activate' instead.  */)
+  (Lisp_Object timer, Lisp_Object idle, Lisp_Object reuse_cell)
+{
+  struct timer_heap *h = NILP (idle) ? &timer_heap : &idle_timer_heap;
+  Lisp_Object cell, head, head_info;
+  struct timespec time;
+
+  rebuild_stale_timer_heaps ();
+
+  /* A timer is in a list at most once.  */
+  timer_heap_remove (h, timer);
+  head = *h->list;
+
+  if (CONSP (reuse_cell))
+    {
+      XSETCAR (reuse_cell, timer);
+      XSETCDR (reuse_cell, head);
+      cell = reuse_cell;
+    }
+  else
+    cell = Fcons (timer, head);
+
+  /* Set the variables directly, so that watch_timer_list isn't
+     called.  */
+  *h->list = cell;
+
+  if (!timer_time (timer, &time))
+    {
+      h->junk++;
+      return Qnil;
+    }
+
+  if (CONSP (head))
+    {
+      head_info = timer_info (h, XCAR (head));
+      if (!NILP (head_info) && NILP (AREF (head_info, TIMER_INFO_PREV)))
+	ASET (head_info, TIMER_INFO_PREV, cell);
+    }
+
+  if (NILP (h->table))
+    timer_heap_rebuild (h);
+  else
+    {
+      Lisp_Object info = make_nil_vector (TIMER_INFO_SLOTS);
+      ASET (info, TIMER_INFO_TIMER, timer);
+      Fputhash (timer, info, h->table);
+      timer_heap_push (h, info, time);
+    }
+  return Qnil;
+}
+
+DEFUN ("timer--remove", Ftimer__remove, Stimer__remove, 1, 1, 0,
+       doc: /* Remove TIMER from `timer-list' and `timer-idle-list'.
+Return the cons cell that held TIMER in one of these lists, or nil.
+This is an internal function; use `cancel-timer' instead.  */)
+  (Lisp_Object timer)
+{
+  rebuild_stale_timer_heaps ();
+
+  Lisp_Object cell = timer_heap_remove (&timer_heap, timer);
+  Lisp_Object idle_cell = timer_heap_remove (&idle_timer_heap, timer);
+  return NILP (cell) ? idle_cell : cell;
+}
+
+DEFUN ("timer--active-p", Ftimer__active_p, Stimer__active_p, 1, 2, 0,
+       doc: /* Return non-nil if TIMER is in `timer-list'.
+If IDLE is non-nil, return non-nil if TIMER is in `timer-idle-list'.
+This is an internal function; it is faster than `memq'.  */)
+  (Lisp_Object timer, Lisp_Object idle)
+{
+  struct timer_heap *h = NILP (idle) ? &timer_heap : &idle_timer_heap;
+
+  rebuild_stale_timer_heaps ();
+  if (h->junk)
+    return Fmemq (timer, *h->list);
+  return NILP (timer_info (h, timer)) ? Qnil : Qt;
+}
+
+/* Return the first entry of heap H after taking out of the heap the
+   entries of timers that were triggered; these are pushed on
+   *DEFERRED if H is not the heap of idle timers, and may be run when
+   they are no longer triggered.  Value is NULL if the heap is
+   empty.  */
+
+static struct timer_heap_entry *
+timer_heap_first (struct timer_heap *h, Lisp_Object *deferred)
+{
+  while (h->used > 0)
+    {
+      struct timer_heap_entry *e = &h->entries[0];
+      Lisp_Object timer = AREF (e->info, TIMER_INFO_TIMER);
+      struct timespec time;
+
+      if (!timer_time (timer, &time))
+	/* Lisp code has made TIMER invalid.  */
+	timer_heap_delete (h, 0);
+      else if (timespec_cmp (time, e->time) != 0)
+	{
+	  /* Lisp code has changed the time of TIMER in place.  */
+	  e->time = time;
+	  timer_heap_sift_down (h, 0);
+	}
+      else if (NILP (AREF (timer, 0)))
+	return e;
+      else
+	{
+	  if (h != &idle_timer_heap)
+	    *deferred = Fcons (timer, *deferred);
+	  timer_heap_delete (h, 0);
+	}
+    }
+  return NULL;
+}
+
+/* Put the deferred TIMER back into the heap of ordinary timers, if it
+   is still in `timer-list'.  */
+
+static void
+timer_heap_undefer (Lisp_Object timer)
+{
+  Lisp_Object info = timer_info (&timer_heap, timer);
+  struct timespec time;
+
+  if (!NILP (info) && XFIXNUM (AREF (info, TIMER_INFO_INDEX)) < 0
+      && timer_time (timer, &time))
+    timer_heap_push (&timer_heap, info, time);
+}
+
 /* Record the start of when Emacs is idle,
    for the sake of running idle-time timers.  */
 
@@ -4199,6 +4634,7 @@ timer_start_idle (void)
 
   /* Mark all idle-time timers as once again candidates for running.  */
   call0 (intern ("internal-timer-start-idle"));
+  timer_heap_rebuild (&idle_timer_heap);
 }
 
 /* Record that Emacs is no longer idle, so stop running idle-time timers.  */
@@ -4225,26 +4661,7 @@ timer_resume_idle (void)
    ...).  Each element has the form (FUN . ARGS).  */
 Lisp_Object pending_funcalls;
 
-/* Return true if TIMER is a valid timer, placing its value into *RESULT.  */
-static bool
-decode_timer (Lisp_Object timer, struct timespec *result)
-{
-  Lisp_Object *vec;
-
-  if (! (VECTORP (timer) && ASIZE (timer) == 10))
-    return false;
-  vec = XVECTOR (timer)->contents;
-  if (! NILP (vec[0]))
-    return false;
-  if (! FIXNUMP (vec[2]))
-    return false;
-  return list4_to_timespec (vec[1], vec[2], vec[3], vec[8], result);
-}
-
-
-/* Check whether a timer has fired.  To prevent larger problems we simply
-   disregard elements that are not proper timers.  Do not make a circular
-   timer list for the time being.
+/* Check whether a timer has fired.
 
    Returns the time to wait until the next timer fires.  If a
    timer is triggering now, return zero.
@@ -4252,19 +4669,22 @@ decode_timer (Lisp_Object timer, struct timespec *result)
 
    If a timer is ripe, we run it, with quitting turned off.
    In that case we return 0 to indicate that a new timer_check_2 call
-   should be done.  */
+   should be done.
+
+   Timers added after SEQ_LIMIT was taken are not run, even if they are
+   ripe; this allows a timer to add itself again, without locking up
+   Emacs if the newly added timer is already ripe when added.  Triggered
+   ordinary timers are pushed on *DEFERRED, see timer_heap_first.  */
 
 static struct timespec
-timer_check_2 (Lisp_Object timers, Lisp_Object idle_timers)
+timer_check_2 (intmax_t seq_limit, Lisp_Object *deferred)
 {
-  struct timespec nexttime;
-  struct timespec now;
-  struct timespec idleness_now;
-  Lisp_Object chosen_timer;
-
-  nexttime = invalid_timespec ();
-
-  chosen_timer = Qnil;
+  struct timespec now, idleness_now;
+  struct timespec timer_difference = invalid_timespec ();
+  struct timespec idle_timer_difference = invalid_timespec ();
+  struct timer_heap_entry *e, *idle_e = NULL;
+  bool timer_ripe = false, idle_timer_ripe = false;
+  bool idle = timespec_valid_p (timer_idleness_start_time);
 
   /* First run the code that was delayed.  */
   while (CONSP (pending_funcalls))
@@ -4274,128 +4694,99 @@ timer_check_2 (Lisp_Object timers, Lisp_Object idle_timers)
       safe_call2 (Qapply, XCAR (funcall), XCDR (funcall));
     }
 
-  if (CONSP (timers) || CONSP (idle_timers))
-    {
-      now = current_timespec ();
-      idleness_now = (timespec_valid_p (timer_idleness_start_time)
-		      ? timespec_sub (now, timer_idleness_start_time)
-		      : make_timespec (0, 0));
+  /* The timer lists may have been set by the code just run.  */
+  rebuild_stale_timer_heaps ();
+
+  now = current_timespec ();
+  idleness_now = (idle
+		  ? timespec_sub (now, timer_idleness_start_time)
+		  : make_timespec (0, 0));
+
+  /* Set TIMER_DIFFERENCE based on the next ordinary timer.
+     TIMER_DIFFERENCE is the distance in time from NOW to when
+     this timer becomes ripe.  */
+  e = timer_heap_first (&timer_heap, deferred);
+  if (e)
+    {
+      timer_ripe = timespec_cmp (e->time, now) <= 0;
+      timer_difference = (timer_ripe
+			  ? timespec_sub (now, e->time)
+			  : timespec_sub (e->time, now));
+    }
+
+  /* Likewise for IDLE_TIMER_DIFFERENCE based on the next idle timer.
+     Consider the idle timers only if Emacs is idle.  */
+  if (idle)
+    idle_e = timer_heap_first (&idle_timer_heap, deferred);
+  if (idle_e)
+    {
+      idle_timer_ripe = timespec_cmp (idle_e->time, idleness_now) <= 0;
+      idle_timer_difference
+	= (idle_timer_ripe
+	   ? timespec_sub (idleness_now, idle_e->time)
+	   : timespec_sub (idle_e->time, idleness_now));
+    }
+
+  /* Decide which timer is the next timer.  */
+  if (timespec_valid_p (timer_difference)
+      && (! timespec_valid_p (idle_timer_difference)
+	  || idle_timer_ripe < timer_ripe
+	  || (idle_timer_ripe == timer_ripe
+	      && ((timer_ripe
+		   ? timespec_cmp (idle_timer_difference,
+				   timer_difference)
+		   : timespec_cmp (timer_difference,
+				   idle_timer_difference))
+		  < 0))))
+    idle_e = NULL;
+  else if (idle_e)
+    {
+      e = idle_e;
+      timer_ripe = idle_timer_ripe;
+      timer_difference = idle_timer_difference;
     }
+  else
+    return invalid_timespec ();
+
+  /* When we encounter a timer that is still waiting, return the
+     amount of time to wait before it is ripe.  If the timer was
+     added while running timers, wait as little as possible.  */
+  if (!timer_ripe)
+    return timer_difference;
+  if (e->seq >= seq_limit)
+    return make_timespec (0, 1);
+
+  /* The timer is ripe; run it.  timer-event-handler removes it from
+     its list and heap.  */
+  Lisp_Object chosen_timer = AREF (e->info, TIMER_INFO_TIMER);
+  ptrdiff_t count = SPECPDL_INDEX ();
+  Lisp_Object old_deactivate_mark = Vdeactivate_mark;
 
-  while (CONSP (timers) || CONSP (idle_timers))
-    {
-      Lisp_Object timer = Qnil, idle_timer = Qnil;
-      struct timespec timer_time, idle_timer_time;
-      struct timespec difference;
-      struct timespec timer_difference = invalid_timespec ();
-      struct timespec idle_timer_difference = invalid_timespec ();
-      bool ripe, timer_ripe = 0, idle_timer_ripe = 0;
-
-      /* Set TIMER and TIMER_DIFFERENCE
-	 based on the next ordinary timer.
-	 TIMER_DIFFERENCE is the distance in time from NOW to when
-	 this timer becomes ripe.
-         Skip past invalid timers and timers already handled.  */
-      if (CONSP (timers))
-	{
-	  timer = XCAR (timers);
-	  if (! decode_timer (timer, &timer_time))
-	    {
-	      timers = XCDR (timers);
-	      continue;
-	    }
-
-	  timer_ripe = timespec_cmp (timer_time, now) <= 0;
-	  timer_difference = (timer_ripe
-			      ? timespec_sub (now, timer_time)
-			      : timespec_sub (timer_time, now));
-	}
-
-      /* Likewise for IDLE_TIMER and IDLE_TIMER_DIFFERENCE
-	 based on the next idle timer.  */
-      if (CONSP (idle_timers))
-	{
-	  idle_timer = XCAR (idle_timers);
-	  if (! decode_timer (idle_timer, &idle_timer_time))
-	    {
-	      idle_timers = XCDR (idle_timers);
-	      continue;
-	    }
-
-	  idle_timer_ripe = timespec_cmp (idle_timer_time, idleness_now) <= 0;
-	  idle_timer_difference
-	    = (idle_timer_ripe
-	       ? timespec_sub (idleness_now, idle_timer_time)
-	       : timespec_sub (idle_timer_time, idleness_now));
-	}
-
-      /* Decide which timer is the next timer,
-	 and set CHOSEN_TIMER, DIFFERENCE, and RIPE accordingly.
-	 Also step down the list where we found that timer.  */
-
-      if (timespec_valid_p (timer_difference)
-	  && (! timespec_valid_p (idle_timer_difference)
-	      || idle_timer_ripe < timer_ripe
-	      || (idle_timer_ripe == timer_ripe
-		  && ((timer_ripe
-		       ? timespec_cmp (idle_timer_difference,
-				       timer_difference)
-		       : timespec_cmp (timer_difference,
-				       idle_timer_difference))
-		      < 0))))
-	{
-	  chosen_timer = timer;
-	  timers = XCDR (timers);
-	  difference = timer_difference;
-	  ripe = timer_ripe;
-	}
-      else
-	{
-	  chosen_timer = idle_timer;
-	  idle_timers = XCDR (idle_timers);
-	  difference = idle_timer_difference;
-	  ripe = idle_timer_ripe;
-	}
-
-      /* If timer is ripe, run it if it hasn't been run.  */
-      if (ripe)
-	{
-	  if (NILP (AREF (chosen_timer, 0)))
-	    {
-	      ptrdiff_t count = SPECPDL_INDEX ();
-	      Lisp_Object old_deactivate_mark = Vdeactivate_mark;
-
-	      /* Mark the timer as triggered to prevent problems if the lisp
-		 code fails to reschedule it right.  */
-	      ASET (chosen_timer, 0, Qt);
-
-	      specbind (Qinhibit_quit, Qt);
+  if (idle_e)
+    timer_statistics.idle_dispatched++;
+  else
+    timer_statistics.dispatched++;
+  timer_statistics.total_latency
+    = timespec_add (timer_statistics.total_latency, timer_difference);
+  if (timespec_cmp (timer_difference, timer_statistics.max_latency) > 0)
+    timer_statistics.max_latency = timer_difference;
 
-	      call1 (Qtimer_event_handler, chosen_timer);
-	      Vdeactivate_mark = old_deactivate_mark;
-	      timers_run++;
-	      unbind_to (count, Qnil);
+  /* Mark the timer as triggered to prevent problems if the lisp
+     code fails to reschedule it right.  */
+  ASET (chosen_timer, 0, Qt);
 
-	      /* Since we have handled the event,
-		 we don't need to tell the caller to wake up and do it.  */
-              /* But the caller must still wait for the next timer, so
-                 return 0 to indicate that.  */
-	    }
+  specbind (Qinhibit_quit, Qt);
 
-	  nexttime = make_timespec (0, 0);
-          break;
-	}
-      else
-	/* When we encounter a timer that is still waiting,
-	   return the amount of time to wait before it is ripe.  */
-	{
-	  return difference;
-	}
-    }
+  call1 (Qtimer_event_handler, chosen_timer);
+  Vdeactivate_mark = old_deactivate_mark;
+  timers_run++;
+  unbind_to (count, Qnil);
 
-  /* No timers are pending in the future.  */
-  /* Return 0 if we generated an event, and -1 if not.  */
-  return nexttime;
+  /* Since we have handled the event,
+     we don't need to tell the caller to wake up and do it.  */
+  /* But the caller must still wait for the next timer, so
+     return 0 to indicate that.  */
+  return make_timespec (0, 0);
 }
 
 
@@ -4412,34 +4803,61 @@ timer_check_2 (Lisp_Object timers, Lisp_Object idle_timers)
 timer_check (void)
 {
   struct timespec nexttime;
-  Lisp_Object timers, idle_timers;
-
-  Lisp_Object tem = Vinhibit_quit;
-  Vinhibit_quit = Qt;
-
-  /* We use copies of the timers' lists to allow a timer to add itself
-     again, without locking up Emacs if the newly added timer is
-     already ripe when added.  */
-
-  /* Always consider the ordinary timers.  */
-  timers = Fcopy_sequence (Vtimer_list);
-  /* Consider the idle timers only if Emacs is idle.  */
-  if (timespec_valid_p (timer_idleness_start_time))
-    idle_timers = Fcopy_sequence (Vtimer_idle_list);
-  else
-    idle_timers = Qnil;
+  intmax_t seq_limit;
+  Lisp_Object deferred = Qnil;
 
-  Vinhibit_quit = tem;
+  /* Rebuild the heaps before taking SEQ_LIMIT, so that the timers
+     don't look as if they were added while running timers.  */
+  rebuild_stale_timer_heaps ();
+  seq_limit = timer_heap_seq;
 
   do
     {
-      nexttime = timer_check_2 (timers, idle_timers);
+      nexttime = timer_check_2 (seq_limit, &deferred);
     }
   while (nexttime.tv_sec == 0 && nexttime.tv_nsec == 0);
 
+  /* Put back the timers that couldn't be run because they were
+     triggered, but are still active.  */
+  for (; CONSP (deferred); deferred = XCDR (deferred))
+    timer_heap_undefer (XCAR (deferred));
+
   return nexttime;
 }
 
+DEFUN ("timer-statistics", Ftimer_statistics, Stimer_statistics, 0, 1, 0,
+       doc: /* Return statistics about the timers that were run.
+The value is a property list with the following properties:
+
+  :dispatched       The number of ordinary timers run.
+  :idle-dispatched  The number of idle timers run.
+  :mean-latency     The mean time in seconds by which timers ran
+                    later than they were due.
+  :max-latency      The maximum of these times.
+  :queued, :idle-queued
+                    The number of entries in the queues of ordinary
+                    and idle timers.
+
+If CLEAR is non-nil, reset the statistics after returning them.  */)
+  (Lisp_Object clear)
+{
+  intmax_t n = timer_statistics.dispatched + timer_statistics.idle_dispatched;
+  Lisp_Object value
+    = list (QCdispatched, make_int (timer_statistics.dispatched),
+	    QCidle_dispatched, make_int (timer_statistics.idle_dispatched),
+	    QCmean_latency,
+	    make_float (n ? timespectod (timer_statistics.total_latency) / n
+			: 0),
+	    QCmax_latency,
+	    make_float (timespectod (timer_statistics.max_latency)),
+	    QCqueued, make_int (timer_heap.used),
+	    QCidle_queued, make_int (idle_timer_heap.used));
+
+  if (!NILP (clear))
+    memset (&timer_statistics, 0, sizeof timer_statistics);
+  return value;
+}
+
 DEFUN ("current-idle-time", Fcurrent_idle_time, Scurrent_idle_time, 0, 0, 0,
        doc: /* Return the current length of Emacs idleness, or nil.
 The value when Emacs is idle is a Lisp timestamp in the style of
@@ -5432,6 +5850,14 @@ make_lispy_event (struct input_event *event)
     case NO_EVENT:
       return Qnil;
 
+#ifdef HAVE_WINDOW_SYSTEM
+    /* Put the loaded pixels into their images, outside of
+       redisplay; read_char redisplays when it reads nil.  */
+    case IMAGE_LOADED_EVENT:
+      image_finish_loads ();
+      return Qnil;
+#endif
+
     case HELP_EVENT:
       {
 	Lisp_Object frame = event->frame_or_window;
@@ -11626,6 +12052,9 @@ is_ignored_event (union buffered_input_event *event)
 
   switch (event->kind)
     {
+#ifdef HAVE_WINDOW_SYSTEM
+    case IMAGE_LOADED_EVENT: return true;
+#endif
     case FOCUS_IN_EVENT: ignore_event = Qfocus_in; break;
     case FOCUS_OUT_EVENT: ignore_event = Qfocus_out; break;
     case HELP_EVENT: ignore_event = Qhelp_echo; break;
@@ -11652,6 +12081,11 @@ syms_of_keyboard (void)
   pending_funcalls = Qnil;
   staticpro (&pending_funcalls);
 
+  timer_heap.table = Qnil;
+  staticpro (&timer_heap.table);
+  idle_timer_heap.table = Qnil;
+  staticpro (&idle_timer_heap.table);
+
   Vlispy_mouse_stem = build_pure_c_string ("mouse");
   staticpro (&Vlispy_mouse_stem);
 
@@ -11686,6 +12120,14 @@ syms_of_keyboard (void)
   tool_bar_items_vector = Qnil;
 
   DEFSYM (Qtimer_event_handler, "timer-event-handler");
+  DEFSYM (Qtimer_list, "timer-list");
+  DEFSYM (Qtimer_idle_list, "timer-idle-list");
+  DEFSYM (QCdispatched, ":dispatched");
+  DEFSYM (QCidle_dispatched, ":idle-dispatched");
+  DEFSYM (QCmean_latency, ":mean-latency");
+  DEFSYM (QCmax_latency, ":max-latency");
+  DEFSYM (QCqueued, ":queued");
+  DEFSYM (QCidle_queued, ":idle-queued");
 
   /* Non-nil disable property on a command means do not execute it;
      call disabled-command-function's value instead.  */
@@ -11917,6 +12359,10 @@ syms_of_keyboard (void)
   staticpro (&help_form_saved_window_configs);
 
   defsubr (&Scurrent_idle_time);
+  defsubr (&Stimer__insert);
+  defsubr (&Stimer__remove);
+  defsubr (&Stimer__active_p);
+  defsubr (&Stimer_statistics);
   defsubr (&Sevent_symbol_parse_modifiers);
   defsubr (&Sevent_convert_list);
   defsubr (&Sinternal_handle_focus_in);
@@ -12384,11 +12830,11 @@ syms_of_keyboard (void)
   Vdelayed_warnings_list = Qnil;
 
   DEFVAR_LISP ("timer-list", Vtimer_list,
-	       doc: /* List of active absolute time timers in order of increasing time.  */);
+	       doc: /* List of active absolute time timers, in no particular order.  */);
   Vtimer_list = Qnil;
 
   DEFVAR_LISP ("timer-idle-list", Vtimer_idle_list,
-	       doc: /* List of active idle-time timers in order of increasing time.  */);
+	       doc: /* List of active idle-time timers, in no particular order.  */);
   Vtimer_idle_list = Qnil;
 
   DEFVAR_LISP ("input-method-function", Vinput_method_function,
@@ -12563,6 +13009,16 @@ syms_of_keyboard (void)
 This flag may eventually be removed once this behavior is deemed safe.  */);
   input_pending_p_filter_events = true;
 
+  /* Rebuild the timer queues when Lisp code sets the timer lists.  */
+  static union Aligned_Lisp_Subr Swatch_timer_list =
+     {{{ PSEUDOVECTOR_FLAG | (PVEC_SUBR << PSEUDOVECTOR_AREA_BITS) },
+       { .a4 = watch_timer_list },
+       4, 4, "watch_timer_list", {0}, 0}};
+  Lisp_Object watcher;
+  XSETSUBR (watcher, &Swatch_timer_list.s);
+  Fadd_variable_watcher (Qtimer_list, watcher);
+  Fadd_variable_watcher (Qtimer_idle_list, watcher);
+
   pdumper_do_now_and_after_load (syms_of_keyboard_for_pdumper);
 }
 
@@ -12593,6 +13049,9 @@ syms_of_keyboard_for_pdumper (void)
   PDUMPER_RESET_LV (Vdeferred_action_list, Qnil);
   PDUMPER_RESET_LV (Vdelayed_warnings_list, Qnil);
 
+  /* The timer queues are not dumped; rebuild them from the lists.  */
+  timer_heaps_stale = true;
+
   /* Create the initial keyboard.  Qt means 'unset'.  */
   eassert (initial_kboard == NULL);
   initial_kboard = allocate_kboard (Qt);
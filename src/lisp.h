@@ -590,6 +590,7 @@ #define ENUM_BF(TYPE) enum TYPE
 /* Defined in chartab.c.  */
 extern Lisp_Object char_table_ref (Lisp_Object, int) ATTRIBUTE_PURE;
 extern void char_table_set (Lisp_Object, int, Lisp_Object);
+extern void char_table_modified (Lisp_Object);
 
 /* Defined in data.c.  */
 extern AVOID args_out_of_range_3 (Lisp_Object, Lisp_Object, Lisp_Object);
@@ -3681,11 +3682,11 @@ verify (FLT_RADIX == 2 || FLT_RADIX == 16);
 extern int x_bitmap_mask (struct frame *, ptrdiff_t);
 extern void syms_of_image (void);
 
-#ifdef HAVE_JSON
 /* Defined in json.c.  */
-extern void init_json (void);
+extern void json_check_parse_args (ptrdiff_t, Lisp_Object *);
+extern Lisp_Object json_parse_bytes (const char *, const unsigned char *,
+				     ptrdiff_t, ptrdiff_t, Lisp_Object *);
 extern void syms_of_json (void);
-#endif
 
 /* Defined in insdel.c.  */
 extern void move_gap_both (ptrdiff_t, ptrdiff_t);
@@ -3704,6 +3705,8 @@ verify (FLT_RADIX == 2 || FLT_RADIX == 16);
 			   bool, bool, bool);
 extern void insert_from_gap_1 (ptrdiff_t, ptrdiff_t, bool text_at_gap_tail);
 extern void insert_from_gap (ptrdiff_t, ptrdiff_t, bool text_at_gap_tail);
+extern void adjust_after_insert_before_markers (ptrdiff_t, ptrdiff_t,
+						ptrdiff_t, ptrdiff_t);
 extern void insert_from_string (Lisp_Object, ptrdiff_t, ptrdiff_t,
 				ptrdiff_t, ptrdiff_t, bool);
 extern void insert_from_buffer (struct buffer *, ptrdiff_t, ptrdiff_t, bool);
@@ -3743,6 +3746,7 @@ verify (FLT_RADIX == 2 || FLT_RADIX == 16);
 #endif
 extern Lisp_Object Vwindow_system;
 extern Lisp_Object sit_for (Lisp_Object, bool, int);
+extern void invalidate_glyph_row_caches (void);
 
 /* Defined in xdisp.c.  */
 extern bool noninteractive_need_newline;
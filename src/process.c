@@ -88,7 +88,20 @@ #define HAVE_LOCAL_SOCKETS
 #include <pty.h>
 #endif
 
+#ifdef HAVE_SYS_EPOLL_H
+#include <poll.h>
+#include <sys/epoll.h>
+#endif
+
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+#endif
+
 #include <c-ctype.h>
+#include <c-strcase.h>
 #include <flexmember.h>
 #include <nproc.h>
 #include <sig2str.h>
@@ -244,10 +257,37 @@ #define PIPECONN1_P(p) (EQ (p->type, Qpipe))
 # define HAVE_SEQPACKET
 #endif
 
+/* Define USE_EPOLL if wait_reading_process_output can wait for
+   descriptors with epoll, which costs time in proportion to the
+   number of ready descriptors rather than to the largest descriptor.
+   Define USE_POLL if, where epoll can't be used, it can wait with
+   poll instead of select, so that descriptors needn't be smaller
+   than FD_SETSIZE.  Builds with GLib wait with xg_select instead.  */
+
+#ifdef HAVE_SYS_EPOLL_H
+# define USE_EPOLL
+# ifndef HAVE_GLIB
+#  define USE_POLL
+# endif
+#endif
+
+/* Define USE_PIDFD if child processes can be waited for with
+   descriptors that become readable when they exit, so that the
+   SIGCHLD handler needn't check every process for having exited.  */
+
+#if defined HAVE_SYS_PIDFD_H && defined HAVE_PIDFD_OPEN && defined HAVE_WAITID
+# include <sys/pidfd.h>
+# define USE_PIDFD
+#endif
+
 #define READ_OUTPUT_DELAY_INCREMENT (TIMESPEC_HZ / 100)
 #define READ_OUTPUT_DELAY_MAX       (READ_OUTPUT_DELAY_INCREMENT * 5)
 #define READ_OUTPUT_DELAY_MAX_MAX   (READ_OUTPUT_DELAY_INCREMENT * 7)
 
+/* Upper bound of read_output_size, unless read-process-output-max is
+   even larger.  */
+#define READ_OUTPUT_SIZE_MAX (1024 * 1024)
+
 /* Number of processes which have a non-zero read_output_delay,
    and therefore might be delayed for adaptive read buffering.  */
 
@@ -260,7 +300,8 @@ #define READ_OUTPUT_DELAY_MAX_MAX   (READ_OUTPUT_DELAY_INCREMENT * 7)
 static void start_process_unwind (Lisp_Object);
 static void create_process (Lisp_Object, char **, Lisp_Object);
 #ifdef USABLE_SIGIO
-static bool keyboard_bit_set (fd_set *);
+struct ready_fds;
+static bool keyboard_bit_set (struct ready_fds *);
 #endif
 static void deactivate_process (Lisp_Object);
 static int status_notify (struct Lisp_Process *, struct Lisp_Process *);
@@ -295,9 +336,17 @@ network_lookup_address_info_1 (Lisp_Object host, const char *service,
 static void child_signal_read (int, void *);
 #endif
 static void child_signal_notify (void);
+#ifdef USE_PIDFD
+static void open_child_pidfd (struct Lisp_Process *);
+static void close_child_pidfd (struct Lisp_Process *);
+#endif
+
+/* The tables below that are indexed by descriptor have room for
+   this many descriptors.  See grow_fd_tables.  */
+static int fd_table_size;
 
 /* Indexed by descriptor, gives the process (if any) for that descriptor.  */
-static Lisp_Object chan_process[FD_SETSIZE];
+static Lisp_Object *chan_process;
 static void wait_for_socket_fds (Lisp_Object, char const *);
 
 /* Alist of elements (NAME . PROCESS).  */
@@ -309,18 +358,18 @@ network_lookup_address_info_1 (Lisp_Object host, const char *service,
    output from the process is to read at least one char.
    Always -1 on systems that support FIONREAD.  */
 
-static int proc_buffered_char[FD_SETSIZE];
+static int *proc_buffered_char;
 
 /* Table of `struct coding-system' for each process.  */
-static struct coding_system *proc_decode_coding_system[FD_SETSIZE];
-static struct coding_system *proc_encode_coding_system[FD_SETSIZE];
+static struct coding_system **proc_decode_coding_system;
+static struct coding_system **proc_encode_coding_system;
 
 #ifdef DATAGRAM_SOCKETS
 /* Table of `partner address' for datagram sockets.  */
 static struct sockaddr_and_len {
   struct sockaddr *sa;
   ptrdiff_t len;
-} datagram_address[FD_SETSIZE];
+} *datagram_address;
 #define DATAGRAM_CHAN_P(chan)	(datagram_address[chan].sa != 0)
 #define DATAGRAM_CONN_P(proc)                                           \
   (PROCESSP (proc) &&                                                   \
@@ -383,6 +432,21 @@ pset_mark (struct Lisp_Process *p, Lisp_Object val)
   p->mark = val;
 }
 static void
+pset_message_buf (struct Lisp_Process *p, Lisp_Object val)
+{
+  p->message_buf = val;
+}
+static void
+pset_message_framing (struct Lisp_Process *p, Lisp_Object val)
+{
+  p->message_framing = val;
+}
+static void
+pset_message_framing_args (struct Lisp_Process *p, Lisp_Object val)
+{
+  p->message_framing_args = val;
+}
+static void
 pset_thread (struct Lisp_Process *p, Lisp_Object val)
 {
   p->thread = val;
@@ -442,7 +506,12 @@ make_lisp_proc (struct Lisp_Process *p)
   /* This descriptor refers to a process.  */
   PROCESS_FD = 8,
   /* A non-blocking connect.  Only valid if FOR_WRITE is set.  */
-  NON_BLOCKING_CONNECT_FD = 16
+  NON_BLOCKING_CONNECT_FD = 16,
+  /* The input of a process that send_process waits to be able to
+     write to.  Only valid if FOR_WRITE is set.  */
+  INPUT_SPACE_FD = 32,
+  /* The pidfd of a child process.  Only valid if FOR_READ is set.  */
+  CHILD_FD = 64
 };
 
 static struct fd_callback_data
@@ -458,8 +527,614 @@ make_lisp_proc (struct Lisp_Process *p)
   /* If this fd is currently being selected on by a thread, this
      points to the thread.  Otherwise it is NULL.  */
   struct thread_state *waiting_thread;
-} fd_callback_info[FD_SETSIZE];
+  /* True if output from this fd is not to be read in this round of
+     wait_reading_process_output, for adaptive read buffering.  */
+  bool read_skipped;
+#ifdef USE_EPOLL
+  /* The epoll events for which this fd is registered with epoll_fd,
+     zero if it isn't.  These can be fewer than its flags ask for,
+     see epoll_mute.  */
+  int epoll_events;
+  /* True if epoll refused to register this fd, see epoll_set.  */
+  bool epoll_unsupported;
+#endif
+} *fd_callback_info;
+
+/* Number of descriptors whose waiting_thread is non-NULL.  */
+static int num_waiting_fds;
+
+/* Make room for descriptor FD in the tables indexed by descriptor.
+   Value is false if FD is too large to be waited for, which is the
+   case if FD_SETSIZE <= FD, unless descriptors are waited for with
+   poll or epoll.  */
+
+static bool
+grow_fd_tables (int fd)
+{
+  if (fd < fd_table_size)
+    return true;
+#ifndef USE_POLL
+  if (FD_SETSIZE <= fd)
+    return false;
+#endif
+
+  int old_size = fd_table_size;
+  ptrdiff_t size = old_size;
+  fd_callback_info = xpalloc (fd_callback_info, &size, fd + 1 - size,
+			      INT_MAX, sizeof *fd_callback_info);
+  fd_table_size = size;
+  chan_process = xnrealloc (chan_process, size, sizeof *chan_process);
+  proc_buffered_char = xnrealloc (proc_buffered_char, size,
+				  sizeof *proc_buffered_char);
+  proc_decode_coding_system
+    = xnrealloc (proc_decode_coding_system, size,
+		 sizeof *proc_decode_coding_system);
+  proc_encode_coding_system
+    = xnrealloc (proc_encode_coding_system, size,
+		 sizeof *proc_encode_coding_system);
+#ifdef DATAGRAM_SOCKETS
+  datagram_address = xnrealloc (datagram_address, size,
+				sizeof *datagram_address);
+#endif
+
+  for (int i = old_size; i < size; i++)
+    {
+      memset (&fd_callback_info[i], 0, sizeof fd_callback_info[i]);
+      chan_process[i] = Qnil;
+      proc_buffered_char[i] = -1;
+      proc_decode_coding_system[i] = NULL;
+      proc_encode_coding_system[i] = NULL;
+#ifdef DATAGRAM_SOCKETS
+      datagram_address[i].sa = NULL;
+      datagram_address[i].len = 0;
+#endif
+    }
+  return true;
+}
+
+/* What wait_reading_process_output waits for in one round.  */
+
+struct wait_filter
+{
+  /* Wait until reading is possible from descriptors that have
+     FOR_READ and none of the flags in READ_EXCLUDE.  */
+  int read_exclude;
+
+  /* If nonnegative, wait for reading from this descriptor instead.  */
+  int only_fd;
+
+  /* Whether to wait until writing is possible to descriptors that
+     have FOR_WRITE.  */
+  bool write;
+
+  /* If nonnegative, also wait for reading from this descriptor, or
+     never wait for this descriptor.  Wait for the pidfds of child
+     processes whenever waiting for CHILD_FD.  */
+  int child_fd, exclude_fd;
+};
+
+/* Return the events (FOR_READ and FOR_WRITE) for which FILTER waits
+   on FD.  If MARK, record that the current thread waits on FD.  */
+
+static int
+wanted_events (struct wait_filter const *filter, int fd, bool mark)
+{
+  struct fd_callback_data *d = &fd_callback_info[fd];
+  int events = 0;
+
+  if (fd == filter->child_fd || fd == filter->only_fd)
+    return FOR_READ;
+  if ((d->flags & CHILD_FD) != 0)
+    return 0 <= filter->child_fd ? FOR_READ : 0;
+  if (fd == filter->exclude_fd)
+    return 0;
+  if (d->thread != NULL && d->thread != current_thread)
+    return 0;
+  if (d->waiting_thread != NULL && d->waiting_thread != current_thread)
+    return 0;
+  if ((d->flags & FOR_READ) != 0
+      && (d->flags & filter->read_exclude) == 0
+      && filter->only_fd < 0
+      && !d->read_skipped)
+    events |= FOR_READ;
+  if ((d->flags & FOR_WRITE) != 0 && filter->write)
+    events |= FOR_WRITE;
+  if (events && mark && d->waiting_thread == NULL)
+    {
+      d->waiting_thread = current_thread;
+      num_waiting_fds++;
+    }
+  return events;
+}
+
+/* Descriptors found ready by wait_for_fds, in increasing order.  */
+
+struct ready_fds
+{
+  struct ready_fd
+  {
+    int fd;
+    /* FOR_READ and/or FOR_WRITE.  */
+    int events;
+  } *fds;
+  ptrdiff_t n, size;
+};
+
+static void
+add_ready_fd (struct ready_fds *ready, int fd, int events)
+{
+  if (ready->n == ready->size)
+    ready->fds = xpalloc (ready->fds, &ready->size, 1, -1,
+			  sizeof *ready->fds);
+  ready->fds[ready->n].fd = fd;
+  ready->fds[ready->n].events = events;
+  ready->n++;
+}
+
+static void
+free_ready_fds (void *ready)
+{
+  xfree (((struct ready_fds *) ready)->fds);
+}
+
+static int
+compare_ready_fds (const void *a, const void *b)
+{
+  int fd_a = ((struct ready_fd const *) a)->fd;
+  int fd_b = ((struct ready_fd const *) b)->fd;
+  return (fd_a > fd_b) - (fd_a < fd_b);
+}
+
+/* Sort READY by descriptor, merging entries for the same one.  */
+
+static void
+sort_ready_fds (struct ready_fds *ready)
+{
+  ptrdiff_t i, n = 0;
+
+  qsort (ready->fds, ready->n, sizeof *ready->fds, compare_ready_fds);
+  for (i = 0; i < ready->n; i++)
+    if (n > 0 && ready->fds[n - 1].fd == ready->fds[i].fd)
+      ready->fds[n - 1].events |= ready->fds[i].events;
+    else
+      ready->fds[n++] = ready->fds[i];
+  ready->n = n;
+}
+
+#ifdef USE_EPOLL
+
+/* The epoll descriptor with which each descriptor that has FOR_READ
+   or FOR_WRITE is registered, or -1 if epoll is not used.  */
+static int epoll_fd = -1;
+
+/* True if descriptors may be registered with epoll_fd that shouldn't
+   be, for instance because they were closed before being removed,
+   so that epoll_fd must be made anew.  */
+static bool epoll_stale;
+
+/* Descriptors registered for fewer events than their flags ask for,
+   see epoll_mute.  */
+static int *epoll_muted;
+static ptrdiff_t epoll_nmuted, epoll_muted_size;
+
+/* Descriptors that epoll refused to register, see epoll_set.  Some
+   may no longer be monitored; epoll_wait_fds weeds them out.  */
+static int *epoll_unsupported;
+static ptrdiff_t epoll_nunsupported, epoll_unsupported_size;
+
+/* Maximum number of events to fetch with one epoll_wait.  */
+enum { EPOLL_MAX_EVENTS = 64 };
+
+static int
+epoll_events_of (int events)
+{
+  return (((events & FOR_READ) ? EPOLLIN : 0)
+	  | ((events & FOR_WRITE) ? EPOLLOUT : 0));
+}
+
+/* Register FD with epoll_fd for EPOLL_EVENTS, or remove it if
+   EPOLL_EVENTS is zero.  */
+
+static void
+epoll_set (int fd, int epoll_events)
+{
+  struct fd_callback_data *d = &fd_callback_info[fd];
+  struct epoll_event event = { .events = epoll_events, .data.fd = fd };
+  int op = (! epoll_events ? EPOLL_CTL_DEL
+	    : d->epoll_events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD);
+
+  if (epoll_fd < 0)
+    return;
+  if (d->epoll_unsupported)
+    {
+      /* Try again when FD is monitored anew, perhaps as another
+	 file.  */
+      if (!epoll_events)
+	d->epoll_unsupported = false;
+      return;
+    }
+  if (d->epoll_events == epoll_events)
+    return;
+  d->epoll_events = epoll_events;
+  if (epoll_ctl (epoll_fd, op, fd, &event) != 0)
+    {
+      if (errno == EPERM && op == EPOLL_CTL_ADD)
+	{
+	  /* FD is a regular file or a directory, say stdin redirected
+	     from a file.  Only this descriptor can't be waited for with
+	     epoll; epoll_wait_fds reports it as ready, as poll and
+	     select would.  */
+	  d->epoll_events = 0;
+	  d->epoll_unsupported = true;
+	  if (epoll_nunsupported == epoll_unsupported_size)
+	    epoll_unsupported = xpalloc (epoll_unsupported,
+					 &epoll_unsupported_size, 1, -1,
+					 sizeof *epoll_unsupported);
+	  epoll_unsupported[epoll_nunsupported++] = fd;
+	}
+      else if (errno == ENOMEM || errno == ENOSPC)
+	{
+	  /* No more descriptors can be waited for with epoll.  Wait
+	     for all of them some other way from now on.  */
+	  emacs_close (epoll_fd);
+	  epoll_fd = -1;
+	}
+      else
+	epoll_stale = true;
+    }
+}
+
+/* Make the registration of FD with epoll_fd match its flags.  */
+
+static void
+epoll_update (int fd)
+{
+  epoll_set (fd, epoll_events_of (fd_callback_info[fd].flags));
+}
+
+/* Make epoll_fd anew from the flags of all descriptors.  */
+
+static void
+epoll_rebuild (void)
+{
+  emacs_close (epoll_fd);
+  epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+  epoll_stale = false;
+  epoll_nmuted = 0;
+  epoll_nunsupported = 0;
+  for (int fd = 0; fd < fd_table_size; fd++)
+    {
+      fd_callback_info[fd].epoll_events = 0;
+      fd_callback_info[fd].epoll_unsupported = false;
+      if (fd <= max_desc)
+	epoll_update (fd);
+    }
+}
+
+/* Register FD, which is ready for events that aren't being waited
+   for, only for the events in WANTED, so that it doesn't keep waking
+   us up.  epoll_unmute undoes this.  */
+
+static void
+epoll_mute (int fd, int wanted)
+{
+  int epoll_events = epoll_events_of (fd_callback_info[fd].flags & wanted);
+
+  if (epoll_events == fd_callback_info[fd].epoll_events)
+    return;
+  if (epoll_nmuted == epoll_muted_size)
+    epoll_muted = xpalloc (epoll_muted, &epoll_muted_size, 1, -1,
+			   sizeof *epoll_muted);
+  epoll_muted[epoll_nmuted++] = fd;
+  epoll_set (fd, epoll_events);
+}
 
+/* Register the muted descriptors that FILTER waits for, or all of
+   them if FILTER is null, again for all events their flags ask
+   for.  */
+
+static void
+epoll_unmute (struct wait_filter const *filter)
+{
+  ptrdiff_t i, n = 0;
+
+  for (i = 0; i < epoll_nmuted; i++)
+    {
+      int fd = epoll_muted[i];
+      int epoll_events = epoll_events_of (fd_callback_info[fd].flags);
+      int missing = epoll_events & ~fd_callback_info[fd].epoll_events;
+
+      if (!missing)
+	continue;
+      if (filter
+	  && !(epoll_events_of (wanted_events (filter, fd, false))
+	       & missing))
+	epoll_muted[n++] = fd;
+      else
+	epoll_set (fd, epoll_events);
+    }
+  epoll_nmuted = n;
+}
+
+/* Return true if wait_for_fds should use epoll for FILTER.  epoll_fd
+   is shared by all threads, so it can't honor the descriptors that
+   other threads wait on, or that are locked to them.  Nor does it
+   hold the descriptor of a stopped process, which FILTER->only_fd can
+   be; poll and select wait for that too.  */
+
+static bool
+epoll_usable_p (struct wait_filter const *filter)
+{
+  if (epoll_stale && 0 <= epoll_fd)
+    epoll_rebuild ();
+  return (0 <= epoll_fd && single_thread_p ()
+	  && (filter->only_fd < 0
+	      || filter->only_fd >= fd_table_size
+	      || ((fd_callback_info[filter->only_fd].flags & FOR_READ) != 0
+		  && !fd_callback_info[filter->only_fd].epoll_unsupported)));
+}
+
+#ifndef HAVE_GLIB
+
+struct epoll_wait_args
+{
+  struct epoll_event *events;
+  int timeout;
+};
+
+static int
+call_epoll_wait (void *arg)
+{
+  struct epoll_wait_args *args = arg;
+  return epoll_wait (epoll_fd, args->events, EPOLL_MAX_EVENTS,
+		     args->timeout);
+}
+
+#endif
+
+/* Implement wait_for_fds with epoll.  */
+
+static int
+epoll_wait_fds (struct wait_filter const *filter, struct timespec timeout,
+		struct ready_fds *ready)
+{
+  struct epoll_event events[EPOLL_MAX_EVENTS];
+  int i, nevents;
+  ptrdiff_t j, n = 0;
+
+  epoll_unmute (filter);
+
+  /* Poll and select find regular files always ready, so don't wait
+     if FILTER wants one of the descriptors epoll refused.  */
+  for (j = 0; j < epoll_nunsupported; j++)
+    {
+      int fd = epoll_unsupported[j];
+      int got;
+
+      if (!fd_callback_info[fd].epoll_unsupported)
+	continue;
+      epoll_unsupported[n++] = fd;
+      got = (wanted_events (filter, fd, false)
+	     & fd_callback_info[fd].flags & (FOR_READ | FOR_WRITE));
+      if (got)
+	add_ready_fd (ready, fd, got);
+    }
+  epoll_nunsupported = n;
+  if (ready->n > 0)
+    timeout = make_timespec (0, 0);
+
+#ifdef HAVE_GLIB
+  /* Let xg_select wait for epoll_fd along with GLib's descriptors.  */
+  fd_set rfds;
+  FD_ZERO (&rfds);
+  FD_SET (epoll_fd, &rfds);
+  nevents = xg_select (epoll_fd + 1, &rfds, NULL, NULL, &timeout, NULL);
+  if (0 < nevents)
+    nevents = epoll_wait (epoll_fd, events, EPOLL_MAX_EVENTS, 0);
+#else
+  /* Round the timeout up to milliseconds, so as not to wake up
+     before it expires.  */
+  struct epoll_wait_args args;
+  args.events = events;
+  args.timeout = (timeout.tv_sec < INT_MAX / 1000 - 1
+		  ? (timeout.tv_sec * 1000
+		     + (timeout.tv_nsec + 999999) / 1000000)
+		  : INT_MAX);
+  nevents = thread_call_unlocked (call_epoll_wait, &args);
+#endif
+  if (nevents < 0)
+    return -1;
+
+  for (i = 0; i < nevents; i++)
+    {
+      int fd = events[i].data.fd;
+      struct fd_callback_data *d;
+      int wanted, got = 0;
+
+      if (fd < 0 || fd_table_size <= fd
+	  || fd_callback_info[fd].epoll_events == 0)
+	{
+	  /* An event for a descriptor that was closed before it
+	     was removed.  */
+	  epoll_stale = true;
+	  continue;
+	}
+      d = &fd_callback_info[fd];
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+	got |= FOR_READ;
+      if (events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+	got |= FOR_WRITE;
+      got &= d->flags & (FOR_READ | FOR_WRITE);
+      wanted = wanted_events (filter, fd, false);
+      if (got & ~wanted)
+	epoll_mute (fd, wanted);
+      if (got & wanted)
+	add_ready_fd (ready, fd, got & wanted);
+    }
+  sort_ready_fds (ready);
+  return ready->n;
+}
+
+#endif	/* USE_EPOLL */
+
+#ifdef USE_POLL
+
+struct poll_args
+{
+  struct pollfd *fds;
+  nfds_t nfds;
+  struct timespec *timeout;
+};
+
+static int
+call_ppoll (void *arg)
+{
+  struct poll_args *args = arg;
+  return ppoll (args->fds, args->nfds, args->timeout, NULL);
+}
+
+/* Implement wait_for_fds with poll.  */
+
+static int
+poll_wait_fds (struct wait_filter const *filter, struct timespec timeout,
+	       struct ready_fds *ready)
+{
+  struct poll_args args;
+  int fd, nfds;
+  nfds_t i;
+  USE_SAFE_ALLOCA;
+
+  SAFE_NALLOCA (args.fds, 1, max_desc + 2);
+  args.nfds = 0;
+  args.timeout = &timeout;
+  for (fd = 0; fd <= max_desc; fd++)
+    {
+      int wanted = wanted_events (filter, fd, true);
+      if (wanted)
+	{
+	  args.fds[args.nfds].fd = fd;
+	  args.fds[args.nfds].events = (((wanted & FOR_READ) ? POLLIN : 0)
+					| ((wanted & FOR_WRITE) ? POLLOUT : 0));
+	  args.nfds++;
+	}
+    }
+  if (max_desc < filter->only_fd)
+    {
+      args.fds[args.nfds].fd = filter->only_fd;
+      args.fds[args.nfds].events = POLLIN;
+      args.nfds++;
+    }
+
+  nfds = thread_call_unlocked (call_ppoll, &args);
+
+  for (i = 0; 0 < nfds && i < args.nfds; i++)
+    {
+      short revents = args.fds[i].revents;
+      int got = 0;
+
+      if (revents & POLLNVAL)
+	{
+	  /* Another thread can close the descriptor of the process
+	     we wait for while we don't hold the global lock.  Report
+	     it as ready, so that our caller notices.  Otherwise treat
+	     this like select does.  */
+	  if (fd_callback_info[args.fds[i].fd].flags == 0)
+	    {
+	      add_ready_fd (ready, args.fds[i].fd, FOR_READ);
+	      continue;
+	    }
+	  errno = EBADF;
+	  nfds = -1;
+	  break;
+	}
+      if (revents & (POLLIN | POLLHUP | POLLERR)
+	  && args.fds[i].events & POLLIN)
+	got |= FOR_READ;
+      if (revents & (POLLOUT | POLLHUP | POLLERR)
+	  && args.fds[i].events & POLLOUT)
+	got |= FOR_WRITE;
+      if (got)
+	add_ready_fd (ready, args.fds[i].fd, got);
+    }
+  SAFE_FREE ();
+  return nfds < 0 ? -1 : ready->n;
+}
+
+#else  /* !USE_POLL */
+
+/* Implement wait_for_fds with select.  */
+
+static int
+select_wait_fds (struct wait_filter const *filter, struct timespec timeout,
+		 struct ready_fds *ready)
+{
+  fd_set rfds, wfds;
+  int fd, nfds;
+
+  FD_ZERO (&rfds);
+  FD_ZERO (&wfds);
+  eassert (max_desc < FD_SETSIZE);
+  for (fd = 0; fd <= max_desc; fd++)
+    {
+      int wanted = wanted_events (filter, fd, true);
+      if (wanted & FOR_READ)
+	FD_SET (fd, &rfds);
+      if (wanted & FOR_WRITE)
+	FD_SET (fd, &wfds);
+    }
+  if (max_desc < filter->only_fd)
+    {
+      eassert (filter->only_fd < FD_SETSIZE);
+      FD_SET (filter->only_fd, &rfds);
+    }
+  fd = max (max_desc, filter->only_fd);
+
+  /* Non-macOS HAVE_GLIB builds call thread_select in xgselect.c.  */
+#if defined HAVE_GLIB && !defined HAVE_NS
+  nfds = xg_select (fd + 1, &rfds, filter->write ? &wfds : NULL,
+		    NULL, &timeout, NULL);
+#elif defined HAVE_NS
+  /* And NS builds call thread_select in ns_select. */
+  nfds = ns_select (fd + 1, &rfds, filter->write ? &wfds : NULL,
+		    NULL, &timeout, NULL);
+#else  /* !HAVE_GLIB */
+  nfds = thread_select (pselect, fd + 1, &rfds,
+			filter->write ? &wfds : NULL,
+			NULL, &timeout, NULL);
+#endif	/* !HAVE_GLIB */
+
+  for (; 0 < nfds && 0 <= fd; fd--)
+    {
+      int got = ((FD_ISSET (fd, &rfds) ? FOR_READ : 0)
+		 | (FD_ISSET (fd, &wfds) ? FOR_WRITE : 0));
+      if (got)
+	add_ready_fd (ready, fd, got);
+    }
+  sort_ready_fds (ready);
+  return nfds < 0 ? -1 : ready->n;
+}
+
+#endif	/* !USE_POLL */
+
+/* Wait for at most TIMEOUT until a descriptor that FILTER selects is
+   ready for reading or writing.  Store the ready descriptors in
+   READY.  Value is their number, or -1 with errno set on failure.  */
+
+static int
+wait_for_fds (struct wait_filter const *filter, struct timespec timeout,
+	      struct ready_fds *ready)
+{
+  ready->n = 0;
+#ifdef USE_EPOLL
+  if (epoll_usable_p (filter))
+    return epoll_wait_fds (filter, timeout, ready);
+#endif
+#ifdef USE_POLL
+  return poll_wait_fds (filter, timeout, ready);
+#else
+  return select_wait_fds (filter, timeout, ready);
+#endif
+}
 
 /* Add a file descriptor FD to be monitored for when read is possible.
    When read is possible, call FUNC with argument DATA.  */
@@ -469,7 +1144,6 @@ add_read_fd (int fd, fd_callback func, void *data)
 {
   add_keyboard_wait_descriptor (fd);
 
-  eassert (0 <= fd && fd < FD_SETSIZE);
   fd_callback_info[fd].func = func;
   fd_callback_info[fd].data = data;
 }
@@ -484,15 +1158,32 @@ add_non_keyboard_read_fd (int fd, fd_callback func, void *data)
 static void
 add_process_read_fd (int fd)
 {
-  eassert (fd >= 0 && fd < FD_SETSIZE);
+  eassert (fd >= 0 && fd < fd_table_size);
   eassert (fd_callback_info[fd].func == NULL);
 
   fd_callback_info[fd].flags &= ~KEYBOARD_FD;
   fd_callback_info[fd].flags |= FOR_READ;
   if (fd > max_desc)
     max_desc = fd;
-  eassert (0 <= fd && fd < FD_SETSIZE);
   fd_callback_info[fd].flags |= PROCESS_FD;
+#ifdef USE_EPOLL
+  epoll_update (fd);
+#endif
+}
+
+/* FD is no longer monitored.  Forget which thread waited for it,
+   which clear_waiting_thread_info might not do if FD is now above
+   max_desc, lest a later descriptor with the same number be ignored
+   by all other threads.  */
+
+static void
+forget_waiting_thread (int fd)
+{
+  if (fd_callback_info[fd].waiting_thread != NULL)
+    {
+      fd_callback_info[fd].waiting_thread = NULL;
+      num_waiting_fds--;
+    }
 }
 
 /* Stop monitoring file descriptor FD for when read is possible.  */
@@ -502,11 +1193,12 @@ delete_read_fd (int fd)
 {
   delete_keyboard_wait_descriptor (fd);
 
-  eassert (0 <= fd && fd < FD_SETSIZE);
+  eassert (0 <= fd && fd < fd_table_size);
   if (fd_callback_info[fd].flags == 0)
     {
       fd_callback_info[fd].func = 0;
       fd_callback_info[fd].data = 0;
+      forget_waiting_thread (fd);
     }
 }
 
@@ -516,25 +1208,58 @@ delete_read_fd (int fd)
 void
 add_write_fd (int fd, fd_callback func, void *data)
 {
-  eassert (fd >= 0 && fd < FD_SETSIZE);
+  eassert (fd >= 0);
+  if (!grow_fd_tables (fd))
+    emacs_abort ();
 
   fd_callback_info[fd].func = func;
   fd_callback_info[fd].data = data;
   fd_callback_info[fd].flags |= FOR_WRITE;
   if (fd > max_desc)
     max_desc = fd;
+#ifdef USE_EPOLL
+  epoll_update (fd);
+#endif
 }
 
 static void
 add_non_blocking_write_fd (int fd)
 {
-  eassert (fd >= 0 && fd < FD_SETSIZE);
+  eassert (fd >= 0 && fd < fd_table_size);
   eassert (fd_callback_info[fd].func == NULL);
 
   fd_callback_info[fd].flags |= FOR_WRITE | NON_BLOCKING_CONNECT_FD;
   if (fd > max_desc)
     max_desc = fd;
   ++num_pending_connects;
+#ifdef USE_EPOLL
+  epoll_update (fd);
+#endif
+}
+
+/* Wait for the input descriptor of process P to be writable, see
+   wait_for_process_input_space.  */
+
+static void
+add_input_space_fd (struct Lisp_Process *p)
+{
+  int fd = p->outfd;
+  eassert (fd >= 0 && fd < fd_table_size);
+
+  fd_callback_info[fd].flags |= FOR_WRITE | INPUT_SPACE_FD;
+  if (fd > max_desc)
+    max_desc = fd;
+#ifdef USE_EPOLL
+  epoll_update (fd);
+#endif
+}
+
+static void
+delete_input_space_fd (struct Lisp_Process *p)
+{
+  if (0 <= p->outfd
+      && (fd_callback_info[p->outfd].flags & INPUT_SPACE_FD) != 0)
+    delete_write_fd (p->outfd);
 }
 
 static void
@@ -542,7 +1267,6 @@ recompute_max_desc (void)
 {
   int fd;
 
-  eassert (max_desc < FD_SETSIZE);
   for (fd = max_desc; fd >= 0; --fd)
     {
       if (fd_callback_info[fd].flags != 0)
@@ -551,7 +1275,6 @@ recompute_max_desc (void)
 	  break;
 	}
     }
-  eassert (max_desc < FD_SETSIZE);
 }
 
 /* Stop monitoring file descriptor FD for when write is possible.  */
@@ -559,127 +1282,40 @@ recompute_max_desc (void)
 void
 delete_write_fd (int fd)
 {
-  eassert (0 <= fd && fd < FD_SETSIZE);
+  eassert (0 <= fd && fd < fd_table_size);
   if ((fd_callback_info[fd].flags & NON_BLOCKING_CONNECT_FD) != 0)
     {
       if (--num_pending_connects < 0)
 	emacs_abort ();
     }
-  fd_callback_info[fd].flags &= ~(FOR_WRITE | NON_BLOCKING_CONNECT_FD);
+  fd_callback_info[fd].flags &= ~(FOR_WRITE | NON_BLOCKING_CONNECT_FD
+				  | INPUT_SPACE_FD);
+#ifdef USE_EPOLL
+  epoll_update (fd);
+#endif
   if (fd_callback_info[fd].flags == 0)
     {
       fd_callback_info[fd].func = 0;
       fd_callback_info[fd].data = 0;
+      forget_waiting_thread (fd);
 
       if (fd == max_desc)
 	recompute_max_desc ();
     }
 }
 
-static void
-compute_input_wait_mask (fd_set *mask)
-{
-  int fd;
-
-  FD_ZERO (mask);
-  eassert (max_desc < FD_SETSIZE);
-  for (fd = 0; fd <= max_desc; ++fd)
-    {
-      if (fd_callback_info[fd].thread != NULL
-	  && fd_callback_info[fd].thread != current_thread)
-	continue;
-      if (fd_callback_info[fd].waiting_thread != NULL
-	  && fd_callback_info[fd].waiting_thread != current_thread)
-	continue;
-      if ((fd_callback_info[fd].flags & FOR_READ) != 0)
-	{
-	  FD_SET (fd, mask);
-	  fd_callback_info[fd].waiting_thread = current_thread;
-	}
-    }
-}
-
-static void
-compute_non_process_wait_mask (fd_set *mask)
-{
-  int fd;
-
-  FD_ZERO (mask);
-  eassert (max_desc < FD_SETSIZE);
-  for (fd = 0; fd <= max_desc; ++fd)
-    {
-      if (fd_callback_info[fd].thread != NULL
-	  && fd_callback_info[fd].thread != current_thread)
-	continue;
-      if (fd_callback_info[fd].waiting_thread != NULL
-	  && fd_callback_info[fd].waiting_thread != current_thread)
-	continue;
-      if ((fd_callback_info[fd].flags & FOR_READ) != 0
-	  && (fd_callback_info[fd].flags & PROCESS_FD) == 0)
-	{
-	  FD_SET (fd, mask);
-	  fd_callback_info[fd].waiting_thread = current_thread;
-	}
-    }
-}
-
-static void
-compute_non_keyboard_wait_mask (fd_set *mask)
-{
-  int fd;
-
-  FD_ZERO (mask);
-  eassert (max_desc < FD_SETSIZE);
-  for (fd = 0; fd <= max_desc; ++fd)
-    {
-      if (fd_callback_info[fd].thread != NULL
-	  && fd_callback_info[fd].thread != current_thread)
-	continue;
-      if (fd_callback_info[fd].waiting_thread != NULL
-	  && fd_callback_info[fd].waiting_thread != current_thread)
-	continue;
-      if ((fd_callback_info[fd].flags & FOR_READ) != 0
-	  && (fd_callback_info[fd].flags & KEYBOARD_FD) == 0)
-	{
-	  FD_SET (fd, mask);
-	  fd_callback_info[fd].waiting_thread = current_thread;
-	}
-    }
-}
-
-static void
-compute_write_mask (fd_set *mask)
-{
-  int fd;
-
-  FD_ZERO (mask);
-  eassert (max_desc < FD_SETSIZE);
-  for (fd = 0; fd <= max_desc; ++fd)
-    {
-      if (fd_callback_info[fd].thread != NULL
-	  && fd_callback_info[fd].thread != current_thread)
-	continue;
-      if (fd_callback_info[fd].waiting_thread != NULL
-	  && fd_callback_info[fd].waiting_thread != current_thread)
-	continue;
-      if ((fd_callback_info[fd].flags & FOR_WRITE) != 0)
-	{
-	  FD_SET (fd, mask);
-	  fd_callback_info[fd].waiting_thread = current_thread;
-	}
-    }
-}
-
 static void
 clear_waiting_thread_info (void)
 {
   int fd;
 
-  eassert (max_desc < FD_SETSIZE);
-  for (fd = 0; fd <= max_desc; ++fd)
+  for (fd = 0; num_waiting_fds > 0 && fd <= max_desc; ++fd)
     {
       if (fd_callback_info[fd].waiting_thread == current_thread)
-	fd_callback_info[fd].waiting_thread = NULL;
+	{
+	  fd_callback_info[fd].waiting_thread = NULL;
+	  num_waiting_fds--;
+	}
     }
 }
 
@@ -688,6 +1324,10 @@ clear_waiting_thread_info (void)
 static bool
 kbd_is_ours (void)
 {
+  /* A thread that waits alone waits for the keyboard too.  */
+  if (num_waiting_fds == 0)
+    return single_thread_p ();
+
   for (int fd = 0; fd <= max_desc; ++fd)
     {
       if (fd_callback_info[fd].waiting_thread != current_thread)
@@ -911,6 +1551,7 @@ make_process (Lisp_Object name)
      non-Lisp data, so do it only for slots which should not be zero.  */
   p->infd = -1;
   p->outfd = -1;
+  p->pidfd = -1;
   for (int i = 0; i < PROCESS_OPEN_FDS; i++)
     p->open_fd[i] = -1;
 
@@ -967,10 +1608,10 @@ update_processes_for_thread_death (Lisp_Object dying_thread)
 	  struct Lisp_Process *proc = XPROCESS (process);
 
 	  pset_thread (proc, Qnil);
-	  eassert (proc->infd < FD_SETSIZE);
+	  eassert (proc->infd < fd_table_size);
 	  if (proc->infd >= 0)
 	    fd_callback_info[proc->infd].thread = NULL;
-	  eassert (proc->outfd < FD_SETSIZE);
+	  eassert (proc->outfd < fd_table_size);
 	  if (proc->outfd >= 0)
 	    fd_callback_info[proc->outfd].thread = NULL;
 	}
@@ -1013,7 +1654,7 @@ DEFUN ("get-process", Fget_process, Sget_process, 1, 1, 0,
    Buffers denote the first process in the buffer, and nil denotes the
    current buffer.  */
 
-static Lisp_Object
+Lisp_Object
 get_process (register Lisp_Object name)
 {
   register Lisp_Object proc, obj;
@@ -1411,10 +2052,10 @@ DEFUN ("set-process-thread", Fset_process_thread, Sset_process_thread,
 
   proc = XPROCESS (process);
   pset_thread (proc, thread);
-  eassert (proc->infd < FD_SETSIZE);
+  eassert (proc->infd < fd_table_size);
   if (proc->infd >= 0)
     fd_callback_info[proc->infd].thread = tstate;
-  eassert (proc->outfd < FD_SETSIZE);
+  eassert (proc->outfd < fd_table_size);
   if (proc->outfd >= 0)
     fd_callback_info[proc->outfd].thread = tstate;
 
@@ -2142,7 +2783,7 @@ create_process (Lisp_Object process, char **new_argv, Lisp_Object current_dir)
 	}
     }
 
-  if (FD_SETSIZE <= inchannel || FD_SETSIZE <= outchannel)
+  if (!grow_fd_tables (inchannel) || !grow_fd_tables (outchannel))
     report_file_errno ("Creating pipe", Qnil, EMFILE);
 
 #ifndef WINDOWSNT
@@ -2154,7 +2795,7 @@ create_process (Lisp_Object process, char **new_argv, Lisp_Object current_dir)
   fcntl (outchannel, F_SETFL, O_NONBLOCK);
 
   /* Record this as an active process, with its channels.  */
-  eassert (0 <= inchannel && inchannel < FD_SETSIZE);
+  eassert (0 <= inchannel && inchannel < fd_table_size);
   chan_process[inchannel] = process;
   p->infd = inchannel;
   p->outfd = outchannel;
@@ -2193,6 +2834,10 @@ create_process (Lisp_Object process, char **new_argv, Lisp_Object current_dir)
   p->pid = pid;
   if (pid >= 0)
     p->alive = 1;
+#ifdef USE_PIDFD
+  if (pid > 0)
+    open_child_pidfd (p);
+#endif
 
   /* Stop blocking in the parent.  */
   unblock_child_signal (&oldset);
@@ -2249,7 +2894,7 @@ create_pty (Lisp_Object process)
   if (pty_fd >= 0)
     {
       p->open_fd[SUBPROCESS_STDIN] = pty_fd;
-      if (FD_SETSIZE <= pty_fd)
+      if (!grow_fd_tables (pty_fd))
 	report_file_errno ("Opening pty", Qnil, EMFILE);
 #if ! defined (USG) || defined (USG_SUBTTY_WORKS)
       /* On most USG systems it does not work to open the pty's tty here,
@@ -2272,7 +2917,7 @@ create_pty (Lisp_Object process)
 
       /* Record this as an active process, with its channels.
 	 As a result, child_setup will close Emacs's side of the pipes.  */
-      eassert (0 <= pty_fd && pty_fd < FD_SETSIZE);
+      eassert (0 <= pty_fd && pty_fd < fd_table_size);
       chan_process[pty_fd] = process;
       p->infd = pty_fd;
       p->outfd = pty_fd;
@@ -2359,7 +3004,7 @@ DEFUN ("make-pipe-process", Fmake_pipe_process, Smake_pipe_process,
   outchannel = p->open_fd[WRITE_TO_SUBPROCESS];
   inchannel = p->open_fd[READ_FROM_SUBPROCESS];
 
-  if (FD_SETSIZE <= inchannel || FD_SETSIZE <= outchannel)
+  if (!grow_fd_tables (inchannel) || !grow_fd_tables (outchannel))
     report_file_errno ("Creating pipe", Qnil, EMFILE);
 
   fcntl (inchannel, F_SETFL, O_NONBLOCK);
@@ -2370,7 +3015,7 @@ DEFUN ("make-pipe-process", Fmake_pipe_process, Smake_pipe_process,
 #endif
 
   /* Record this as an active process, with its channels.  */
-  eassert (0 <= inchannel && inchannel < FD_SETSIZE);
+  eassert (0 <= inchannel && inchannel < fd_table_size);
   chan_process[inchannel] = proc;
   p->infd = inchannel;
   p->outfd = outchannel;
@@ -2701,7 +3346,7 @@ DEFUN ("process-datagram-address", Fprocess_datagram_address, Sprocess_datagram_
     return Qnil;
 
   channel = XPROCESS (process)->infd;
-  eassert (0 <= channel && channel < FD_SETSIZE);
+  eassert (0 <= channel && channel < fd_table_size);
   return conv_sockaddr_to_lisp (datagram_address[channel].sa,
 				datagram_address[channel].len);
 }
@@ -2730,7 +3375,7 @@ DEFUN ("set-process-datagram-address", Fset_process_datagram_address, Sset_proce
   channel = XPROCESS (process)->infd;
 
   len = get_lisp_to_sockaddr_size (address, &family);
-  eassert (0 <= channel && channel < FD_SETSIZE);
+  eassert (0 <= channel && channel < fd_table_size);
   if (len == 0 || datagram_address[channel].len != len)
     return Qnil;
   conv_lisp_to_sockaddr (family, address, datagram_address[channel].sa, len);
@@ -3105,13 +3750,13 @@ DEFUN ("make-serial-process", Fmake_serial_process, Smake_serial_process,
 
   fd = serial_open (port);
   p->open_fd[SUBPROCESS_STDIN] = fd;
-  if (FD_SETSIZE <= fd)
+  if (!grow_fd_tables (fd))
     report_file_errno ("Opening serial port", port, EMFILE);
   p->infd = fd;
   p->outfd = fd;
   if (fd > max_desc)
     max_desc = fd;
-  eassert (0 <= fd && fd < FD_SETSIZE);
+  eassert (0 <= fd && fd < fd_table_size);
   chan_process[fd] = proc;
 
   buffer = Fplist_get (contact, QCbuffer);
@@ -3283,7 +3928,7 @@ finish_after_tls_connection (Lisp_Object proc)
 		    Fplist_get (contact, QChost),
 		    Fplist_get (contact, QCservice));
 
-  eassert (p->outfd < FD_SETSIZE);
+  eassert (p->outfd < fd_table_size);
   if (NILP (result))
     {
       pset_status (p, list2 (Qfailed,
@@ -3329,7 +3974,8 @@ connect_network_socket (Lisp_Object proc, Lisp_Object addrinfos,
   if (!NILP (use_external_socket_p))
     {
       socket_to_use = external_sock_fd;
-      eassert (socket_to_use < FD_SETSIZE);
+      bool fits = grow_fd_tables (socket_to_use);
+      eassert (fits);
 
       /* Ensure we don't consume the external socket twice.  */
       external_sock_fd = -1;
@@ -3372,7 +4018,7 @@ connect_network_socket (Lisp_Object proc, Lisp_Object addrinfos,
 	      continue;
 	    }
 	  /* Reject file descriptors that would be too large.  */
-	  if (FD_SETSIZE <= s)
+	  if (!grow_fd_tables (s))
 	    {
 	      emacs_close (s);
 	      s = -1;
@@ -3543,7 +4189,7 @@ connect_network_socket (Lisp_Object proc, Lisp_Object addrinfos,
 #ifdef DATAGRAM_SOCKETS
       if (p->socktype == SOCK_DGRAM)
 	{
-	  eassert (0 <= s && s < FD_SETSIZE);
+	  eassert (0 <= s && s < fd_table_size);
 	  if (datagram_address[s].sa)
 	    emacs_abort ();
 
@@ -3608,7 +4254,7 @@ connect_network_socket (Lisp_Object proc, Lisp_Object addrinfos,
   inch = s;
   outch = s;
 
-  eassert (0 <= inch && inch < FD_SETSIZE);
+  eassert (0 <= inch && inch < fd_table_size);
   chan_process[inch] = proc;
 
   fcntl (inch, F_SETFL, O_NONBLOCK);
@@ -3635,7 +4281,7 @@ connect_network_socket (Lisp_Object proc, Lisp_Object addrinfos,
       if (! (connecting_status (p->status)
 	     && EQ (XCDR (p->status), addrinfos)))
 	pset_status (p, Fcons (Qconnect, addrinfos));
-      eassert (0 <= inch && inch < FD_SETSIZE);
+      eassert (0 <= inch && inch < fd_table_size);
       if ((fd_callback_info[inch].flags & NON_BLOCKING_CONNECT_FD) == 0)
 	add_non_blocking_write_fd (inch);
     }
@@ -4700,11 +5346,25 @@ deactivate_process (Lisp_Object proc)
 
   /* Beware SIGCHLD hereabouts.  */
 
+  inchannel = p->infd;
+  eassert (inchannel < fd_table_size);
+
+  /* Stop waiting for the descriptors before closing them, since
+     epoll can't forget descriptors that were closed.  */
+  if (inchannel >= 0)
+    {
+      delete_read_fd (inchannel);
+      if ((fd_callback_info[inchannel].flags & NON_BLOCKING_CONNECT_FD) != 0)
+	delete_write_fd (inchannel);
+    }
+  delete_input_space_fd (p);
+#ifdef USE_PIDFD
+  close_child_pidfd (p);
+#endif
+
   for (i = 0; i < PROCESS_OPEN_FDS; i++)
     close_process_fd (&p->open_fd[i]);
 
-  inchannel = p->infd;
-  eassert (inchannel < FD_SETSIZE);
   if (inchannel >= 0)
     {
       p->infd  = -1;
@@ -4718,9 +5378,6 @@ deactivate_process (Lisp_Object proc)
 	}
 #endif
       chan_process[inchannel] = Qnil;
-      delete_read_fd (inchannel);
-      if ((fd_callback_info[inchannel].flags & NON_BLOCKING_CONNECT_FD) != 0)
-	delete_write_fd (inchannel);
       if (inchannel == max_desc)
 	recompute_max_desc ();
     }
@@ -4841,7 +5498,7 @@ server_accept_connection (Lisp_Object server, int channel)
 
   s = accept4 (channel, &saddr.sa, &len, SOCK_CLOEXEC);
 
-  if (FD_SETSIZE <= s)
+  if (!grow_fd_tables (s))
     {
       emacs_close (s);
       s = -1;
@@ -4945,7 +5602,7 @@ server_accept_connection (Lisp_Object server, int channel)
   Lisp_Object name = Fformat (nargs, args);
   Lisp_Object proc = make_process (name);
 
-  eassert (0 <= s && s < FD_SETSIZE);
+  eassert (0 <= s && s < fd_table_size);
   chan_process[s] = proc;
 
   fcntl (s, F_SETFL, O_NONBLOCK);
@@ -5160,9 +5817,8 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 {
   static int last_read_channel = -1;
   int channel, nfds;
-  fd_set Available;
-  fd_set Writeok;
-  bool check_write;
+  struct ready_fds ready = { NULL, 0, 0 };
+  ptrdiff_t i;
   int check_delay;
   bool no_avail;
   int xerrno;
@@ -5184,9 +5840,6 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 	   || NILP (wait_proc->thread)
 	   || XTHREAD (wait_proc->thread) == current_thread);
 
-  FD_ZERO (&Available);
-  FD_ZERO (&Writeok);
-
   if (time_limit == 0 && nsecs == 0 && wait_proc && !NILP (Vinhibit_quit)
       && !(CONSP (wait_proc->status)
 	   && EQ (XCAR (wait_proc->status), Qexit)))
@@ -5195,6 +5848,7 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
   record_unwind_protect_int (wait_reading_process_output_unwind,
 			     waiting_for_user_input_p);
   waiting_for_user_input_p = read_kbd;
+  record_unwind_protect_ptr (free_ready_fds, &ready);
 
   if (TYPE_MAXIMUM (time_t) < time_limit)
     time_limit = TYPE_MAXIMUM (time_t);
@@ -5213,8 +5867,6 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
   while (1)
     {
       bool process_skipped = false;
-      bool wrapped;
-      int channel_start;
 
       /* If calling from keyboard input, do not quit
 	 since we want to return C-g as an input character.
@@ -5228,8 +5880,6 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
       if (! NILP (wait_for_cell) && ! NILP (XCAR (wait_for_cell)))
 	break;
 
-      eassert (max_desc < FD_SETSIZE);
-
 #if defined HAVE_GETADDRINFO_A || defined HAVE_GNUTLS
       {
 	Lisp_Object process_list_head, aproc;
@@ -5347,30 +5997,21 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 	 timeout to get our attention.  */
       if (update_tick != process_tick)
 	{
-	  fd_set Atemp;
-	  fd_set Ctemp;
+	  struct wait_filter filter;
 
-          if (kbd_on_hold_p ())
-            FD_ZERO (&Atemp);
-          else
-            compute_input_wait_mask (&Atemp);
-	  compute_write_mask (&Ctemp);
+	  filter.read_exclude = kbd_on_hold_p () ? FOR_READ : 0;
+	  filter.only_fd = -1;
+	  filter.write = num_pending_connects > 0;
+	  filter.child_fd = -1;
 
 	  /* If a process status has changed, the child signal pipe
 	     will likely be readable.  We want to ignore it for now,
 	     because otherwise we wouldn't run into a timeout
 	     below.  */
-	  int fd = child_signal_read_fd;
-	  eassert (fd < FD_SETSIZE);
-	  if (0 <= fd)
-	    FD_CLR (fd, &Atemp);
+	  filter.exclude_fd = child_signal_read_fd;
 
 	  timeout = make_timespec (0, 0);
-	  if ((thread_select (pselect, max_desc + 1,
-			      &Atemp,
-			      (num_pending_connects > 0 ? &Ctemp : NULL),
-			      NULL, &timeout, NULL)
-	       <= 0))
+	  if (wait_for_fds (&filter, timeout, &ready) <= 0)
 	    {
 	      /* It's okay for us to do this and then continue with
 		 the loop, since timeout has already been zeroed out.  */
@@ -5426,38 +6067,36 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 
       /* Wait till there is something to do.  */
 
+      struct wait_filter filter;
+      filter.read_exclude = 0;
+      filter.only_fd = -1;
+      filter.write = false;
+      filter.exclude_fd = -1;
+
       if (wait_proc && just_wait_proc)
 	{
 	  if (wait_proc->infd < 0)  /* Terminated.  */
 	    break;
-	  FD_SET (wait_proc->infd, &Available);
+	  filter.only_fd = wait_proc->infd;
 	  check_delay = 0;
-          check_write = 0;
 	}
       else if (!NILP (wait_for_cell))
 	{
-	  compute_non_process_wait_mask (&Available);
+	  filter.read_exclude = PROCESS_FD;
 	  check_delay = 0;
-	  check_write = 0;
 	}
       else
 	{
 	  if (! read_kbd)
-	    compute_non_keyboard_wait_mask (&Available);
-	  else
-	    compute_input_wait_mask (&Available);
-	  compute_write_mask (&Writeok);
+	    filter.read_exclude = KEYBOARD_FD;
+	  filter.write = true;
  	  check_delay = wait_proc ? 0 : process_output_delay_count;
-	  check_write = true;
 	}
 
       /* We have to be informed when we receive a SIGCHLD signal for
 	 an asynchronous process.  Otherwise this might deadlock if we
 	 receive a SIGCHLD during `pselect'.  */
-      int child_fd = child_signal_read_fd;
-      eassert (child_fd < FD_SETSIZE);
-      if (0 <= child_fd)
-        FD_SET (child_fd, &Available);
+      filter.child_fd = child_signal_read_fd;
 
       /* If frame size has changed or the window is newly mapped,
 	 redisplay now, before we start to wait.  There is a race
@@ -5482,13 +6121,14 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 	{
 	  nfds = read_kbd ? 0 : 1;
 	  no_avail = 1;
-	  FD_ZERO (&Available);
+	  ready.n = 0;
+	  xerrno = 0;
 	}
       else
 	{
 #ifdef HAVE_GNUTLS
 	  int tls_nfds;
-	  fd_set tls_available;
+	  bool wait_proc_tls;
 #endif
 	  /* Set the timeout for adaptive read buffering if any
 	     process has non-zero read_output_skip and non-zero
@@ -5497,26 +6137,29 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 	     Vprocess_adaptive_read_buffering is nil.  */
 	  if (process_output_skip && check_delay > 0)
 	    {
+	      Lisp_Object tail;
 	      int adaptive_nsecs = timeout.tv_nsec;
 	      if (timeout.tv_sec > 0 || adaptive_nsecs > READ_OUTPUT_DELAY_MAX)
 		adaptive_nsecs = READ_OUTPUT_DELAY_MAX;
-	      for (channel = 0; check_delay > 0 && channel <= max_desc; channel++)
+	      FOR_EACH_PROCESS (tail, proc)
 		{
-		  proc = chan_process[channel];
-		  if (NILP (proc))
+		  struct Lisp_Process *p = XPROCESS (proc);
+		  if (check_delay <= 0)
+		    break;
+		  if (p->infd < 0)
 		    continue;
 		  /* Find minimum non-zero read_output_delay among the
 		     processes with non-zero read_output_skip.  */
-		  if (XPROCESS (proc)->read_output_delay > 0)
+		  if (p->read_output_delay > 0)
 		    {
 		      check_delay--;
-		      if (!XPROCESS (proc)->read_output_skip)
+		      if (!p->read_output_skip)
 			continue;
-		      FD_CLR (channel, &Available);
+		      fd_callback_info[p->infd].read_skipped = true;
 		      process_skipped = true;
-		      XPROCESS (proc)->read_output_skip = 0;
-		      if (XPROCESS (proc)->read_output_delay < adaptive_nsecs)
-			adaptive_nsecs = XPROCESS (proc)->read_output_delay;
+		      p->read_output_skip = 0;
+		      if (p->read_output_delay < adaptive_nsecs)
+			adaptive_nsecs = p->read_output_delay;
 		    }
 		}
 	      timeout = make_timespec (0, adaptive_nsecs);
@@ -5563,70 +6206,64 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
           /* GnuTLS buffers data internally. We need to check if some
 	     data is available in the buffers manually before the select.
 	     And if so, we need to skip the select which could block. */
-	  FD_ZERO (&tls_available);
 	  tls_nfds = 0;
-	  for (channel = 0; channel < FD_SETSIZE; ++channel)
-	    if (! NILP (chan_process[channel])
-		&& FD_ISSET (channel, &Available))
+	  wait_proc_tls = false;
+	  {
+	    Lisp_Object tail;
+	    FOR_EACH_PROCESS (tail, proc)
 	      {
-		struct Lisp_Process *p = XPROCESS (chan_process[channel]);
-		if (p
+		struct Lisp_Process *p = XPROCESS (proc);
+		if (0 <= p->infd
 		    && p->gnutls_p && p->gnutls_state
+		    && (wanted_events (&filter, p->infd, false) & FOR_READ)
 		    && emacs_gnutls_record_check_pending (p->gnutls_state) > 0)
 		  {
 		    tls_nfds++;
-		    eassert (p->infd == channel);
-		    FD_SET (p->infd, &tls_available);
+		    if (p == wait_proc)
+		      wait_proc_tls = true;
 		  }
 	      }
+	  }
 	  /* If wait_proc is somebody else, we have to wait in select
 	     as usual.  Otherwise, clobber the timeout. */
-	  if (tls_nfds > 0
-	      && (!wait_proc ||
-		  (wait_proc->infd >= 0
-		   && FD_ISSET (wait_proc->infd, &tls_available))))
+	  if (tls_nfds > 0 && (!wait_proc || wait_proc_tls))
 	    timeout = make_timespec (0, 0);
 #endif
 
-	  /* Non-macOS HAVE_GLIB builds call thread_select in xgselect.c.  */
-#if defined HAVE_GLIB && !defined HAVE_NS
-	  nfds = xg_select (max_desc + 1,
-			    &Available, (check_write ? &Writeok : 0),
-			    NULL, &timeout, NULL);
-#elif defined HAVE_NS
-          /* And NS builds call thread_select in ns_select. */
-          nfds = ns_select (max_desc + 1,
-			    &Available, (check_write ? &Writeok : 0),
-			    NULL, &timeout, NULL);
-#else  /* !HAVE_GLIB */
-	  nfds = thread_select (pselect, max_desc + 1,
-				&Available,
-				(check_write ? &Writeok : 0),
-				NULL, &timeout, NULL);
-#endif	/* !HAVE_GLIB */
+	  nfds = wait_for_fds (&filter, timeout, &ready);
+	  xerrno = errno;
+
+	  if (process_skipped)
+	    {
+	      Lisp_Object tail;
+	      FOR_EACH_PROCESS (tail, proc)
+		if (0 <= XPROCESS (proc)->infd)
+		  fd_callback_info[XPROCESS (proc)->infd].read_skipped = false;
+	    }
 
 #ifdef HAVE_GNUTLS
-	  /* Merge tls_available into Available. */
-	  if (tls_nfds > 0)
+	  /* Add the descriptors with buffered data to READY.  Note:
+	     nfds does not need to be accurate, just positive is
+	     enough.  */
+	  if (tls_nfds > 0 && (nfds >= 0 || xerrno == EINTR))
 	    {
-	      if (nfds == 0 || (nfds < 0 && errno == EINTR))
+	      Lisp_Object tail;
+	      FOR_EACH_PROCESS (tail, proc)
 		{
-		  /* Fast path, just copy. */
-		  nfds = tls_nfds;
-		  Available = tls_available;
+		  struct Lisp_Process *p = XPROCESS (proc);
+		  if (0 <= p->infd
+		      && p->gnutls_p && p->gnutls_state
+		      && (wanted_events (&filter, p->infd, false) & FOR_READ)
+		      && (emacs_gnutls_record_check_pending (p->gnutls_state)
+			  > 0))
+		    add_ready_fd (&ready, p->infd, FOR_READ);
 		}
-	      else if (nfds > 0)
-		/* Slow path, merge one by one.  Note: nfds does not need
-		   to be accurate, just positive is enough. */
-		for (channel = 0; channel < FD_SETSIZE; ++channel)
-		  if (FD_ISSET(channel, &tls_available))
-		    FD_SET(channel, &Available);
+	      sort_ready_fds (&ready);
+	      nfds = ready.n;
 	    }
 #endif
 	}
 
-      xerrno = errno;
-
       /* Make C-g and alarm signals set flags again.  */
       clear_waiting_for_input ();
 
@@ -5728,7 +6365,7 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 	 but select says there is input.  */
 
       if (read_kbd && interrupt_input
-	  && keyboard_bit_set (&Available) && ! noninteractive)
+	  && keyboard_bit_set (&ready) && ! noninteractive)
 	handle_input_available_signal (SIGIO);
 #endif
 
@@ -5741,33 +6378,30 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
       if (no_avail || nfds == 0)
 	continue;
 
-      for (channel = 0; channel <= max_desc; ++channel)
+      for (i = 0; i < ready.n; i++)
         {
+	  int events = ready.fds[i].events;
+	  channel = ready.fds[i].fd;
           struct fd_callback_data *d = &fd_callback_info[channel];
           if (d->func
-	      && ((d->flags & FOR_READ
-		   && FD_ISSET (channel, &Available))
-		  || ((d->flags & FOR_WRITE)
-		      && FD_ISSET (channel, &Writeok))))
+	      && ((d->flags & FOR_READ && events & FOR_READ)
+		  || ((d->flags & FOR_WRITE) && events & FOR_WRITE)))
             d->func (channel, d->data);
 	}
 
       /* Do round robin if `process-pritoritize-lower-fds' is nil. */
-      channel_start
-	= process_prioritize_lower_fds ? 0 : last_read_channel + 1;
+      ptrdiff_t ready_start = 0;
+      if (!process_prioritize_lower_fds)
+	while (ready_start < ready.n
+	       && ready.fds[ready_start].fd <= last_read_channel)
+	  ready_start++;
 
-      for (channel = channel_start, wrapped = false;
-	   !wrapped || (channel < channel_start && channel <= max_desc);
-	   channel++)
+      for (i = 0; i < ready.n; i++)
 	{
-	  if (channel > max_desc)
-	    {
-	      wrapped = true;
-	      channel = -1;
-	      continue;
-	    }
+	  struct ready_fd *r = &ready.fds[(ready_start + i) % ready.n];
+	  channel = r->fd;
 
-	  if (FD_ISSET (channel, &Available)
+	  if (r->events & FOR_READ
 	      && ((fd_callback_info[channel].flags & (KEYBOARD_FD | PROCESS_FD))
 		  == PROCESS_FD))
 	    {
@@ -5803,7 +6437,8 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 		     which can call accept-process-output,
 		     don't try to read from any other processes
 		     before doing the select again.  */
-		  FD_ZERO (&Available);
+		  for (ptrdiff_t j = 0; j < ready.n; j++)
+		    ready.fds[j].events &= ~FOR_READ;
 		  last_read_channel = channel;
 
 		  if (do_display)
@@ -5863,7 +6498,16 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 				 list2 (Qexit, make_fixnum (256)));
 		}
 	    }
-	  if (FD_ISSET (channel, &Writeok)
+	  if (r->events & FOR_WRITE
+	      && (fd_callback_info[channel].flags & INPUT_SPACE_FD) != 0)
+	    {
+	      /* A process that send_process waits for can take more
+		 input.  Stop waiting if it's the one we wait for.  */
+	      delete_write_fd (channel);
+	      if (wait_proc && wait_proc->outfd == channel)
+		wait = MINIMUM;
+	    }
+	  if (r->events & FOR_WRITE
 	      && (fd_callback_info[channel].flags
 		  & NON_BLOCKING_CONNECT_FD) != 0)
 	    {
@@ -5985,17 +6629,446 @@ read_process_output_error_handler (Lisp_Object error_val)
   return Qt;
 }
 
+
+/* Return the number of bytes to read from process P at once.  */
+
+static ptrdiff_t
+process_read_size (struct Lisp_Process *p)
+{
+  ptrdiff_t readmax = clip_to_bounds (1, read_process_output_max, PTRDIFF_MAX);
+  return max (readmax, p->read_output_size);
+}
+
+/* Adapt the delay and the size of the reads from process P to the
+   NBYTES bytes it just produced, where READMAX was the most we could
+   read.  */
+
+static void
+adapt_process_reads (struct Lisp_Process *p, ssize_t nbytes, ptrdiff_t readmax)
+{
+  ptrdiff_t size = process_read_size (p);
+  ptrdiff_t readmin = clip_to_bounds (1, read_process_output_max, PTRDIFF_MAX);
+
+  if (p->adaptive_read_buffering)
+    {
+      int delay = p->read_output_delay;
+      if (nbytes < 256)
+	{
+	  if (delay < READ_OUTPUT_DELAY_MAX_MAX)
+	    {
+	      if (delay == 0)
+		process_output_delay_count++;
+	      delay += READ_OUTPUT_DELAY_INCREMENT * 2;
+	    }
+	}
+      else if (delay > 0 && nbytes == readmax)
+	{
+	  delay -= READ_OUTPUT_DELAY_INCREMENT;
+	  if (delay == 0)
+	    process_output_delay_count--;
+	}
+      p->read_output_delay = delay;
+      if (delay)
+	{
+	  p->read_output_skip = 1;
+	  process_output_skip = 1;
+	}
+    }
+
+  /* A full read means the process has more output ready for us, so
+     read more at once next time.  Go back towards
+     read-process-output-max when reads use little of the space.  */
+  if (nbytes == readmax && size < READ_OUTPUT_SIZE_MAX)
+    p->read_output_size = min (2 * size, READ_OUTPUT_SIZE_MAX);
+  else if (nbytes < size / 4 && readmin < size)
+    p->read_output_size = max (size / 2, readmin);
+}
+
+/* Return the number of bytes that can be read from CHANNEL without
+   blocking, or 0 if that is unknown.  */
+
+static ptrdiff_t
+bytes_available (int channel)
+{
+#ifdef FIONREAD
+  int avail;
+  if (ioctl (channel, FIONREAD, &avail) == 0 && 0 < avail)
+    return avail;
+#endif
+  return 0;
+}
+
+/* Return true if the output of process P, read from CHANNEL and
+   decoded with CODING, can be read straight into the gap of its
+   buffer, see read_process_output_into_gap.  This requires that P
+   uses the default filter, and that CODING decodes without detection
+   or conversion of line ends, so that decode_coding_gap can decode the
+   output where it is.  */
+
+static bool
+process_output_to_gap_p (struct Lisp_Process *p, int channel,
+			 struct coding_system *coding)
+{
+  Lisp_Object attrs, type;
+
+  if (!EQ (p->filter, Qinternal_default_process_filter)
+      || !NILP (p->message_framing)
+      || !BUFFERP (p->buffer) || !BUFFER_LIVE_P (XBUFFER (p->buffer))
+      || proc_buffered_char[channel] >= 0
+      || coding->mode & CODING_MODE_LAST_BLOCK
+#ifdef DATAGRAM_SOCKETS
+      || DATAGRAM_CHAN_P (channel)
+#endif
+#ifdef HAVE_GNUTLS
+      || p->gnutls_p
+#endif
+      || CODING_REQUIRE_DETECTION (coding)
+      || !EQ (CODING_ID_EOL_TYPE (coding->id), Qunix))
+    return false;
+
+  attrs = CODING_ID_ATTRS (coding->id);
+  type = CODING_ATTR_TYPE (attrs);
+  if (!NILP (CODING_ATTR_POST_READ (attrs)))
+    return false;
+  if (EQ (type, Qraw_text))
+    return true;
+  return (EQ (type, Qutf_8)
+	  && coding->spec.utf_8_bom == utf_without_bom
+	  && !NILP (BVAR (XBUFFER (p->buffer), enable_multibyte_characters)));
+}
+
+/* Return the number of bytes at the end of the NBYTES bytes at SRC
+   that begin a UTF-8 sequence they don't complete.  */
+
+static int
+utf_8_incomplete_tail (unsigned char const *src, ptrdiff_t nbytes)
+{
+  int i;
+
+  for (i = 1; i <= min (nbytes, MAX_MULTIBYTE_LENGTH - 1); i++)
+    {
+      int c = src[nbytes - i];
+      if (CHAR_HEAD_P (c))
+	return i < BYTES_BY_CHAR_HEAD (c) ? i : 0;
+    }
+  return 0;
+}
+
+struct gap_read
+{
+  struct Lisp_Process *p;
+  int channel;
+  struct coding_system *coding;
+  /* The number of bytes to read.  */
+  ptrdiff_t nbytes;
+  /* The value of the read, or -2 if it didn't take place.  */
+  ssize_t nread;
+  /* The errno of a failed read.  */
+  int read_errno;
+};
+
+/* Insert the output of a process into its buffer as
+   internal-default-process-filter does, but read it from the
+   process's channel straight into the gap, and decode it there.
+   This saves copying the output, and making a string of it.  ARG
+   points to a struct gap_read describing the read.  */
+
+static Lisp_Object
+read_process_output_into_gap (Lisp_Object arg)
+{
+  struct gap_read *r = xmint_pointer (arg);
+  struct Lisp_Process *p = r->p;
+  struct coding_system *coding = r->coding;
+  int carryover = p->decoding_carryover;
+  ptrdiff_t opoint, opoint_byte, before, before_byte, nbytes, tail;
+  ptrdiff_t old_begv, old_zv, old_begv_byte, old_zv_byte;
+  Lisp_Object old_read_only;
+  unsigned char *dst;
+  struct buffer *b;
+  int mode;
+
+  Fset_buffer (p->buffer);
+  opoint = PT;
+  opoint_byte = PT_BYTE;
+  old_read_only = BVAR (current_buffer, read_only);
+  old_begv = BEGV;
+  old_zv = ZV;
+  old_begv_byte = BEGV_BYTE;
+  old_zv_byte = ZV_BYTE;
+
+  bset_read_only (current_buffer, Qnil);
+
+  if (XMARKER (p->mark)->buffer)
+    set_point_from_marker (p->mark);
+  else
+    SET_PT_BOTH (ZV, ZV_BYTE);
+  if (! (BEGV <= PT && PT <= ZV))
+    Fwiden ();
+
+  /* Run the hooks before reading, because they might use the gap.  If
+     they signal an error, the output stays unread.  */
+  prepare_to_modify_buffer (PT, PT, NULL);
+  before = PT;
+  before_byte = PT_BYTE;
+
+  /* Read the output, after the carryover, to the end of the gap,
+     where decode_coding_gap expects it.  */
+  if (PT != GPT)
+    move_gap_both (PT, PT_BYTE);
+  if (GAP_SIZE < carryover + r->nbytes)
+    make_gap (carryover + r->nbytes - GAP_SIZE);
+  dst = GAP_END_ADDR - r->nbytes - carryover;
+  if (carryover)
+    memcpy (dst, SDATA (p->decoding_buf), carryover);
+  r->nread = emacs_read (r->channel, dst + carryover, r->nbytes);
+  r->read_errno = errno;
+  nbytes = carryover + max (0, r->nread);
+
+  /* Keep an incomplete character for the next read, see
+     read_and_dispose_of_process_output.  */
+  tail = (EQ (CODING_ATTR_TYPE (CODING_ID_ATTRS (coding->id)), Qutf_8)
+	  ? utf_8_incomplete_tail (dst, nbytes) : 0);
+  p->decoding_carryover = tail;
+  if (tail)
+    {
+      if (SCHARS (p->decoding_buf) < tail)
+	pset_decoding_buf (p, make_uninit_string (tail));
+      memcpy (SDATA (p->decoding_buf), dst + nbytes - tail, tail);
+      nbytes -= tail;
+    }
+  if (dst + nbytes != GAP_END_ADDR)
+    memmove (GAP_END_ADDR - nbytes, dst, nbytes);
+
+  if (0 < nbytes)
+    {
+      /* decode_coding_gap treats its input as the last block, but
+	 this output is followed by more.  */
+      mode = coding->mode;
+      coding->dst_multibyte
+	= !NILP (BVAR (current_buffer, enable_multibyte_characters));
+      decode_coding_gap (coding, nbytes);
+      coding->mode = mode;
+      Vlast_coding_system_used = CODING_ID_NAME (coding->id);
+      adjust_after_insert_before_markers (before, before_byte,
+					  before + coding->produced_char,
+					  before_byte + coding->produced);
+    }
+  signal_after_change (before, 0, PT - before);
+  update_compositions (before, PT, CHECK_BORDER);
+
+  /* The rest is as in internal-default-process-filter.  */
+  if (BUFFERP (p->buffer)
+      && (b = XBUFFER (p->buffer), b != current_buffer))
+    set_marker_both (p->mark, p->buffer, BUF_PT (b), BUF_PT_BYTE (b));
+  else
+    set_marker_both (p->mark, p->buffer, PT, PT_BYTE);
+
+  update_mode_lines = 23;
+
+  if (opoint >= before)
+    {
+      opoint += PT - before;
+      opoint_byte += PT_BYTE - before_byte;
+    }
+  if (old_begv > before)
+    {
+      old_begv += PT - before;
+      old_begv_byte += PT_BYTE - before_byte;
+    }
+  if (old_zv >= before)
+    {
+      old_zv += PT - before;
+      old_zv_byte += PT_BYTE - before_byte;
+    }
+
+  if (old_begv != BEGV || old_zv != ZV)
+    Fnarrow_to_region (make_fixnum (old_begv), make_fixnum (old_zv));
+
+  bset_read_only (current_buffer, old_read_only);
+  SET_PT_BOTH (opoint, opoint_byte);
+  return Qnil;
+}
+
 static void
 read_and_dispose_of_process_output (struct Lisp_Process *p, char *chars,
 				    ssize_t nbytes,
-				    struct coding_system *coding);
+				    struct coding_system *coding,
+				    struct gap_read *r);
+
+/* Return where to read up to NBYTES more bytes of the output of
+   process P, whose output is split into messages, after the bytes
+   not yet consumed.  */
+
+static char *
+process_message_space (struct Lisp_Process *p, ptrdiff_t nbytes)
+{
+  ptrdiff_t size = NILP (p->message_buf) ? 0 : SBYTES (p->message_buf);
+  ptrdiff_t used = p->message_end - p->message_start;
+
+  if (size - p->message_end < nbytes)
+    {
+      if (size - used < nbytes)
+	{
+	  ptrdiff_t new_size = max (used + nbytes,
+				    (size <= STRING_BYTES_BOUND / 2
+				     ? 2 * size : STRING_BYTES_BOUND));
+	  Lisp_Object buf = make_uninit_string (new_size);
+	  if (used)
+	    memcpy (SDATA (buf), SDATA (p->message_buf) + p->message_start,
+		    used);
+	  pset_message_buf (p, buf);
+	}
+      else
+	memmove (SDATA (p->message_buf),
+		 SDATA (p->message_buf) + p->message_start, used);
+      p->message_start = 0;
+      p->message_end = used;
+    }
+  return (char *) SDATA (p->message_buf) + p->message_end;
+}
+
+/* The most bytes the header of a message can have.  */
+enum { PROCESS_MESSAGE_HEADER_MAX = 64 * 1024 };
+
+/* Return the body size that the Content-Length field in the NBYTES
+   bytes of message header at HEADER gives, or -1 if there is no such
+   valid field.  */
+
+static ptrdiff_t
+process_message_content_length (unsigned char const *header,
+				ptrdiff_t nbytes)
+{
+  static char const field[] = "content-length:";
+  int field_size = sizeof field - 1;
+  unsigned char const *end = header + nbytes;
+  unsigned char const *line, *eol, *q;
+
+  for (line = header; line < end; line = eol + 1)
+    {
+      eol = memchr (line, '\n', end - line);
+      if (!eol)
+	eol = end;
+      if (field_size <= eol - line
+	  && c_strncasecmp ((char const *) line, field, field_size) == 0)
+	{
+	  ptrdiff_t size = 0;
+	  q = line + field_size;
+	  while (q < eol && (*q == ' ' || *q == '\t'))
+	    q++;
+	  if (! (q < eol && c_isdigit (*q)))
+	    return -1;
+	  for (; q < eol && c_isdigit (*q); q++)
+	    if (INT_MULTIPLY_WRAPV (size, 10, &size)
+		|| INT_ADD_WRAPV (size, *q - '0', &size))
+	      return -1;
+	  while (q < eol && (*q == ' ' || *q == '\t' || *q == '\r'))
+	    q++;
+	  return q == eol ? size : -1;
+	}
+    }
+  return -1;
+}
+
+/* A message to give to the filter of process P: the SIZE bytes at
+   START in its message buffer.  */
+
+struct process_message
+{
+  struct Lisp_Process *p;
+  ptrdiff_t start;
+  ptrdiff_t size;
+};
+
+/* Give the filter of a process the message that ARG, a pointer to a
+   struct process_message, describes, as its framing says.  */
+
+static Lisp_Object
+read_process_message_call (Lisp_Object arg)
+{
+  struct process_message *m = xmint_pointer (arg);
+  struct Lisp_Process *p = m->p;
+  unsigned char *body = SDATA (p->message_buf) + m->start;
+  Lisp_Object message;
+
+  if (EQ (p->message_framing, Qjson))
+    message = json_parse_bytes ("<process>", body, m->size,
+				ASIZE (p->message_framing_args),
+				XVECTOR (p->message_framing_args)->contents);
+  else
+    message = make_string_from_utf8 ((char *) body, m->size);
+  return call2 (p->filter, make_lisp_proc (p), message);
+}
+
+/* Report the error MESSAGE in the output of process P as errors in
+   its filter are reported.  */
+
+static void
+process_message_error (struct Lisp_Process *p, const char *message)
+{
+  read_process_output_error_handler
+    (list2 (Qerror, CALLN (Fformat, build_string (message),
+			   p->name)));
+}
+
+/* Give the filter of process P each of the messages that its message
+   buffer holds in full, see `set-process-message-framing'.  The
+   filter can read more output or change the framing, so the state of
+   P is looked at afresh for each message, and updated before the
+   filter is called.  */
+
+static void
+dispose_of_process_messages (struct Lisp_Process *p)
+{
+  while (!NILP (p->message_framing))
+    {
+      ptrdiff_t start = p->message_start;
+      ptrdiff_t avail = p->message_end - start;
+      ptrdiff_t size = p->message_body_size;
+
+      if (size < 0)
+	{
+	  if (avail == 0)
+	    break;
+	  unsigned char *header = SDATA (p->message_buf) + start;
+	  unsigned char *end = memmem (header, avail, "\r\n\r\n", 4);
+	  if (!end)
+	    {
+	      if (avail < PROCESS_MESSAGE_HEADER_MAX)
+		break;
+	      p->message_start = p->message_end;
+	      process_message_error (p, "Message header from %s is too long");
+	      continue;
+	    }
+	  size = process_message_content_length (header, end - header);
+	  p->message_start = start + (end + 4 - header);
+	  if (size < 0)
+	    {
+	      process_message_error (p, ("Message header from %s has no"
+					 " valid Content-Length"));
+	      continue;
+	    }
+	  p->message_body_size = size;
+	  continue;
+	}
+
+      if (avail < size)
+	break;
+      p->message_start = start + size;
+      p->message_body_size = -1;
+      struct process_message m = { p, start, size };
+      internal_condition_case_1 (read_process_message_call,
+				 make_mint_ptr (&m),
+				 !NILP (Vdebug_on_error) ? Qnil : Qerror,
+				 read_process_output_error_handler);
+    }
+}
 
 /* Read pending output from the process channel,
    starting with our buffered-ahead character if we have one.
    Yield number of decoded characters read,
    or -1 (setting errno) if there is a read error.
 
-   This function reads at most read_process_output_max bytes.
+   This function reads at most process_read_size bytes.
    If you want to read all available subprocess output,
    you must call it repeatedly until it returns zero.
 
@@ -6007,20 +7080,62 @@ read_process_output (Lisp_Object proc, int channel)
 {
   ssize_t nbytes;
   struct Lisp_Process *p = XPROCESS (proc);
-  eassert (0 <= channel && channel < FD_SETSIZE);
+  eassert (0 <= channel && channel < fd_table_size);
   struct coding_system *coding = proc_decode_coding_system[channel];
   int carryover = p->decoding_carryover;
-  ptrdiff_t readmax = clip_to_bounds (1, read_process_output_max, PTRDIFF_MAX);
+  ptrdiff_t readmax = process_read_size (p);
   ptrdiff_t count = SPECPDL_INDEX ();
   Lisp_Object odeactivate;
   char *chars;
 
+  /* Read straight into the buffer if we can.  Ask for no more than is
+     available, so that the read doesn't fail after the modification
+     hooks have run.  */
+  if (process_output_to_gap_p (p, channel, coding))
+    {
+      struct gap_read r;
+      r.nbytes = min (readmax, bytes_available (channel));
+      if (0 < r.nbytes)
+	{
+	  r.p = p;
+	  r.channel = channel;
+	  r.coding = coding;
+	  r.nread = -2;
+	  odeactivate = Vdeactivate_mark;
+	  record_unwind_current_buffer ();
+	  read_and_dispose_of_process_output (p, NULL, 0, coding, &r);
+	  Vdeactivate_mark = odeactivate;
+	  unbind_to (count, Qnil);
+	  if (r.nread != -2)
+	    {
+	      if (0 < r.nread)
+		{
+		  p->nbytes_read += r.nread;
+		  adapt_process_reads (p, r.nread, readmax);
+		}
+	      else
+		errno = r.read_errno;
+	      return r.nread;
+	    }
+	  /* The hooks signaled an error.  Give the output to the
+	     filter as usual, so that it doesn't stay unread.  */
+	  carryover = p->decoding_carryover;
+	}
+    }
+
   USE_SAFE_ALLOCA;
-  chars = SAFE_ALLOCA (sizeof coding->carryover + readmax);
+  if (!NILP (p->message_framing))
+    /* Read output that is split into messages straight into the
+       message buffer, where it is split.  It has no carryover.  */
+    chars = process_message_space (p, readmax);
+  else
+    {
+      chars = SAFE_ALLOCA (sizeof coding->carryover + readmax);
 
-  if (carryover)
-    /* See the comment above.  */
-    memcpy (chars, SDATA (p->decoding_buf), carryover);
+      if (carryover)
+	/* See the comment above.  */
+	memcpy (chars, SDATA (p->decoding_buf), carryover);
+    }
 
 #ifdef DATAGRAM_SOCKETS
   /* We have a working select, so proc_buffered_char is always -1.  */
@@ -6049,31 +7164,8 @@ read_process_output (Lisp_Object proc, int channel)
 #endif
 	nbytes = emacs_read (channel, chars + carryover + buffered,
 			     readmax - buffered);
-      if (nbytes > 0 && p->adaptive_read_buffering)
-	{
-	  int delay = p->read_output_delay;
-	  if (nbytes < 256)
-	    {
-	      if (delay < READ_OUTPUT_DELAY_MAX_MAX)
-		{
-		  if (delay == 0)
-		    process_output_delay_count++;
-		  delay += READ_OUTPUT_DELAY_INCREMENT * 2;
-		}
-	    }
-	  else if (delay > 0 && nbytes == readmax - buffered)
-	    {
-	      delay -= READ_OUTPUT_DELAY_INCREMENT;
-	      if (delay == 0)
-		process_output_delay_count--;
-	    }
-	  p->read_output_delay = delay;
-	  if (delay)
-	    {
-	      p->read_output_skip = 1;
-	      process_output_skip = 1;
-	    }
-	}
+      if (nbytes > 0)
+	adapt_process_reads (p, nbytes, readmax - buffered);
       nbytes += buffered;
       nbytes += buffered && nbytes <= 0;
     }
@@ -6105,7 +7197,7 @@ read_process_output (Lisp_Object proc, int channel)
      friends don't expect current-buffer to be changed from under them.  */
   record_unwind_current_buffer ();
 
-  read_and_dispose_of_process_output (p, chars, nbytes, coding);
+  read_and_dispose_of_process_output (p, chars, nbytes, coding, NULL);
 
   /* Handling the process output should not deactivate the mark.  */
   Vdeactivate_mark = odeactivate;
@@ -6114,10 +7206,15 @@ read_process_output (Lisp_Object proc, int channel)
   return nbytes;
 }
 
+/* Give the NBYTES bytes at CHARS, which process P has produced, to
+   its filter after decoding them with CODING.  If R is non-null,
+   instead read the output straight into P's buffer as R says.  */
+
 static void
 read_and_dispose_of_process_output (struct Lisp_Process *p, char *chars,
 				    ssize_t nbytes,
-				    struct coding_system *coding)
+				    struct coding_system *coding,
+				    struct gap_read *r)
 {
   Lisp_Object outstream = p->filter;
   Lisp_Object text;
@@ -6153,6 +7250,24 @@ read_and_dispose_of_process_output (struct Lisp_Process *p, char *chars,
      save the match data in a special nonrecursive fashion.  */
   running_asynch_code = 1;
 
+  if (r)
+    {
+      internal_condition_case_1 (read_process_output_into_gap,
+				 make_mint_ptr (r),
+				 !NILP (Vdebug_on_error) ? Qnil : Qerror,
+				 read_process_output_error_handler);
+      goto done;
+    }
+
+  if (!NILP (p->message_framing))
+    {
+      eassert ((unsigned char *) chars
+	       == SDATA (p->message_buf) + p->message_end);
+      p->message_end += nbytes;
+      dispose_of_process_messages (p);
+      goto done;
+    }
+
   decode_coding_c_string (coding, (unsigned char *) chars, nbytes, Qt);
   text = coding->dst_object;
   Vlast_coding_system_used = CODING_ID_NAME (coding->id);
@@ -6172,7 +7287,7 @@ read_and_dispose_of_process_output (struct Lisp_Process *p, char *chars,
 	 proc_encode_coding_system[p->outfd] surely points to a
 	 valid memory because p->outfd will be changed once EOF is
 	 sent to the process.  */
-      eassert (p->outfd < FD_SETSIZE);
+      eassert (p->outfd < fd_table_size);
       if (NILP (p->encode_coding_system) && p->outfd >= 0
 	  && proc_encode_coding_system[p->outfd])
 	{
@@ -6200,6 +7315,7 @@ read_and_dispose_of_process_output (struct Lisp_Process *p, char *chars,
 			       !NILP (Vdebug_on_error) ? Qnil : Qerror,
 			       read_process_output_error_handler);
 
+ done:
   /* If we saved the match data nonrecursively, restore it now.  */
   restore_search_regs ();
   running_asynch_code = outer_running_asynch_code;
@@ -6381,23 +7497,173 @@ write_queue_pop (struct Lisp_Process *p, Lisp_Object *obj,
   return 1;
 }
 
-/* Send some data to process PROC.
-   BUF is the beginning of the data; LEN is the number of characters.
-   OBJECT is the Lisp object that the data comes from.  If OBJECT is
-   nil or t, it means that the data comes from C string.
+/* Remove the first NBYTES bytes from the write_queue of process P,
+   which have been sent.  */
 
-   If OBJECT is not nil, the data is encoded by PROC's coding-system
-   for encoding before it is sent.
+static void
+write_queue_consume (struct Lisp_Process *p, ptrdiff_t nbytes)
+{
+  while (CONSP (p->write_queue))
+    {
+      Lisp_Object offset_length = XCDR (XCAR (p->write_queue));
+      ptrdiff_t len = XFIXNUM (XCDR (offset_length));
 
-   This function can evaluate Lisp code and can garbage collect.  */
+      if (nbytes < len)
+	{
+	  XSETCAR (offset_length,
+		   make_fixnum (XFIXNUM (XCAR (offset_length)) + nbytes));
+	  XSETCDR (offset_length, make_fixnum (len - nbytes));
+	  break;
+	}
+      nbytes -= len;
+      pset_write_queue (p, XCDR (p->write_queue));
+    }
+}
+
+#ifdef HAVE_SYS_UIO_H
+
+/* Send as much of the write_queue of process P to OUTFD as a single
+   writev will take, and remove that from the queue.  Return the number
+   of bytes sent, or -1 with errno set on failure.  */
+
+static ssize_t
+write_queue_writev (struct Lisp_Process *p, int outfd)
+{
+  struct iovec iov[min (IOV_MAX, 64)];
+  int iovcnt = 0;
+  Lisp_Object tail;
+  ssize_t written;
+
+  for (tail = p->write_queue;
+       CONSP (tail) && iovcnt < ARRAYELTS (iov);
+       tail = XCDR (tail))
+    {
+      Lisp_Object entry = XCAR (tail);
+      Lisp_Object offset_length = XCDR (entry);
+      iov[iovcnt].iov_base = (SSDATA (XCAR (entry))
+			      + XFIXNUM (XCAR (offset_length)));
+      iov[iovcnt].iov_len = XFIXNUM (XCDR (offset_length));
+      iovcnt++;
+    }
+
+  while ((written = writev (outfd, iov, iovcnt)) < 0 && errno == EINTR)
+    if (pending_signals)
+      process_pending_signals ();
+
+  if (written >= 0)
+    write_queue_consume (p, written);
+  return written;
+}
+
+#endif
+
+/* Return true if sending the LEN bytes at BUF, which are the text of
+   OBJECT, a multibyte string or buffer, with CODING would not change
+   them, so that they needn't be encoded.  This is the case if CODING
+   is UTF-8 with Unix line ends and no conversions, and the bytes
+   contain no raw 8-bit bytes.  */
+
+static bool
+utf_8_text_unchanged_by_encoding_p (struct coding_system *coding,
+				    const char *buf, ptrdiff_t len)
+{
+  Lisp_Object attrs = CODING_ID_ATTRS (coding->id);
+  const unsigned char *p = (const unsigned char *) buf;
+  const unsigned char *end = p + len;
+
+  if (! (EQ (CODING_ATTR_TYPE (attrs), Qutf_8)
+	 && coding->spec.utf_8_bom == utf_without_bom
+	 && EQ (CODING_ID_EOL_TYPE (coding->id), Qunix)
+	 && NILP (CODING_ATTR_PRE_WRITE (attrs))
+	 && NILP (get_translation_table (attrs, true, NULL))))
+    return false;
+
+  /* Raw 8-bit bytes are represented by 2-byte sequences starting with
+     0xC0 or 0xC1, which no other character uses.  */
+  for (; p < end; p++)
+    if ((*p & 0xFE) == 0xC0)
+      return false;
+  return true;
+}
+
+/* Wait until process P can probably take more input, after a write
+   to it would have blocked.  Read output meanwhile, since P might not
+   read its input before we read its output.  */
 
 static void
-send_process (Lisp_Object proc, const char *buf, ptrdiff_t len,
-	      Lisp_Object object)
+wait_for_process_input_space (struct Lisp_Process *p)
+{
+#ifdef BROKEN_PTY_READ_AFTER_EAGAIN
+  /* A gross hack to work around a bug in FreeBSD.
+     In the following sequence, read(2) returns
+     bogus data:
+
+     write(2)	 1022 bytes
+     write(2)   954 bytes, get EAGAIN
+     read(2)   1024 bytes in process_read_output
+     read(2)     11 bytes in process_read_output
+
+     That is, read(2) returns more bytes than have
+     ever been written successfully.  The 1033 bytes
+     read are the 1022 bytes written successfully
+     after processing (for example with CRs added if
+     the terminal is set up that way which it is
+     here).  The same bytes will be seen again in a
+     later read(2), without the CRs.  */
+
+  if (errno == EAGAIN)
+    {
+      int flags = FWRITE;
+      ioctl (p->outfd, TIOCFLUSH, &flags);
+    }
+#endif /* BROKEN_PTY_READ_AFTER_EAGAIN */
+
+  /* Stop waiting as soon as P can take more input, unless some other
+     thread would have to wait for P, or something else already waits
+     for its descriptor to be writable.  */
+  if ((NILP (p->thread) || XTHREAD (p->thread) == current_thread)
+      && (fd_callback_info[p->outfd].flags & FOR_WRITE) == 0)
+    {
+      add_input_space_fd (p);
+      wait_reading_process_output (0, 20 * 1000 * 1000, 0, 0, Qnil, p, 0);
+      delete_input_space_fd (p);
+    }
+  else
+    wait_reading_process_output (0, 20 * 1000 * 1000, 0, 0, Qnil, NULL, 0);
+}
+
+/* Signal an error for a failed write to process PROC, with errno set,
+   closing PROC if it no longer reads its input.  */
+
+static AVOID
+send_process_error (Lisp_Object proc)
+{
+  struct Lisp_Process *p = XPROCESS (proc);
+
+  if (errno == EPIPE)
+    {
+      p->raw_status_new = 0;
+      pset_status (p, list2 (Qexit, make_fixnum (256)));
+      p->tick = ++process_tick;
+      deactivate_process (proc);
+      error ("process %s no longer connected to pipe; closed it",
+	     SDATA (p->name));
+    }
+  else
+    /* This is a real error.  */
+    report_file_error ("Writing to process", proc);
+}
+
+static void send_process_1 (Lisp_Object, const char *, ptrdiff_t,
+			    Lisp_Object);
+
+/* Signal an error if process PROC can't take input, after waiting
+   for it to be set up if it is a network process.  */
+
+static void
+check_process_can_send (Lisp_Object proc)
 {
   struct Lisp_Process *p = XPROCESS (proc);
-  ssize_t rv;
-  struct coding_system *coding;
 
   if (NETCONN_P (proc))
     {
@@ -6411,8 +7677,30 @@ send_process (Lisp_Object proc, const char *buf, ptrdiff_t len,
     error ("Process %s not running", SDATA (p->name));
   if (p->outfd < 0)
     error ("Output file descriptor of %s is closed", SDATA (p->name));
+}
+
+/* Send some data to process PROC.
+   BUF is the beginning of the data; LEN is the number of characters.
+   OBJECT is the Lisp object that the data comes from.  If OBJECT is
+   nil or t, it means that the data comes from C string.
+
+   If OBJECT is not nil, the data is encoded by PROC's coding-system
+   for encoding before it is sent, unless encoding wouldn't change it.
+   Then it is sent straight from OBJECT, and copied only if the process
+   can't take all of it at once.
+
+   This function can evaluate Lisp code and can garbage collect.  */
+
+static void
+send_process (Lisp_Object proc, const char *buf, ptrdiff_t len,
+	      Lisp_Object object)
+{
+  struct Lisp_Process *p = XPROCESS (proc);
+  struct coding_system *coding;
 
-  eassert (p->outfd < FD_SETSIZE);
+  check_process_can_send (proc);
+
+  eassert (p->outfd < fd_table_size);
   coding = proc_encode_coding_system[p->outfd];
   Vlast_coding_system_used = CODING_ID_NAME (coding->id);
 
@@ -6461,7 +7749,10 @@ send_process (Lisp_Object proc, const char *buf, ptrdiff_t len,
     }
   coding->dst_multibyte = 0;
 
-  if (CODING_REQUIRE_ENCODING (coding))
+  if (CODING_REQUIRE_ENCODING (coding)
+      && ! (coding->src_multibyte
+	    && (STRINGP (object) || BUFFERP (object))
+	    && utf_8_text_unchanged_by_encoding_p (coding, buf, len)))
     {
       coding->dst_object = Qt;
       if (BUFFERP (object))
@@ -6498,6 +7789,22 @@ send_process (Lisp_Object proc, const char *buf, ptrdiff_t len,
       buf = SSDATA (object);
     }
 
+  send_process_1 (proc, buf, len, object);
+}
+
+/* Send LEN bytes at BUF to process PROC as they are, queueing them
+   behind any data that is still waiting to be sent.  OBJECT is the
+   Lisp string that BUF points into, or nil if BUF is a C string.
+
+   This function can evaluate Lisp code and can garbage collect.  */
+
+static void
+send_process_1 (Lisp_Object proc, const char *buf, ptrdiff_t len,
+		Lisp_Object object)
+{
+  struct Lisp_Process *p = XPROCESS (proc);
+  ssize_t rv;
+
   /* If there is already data in the write_queue, put the new data
      in the back of queue.  Otherwise, ignore it.  */
   if (!NILP (p->write_queue))
@@ -6509,6 +7816,36 @@ send_process (Lisp_Object proc, const char *buf, ptrdiff_t len,
       const char *cur_buf;
       Lisp_Object cur_object;
 
+#ifdef HAVE_SYS_UIO_H
+      /* Send as many queued entries as we can with each write.  */
+      if (!NILP (p->write_queue)
+#ifdef DATAGRAM_SOCKETS
+	  && !DATAGRAM_CHAN_P (p->outfd)
+#endif
+#ifdef HAVE_GNUTLS
+	  && !(p->gnutls_p && p->gnutls_state)
+#endif
+	  )
+	{
+	  eassert (0 <= p->outfd && p->outfd < fd_table_size);
+	  if (write_queue_writev (p, p->outfd) < 0)
+	    {
+	      if (would_block (errno))
+		wait_for_process_input_space (p);
+	      else
+		send_process_error (proc);
+	    }
+	  else if (p->read_output_delay > 0
+		   && p->adaptive_read_buffering == 1)
+	    {
+	      p->read_output_delay = 0;
+	      process_output_delay_count--;
+	      p->read_output_skip = 0;
+	    }
+	  continue;
+	}
+#endif
+
       /* If write_queue is empty, ignore it.  */
       if (!write_queue_pop (p, &cur_object, &cur_buf, &cur_len))
 	{
@@ -6522,7 +7859,7 @@ send_process (Lisp_Object proc, const char *buf, ptrdiff_t len,
 	  /* Send this batch, using one or more write calls.  */
 	  ptrdiff_t written = 0;
 	  int outfd = p->outfd;
-	  eassert (0 <= outfd && outfd < FD_SETSIZE);
+	  eassert (0 <= outfd && outfd < fd_table_size);
 #ifdef DATAGRAM_SOCKETS
 	  if (DATAGRAM_CHAN_P (outfd))
 	    {
@@ -6568,50 +7905,14 @@ send_process (Lisp_Object proc, const char *buf, ptrdiff_t len,
 		   that may allow the program
 		   to finish doing output and read more.  */
 		{
-#ifdef BROKEN_PTY_READ_AFTER_EAGAIN
-		  /* A gross hack to work around a bug in FreeBSD.
-		     In the following sequence, read(2) returns
-		     bogus data:
-
-		     write(2)	 1022 bytes
-		     write(2)   954 bytes, get EAGAIN
-		     read(2)   1024 bytes in process_read_output
-		     read(2)     11 bytes in process_read_output
-
-		     That is, read(2) returns more bytes than have
-		     ever been written successfully.  The 1033 bytes
-		     read are the 1022 bytes written successfully
-		     after processing (for example with CRs added if
-		     the terminal is set up that way which it is
-		     here).  The same bytes will be seen again in a
-		     later read(2), without the CRs.  */
-
-		  if (errno == EAGAIN)
-		    {
-		      int flags = FWRITE;
-		      ioctl (p->outfd, TIOCFLUSH, &flags);
-		    }
-#endif /* BROKEN_PTY_READ_AFTER_EAGAIN */
-
 		  /* Put what we should have written in write_queue.  */
 		  write_queue_push (p, cur_object, cur_buf, cur_len, 1);
-		  wait_reading_process_output (0, 20 * 1000 * 1000,
-					       0, 0, Qnil, NULL, 0);
+		  wait_for_process_input_space (p);
 		  /* Reread queue, to see what is left.  */
 		  break;
 		}
-	      else if (errno == EPIPE)
-		{
-		  p->raw_status_new = 0;
-		  pset_status (p, list2 (Qexit, make_fixnum (256)));
-		  p->tick = ++process_tick;
-		  deactivate_process (proc);
-		  error ("process %s no longer connected to pipe; closed it",
-			 SDATA (p->name));
-		}
 	      else
-		/* This is a real error.  */
-		report_file_error ("Writing to process", proc);
+		send_process_error (proc);
 	    }
 	  cur_buf += written;
 	  cur_len -= written;
@@ -6620,6 +7921,20 @@ send_process (Lisp_Object proc, const char *buf, ptrdiff_t len,
   while (!NILP (p->write_queue));
 }
 
+/* Send the LEN bytes at BUF, a C string, to process PROC as they are,
+   without encoding them with its coding system.  This is for callers
+   that produce the bytes to send themselves, such as the JSON
+   serializer.
+
+   This function can evaluate Lisp code and can garbage collect.  */
+
+void
+send_process_bytes (Lisp_Object proc, const char *buf, ptrdiff_t len)
+{
+  check_process_can_send (proc);
+  send_process_1 (proc, buf, len, Qnil);
+}
+
 DEFUN ("process-send-region", Fprocess_send_region, Sprocess_send_region,
        3, 3, 0,
        doc: /* Send current contents of region as input to PROCESS.
@@ -6973,7 +8288,7 @@ DEFUN ("continue-process", Fcontinue_process, Scontinue_process, 0, 2, 0,
       struct Lisp_Process *p;
 
       p = XPROCESS (process);
-      eassert (p->infd < FD_SETSIZE);
+      eassert (p->infd < fd_table_size);
       if (EQ (p->command, Qt)
 	  && p->infd >= 0
 	  && (!EQ (p->filter, Qt) || EQ (p->status, Qlisten)))
@@ -7101,7 +8416,7 @@ DEFUN ("process-send-eof", Fprocess_send_eof, Sprocess_send_eof, 0, 1, 0,
 
 
   outfd = XPROCESS (proc)->outfd;
-  eassert (outfd < FD_SETSIZE);
+  eassert (outfd < fd_table_size);
   if (outfd >= 0)
     coding = proc_encode_coding_system[outfd];
 
@@ -7142,6 +8457,7 @@ DEFUN ("process-send-eof", Fprocess_send_eof, Sprocess_send_eof, 0, 1, 0,
 	  && (EQ (p->type, Qnetwork) || p->infd == old_outfd))
 	shutdown (old_outfd, 1);
 #endif
+      delete_input_space_fd (p);
       close_process_fd (&p->open_fd[WRITE_TO_SUBPROCESS]);
       new_outfd = emacs_open (NULL_DEVICE, O_WRONLY, 0);
       if (new_outfd < 0)
@@ -7149,13 +8465,13 @@ DEFUN ("process-send-eof", Fprocess_send_eof, Sprocess_send_eof, 0, 1, 0,
       p->open_fd[WRITE_TO_SUBPROCESS] = new_outfd;
       p->outfd = new_outfd;
 
-      eassert (0 <= new_outfd && new_outfd < FD_SETSIZE);
+      eassert (0 <= new_outfd && new_outfd < fd_table_size);
       if (!proc_encode_coding_system[new_outfd])
 	proc_encode_coding_system[new_outfd]
 	  = xmalloc (sizeof (struct coding_system));
       if (old_outfd >= 0)
 	{
-	  eassert (old_outfd < FD_SETSIZE);
+	  eassert (old_outfd < fd_table_size);
 	  *proc_encode_coding_system[new_outfd]
 	    = *proc_encode_coding_system[old_outfd];
 	  memset (proc_encode_coding_system[old_outfd], 0,
@@ -7228,10 +8544,10 @@ child_signal_init (void)
   int fds[2];
   if (emacs_pipe (fds) < 0)
     report_file_error ("Creating pipe for child signal", Qnil);
-  if (FD_SETSIZE <= fds[0])
+  if (!grow_fd_tables (fds[0]))
     {
-      /* Since we need to `pselect' on the read end, it has to fit
-	 into an `fd_set'.  */
+      /* Since we need to wait for the read end, it has to fit
+	 into an `fd_set' if we use `pselect'.  */
       emacs_close (fds[0]);
       emacs_close (fds[1]);
       report_file_errno ("Creating pipe for child signal", Qnil,
@@ -7282,6 +8598,152 @@ child_signal_notify (void)
 #endif
 }
 
+/* Record STATUS, which waitpid reported, as the new status of the
+   child process P.  This can be called from the SIGCHLD handler.  */
+
+static void
+record_child_status (struct Lisp_Process *p, int status)
+{
+  p->tick = ++process_tick;
+  p->raw_status = status;
+  p->raw_status_new = 1;
+
+  /* If process has terminated, stop waiting for its output.  */
+  if (WIFSIGNALED (status) || WIFEXITED (status))
+    {
+      bool clear_desc_flag = 0;
+      p->alive = 0;
+      if (p->infd >= 0)
+	clear_desc_flag = 1;
+
+      /* clear_desc_flag avoids a compiler bug in Microsoft C.  */
+      if (clear_desc_flag)
+	delete_read_fd (p->infd);
+    }
+}
+
+#ifdef USE_PIDFD
+
+/* Number of processes that have a pidfd.  */
+static int num_child_pidfds;
+
+/* Record the exit of the process DATA, whose pidfd FD has become
+   readable, unless the SIGCHLD handler already did.  Then stop
+   waiting for FD.  */
+
+static void
+child_pidfd_ready (int fd, void *data)
+{
+  struct Lisp_Process *p = data;
+  int status;
+  sigset_t oldset;
+
+  eassert (fd == p->pidfd);
+  block_child_signal (&oldset);
+  if (p->alive
+      && child_status_changed (p->pid, &status, WUNTRACED | WCONTINUED))
+    record_child_status (p, status);
+  unblock_child_signal (&oldset);
+
+  if (!p->alive)
+    close_child_pidfd (p);
+}
+
+/* Wait for the child process P to exit with a pidfd, rather than
+   leaving that to the SIGCHLD handler.  Do nothing if the system
+   can't make one.  */
+
+static void
+open_child_pidfd (struct Lisp_Process *p)
+{
+  int fd = pidfd_open (p->pid, 0);
+
+  if (fd < 0)
+    return;
+  if (!grow_fd_tables (fd))
+    {
+      emacs_close (fd);
+      return;
+    }
+  add_non_keyboard_read_fd (fd, child_pidfd_ready, p);
+  fd_callback_info[fd].flags |= CHILD_FD;
+  p->pidfd = fd;
+  num_child_pidfds++;
+}
+
+static void
+close_child_pidfd (struct Lisp_Process *p)
+{
+  int fd = p->pidfd;
+
+  if (fd < 0)
+    return;
+  p->pidfd = -1;
+  num_child_pidfds--;
+  delete_read_fd (fd);
+  emacs_close (fd);
+}
+
+/* Look for the processes with a pidfd whose status changed, without
+   checking every process, and record their new status.  The pidfds
+   also report the exits, but only when wait_reading_process_output
+   next looks at them, whereas the SIGCHLD handler, which calls this,
+   records them right away.  Value is true if any status changed.  */
+
+static bool
+record_child_changes (void)
+{
+  bool changed = false;
+
+  while (true)
+    {
+      Lisp_Object tail, proc;
+      struct Lisp_Process *p = NULL;
+      siginfo_t info;
+      int status;
+
+      /* Find a child with a new status without reaping it.  */
+      info.si_pid = 0;
+      if (waitid (P_ALL, 0, &info,
+		  WEXITED | WSTOPPED | WCONTINUED | WNOHANG | WNOWAIT) != 0
+	  || info.si_pid == 0)
+	break;
+      FOR_EACH_PROCESS (tail, proc)
+	if (XPROCESS (proc)->pid == info.si_pid)
+	  {
+	    p = XPROCESS (proc);
+	    break;
+	  }
+
+      if (p && p->alive && 0 <= p->pidfd
+	  && child_status_changed (p->pid, &status, WUNTRACED | WCONTINUED))
+	{
+	  changed = true;
+	  record_child_status (p, status);
+	  continue;
+	}
+
+      /* The child isn't ours to wait for, and waitid would keep
+	 finding it first.  Check the processes with a pidfd one by
+	 one instead.  */
+      FOR_EACH_PROCESS (tail, proc)
+	{
+	  p = XPROCESS (proc);
+	  if (p->alive && 0 <= p->pidfd
+	      && child_status_changed (p->pid, &status,
+				       WUNTRACED | WCONTINUED))
+	    {
+	      changed = true;
+	      record_child_status (p, status);
+	    }
+	}
+      break;
+    }
+  return changed;
+}
+
+#endif	/* USE_PIDFD */
+
 /* LIB_CHILD_HANDLER is a SIGCHLD handler that Emacs calls while doing
    its own SIGCHLD handling.  On POSIXish systems, glib needs this to
    keep track of its own children.  GNUstep is similar.  */
@@ -7349,36 +8811,29 @@ handle_child_signal (int sig)
 	}
     }
 
-  /* Otherwise, if it is asynchronous, it is in Vprocess_alist.  */
+  /* Otherwise, if it is asynchronous, it is in Vprocess_alist.
+     The processes with a pidfd are looked for separately.  */
   FOR_EACH_PROCESS (tail, proc)
     {
       struct Lisp_Process *p = XPROCESS (proc);
       int status;
 
       if (p->alive
+#ifdef USE_PIDFD
+	  && p->pidfd < 0
+#endif
 	  && child_status_changed (p->pid, &status, WUNTRACED | WCONTINUED))
 	{
-	  /* Change the status of the process that was found.  */
 	  changed = true;
-	  p->tick = ++process_tick;
-	  p->raw_status = status;
-	  p->raw_status_new = 1;
-
-	  /* If process has terminated, stop waiting for its output.  */
-	  if (WIFSIGNALED (status) || WIFEXITED (status))
-	    {
-	      bool clear_desc_flag = 0;
-	      p->alive = 0;
-	      if (p->infd >= 0)
-		clear_desc_flag = 1;
-
-	      /* clear_desc_flag avoids a compiler bug in Microsoft C.  */
-	      if (clear_desc_flag)
-		delete_read_fd (p->infd);
-	    }
+	  record_child_status (p, status);
 	}
     }
 
+#ifdef USE_PIDFD
+  if (0 < num_child_pidfds && record_child_changes ())
+    changed = true;
+#endif
+
   if (changed)
     /* Wake up `wait_reading_process_output'.  */
     child_signal_notify ();
@@ -7699,12 +9154,70 @@ DEFUN ("process-filter-multibyte-p", Fprocess_filter_multibyte_p,
   struct Lisp_Process *p = XPROCESS (process);
   if (p->infd < 0)
     return Qnil;
-  eassert (p->infd < FD_SETSIZE);
+  eassert (p->infd < fd_table_size);
   struct coding_system *coding = proc_decode_coding_system[p->infd];
   return (CODING_FOR_UNIBYTE (coding) ? Qnil : Qt);
 }
 
 
+DEFUN ("set-process-message-framing", Fset_process_message_framing,
+       Sset_process_message_framing, 2, MANY, 0,
+       doc: /* Split the output of PROCESS into messages framed as FRAMING.
+If FRAMING is nil, the filter of PROCESS is given its output as it
+arrives, decoded with its coding system for decoding.
+
+Otherwise the output is expected to be a series of messages as in
+JSON-RPC over streams and the Language Server Protocol: each consists
+of header lines ending with CRLF, an empty line, and a body whose size
+in bytes the header field "Content-Length" gives.  The filter is then
+called once for each message, with its body in place of the output:
+
+- If FRAMING is `content-length', the body is given as a string,
+  decoded as UTF-8.
+
+- If FRAMING is `json', the body is parsed as JSON, and given as the
+  resulting object.  ARGS are keyword arguments that specify how, the
+  same as for `json-parse-string', which see.
+
+The headers and the bodies are neither inserted into buffers nor made
+into strings on the way.  Errors in the framing or in parsing a body
+are reported as errors in the filter, and the message is skipped.
+Changing the framing discards any incomplete message read so far.
+usage: (set-process-message-framing PROCESS FRAMING &rest ARGS)  */)
+  (ptrdiff_t nargs, Lisp_Object *args)
+{
+  Lisp_Object process = args[0], framing = args[1];
+  CHECK_PROCESS (process);
+  if (EQ (framing, Qjson))
+    json_check_parse_args (nargs - 2, args + 2);
+  else if (!NILP (framing) && !EQ (framing, Qcontent_length))
+    wrong_choice (list3 (Qnil, Qcontent_length, Qjson), framing);
+  else if (nargs > 2)
+    xsignal2 (Qwrong_number_of_arguments, Qset_process_message_framing,
+	      make_fixnum (nargs));
+
+  struct Lisp_Process *p = XPROCESS (process);
+  pset_message_framing (p, framing);
+  pset_message_framing_args (p, Fvector (nargs - 2, args + 2));
+  pset_message_buf (p, Qnil);
+  p->message_start = p->message_end = 0;
+  p->message_body_size = -1;
+  /* Framed output is never decoded.  */
+  p->decoding_carryover = 0;
+  return Qnil;
+}
+
+DEFUN ("process-message-framing", Fprocess_message_framing,
+       Sprocess_message_framing, 1, 1, 0,
+       doc: /* Return the framing of the output messages of PROCESS.
+See `set-process-message-framing'.  */)
+  (Lisp_Object process)
+{
+  CHECK_PROCESS (process);
+  return XPROCESS (process)->message_framing;
+}
+
+
 
 
 # ifdef HAVE_GPM
@@ -7725,18 +9238,18 @@ delete_gpm_wait_descriptor (int desc)
 
 # ifdef USABLE_SIGIO
 
-/* Return true if *MASK has a bit set
-   that corresponds to one of the keyboard input descriptors.  */
+/* Return true if READY has a descriptor ready for reading
+   that is one of the keyboard input descriptors.  */
 
 static bool
-keyboard_bit_set (fd_set *mask)
+keyboard_bit_set (struct ready_fds *ready)
 {
-  int fd;
+  ptrdiff_t i;
 
-  eassert (max_desc < FD_SETSIZE);
-  for (fd = 0; fd <= max_desc; fd++)
-    if (FD_ISSET (fd, mask)
-	&& ((fd_callback_info[fd].flags & (FOR_READ | KEYBOARD_FD))
+  for (i = 0; i < ready->n; i++)
+    if (ready->fds[i].events & FOR_READ
+	&& ((fd_callback_info[ready->fds[i].fd].flags
+	     & (FOR_READ | KEYBOARD_FD))
 	    == (FOR_READ | KEYBOARD_FD)))
       return 1;
 
@@ -7981,7 +9494,7 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 void
 add_timer_wait_descriptor (int fd)
 {
-  eassert (0 <= fd && fd < FD_SETSIZE);
+  eassert (0 <= fd && fd < fd_table_size);
   add_read_fd (fd, timerfd_callback, NULL);
   fd_callback_info[fd].flags &= ~KEYBOARD_FD;
 }
@@ -8007,11 +9520,16 @@ remove_slash_colon (Lisp_Object name)
 add_keyboard_wait_descriptor (int desc)
 {
 #ifdef subprocesses /* Actually means "not MSDOS".  */
-  eassert (desc >= 0 && desc < FD_SETSIZE);
+  eassert (desc >= 0);
+  if (!grow_fd_tables (desc))
+    emacs_abort ();
   fd_callback_info[desc].flags &= ~PROCESS_FD;
   fd_callback_info[desc].flags |= (FOR_READ | KEYBOARD_FD);
   if (desc > max_desc)
     max_desc = desc;
+#ifdef USE_EPOLL
+  epoll_update (desc);
+#endif
 #endif
 }
 
@@ -8021,9 +9539,13 @@ add_keyboard_wait_descriptor (int desc)
 delete_keyboard_wait_descriptor (int desc)
 {
 #ifdef subprocesses
-  eassert (desc >= 0 && desc < FD_SETSIZE);
+  eassert (desc >= 0 && desc < fd_table_size);
 
-  fd_callback_info[desc].flags &= ~(FOR_READ | KEYBOARD_FD | PROCESS_FD);
+  fd_callback_info[desc].flags &= ~(FOR_READ | KEYBOARD_FD | PROCESS_FD
+				    | CHILD_FD);
+#ifdef USE_EPOLL
+  epoll_update (desc);
+#endif
 
   if (desc == max_desc)
     recompute_max_desc ();
@@ -8044,7 +9566,7 @@ setup_process_coding_systems (Lisp_Object process)
   if (inch < 0 || outch < 0)
     return;
 
-  eassert (0 <= inch && inch < FD_SETSIZE);
+  eassert (0 <= inch && inch < fd_table_size);
   if (!proc_decode_coding_system[inch])
     proc_decode_coding_system[inch] = xmalloc (sizeof (struct coding_system));
   coding_system = p->decode_coding_system;
@@ -8056,7 +9578,7 @@ setup_process_coding_systems (Lisp_Object process)
     }
   setup_coding_system (coding_system, proc_decode_coding_system[inch]);
 
-  eassert (0 <= outch && outch < FD_SETSIZE);
+  eassert (0 <= outch && outch < fd_table_size);
   if (!proc_encode_coding_system[outch])
     proc_encode_coding_system[outch] = xmalloc (sizeof (struct coding_system));
   setup_coding_system (p->encode_coding_system,
@@ -8302,8 +9824,6 @@ open_channel_for_module (Lisp_Object process)
 init_process_emacs (int sockfd)
 {
 #ifdef subprocesses
-  int i;
-
   inhibit_sentinels = 0;
 
   if (!will_dump_with_unexec_p ())
@@ -8334,8 +9854,9 @@ init_process_emacs (int sockfd)
 #endif
     }
 
-#ifdef HAVE_SETRLIMIT
-  /* Don't allocate more than FD_SETSIZE file descriptors for Emacs itself.  */
+#if defined HAVE_SETRLIMIT && !defined USE_POLL
+  /* Don't allocate more than FD_SETSIZE file descriptors for Emacs
+     itself, unless it waits for them with poll or epoll.  */
   if (getrlimit (RLIMIT_NOFILE, &nofile_limit) != 0)
     nofile_limit.rlim_cur = 0;
   else if (FD_SETSIZE < nofile_limit.rlim_cur)
@@ -8361,7 +9882,22 @@ init_process_emacs (int sockfd)
   Vinternal__daemon_sockname = sockname;
 
   max_desc = -1;
-  memset (fd_callback_info, 0, sizeof (fd_callback_info));
+  fd_table_size = 0;
+  fd_callback_info = NULL;
+  chan_process = NULL;
+  proc_buffered_char = NULL;
+  proc_decode_coding_system = proc_encode_coding_system = NULL;
+#ifdef DATAGRAM_SOCKETS
+  datagram_address = NULL;
+#endif
+  grow_fd_tables (0);
+  num_waiting_fds = 0;
+
+#ifdef USE_EPOLL
+  epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+  epoll_stale = false;
+  epoll_nmuted = 0;
+#endif
 
   num_pending_connects = 0;
 
@@ -8377,16 +9913,6 @@ init_process_emacs (int sockfd)
 
   Vprocess_alist = Qnil;
   deleted_pid_list = Qnil;
-  for (i = 0; i < FD_SETSIZE; i++)
-    {
-      chan_process[i] = Qnil;
-      proc_buffered_char[i] = -1;
-    }
-  memset (proc_decode_coding_system, 0, sizeof proc_decode_coding_system);
-  memset (proc_encode_coding_system, 0, sizeof proc_encode_coding_system);
-#ifdef DATAGRAM_SOCKETS
-  memset (datagram_address, 0, sizeof datagram_address);
-#endif
 
 #endif	/* subprocesses */
   kbd_is_on_hold = 0;
@@ -8496,6 +10022,9 @@ syms_of_process (void)
 	  "internal-default-process-sentinel");
   DEFSYM (Qinternal_default_process_filter,
 	  "internal-default-process-filter");
+  DEFSYM (Qcontent_length, "content-length");
+  DEFSYM (Qjson, "json");
+  DEFSYM (Qset_process_message_framing, "set-process-message-framing");
 #endif
   DEFSYM (Qpri, "pri");
   DEFSYM (Qnice, "nice");
@@ -8559,9 +10088,11 @@ syms_of_process (void)
   Vinternal__daemon_sockname = Qnil;
 
   DEFVAR_INT ("read-process-output-max", read_process_output_max,
-	      doc: /* Maximum number of bytes to read from subprocess in a single chunk.
-Enlarge the value only if the subprocess generates very large (megabytes)
-amounts of data in one go.  */);
+	      doc: /* Number of bytes to read from subprocess in a single chunk.
+While a subprocess produces output faster than Emacs reads it, Emacs
+reads larger chunks from it, up to a megabyte or this value, whichever
+is larger.  Enlarge the value only if the subprocess generates very
+large (megabytes) amounts of data in one go.  */);
   read_process_output_max = 4096;
 
   DEFSYM (Qinternal_default_interrupt_process,
@@ -8631,6 +10162,8 @@ syms_of_process (void)
   defsubr (&Sprocess_coding_system);
   defsubr (&Sset_process_filter_multibyte);
   defsubr (&Sprocess_filter_multibyte_p);
+  defsubr (&Sset_process_message_framing);
+  defsubr (&Sprocess_message_framing);
 
  {
    Lisp_Object subfeatures = Qnil;
@@ -115,6 +115,17 @@ #define EMACS_PROCESS_H
     /* Pipe process attached to the standard error of this process.  */
     Lisp_Object stderrproc;
 
+    /* How the output is split into messages for the filter: nil, or
+       one of the symbols `content-length' and `json'.  */
+    Lisp_Object message_framing;
+
+    /* Vector of the keyword arguments for parsing JSON messages.  */
+    Lisp_Object message_framing_args;
+
+    /* Unibyte string holding the output that hasn't been given to the
+       filter as messages yet, or nil.  */
+    Lisp_Object message_buf;
+
     /* The thread a process is linked to, or nil for any thread.  */
     Lisp_Object thread;
     /* After this point, there are no Lisp_Objects.  */
@@ -131,6 +142,9 @@ #define EMACS_PROCESS_H
     uintmax_t nbytes_read;
     /* Descriptor by which we write to this process.  */
     int outfd;
+    /* Descriptor that becomes readable when this child process exits,
+       or -1 if the SIGCHLD handler must check for that.  */
+    int pidfd;
     /* Descriptors that were created for this process and that need
        closing.  Unused entries are negative.  */
     int open_fd[PROCESS_OPEN_FDS];
@@ -147,6 +161,17 @@ #define EMACS_PROCESS_H
        time.  Value is nanoseconds to delay reading output from
        this process.  Range is 0 .. 50 * 1000 * 1000.  */
     int read_output_delay;
+    /* Number of bytes to read from this process at once, or 0 to use
+       `read-process-output-max'.  It grows while the process keeps
+       producing output faster than we read it.  */
+    ptrdiff_t read_output_size;
+    /* The bytes of `message_buf' that are in use, and the start of
+       those not yet consumed.  */
+    ptrdiff_t message_start;
+    ptrdiff_t message_end;
+    /* The size of the body of the message at `message_start', or -1 if
+       its header hasn't been read yet.  */
+    ptrdiff_t message_body_size;
     /* Should we delay reading output from this process.
        Initialized from `Vprocess_adaptive_read_buffering'.
        0 = nil, 1 = t, 2 = other.  */
@@ -303,6 +328,9 @@ pset_gnutls_cred_type (struct Lisp_Process *p, Lisp_Object val)
 
 extern int open_channel_for_module (Lisp_Object);
 
+extern Lisp_Object get_process (Lisp_Object);
+extern void send_process_bytes (Lisp_Object, const char *, ptrdiff_t);
+
 INLINE_HEADER_END
 
 #endif /* EMACS_PROCESS_H */
@@ -1649,12 +1649,65 @@ DEFUN ("skip-syntax-backward", Fskip_syntax_backward, Sskip_syntax_backward, 1,
   return skip_syntaxes (0, syntax, lim);
 }
 
+/* Return true if the ASCII character C is in the set being skipped.
+   ASCIIMAP caches the answer for each ASCII character: 1 if C is in
+   the set, 0 if it is not, and -1 if that is not yet known.  Unknown
+   entries are computed from ISO_CLASSES, NEGATE and FASTMAP the same
+   way the general loops of skip_chars do, so that runs of ASCII text
+   can be skipped without decoding characters or walking ISO_CLASSES
+   more than once per character.  */
+
+static bool
+skip_chars_ascii_p (signed char *asciimap, const char *fastmap,
+		    Lisp_Object iso_classes, bool negate, int c)
+{
+  int in_set = asciimap[c];
+  if (in_set < 0)
+    {
+      in_set = in_classes (c, iso_classes) ? !negate : fastmap[c];
+      asciimap[c] = in_set;
+    }
+  return in_set;
+}
+
+/* Return the address of the first byte in [P, STOP) that is either
+   not ASCII or an ASCII character not in the set described by
+   ASCIIMAP and its fallbacks, or STOP if there is no such byte.  */
+
+static unsigned char *
+skip_ascii_run_forward (unsigned char *p, unsigned char *stop,
+			signed char *asciimap, const char *fastmap,
+			Lisp_Object iso_classes, bool negate)
+{
+  for (; p < stop && ASCII_CHAR_P (*p); p++)
+    if (! skip_chars_ascii_p (asciimap, fastmap, iso_classes, negate, *p))
+      break;
+  return p;
+}
+
+/* Likewise, but scan backward from P, which must be greater than
+   STOP, and return the address just after the first byte that stops
+   the scan, or STOP if every byte in [STOP, P) was skipped.  */
+
+static unsigned char *
+skip_ascii_run_backward (unsigned char *p, unsigned char *stop,
+			 signed char *asciimap, const char *fastmap,
+			 Lisp_Object iso_classes, bool negate)
+{
+  for (; p > stop && ASCII_CHAR_P (p[-1]); p--)
+    if (! skip_chars_ascii_p (asciimap, fastmap, iso_classes, negate, p[-1]))
+      break;
+  return p;
+}
+
 static Lisp_Object
 skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 	    bool handle_iso_classes)
 {
   int c;
   char fastmap[0400];
+  /* Membership of ASCII characters, see skip_chars_ascii_p.  */
+  signed char asciimap[0200];
   /* Store the ranges of non-ASCII characters.  */
   int *char_ranges UNINIT;
   int n_char_ranges = 0;
@@ -1929,11 +1982,19 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 	}
     }
 
+  /* Without character classes, FASTMAP alone decides membership of
+     ASCII characters; otherwise compute it lazily.  */
+  if (NILP (iso_classes))
+    for (i = 0; i < 0200; i++)
+      asciimap[i] = fastmap[i];
+  else
+    memset (asciimap, -1, sizeof asciimap);
+
   {
     ptrdiff_t start_point = PT;
     ptrdiff_t pos = PT;
     ptrdiff_t pos_byte = PT_BYTE;
-    unsigned char *p = PT_ADDR, *endp, *stop;
+    unsigned char *p = PT_ADDR, *endp, *stop, *run;
 
     if (forwardp)
       {
@@ -1966,6 +2027,17 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 		  p = GAP_END_ADDR;
 		  stop = endp;
 		}
+	      if (ASCII_CHAR_P (*p))
+		{
+		  run = skip_ascii_run_forward (p, stop, asciimap, fastmap,
+						iso_classes, negate);
+		  pos += run - p, pos_byte += run - p;
+		  p = run;
+		  maybe_quit ();
+		  if (p < stop && ASCII_CHAR_P (*p))
+		    break;
+		  continue;
+		}
 	      c = string_char_and_length (p, &nbytes);
 	      if (! NILP (iso_classes) && in_classes (c, iso_classes))
 		{
@@ -2007,6 +2079,17 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 		  p = GAP_END_ADDR;
 		  stop = endp;
 		}
+	      if (ASCII_CHAR_P (*p))
+		{
+		  run = skip_ascii_run_forward (p, stop, asciimap, fastmap,
+						iso_classes, negate);
+		  pos += run - p, pos_byte += run - p;
+		  p = run;
+		  maybe_quit ();
+		  if (p < stop && ASCII_CHAR_P (*p))
+		    break;
+		  continue;
+		}
 
 	      if (!NILP (iso_classes) && in_classes (*p, iso_classes))
 		{
@@ -2035,6 +2118,17 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 		  p = GPT_ADDR;
 		  stop = endp;
 		}
+	      if (ASCII_CHAR_P (p[-1]))
+		{
+		  run = skip_ascii_run_backward (p, stop, asciimap, fastmap,
+						 iso_classes, negate);
+		  pos -= p - run, pos_byte -= p - run;
+		  p = run;
+		  maybe_quit ();
+		  if (p > stop && ASCII_CHAR_P (p[-1]))
+		    break;
+		  continue;
+		}
 	      unsigned char *prev_p = p;
 	      do
 		p--;
@@ -2075,6 +2169,17 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 		  p = GPT_ADDR;
 		  stop = endp;
 		}
+	      if (ASCII_CHAR_P (p[-1]))
+		{
+		  run = skip_ascii_run_backward (p, stop, asciimap, fastmap,
+						 iso_classes, negate);
+		  pos -= p - run, pos_byte -= p - run;
+		  p = run;
+		  maybe_quit ();
+		  if (p > stop && ASCII_CHAR_P (p[-1]))
+		    break;
+		  continue;
+		}
 
 	      if (! NILP (iso_classes) && in_classes (p[-1], iso_classes))
 		{
@@ -2100,11 +2205,31 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 }
 
 
+/* Return true if the syntax class of the ASCII character C is set in
+   FASTMAP.  ASCIIMAP caches the answer like in skip_chars_ascii_p; it
+   must be reset to all -1 whenever gl_state may switch to a different
+   syntax table.  */
+
+static bool
+skip_syntax_ascii_p (signed char *asciimap, const unsigned char *fastmap,
+		     int c)
+{
+  int in_set = asciimap[c];
+  if (in_set < 0)
+    {
+      in_set = fastmap[SYNTAX (c)];
+      asciimap[c] = in_set;
+    }
+  return in_set;
+}
+
 static Lisp_Object
 skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 {
   int c;
   unsigned char fastmap[0400];
+  /* Whether ASCII characters are skipped, see skip_syntax_ascii_p.  */
+  signed char asciimap[0200];
   bool negate = 0;
   ptrdiff_t i, i_byte;
   bool multibyte;
@@ -2175,6 +2300,7 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 	    p = BYTE_POS_ADDR (pos_byte);
 	    endp = XFIXNUM (lim) == GPT ? GPT_ADDR : CHAR_POS_ADDR (XFIXNUM (lim));
 	    stop = pos < GPT && GPT < XFIXNUM (lim) ? GPT_ADDR : endp;
+	    memset (asciimap, -1, sizeof asciimap);
 
 	    do
 	      {
@@ -2187,6 +2313,14 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 		    p = GAP_END_ADDR;
 		    stop = endp;
 		  }
+		if (ASCII_CHAR_P (*p))
+		  {
+		    if (! skip_syntax_ascii_p (asciimap, fastmap, *p))
+		      goto done;
+		    p++, pos++, pos_byte++;
+		    rarely_quit (pos);
+		    continue;
+		  }
 		if (multibyte)
 		  c = string_char_and_length (p, &nbytes);
 		else
@@ -2208,6 +2342,7 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 	p = BYTE_POS_ADDR (pos_byte);
 	endp = CHAR_POS_ADDR (XFIXNUM (lim));
 	stop = pos >= GPT && GPT > XFIXNUM (lim) ? GAP_END_ADDR : endp;
+	memset (asciimap, -1, sizeof asciimap);
 
 	if (multibyte)
 	  {
@@ -2220,8 +2355,19 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 		    p = GPT_ADDR;
 		    stop = endp;
 		  }
+		if (parse_sexp_lookup_properties && pos - 1 < gl_state.b_property)
+		  memset (asciimap, -1, sizeof asciimap);
 		UPDATE_SYNTAX_TABLE_BACKWARD (pos - 1);
 
+		if (ASCII_CHAR_P (p[-1]))
+		  {
+		    if (! skip_syntax_ascii_p (asciimap, fastmap, p[-1]))
+		      break;
+		    p--, pos--, pos_byte--;
+		    rarely_quit (pos);
+		    continue;
+		  }
+
 		unsigned char *prev_p = p;
 		do
 		  p--;
@@ -2245,8 +2391,12 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 		    p = GPT_ADDR;
 		    stop = endp;
 		  }
+		if (parse_sexp_lookup_properties && pos - 1 < gl_state.b_property)
+		  memset (asciimap, -1, sizeof asciimap);
 		UPDATE_SYNTAX_TABLE_BACKWARD (pos - 1);
-		if (! fastmap[SYNTAX (p[-1])])
+		if (ASCII_CHAR_P (p[-1])
+		    ? ! skip_syntax_ascii_p (asciimap, fastmap, p[-1])
+		    : ! fastmap[SYNTAX (p[-1])])
 		  break;
 		p--, pos--, pos_byte--;
 		rarely_quit (pos);
@@ -133,6 +133,20 @@ #define OUTPUT1_IF(tty, a) do { if (a) emacs_tputs ((tty), a, 1, cmputc); } whil
 static int last_mouse_x, last_mouse_y;
 #endif /* HAVE_GPM */
 
+/* Write NBYTES bytes at BUF to the output stream of TTY, and to its
+   termscript, if any.  */
+
+static void
+tty_write_bytes (struct tty_display_info *tty, const unsigned char *buf,
+		 ptrdiff_t nbytes)
+{
+  fwrite (buf, 1, nbytes, tty->output);
+  clearerr (tty->output);
+  if (tty->termscript)
+    fwrite (buf, 1, nbytes, tty->termscript);
+  tty->output_bytes += nbytes;
+}
+
 /* Ring the bell on a tty. */
 
 static void
@@ -169,11 +183,7 @@ tty_send_additional_strings (struct terminal *terminal, Lisp_Object sym)
     {
       Lisp_Object string = XCAR (extra_codes);
       if (STRINGP (string))
-        {
-	  fwrite (SDATA (string), 1, SBYTES (string), tty->output);
-          if (tty->termscript)
-	    fwrite (SDATA (string), 1, SBYTES (string), tty->termscript);
-        }
+	tty_write_bytes (tty, SDATA (string), SBYTES (string));
     }
 }
 
@@ -227,6 +237,41 @@ tty_reset_terminal_modes (struct terminal *terminal)
     }
 }
 
+#ifndef DOS_NT
+
+/* The estimated number of bytes of terminal output per glyph of a
+   frame, including escape sequences for cursor motion and faces.  */
+
+enum { TTY_OUTPUT_BYTES_PER_GLYPH = 16 };
+
+/* Give the output stream of TTY a stdio buffer large enough to hold
+   the output of a complete update of a frame of the terminal's
+   current size, so that, if tty-write-updates-at-once is non-nil, an
+   update is sent to the terminal with a single write by
+   tty_update_end.  setvbuf may only be called before the first
+   output to a stream, so this must be called right after the stream
+   is opened; a frame that is enlarged later just needs more than
+   one write for a complete update.  */
+
+static void
+tty_setup_output_buffer (struct tty_display_info *tty)
+{
+  ptrdiff_t size = max (BUFSIZ, ((ptrdiff_t) FrameRows (tty)
+				 * FrameCols (tty)
+				 * TTY_OUTPUT_BYTES_PER_GLYPH));
+  char *buffer = xmalloc (size);
+
+  if (setvbuf (tty->output, buffer, _IOFBF, size) == 0)
+    {
+      tty->output_buffer = buffer;
+      tty->output_buffer_size = size;
+    }
+  else
+    xfree (buffer);
+}
+
+#endif /* !DOS_NT */
+
 /* Flag the end of a display update on a termcap terminal. */
 
 static void
@@ -239,6 +284,7 @@ tty_update_end (struct frame *f)
   tty_turn_off_insert (tty);
   tty_background_highlight (tty);
   fflush (tty->output);
+  tty->output_flushes++;
 }
 
 /* The implementation of set_terminal_window for termcap frames. */
@@ -502,6 +548,7 @@ tty_clear_end_of_line (struct frame *f, int first_unused_hpos)
 	  if (tty->termscript)
 	    putc (' ', tty->termscript);
 	  putc (' ', tty->output);
+	  tty->output_bytes++;
 	}
       cmplus (tty, first_unused_hpos - curX (tty));
     }
@@ -775,10 +822,7 @@ tty_write_glyphs (struct frame *f, struct glyph *string, int len)
       if (coding->produced > 0)
 	{
 	  block_input ();
-	  fwrite (conversion_buffer, 1, coding->produced, tty->output);
-	  clearerr (tty->output);
-	  if (tty->termscript)
-	    fwrite (conversion_buffer, 1, coding->produced, tty->termscript);
+	  tty_write_bytes (tty, conversion_buffer, coding->produced);
 	  unblock_input ();
 	}
       string += n;
@@ -835,10 +879,7 @@ tty_write_glyphs_with_face (register struct frame *f, register struct glyph *str
   if (coding->produced > 0)
     {
       block_input ();
-      fwrite (conversion_buffer, 1, coding->produced, tty->output);
-      clearerr (tty->output);
-      if (tty->termscript)
-	fwrite (conversion_buffer, 1, coding->produced, tty->termscript);
+      tty_write_bytes (tty, conversion_buffer, coding->produced);
       unblock_input ();
     }
 
@@ -921,10 +962,7 @@ tty_insert_glyphs (struct frame *f, struct glyph *start, int len)
       if (coding->produced > 0)
 	{
 	  block_input ();
-	  fwrite (conversion_buffer, 1, coding->produced, tty->output);
-	  clearerr (tty->output);
-	  if (tty->termscript)
-	    fwrite (conversion_buffer, 1, coding->produced, tty->termscript);
+	  tty_write_bytes (tty, conversion_buffer, coding->produced);
 	  unblock_input ();
 	}
 
@@ -4276,6 +4314,8 @@ init_tty (const char *name, const char *terminal_type, bool must_succeed)
                  "Screen size %dx%d is too small",
                  FrameCols (tty), FrameRows (tty));
 
+  tty_setup_output_buffer (tty);
+
   TabWidth (tty) = tgetnum ("tw");
 
   if (!tty->TS_bell)
@@ -4486,6 +4526,8 @@ delete_tty (struct terminal *terminal)
   if (tty->termscript)
     fclose (tty->termscript);
 
+  xfree (tty->output_buffer);
+
   xfree (tty->old_tty);
   xfree (tty->Wcm);
   xfree (tty);
@@ -4530,6 +4572,16 @@ syms_of_term (void)
 trigger redisplay.  */);
   tty_menu_calls_mouse_position_function = 0;
 
+  DEFVAR_BOOL ("tty-write-updates-at-once", tty_write_updates_at_once,
+    doc: /* Non-nil means send each update of a text terminal frame at once.
+If nil, terminal output is flushed every 1000 bytes or so while a
+frame is being updated, because some telnet connections misbehave when
+they receive more than 1KB at once.  If non-nil, the output of a frame
+update is held back until the update is complete, and is then sent to
+the terminal with as few writes as possible, which is faster over
+slow links and avoids showing a partially updated frame.  */);
+  tty_write_updates_at_once = false;
+
   defsubr (&Stty_display_color_p);
   defsubr (&Stty_display_color_cells);
   defsubr (&Stty_no_underline);
@@ -56,6 +56,15 @@ #define EMACS_TERMCHAR_H
   FILE *termscript;             /* If nonzero, send all terminal output
                                    characters to this stream also.  */
 
+  char *output_buffer;          /* The stdio buffer of OUTPUT, if
+                                   tty_setup_output_buffer gave it one.  */
+  ptrdiff_t output_buffer_size; /* The size of OUTPUT_BUFFER.  */
+
+  intmax_t output_bytes;        /* Number of bytes written to OUTPUT so
+                                   far, for redisplay statistics.  */
+  intmax_t output_flushes;      /* Number of times OUTPUT was flushed
+                                   during display updates so far.  */
+
   struct emacs_tty *old_tty;    /* The initial tty mode bits */
 
   bool_bf term_initted : 1;	/* True if we have been through
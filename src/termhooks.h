@@ -229,6 +229,12 @@ #define EMACS_TERMHOOKS_H
 
   , CONFIG_CHANGED_EVENT
 
+#ifdef HAVE_WINDOW_SYSTEM
+  /* An image finished loading asynchronously.  This event is not
+     seen by Lisp; it only makes the command loop redisplay.  */
+  , IMAGE_LOADED_EVENT
+#endif
+
 #ifdef HAVE_NTGUI
   /* Generated when an APPCOMMAND event is received, in response to
      Multimedia or Internet buttons on some keyboards.
@@ -578,13 +578,19 @@ finalize_one_condvar (struct Lisp_CondVar *condvar)
   fd_set *efds;
   struct timespec *timeout;
   sigset_t *sigmask;
+};
+
+struct unlocked_call_args
+{
+  int (*func) (void *);
+  void *arg;
   int result;
 };
 
 static void
-really_call_select (void *arg)
+really_call_unlocked (void *arg)
 {
-  struct select_args *sa = arg;
+  struct unlocked_call_args *ua = arg;
   struct thread_state *self = current_thread;
   sigset_t oldset;
 
@@ -593,13 +599,10 @@ really_call_select (void *arg)
   release_global_lock ();
   restore_signal_mask (&oldset);
 
-  sa->result = (sa->func) (sa->max_fds, sa->rfds, sa->wfds, sa->efds,
-			   sa->timeout, sa->sigmask);
-
-  release_select_lock ();
+  ua->result = ua->func (ua->arg);
 
   block_interrupt_signal (&oldset);
-  /* If we were interrupted by C-g while inside sa->func above, the
+  /* If we were interrupted by C-g while inside ua->func above, the
      signal handler could have called maybe_reacquire_global_lock, in
      which case we are already holding the lock and shouldn't try
      taking it again, or else we will hang forever.  */
@@ -611,6 +614,32 @@ really_call_select (void *arg)
   restore_signal_mask (&oldset);
 }
 
+/* Call FUNC with argument ARG with the global lock released, so that
+   other threads can run while FUNC waits.  Return the value of
+   FUNC.  */
+
+int
+thread_call_unlocked (int (*func) (void *), void *arg)
+{
+  struct unlocked_call_args ua;
+
+  ua.func = func;
+  ua.arg = arg;
+  flush_stack_call_func (really_call_unlocked, &ua);
+  return ua.result;
+}
+
+static int
+call_select (void *arg)
+{
+  struct select_args *sa = arg;
+  int result = (sa->func) (sa->max_fds, sa->rfds, sa->wfds, sa->efds,
+			   sa->timeout, sa->sigmask);
+
+  release_select_lock ();
+  return result;
+}
+
 int
 thread_select (select_func *func, int max_fds, fd_set *rfds,
 	       fd_set *wfds, fd_set *efds, struct timespec *timeout,
@@ -625,8 +654,7 @@ thread_select (select_func *func, int max_fds, fd_set *rfds,
   sa.efds = efds;
   sa.timeout = timeout;
   sa.sigmask = sigmask;
-  flush_stack_call_func (really_call_select, &sa);
-  return sa.result;
+  return thread_call_unlocked (call_select, &sa);
 }
 
 
@@ -1096,6 +1124,14 @@ main_thread_p (const void *ptr)
   return ptr == &main_thread.s;
 }
 
+/* Return true if no thread other than the current one exists.  */
+
+bool
+single_thread_p (void)
+{
+  return !all_threads->next_thread;
+}
+
 bool
 in_current_thread (void)
 {
@@ -293,6 +293,7 @@ XCONDVAR (Lisp_Object a)
 extern void syms_of_threads (void);
 extern bool main_thread_p (const void *);
 extern bool in_current_thread (void);
+extern bool single_thread_p (void);
 
 typedef int select_func (int, fd_set *, fd_set *, fd_set *,
 			 const struct timespec *, const sigset_t *);
@@ -300,6 +301,7 @@ XCONDVAR (Lisp_Object a)
 int thread_select  (select_func *func, int max_fds, fd_set *rfds,
 		    fd_set *wfds, fd_set *efds, struct timespec *timeout,
 		    sigset_t *sigmask);
+int thread_call_unlocked (int (*func) (void *), void *arg);
 
 bool thread_check_current_buffer (struct buffer *);
 
@@ -10480,7 +10480,6 @@ syms_of_w32fns (void)
   DEFSYM (Qserif, "serif");
   DEFSYM (Qzlib, "zlib");
   DEFSYM (Qlcms2, "lcms2");
-  DEFSYM (Qjson, "json");
 
   Fput (Qundefined_color, Qerror_conditions,
 	pure_list (Qundefined_color, Qerror));
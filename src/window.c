@@ -2435,6 +2435,9 @@ replace_window (Lisp_Object old, Lisp_Object new, bool setflag)
       wset_normal_lines (n, o->normal_lines);
       wset_normal_lines (o, make_float (1.0));
       n->desired_matrix = n->current_matrix = 0;
+      n->glyph_row_cache = NULL;
+      n->mode_line_cache = NULL;
+      wset_mode_line_cache_data (n, Qnil);
       n->vscroll = 0;
       memset (&n->cursor, 0, sizeof (n->cursor));
       memset (&n->phys_cursor, 0, sizeof (n->phys_cursor));
@@ -4163,6 +4166,10 @@ DEFUN ("force-window-update", Fforce_window_update, Sforce_window_update,
 displaying that buffer.  */)
   (Lisp_Object object)
 {
+  /* Whatever prompted this call may affect how unchanged text is
+     displayed, so glyph rows cached for it can't be reused.  */
+  invalidate_glyph_row_caches ();
+
   if (NILP (object))
     {
       windows_or_buffers_changed = 29;
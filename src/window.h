@@ -209,6 +209,9 @@ #define WINDOW_H_INCLUDED
     /* An alist with parameters.  */
     Lisp_Object window_parameters;
 
+    /* Lisp data of the lines in mode_line_cache, or nil.  */
+    Lisp_Object mode_line_cache_data;
+
     /* The help echo text for this window.  Qnil if there's none.  */
     Lisp_Object mode_line_help_echo;
 
@@ -219,6 +222,17 @@ #define WINDOW_H_INCLUDED
     struct glyph_matrix *current_matrix;
     struct glyph_matrix *desired_matrix;
 
+    /* Glyph rows recently produced for this window, or NULL.  See
+       glyph_row_cache_lookup.  */
+    struct glyph_row_cache *glyph_row_cache;
+
+    /* Mode line, tab line and header line last displayed in this
+       window, or NULL.  See display_mode_line.  */
+    struct mode_line_cache *mode_line_cache;
+
+    /* Statistics about the redisplay of this window.  */
+    struct redisplay_counters redisplay_counters;
+
     /* The two Lisp_Object fields below are marked in a special way,
        which is why they're placed after `current_matrix'.  */
     /* A list of <buffer, window-start, window-point> triples listing
@@ -499,6 +513,12 @@ wset_redisplay_end_trigger (struct window *w, Lisp_Object val)
   w->redisplay_end_trigger = val;
 }
 
+INLINE void
+wset_mode_line_cache_data (struct window *w, Lisp_Object val)
+{
+  w->mode_line_cache_data = val;
+}
+
 INLINE void
 wset_mode_line_help_echo (struct window *w, Lisp_Object val)
 {
@@ -890,6 +890,7 @@ DEFUN ("set-buffer-redisplay", Fset_buffer_redisplay,
 {
   bset_update_mode_line (current_buffer);
   current_buffer->prevent_redisplay_optimizations_p = true;
+  invalidate_glyph_row_caches ();
   return Qnil;
 }
 
@@ -3168,6 +3169,12 @@ init_iterator (struct it *it, struct window *w,
 	}
     }
 
+  /* Outside of redisplay, Lisp could have modified
+     `face-remapping-alist' or window parameters since faces were last
+     merged.  */
+  if (!redisplaying_p)
+    forget_merged_faces ();
+
   /* Perhaps remap BASE_FACE_ID to a user-specified alternative.  */
   if (! NILP (Vface_remapping_alist))
     remapped_base_face_id
@@ -15186,6 +15193,302 @@ hscroll_windows (Lisp_Object window)
 
 
 
+/***********************************************************************
+			 Redisplay Statistics
+ ***********************************************************************/
+
+/* Statistics accumulated since Emacs started or since they were last
+   cleared by `clear-redisplay-statistics', and statistics of the
+   current call of redisplay_internal.  */
+
+static struct redisplay_counters redisplay_totals, redisplay_cycle;
+
+/* The most recent values of redisplay_cycle, oldest first, in a ring
+   buffer of redisplay_log_size elements starting at index
+   redisplay_log_start.  */
+
+static struct redisplay_log_entry
+{
+  struct timespec start;
+  struct redisplay_counters counters;
+} *redisplay_log;
+static ptrdiff_t redisplay_log_size, redisplay_log_start, redisplay_log_used;
+
+/* Start time of the current call of redisplay_internal.  */
+
+static struct timespec redisplay_cycle_start;
+
+/* Record that redisplay method METHOD was used for window W.  */
+
+static void
+count_redisplay_method (struct window *w, enum redisplay_method method)
+{
+  w->redisplay_counters.methods[method]++;
+  redisplay_cycle.methods[method]++;
+}
+
+/* Add T to the time spent updating frames in the current cycle.
+   Called from update_frame.  */
+
+void
+count_redisplay_update_time (struct timespec t)
+{
+  if (redisplaying_p)
+    redisplay_cycle.update_time
+      = timespec_add (redisplay_cycle.update_time, t);
+}
+
+/* Add NBYTES to the number of bytes sent to text terminals in the
+   current cycle, and NFLUSHES to the number of times their output
+   was flushed.  Called from update_frame.  */
+
+void
+count_redisplay_output (intmax_t nbytes, intmax_t nflushes)
+{
+  if (redisplaying_p)
+    {
+      redisplay_cycle.output_bytes += nbytes;
+      redisplay_cycle.output_flushes += nflushes;
+    }
+}
+
+/* Record that the face of text in window W was computed from its
+   `face' property alone; CACHED means the face merge cache was used.
+   Called from face_at_buffer_position.  */
+
+void
+count_face_merge (struct window *w, bool cached)
+{
+  if (redisplaying_p)
+    {
+      w->redisplay_counters.face_merges++;
+      redisplay_cycle.face_merges++;
+      if (cached)
+	{
+	  w->redisplay_counters.cached_face_merges++;
+	  redisplay_cycle.cached_face_merges++;
+	}
+    }
+}
+
+static void
+start_redisplay_cycle (void)
+{
+  memset (&redisplay_cycle, 0, sizeof redisplay_cycle);
+  redisplay_cycle.count = 1;
+  redisplay_cycle_start = current_timespec ();
+}
+
+/* Add the statistics of the current cycle to the totals and to the
+   log, if the log is enabled by `redisplay-statistics-log-size'.  */
+
+static void
+finish_redisplay_cycle (void)
+{
+  struct redisplay_counters *c = &redisplay_cycle;
+  ptrdiff_t size = clip_to_bounds (0, redisplay_statistics_log_size,
+				   min (PTRDIFF_MAX, SIZE_MAX)
+				   / sizeof *redisplay_log);
+
+  c->time = timespec_sub (current_timespec (), redisplay_cycle_start);
+
+  redisplay_totals.count++;
+  redisplay_totals.windows += c->windows;
+  for (int i = 0; i < REDISPLAY_NMETHODS; i++)
+    redisplay_totals.methods[i] += c->methods[i];
+  redisplay_totals.rows += c->rows;
+  redisplay_totals.cached_rows += c->cached_rows;
+  redisplay_totals.mode_lines += c->mode_lines;
+  redisplay_totals.cached_mode_lines += c->cached_mode_lines;
+  redisplay_totals.face_merges += c->face_merges;
+  redisplay_totals.cached_face_merges += c->cached_face_merges;
+  redisplay_totals.time = timespec_add (redisplay_totals.time, c->time);
+  redisplay_totals.update_time = timespec_add (redisplay_totals.update_time,
+					       c->update_time);
+  redisplay_totals.output_bytes += c->output_bytes;
+  redisplay_totals.output_flushes += c->output_flushes;
+
+  if (size != redisplay_log_size)
+    {
+      /* The size of the log changed; start afresh.  */
+      redisplay_log = xnrealloc (redisplay_log, size, sizeof *redisplay_log);
+      redisplay_log_size = size;
+      redisplay_log_start = redisplay_log_used = 0;
+    }
+  if (size > 0)
+    {
+      struct redisplay_log_entry *e
+	= &redisplay_log[(redisplay_log_start + redisplay_log_used) % size];
+      e->start = redisplay_cycle_start;
+      e->counters = *c;
+      if (redisplay_log_used < size)
+	redisplay_log_used++;
+      else
+	redisplay_log_start = (redisplay_log_start + 1) % size;
+    }
+}
+
+/* Return a property list describing the statistics in C.  If
+   WINDOW_P, C is the statistics of a window.  */
+
+static Lisp_Object
+redisplay_counters_to_plist (const struct redisplay_counters *c,
+			     bool window_p)
+{
+  Lisp_Object plist
+    = list (QCcursor_movement,
+	    make_int (c->methods[REDISPLAY_CURSOR_MOVEMENT]),
+	    QCsingle_line, make_int (c->methods[REDISPLAY_SINGLE_LINE]),
+	    QCreuse_current_matrix,
+	    make_int (c->methods[REDISPLAY_REUSE_CURRENT_MATRIX]),
+	    QCtry_window_id, make_int (c->methods[REDISPLAY_TRY_WINDOW_ID]),
+	    QCtry_window, make_int (c->methods[REDISPLAY_TRY_WINDOW]),
+	    QCrows, make_int (c->rows),
+	    QCcached_rows, make_int (c->cached_rows),
+	    QCmode_lines, make_int (c->mode_lines),
+	    QCcached_mode_lines, make_int (c->cached_mode_lines),
+	    QCface_merges, make_int (c->face_merges),
+	    QCcached_face_merges, make_int (c->cached_face_merges),
+	    QCtime, make_float (timespectod (c->time)));
+
+  if (!window_p)
+    plist = nconc2 (list (QCcount, make_int (c->count),
+			  QCwindows, make_int (c->windows)),
+		    nconc2 (plist,
+			    list (QCupdate_time,
+				  make_float (timespectod (c->update_time)),
+				  QCoutput_bytes, make_int (c->output_bytes),
+				  QCoutput_flushes,
+				  make_int (c->output_flushes))));
+  else
+    plist = Fcons (QCcount, Fcons (make_int (c->count), plist));
+  return plist;
+}
+
+DEFUN ("redisplay-statistics", Fredisplay_statistics,
+       Sredisplay_statistics, 0, 1, 0,
+       doc: /* Return statistics about redisplay as a property list.
+If WINDOW is nil, return statistics about all the redisplay cycles
+since Emacs started or since `clear-redisplay-statistics' was last
+called.  Otherwise, WINDOW must be a live window, and the value
+describes the redisplay of that window since it was created or since
+its statistics were last cleared.
+
+The property list has the following properties:
+
+  :count       The number of redisplay cycles, or the number of
+               times WINDOW was redisplayed.
+  :windows     The number of windows redisplayed; only if WINDOW
+               is nil.
+  :cursor-movement, :single-line, :reuse-current-matrix,
+  :try-window-id
+               The number of times redisplay could produce the
+               display of a window by only moving the cursor, by
+               redisplaying only the line containing point, by
+               reusing glyph rows of the current display, or by
+               scrolling the current display and redisplaying the
+               changed parts, respectively.
+  :try-window  The number of times a window was redisplayed from
+               scratch.
+  :rows        The number of screen lines laid out.
+  :cached-rows The number of screen lines copied instead from the
+               cache enabled by `redisplay-glyph-row-cache-size'.
+  :mode-lines  The number of mode lines, header lines and tab lines
+               displayed.
+  :cached-mode-lines
+               How many of these were copied from the cache enabled
+               by `cache-mode-lines'.
+  :face-merges The number of times the face of text was computed
+               from its `face' property alone.
+  :cached-face-merges
+               How many of these were found in a cache of faces
+               computed earlier.
+  :time        The time in seconds spent in redisplay.
+  :update-time The part of :time spent updating frames, including
+               output to the terminal; only if WINDOW is nil.
+  :output-bytes
+               The number of bytes sent to text terminals when
+               updating frames; only if WINDOW is nil.
+  :output-flushes
+               The number of times output to text terminals was
+               flushed when updating frames; only if WINDOW is nil.
+               See `tty-write-updates-at-once'.
+
+See also `redisplay-statistics-log-size'.  */)
+  (Lisp_Object window)
+{
+  if (NILP (window))
+    return redisplay_counters_to_plist (&redisplay_totals, false);
+  return redisplay_counters_to_plist (&decode_live_window (window)
+				      ->redisplay_counters, true);
+}
+
+/* Clear the statistics of all leaf windows in the window tree rooted
+   at WINDOW.  */
+
+static void
+clear_window_redisplay_counters (Lisp_Object window)
+{
+  while (!NILP (window))
+    {
+      struct window *w = XWINDOW (window);
+
+      if (WINDOWP (w->contents))
+	clear_window_redisplay_counters (w->contents);
+      else
+	memset (&w->redisplay_counters, 0, sizeof w->redisplay_counters);
+
+      window = w->next;
+    }
+}
+
+DEFUN ("clear-redisplay-statistics", Fclear_redisplay_statistics,
+       Sclear_redisplay_statistics, 0, 0, 0,
+       doc: /* Clear all statistics returned by `redisplay-statistics'.
+This also clears the log returned by `redisplay-statistics-log'.  */)
+  (void)
+{
+  Lisp_Object tail, frame;
+
+  memset (&redisplay_totals, 0, sizeof redisplay_totals);
+  redisplay_log_start = redisplay_log_used = 0;
+  FOR_EACH_FRAME (tail, frame)
+    {
+      struct frame *f = XFRAME (frame);
+
+      clear_window_redisplay_counters (FRAME_ROOT_WINDOW (f));
+      if (WINDOWP (f->minibuffer_window))
+	clear_window_redisplay_counters (f->minibuffer_window);
+    }
+  return Qnil;
+}
+
+DEFUN ("redisplay-statistics-log", Fredisplay_statistics_log,
+       Sredisplay_statistics_log, 0, 0, 0,
+       doc: /* Return statistics about recent redisplay cycles.
+The value is a list with one element for each of the last
+`redisplay-statistics-log-size' redisplay cycles, oldest first.  Each
+element is a property list like the value of `redisplay-statistics',
+describing a single cycle, with an additional property :start whose
+value is the time at which the cycle started, as a Lisp timestamp.  */)
+  (void)
+{
+  Lisp_Object log = Qnil;
+
+  for (ptrdiff_t i = redisplay_log_used; 0 < i; i--)
+    {
+      struct redisplay_log_entry *e
+	= &redisplay_log[(redisplay_log_start + i - 1) % redisplay_log_size];
+      log = Fcons (Fcons (QCstart,
+			  Fcons (make_lisp_time (e->start),
+				 redisplay_counters_to_plist (&e->counters,
+							      false))),
+		   log);
+    }
+  return log;
+}
+
+
 /************************************************************************
 				Redisplay
  ************************************************************************/
@@ -15672,6 +15975,8 @@ redisplay_internal (void)
   /* Record this function, so it appears on the profiler's backtraces.  */
   record_in_backtrace (Qredisplay_internal_xC_functionx, 0, 0);
 
+  start_redisplay_cycle ();
+
   FOR_EACH_FRAME (tail, frame)
     XFRAME (frame)->already_hscrolled_p = false;
 
@@ -15681,6 +15986,7 @@ redisplay_internal (void)
 
   pending = false;
   forget_escape_and_glyphless_faces ();
+  forget_merged_faces ();
 
   inhibit_free_realized_faces = false;
 
@@ -15936,6 +16242,8 @@ #define AINC(a,i)							\
 		 current-line's vpos, and cannot DTRT in that case.  */
 	      && !hscrolling_current_line_p (w))
 	    {
+	      count_redisplay_method (w, REDISPLAY_SINGLE_LINE);
+
  	      /* If this is not the window's last line, we must adjust
  		 the charstarts of the lines below.  */
  	      if (it.current_y < it.last_visible_y)
@@ -16416,6 +16724,7 @@ #define AINC(a,i)							\
       clear_image_caches (Qnil);
       clear_image_cache_count = 0;
     }
+  limit_image_caches ();
 #endif /* HAVE_WINDOW_SYSTEM */
 
  end_of_redisplay:
@@ -16425,6 +16734,8 @@ #define AINC(a,i)							\
   if (interrupt_input && interrupts_deferred)
     request_sigio ();
 
+  finish_redisplay_cycle ();
+
   unbind_to (count, Qnil);
   RESUME_POLLING;
 }
@@ -16661,11 +16972,29 @@ redisplay_window_error (Lisp_Object ignore)
   return Qnil;
 }
 
+/* Redisplay WINDOW like redisplay_window, and count that in the
+   redisplay statistics.  */
+
+static void
+redisplay_window_counted (Lisp_Object window, bool just_this_one_p)
+{
+  struct window *w = XWINDOW (window);
+  struct timespec start = current_timespec ();
+
+  redisplay_window (window, just_this_one_p);
+
+  w->redisplay_counters.count++;
+  w->redisplay_counters.time
+    = timespec_add (w->redisplay_counters.time,
+		    timespec_sub (current_timespec (), start));
+  redisplay_cycle.windows++;
+}
+
 static Lisp_Object
 redisplay_window_0 (Lisp_Object window)
 {
   if (displayed_buffer->display_error_modiff < BUF_MODIFF (displayed_buffer))
-    redisplay_window (window, false);
+    redisplay_window_counted (window, false);
   return Qnil;
 }
 
@@ -16673,7 +17002,7 @@ redisplay_window_0 (Lisp_Object window)
 redisplay_window_1 (Lisp_Object window)
 {
   if (displayed_buffer->display_error_modiff < BUF_MODIFF (displayed_buffer))
-    redisplay_window (window, true);
+    redisplay_window_counted (window, true);
   return Qnil;
 }
 
@@ -18848,6 +19177,7 @@ redisplay_window (Lisp_Object window, bool just_this_one_p)
 	{
 	case CURSOR_MOVEMENT_SUCCESS:
 	  used_current_matrix_p = true;
+	  count_redisplay_method (w, REDISPLAY_CURSOR_MOVEMENT);
 	  goto done;
 
 	case CURSOR_MOVEMENT_MUST_SCROLL:
@@ -18881,7 +19211,10 @@ redisplay_window (Lisp_Object window, bool just_this_one_p)
       if (f->fonts_changed)
 	goto need_larger_matrices;
       if (tem > 0)
-	goto done;
+	{
+	  count_redisplay_method (w, REDISPLAY_TRY_WINDOW_ID);
+	  goto done;
+	}
 
       /* Otherwise try_window_id has returned -1 which means that we
 	 don't want the alternative below this comment to execute.  */
@@ -18960,6 +19293,8 @@ redisplay_window (Lisp_Object window, bool just_this_one_p)
 	       is set in that case, so we will detect it below.  */
 	    goto try_to_scroll;
 	}
+      else
+	count_redisplay_method (w, REDISPLAY_REUSE_CURRENT_MATRIX);
 
       if (f->fonts_changed)
 	goto need_larger_matrices;
@@ -19166,6 +19501,8 @@ redisplay_window (Lisp_Object window, bool just_this_one_p)
       || !(used_current_matrix_p
 	   = try_window_reusing_current_matrix (w)))
     use_desired_matrix = (try_window (window, startp, 0) == 1);
+  else
+    count_redisplay_method (w, REDISPLAY_REUSE_CURRENT_MATRIX);
 
   bidi_unshelve_cache (itdata, false);
 
@@ -19514,6 +19851,222 @@ redisplay_window (Lisp_Object window, bool just_this_one_p)
 }
 
 
+/***********************************************************************
+			   Reusing Cached Rows
+ ***********************************************************************/
+
+/* Fill in STAMP with what the rows of IT's window depend on besides
+   their start position, see struct glyph_row_cache_stamp.  Value is
+   false if the rows of that window should not be cached at all.  */
+
+static bool
+make_glyph_row_cache_stamp (struct it *it,
+			    struct glyph_row_cache_stamp *stamp)
+{
+  struct window *w = it->w;
+
+  /* Line numbers can depend on the position of point, and the
+     display of mini-windows and pseudo windows doesn't use
+     try_window in a way that would benefit.  */
+  if (MINI_WINDOW_P (w)
+      || w->pseudo_window_p
+      || !NILP (Vdisplay_line_numbers))
+    return false;
+
+  memset (stamp, 0, sizeof *stamp);
+  stamp->buffer = current_buffer;
+  stamp->begv = BEGV;
+  stamp->zv = ZV;
+  stamp->modiff = MODIFF;
+  stamp->overlay_modiff = OVERLAY_MODIFF;
+  stamp->face_generation = FRAME_FACE_CACHE (it->f)->generation;
+  stamp->first_visible_x = it->first_visible_x;
+  stamp->last_visible_x = it->last_visible_x;
+  stamp->left_margin_cols = WINDOW_LEFT_MARGIN_COLS (w);
+  stamp->right_margin_cols = WINDOW_RIGHT_MARGIN_COLS (w);
+  stamp->tab_width = it->tab_width;
+  stamp->extra_line_spacing = it->extra_line_spacing;
+  stamp->base_face_id = it->base_face_id;
+  stamp->selective = it->selective;
+  stamp->dp = it->dp;
+  stamp->line_wrap = it->line_wrap;
+  stamp->paragraph_embedding = it->paragraph_embedding;
+  stamp->ctl_arrow_p = it->ctl_arrow_p;
+  stamp->bidi_p = it->bidi_p;
+  stamp->selective_display_ellipsis_p = it->selective_display_ellipsis_p;
+  stamp->nobreak_char_display = (NILP (Vnobreak_char_display) ? 0
+				 : EQ (Vnobreak_char_display, Qt) ? 1 : 2);
+  stamp->show_trailing_whitespace_p = !NILP (Vshow_trailing_whitespace);
+  stamp->indicate_empty_lines_p
+    = !NILP (BVAR (current_buffer, indicate_empty_lines));
+  stamp->raw_bytes_as_hex_p = display_raw_bytes_as_hex;
+  stamp->wrap_by_category_p = word_wrap_by_category;
+  return true;
+}
+
+/* Return true if display_pos POS is a position in buffer text, as
+   opposed to a position in an overlay string, display string or
+   display vector.  */
+
+static bool
+display_pos_in_buffer_text_p (struct display_pos *pos)
+{
+  return (pos->overlay_string_index < 0
+	  && pos->dpvec_index < 0
+	  && CHARPOS (pos->string_pos) < 0);
+}
+
+/* Remember glyph row ROW, which display_line just produced from IT,
+   in the glyph row cache of IT's window, if the row can be reused
+   later by display_cached_rows.  */
+
+static void
+cache_glyph_row (struct it *it, struct glyph_row *row)
+{
+  struct window *w = it->w;
+
+  if (!MATRIX_ROW_DISPLAYS_TEXT_P (row)
+      /* The height of the first row depends on its position.  */
+      || row == MATRIX_FIRST_TEXT_ROW (w->desired_matrix)
+      /* Rows showing point can look different, e.g. due to
+	 hscrolling of the current line or trailing whitespace.  */
+      || (PT >= MATRIX_ROW_START_CHARPOS (row)
+	  && PT <= MATRIX_ROW_END_CHARPOS (row))
+      || row->reversed_p
+      || row->overlay_arrow_bitmap
+      || row->starts_in_middle_of_char_p
+      || row->ends_in_middle_of_char_p
+      || row->ends_in_newline_from_string_p
+      || row->ends_in_ellipsis_p
+      || !display_pos_in_buffer_text_p (&row->start)
+      || !display_pos_in_buffer_text_p (&row->end)
+      /* Rows whose characters are reordered can't be continued
+	 from their end position.  */
+      || (it->bidi_p
+	  && (CHARPOS (row->minpos) != CHARPOS (row->start.pos)
+	      || CHARPOS (row->maxpos) != CHARPOS (row->end.pos))))
+    return;
+
+  glyph_row_cache_store (w, row);
+}
+
+#ifdef HAVE_WINDOW_SYSTEM
+
+/* Prepare the images shown in glyph row ROW of frame F for display,
+   as produce_image_glyph would.  This loads images whose pixels were
+   evicted from the image cache since ROW was cached.  */
+
+static void
+prepare_row_images (struct frame *f, struct glyph_row *row)
+{
+  for (int area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
+    {
+      struct glyph *glyph = row->glyphs[area];
+      struct glyph *end = glyph + row->used[area];
+
+      for (; glyph < end; ++glyph)
+	if (glyph->type == IMAGE_GLYPH)
+	  {
+	    struct image *img = IMAGE_OPT_FROM_ID (f, glyph->u.img_id);
+	    if (img)
+	      prepare_image_for_display (f, img);
+	  }
+    }
+}
+
+#endif /* HAVE_WINDOW_SYSTEM */
+
+/* Copy rows from the glyph row cache of IT's window to the desired
+   matrix, starting with the row IT would display next, for as long as
+   suitable rows are found.  If any row is copied, set up IT to
+   continue after the last of them.  Value is the last row copied, or
+   NULL if no row was copied.  */
+
+static struct glyph_row *
+display_cached_rows (struct it *it)
+{
+  struct window *w = it->w;
+  struct glyph_matrix *matrix = w->desired_matrix;
+  struct glyph_row *last = NULL, *prev_last = NULL, *cached;
+  struct display_pos pos = it->start;
+  int continuation_lines_width = it->continuation_lines_width;
+  intmax_t ncopied = 0;
+
+  eassert (it->hpos == 0 && it->current_x == 0);
+  if (it->method != GET_FROM_BUFFER
+      || it->sp > 0
+      || !display_pos_in_buffer_text_p (&it->current))
+    return NULL;
+
+  while (it->current_y < it->last_visible_y
+	 && it->glyph_row > MATRIX_FIRST_TEXT_ROW (matrix)
+	 && it->glyph_row < MATRIX_BOTTOM_TEXT_ROW (matrix, w)
+	 && (cached = glyph_row_cache_lookup (w, &pos,
+					      continuation_lines_width))
+	 && !(PT >= MATRIX_ROW_START_CHARPOS (cached)
+	      && PT <= MATRIX_ROW_END_CHARPOS (cached))
+	 && NILP (overlay_arrow_at_row (it, cached)))
+    {
+      struct glyph_row *row = it->glyph_row;
+
+      prepare_desired_row (w, row, false);
+      if (!copy_cached_glyph_row (row, cached))
+	break;
+#ifdef HAVE_WINDOW_SYSTEM
+      if (FRAME_WINDOW_P (it->f))
+	prepare_row_images (it->f, row);
+#endif
+
+      row->y = it->current_y;
+      if (FRAME_WINDOW_P (it->f))
+	{
+	  int max_y = WINDOW_BOX_HEIGHT_NO_MODE_LINE (w);
+
+	  row->visible_height = row->height;
+	  if (row->y + row->height > max_y)
+	    row->visible_height -= row->y + row->height - max_y;
+	}
+
+      it->current_y += row->height;
+      ++it->vpos;
+      ++it->glyph_row;
+      ++ncopied;
+      prev_last = last;
+      last = row;
+      pos = row->end;
+      continuation_lines_width
+	= (row->continued_p
+	   ? row->continuation_lines_width + row->pixel_width : 0);
+    }
+
+  if (last)
+    {
+      int vpos = it->vpos, y = it->current_y;
+      struct glyph_row *glyph_row = it->glyph_row;
+
+      if (!init_to_row_end (it, w, last))
+	{
+	  /* Let display_line produce the last row again.  */
+	  init_to_row_start (it, w, last);
+	  y = last->y;
+	  --vpos;
+	  --glyph_row;
+	  --ncopied;
+	  last = prev_last;
+	}
+      it->vpos = vpos;
+      it->current_y = y;
+      it->glyph_row = glyph_row;
+      if (glyph_row < MATRIX_BOTTOM_TEXT_ROW (matrix, w))
+	glyph_row->reversed_p = false;
+      w->redisplay_counters.cached_rows += ncopied;
+      redisplay_cycle.cached_rows += ncopied;
+    }
+
+  return last;
+}
+
+
 /* Build the complete desired matrix of WINDOW with a window start
    buffer position POS.
 
@@ -19533,6 +20086,8 @@ try_window (Lisp_Object window, struct text_pos pos, int flags)
   struct frame *f = XFRAME (w->frame);
   int cursor_vpos = w->cursor.vpos;
 
+  count_redisplay_method (w, REDISPLAY_TRY_WINDOW);
+
   /* Make POS the new window start.  */
   set_marker_both (w->start, Qnil, CHARPOS (pos), BYTEPOS (pos));
 
@@ -19544,11 +20099,30 @@ try_window (Lisp_Object window, struct text_pos pos, int flags)
   start_display (&it, w, pos);
   it.glyph_row->reversed_p = false;
 
+  /* See if rows displayed earlier can be reused.  */
+  struct glyph_row_cache_stamp stamp;
+  bool use_row_cache = (make_glyph_row_cache_stamp (&it, &stamp)
+			&& glyph_row_cache_validate (w, &stamp));
+
   /* Display all lines of W.  */
   while (it.current_y < it.last_visible_y)
     {
+      if (use_row_cache)
+	{
+	  struct glyph_row *row = display_cached_rows (&it);
+	  if (row)
+	    {
+	      last_text_row = row;
+	      if (it.current_y >= it.last_visible_y)
+		break;
+	    }
+	}
       if (display_line (&it, cursor_vpos))
-	last_text_row = it.glyph_row - 1;
+	{
+	  last_text_row = it.glyph_row - 1;
+	  if (use_row_cache)
+	    cache_glyph_row (&it, last_text_row);
+	}
       if (f->fonts_changed && !(flags & TRY_WINDOW_IGNORE_FONTS_CHANGE))
 	return 0;
     }
@@ -23505,6 +24079,9 @@ display_line (struct it *it, int cursor_vpos)
       return false;
     }
 
+  it->w->redisplay_counters.rows++;
+  redisplay_cycle.rows++;
+
   /* Clear the result glyph row and enable it.  */
   prepare_desired_row (it->w, row, false);
 
@@ -25497,6 +26074,395 @@ redisplay_mode_lines (Lisp_Object window, bool force)
 }
 
 
+/* Caching mode lines.
+
+   When `cache-mode-lines' is non-nil, display_mode_line saves a copy
+   of each mode line, tab line and header line it displays, and copies
+   it back instead of formatting the line again if nothing the line
+   was produced from has changed since.  That is
+
+   . the format, the window's buffer and its modified state, the
+     faces of the frame, and the width of the window, which are
+     compared directly;
+
+   . the values of symbols referenced by the format, which are
+     watched by watch_mode_line_symbol while `cache-mode-lines' is
+     non-nil; setting a buffer-local binding invalidates only the
+     lines of that buffer;
+
+   . the `%'-constructs in the format, which are decoded again and
+     compared with what they produced before; this is cheap, and has
+     the side effects of decode_mode_spec that redisplay relies on;
+
+   . the values of `:eval' forms, which can't be tracked, so lines
+     with such forms are reused only for `mode-line-cache-eval-ttl'
+     seconds.  */
+
+enum { MODE_LINE_CACHE_LINES = 3 };
+
+struct mode_line_cache_entry
+{
+  /* The cached line.  Its glyph pointers point into GLYPHS.  */
+  struct glyph_row row;
+
+  /* Glyph memory of ROW, and its allocated size in glyphs.  */
+  struct glyph *glyphs;
+  ptrdiff_t nglyphs;
+
+  /* What ROW was produced from, besides the data in the window's
+     mode_line_cache_data.  */
+  struct buffer *buffer;
+  EMACS_INT buffer_tick;
+  int base_face_id;
+  unsigned face_generation;
+  int pixel_width;
+  unsigned generation;
+
+  /* If EVAL_P, the time after which ROW must not be reused.  */
+  struct timespec expiry;
+
+  bool_bf modified_p : 1;
+  bool_bf eval_p : 1;
+  bool_bf valid_p : 1;
+};
+
+struct mode_line_cache
+{
+  struct mode_line_cache_entry entries[MODE_LINE_CACHE_LINES];
+};
+
+/* The Lisp data of a cache entry are stored in a vector with these
+   slots, in the window's mode_line_cache_data vector.  The FORMAT
+   slot holds the mode line format.  SPECS is a list of [C FIELD TEXT
+   STRING] vectors describing the `%'-constructs encountered, see
+   mode_line_specs_unchanged_p.  OBJECTS lists the strings referenced
+   by the glyphs of the line, to protect them from GC.  */
+
+enum
+  {
+    MODE_LINE_CACHE_FORMAT,
+    MODE_LINE_CACHE_SPECS,
+    MODE_LINE_CACHE_OBJECTS,
+    MODE_LINE_CACHE_SLOTS
+  };
+
+/* Incremented to invalidate all mode line caches.  */
+
+static unsigned mode_line_cache_generation;
+
+/* A weak hash table mapping buffers to counters incremented to
+   invalidate the cached lines of windows showing the buffer, or nil
+   if there are none yet.  */
+
+static Lisp_Object mode_line_cache_buffer_ticks;
+
+/* The symbols watched by watch_mode_line_symbol.  */
+
+static Lisp_Object mode_line_cache_watched;
+
+/* True while display_mode_line records what the line it displays is
+   produced from.  The symbols and `%'-constructs display_mode_element
+   encounters are then collected in mode_line_cache_symbols and
+   mode_line_cache_specs, and mode_line_cache_eval_p is set if it
+   evaluates a form.  */
+
+static bool mode_line_cache_recording;
+static Lisp_Object mode_line_cache_symbols, mode_line_cache_specs;
+static bool mode_line_cache_eval_p;
+
+/* Free the mode line cache of window W, if any.  */
+
+void
+free_mode_line_cache (struct window *w)
+{
+  struct mode_line_cache *c = w->mode_line_cache;
+
+  if (c)
+    {
+      for (int i = 0; i < MODE_LINE_CACHE_LINES; i++)
+	xfree (c->entries[i].glyphs);
+      xfree (c);
+      w->mode_line_cache = NULL;
+    }
+  wset_mode_line_cache_data (w, Qnil);
+}
+
+/* Make all mode line caches invalid.  */
+
+void
+invalidate_mode_line_caches (void)
+{
+  mode_line_cache_generation++;
+}
+
+/* Return the counter incremented to invalidate the cached lines of
+   the windows showing buffer B.  */
+
+static EMACS_INT
+mode_line_cache_buffer_tick (struct buffer *b)
+{
+  Lisp_Object buffer;
+
+  if (NILP (mode_line_cache_buffer_ticks))
+    return 0;
+  XSETBUFFER (buffer, b);
+  return XFIXNUM (Fgethash (buffer, mode_line_cache_buffer_ticks,
+			    make_fixnum (0)));
+}
+
+/* Variable watcher for the symbols referenced by cached mode lines.
+   Setting the binding of a symbol in buffer WHERE changes only what
+   the mode lines of that buffer show.  */
+
+static Lisp_Object
+watch_mode_line_symbol (Lisp_Object symbol, Lisp_Object newval,
+			Lisp_Object operation, Lisp_Object where)
+{
+  if (BUFFERP (where))
+    {
+      EMACS_INT tick = mode_line_cache_buffer_tick (XBUFFER (where));
+      if (NILP (mode_line_cache_buffer_ticks))
+	mode_line_cache_buffer_ticks
+	  = CALLN (Fmake_hash_table, QCweakness, Qkey);
+      Fputhash (where, make_fixnum ((tick + 1) & MOST_POSITIVE_FIXNUM),
+		mode_line_cache_buffer_ticks);
+    }
+  else
+    invalidate_mode_line_caches ();
+  return Qnil;
+}
+
+static union Aligned_Lisp_Subr Swatch_mode_line_symbol =
+  {{{ PSEUDOVECTOR_FLAG | (PVEC_SUBR << PSEUDOVECTOR_AREA_BITS) },
+    { .a4 = watch_mode_line_symbol },
+    4, 4, "watch_mode_line_symbol", {0}, 0}};
+
+/* Make sure that setting the symbols in the list SYMBOLS invalidates
+   the mode line caches.  */
+
+static void
+watch_mode_line_symbols (Lisp_Object symbols)
+{
+  Lisp_Object watcher;
+
+  XSETSUBR (watcher, &Swatch_mode_line_symbol.s);
+  for (; CONSP (symbols); symbols = XCDR (symbols))
+    {
+      Lisp_Object symbol = Findirect_variable (XCAR (symbols));
+
+      if (SYMBOLP (symbol)
+	  && XSYMBOL (symbol)->u.s.trapped_write != SYMBOL_NOWRITE
+	  && NILP (Fmemq (symbol, mode_line_cache_watched)))
+	{
+	  Fadd_variable_watcher (symbol, watcher);
+	  mode_line_cache_watched = Fcons (symbol, mode_line_cache_watched);
+	}
+    }
+}
+
+/* Variable watcher for `cache-mode-lines'.  When the cache is turned
+   off, stop watching the symbols referenced by mode lines, so that
+   setting them is fast again, and forget the cached lines, since
+   they are no longer kept up to date.  */
+
+static Lisp_Object
+watch_cache_mode_lines (Lisp_Object symbol, Lisp_Object newval,
+			Lisp_Object operation, Lisp_Object where)
+{
+  if (NILP (newval))
+    {
+      Lisp_Object watcher;
+
+      XSETSUBR (watcher, &Swatch_mode_line_symbol.s);
+      for (; CONSP (mode_line_cache_watched);
+	   mode_line_cache_watched = XCDR (mode_line_cache_watched))
+	Fremove_variable_watcher (XCAR (mode_line_cache_watched), watcher);
+      invalidate_mode_line_caches ();
+    }
+  return Qnil;
+}
+
+/* Return true if display_mode_element should record what it
+   encounters for the mode line cache.  */
+
+static bool
+recording_mode_line_p (void)
+{
+  return mode_line_cache_recording && mode_line_target == MODE_LINE_DISPLAY;
+}
+
+/* Record that the mode line being displayed references SYMBOL.  */
+
+static void
+record_mode_line_symbol (Lisp_Object symbol)
+{
+  if (recording_mode_line_p ()
+      && NILP (Fmemq (symbol, mode_line_cache_symbols)))
+    mode_line_cache_symbols = Fcons (symbol, mode_line_cache_symbols);
+}
+
+/* Record that decode_mode_spec returned SPEC and STRING for the
+   `%'-construct C with field width FIELD.  */
+
+static void
+record_mode_line_spec (int c, int field, const char *spec,
+		       Lisp_Object string)
+{
+  if (recording_mode_line_p ())
+    mode_line_cache_specs
+      = Fcons (CALLN (Fvector, make_fixnum (c), make_fixnum (field),
+		      make_unibyte_string (spec, strlen (spec)), string),
+	       mode_line_cache_specs);
+}
+
+static void
+restore_mode_line_cache_recording (int recording)
+{
+  mode_line_cache_recording = recording;
+}
+
+/* Return the index in the mode line cache of the line displayed with
+   face FACE_ID.  */
+
+static int
+mode_line_cache_index (enum face_id face_id)
+{
+  return (face_id == TAB_LINE_FACE_ID ? 1
+	  : face_id == HEADER_LINE_FACE_ID ? 2
+	  : 0);
+}
+
+/* Return true if the `%'-constructs described by SPECS, see
+   record_mode_line_spec, still produce the same text in window W.  */
+
+static bool
+mode_line_specs_unchanged_p (struct window *w, Lisp_Object specs)
+{
+  for (; CONSP (specs); specs = XCDR (specs))
+    {
+      Lisp_Object spec = XCAR (specs), string, text = AREF (spec, 2);
+      const char *s = decode_mode_spec (w, XFIXNUM (AREF (spec, 0)),
+					XFIXNUM (AREF (spec, 1)), &string);
+
+      if (!EQ (string, AREF (spec, 3))
+	  || strlen (s) != SBYTES (text)
+	  || memcmp (s, SDATA (text), SBYTES (text)) != 0)
+	return false;
+    }
+  return true;
+}
+
+/* Copy the line IT is about to display with face FACE_ID from format
+   FORMAT from the mode line cache of IT's window, if the cached line
+   is still valid.  Value is true if the line was copied.  */
+
+static bool
+display_cached_mode_line (struct it *it, enum face_id face_id,
+			  Lisp_Object format)
+{
+  struct window *w = it->w;
+  struct mode_line_cache *c = w->mode_line_cache;
+  int i = mode_line_cache_index (face_id);
+  struct mode_line_cache_entry *e;
+  Lisp_Object data;
+
+  if (!c || !c->entries[i].valid_p)
+    return false;
+
+  e = &c->entries[i];
+  data = AREF (w->mode_line_cache_data, i);
+  if (e->generation != mode_line_cache_generation
+      || e->buffer != current_buffer
+      || e->buffer_tick != mode_line_cache_buffer_tick (current_buffer)
+      || e->modified_p != (BUF_MODIFF (current_buffer)
+			   > BUF_SAVE_MODIFF (current_buffer))
+      || e->base_face_id != it->base_face_id
+      || e->face_generation != FRAME_FACE_CACHE (it->f)->generation
+      || e->pixel_width != WINDOW_PIXEL_WIDTH (w)
+      || (e->eval_p && timespec_cmp (current_timespec (), e->expiry) > 0)
+      || !EQ (AREF (data, MODE_LINE_CACHE_FORMAT), format))
+    {
+      e->valid_p = false;
+      return false;
+    }
+
+  mode_line_target = MODE_LINE_DISPLAY;
+  if (!mode_line_specs_unchanged_p (w, AREF (data, MODE_LINE_CACHE_SPECS))
+      || !copy_cached_glyph_row (it->glyph_row, &e->row))
+    {
+      e->valid_p = false;
+      return false;
+    }
+  return true;
+}
+
+/* Save the line IT has just displayed with face FACE_ID from format
+   FORMAT in the mode line cache of IT's window, together with what was
+   recorded while displaying it.  Lines showing images, compositions
+   or xwidgets are not saved, because the data these glyphs refer to
+   could be freed while the line is in the cache.  */
+
+static void
+cache_mode_line (struct it *it, enum face_id face_id, Lisp_Object format)
+{
+  struct window *w = it->w;
+  struct glyph_row *row = it->glyph_row;
+  struct mode_line_cache_entry *e;
+  int i = mode_line_cache_index (face_id);
+  Lisp_Object objects = Qnil, data;
+  struct timespec expiry = {0};
+
+  if (mode_line_cache_eval_p)
+    {
+      if (!NUMBERP (Vmode_line_cache_eval_ttl))
+	return;
+      expiry = timespec_add (current_timespec (),
+			     dtotimespec (XFLOATINT
+					  (Vmode_line_cache_eval_ttl)));
+    }
+
+  for (int area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
+    {
+      struct glyph *glyph = row->glyphs[area];
+      struct glyph *end = glyph + row->used[area];
+
+      for (; glyph < end; ++glyph)
+	if (glyph->type != CHAR_GLYPH
+	    && glyph->type != STRETCH_GLYPH
+	    && glyph->type != GLYPHLESS_GLYPH)
+	  return;
+	else if (STRINGP (glyph->object)
+		 && !(CONSP (objects) && EQ (XCAR (objects), glyph->object)))
+	  objects = Fcons (glyph->object, objects);
+    }
+
+  watch_mode_line_symbols (mode_line_cache_symbols);
+
+  if (!w->mode_line_cache)
+    w->mode_line_cache = xzalloc (sizeof *w->mode_line_cache);
+  if (NILP (w->mode_line_cache_data))
+    wset_mode_line_cache_data (w, make_nil_vector (MODE_LINE_CACHE_LINES));
+
+  data = make_nil_vector (MODE_LINE_CACHE_SLOTS);
+  ASET (data, MODE_LINE_CACHE_FORMAT, format);
+  ASET (data, MODE_LINE_CACHE_SPECS, Fnreverse (mode_line_cache_specs));
+  ASET (data, MODE_LINE_CACHE_OBJECTS, objects);
+  ASET (w->mode_line_cache_data, i, data);
+
+  e = &w->mode_line_cache->entries[i];
+  save_glyph_row (&e->row, &e->glyphs, &e->nglyphs, row);
+  e->buffer = current_buffer;
+  e->buffer_tick = mode_line_cache_buffer_tick (current_buffer);
+  e->modified_p = BUF_MODIFF (current_buffer) > BUF_SAVE_MODIFF (current_buffer);
+  e->base_face_id = it->base_face_id;
+  e->face_generation = FRAME_FACE_CACHE (it->f)->generation;
+  e->pixel_width = WINDOW_PIXEL_WIDTH (w);
+  e->generation = mode_line_cache_generation;
+  e->eval_p = mode_line_cache_eval_p;
+  e->expiry = expiry;
+  e->valid_p = true;
+}
+
 /* Display the mode line, the header line, and the tab-line of window
    W.  Value is the sum number of mode lines, header lines, and tab
    lines actually displayed.  */
@@ -25629,8 +26595,34 @@ display_mode_line (struct window *w, enum face_id face_id, Lisp_Object format)
   push_kboard (FRAME_KBOARD (it.f));
   record_unwind_save_match_data ();
 
-  if (NILP (Vmode_line_compact)
-      || face_id == HEADER_LINE_FACE_ID || face_id == TAB_LINE_FACE_ID)
+  bool compact_p = (!NILP (Vmode_line_compact)
+		    && face_id != HEADER_LINE_FACE_ID
+		    && face_id != TAB_LINE_FACE_ID);
+
+  /* Lines displayed while displaying another line, e.g. by
+     pos-visible-in-window-p called from an :eval form, are not
+     cached.  Neither are compact mode lines, which are produced by
+     Fformat_mode_line without recording what they depend on.  */
+  bool cache_p = (cache_mode_lines && !mode_line_cache_recording
+		  && !compact_p);
+  w->redisplay_counters.mode_lines++;
+  redisplay_cycle.mode_lines++;
+  if (cache_p && display_cached_mode_line (&it, face_id, format))
+    {
+      w->redisplay_counters.cached_mode_lines++;
+      redisplay_cycle.cached_mode_lines++;
+      pop_kboard ();
+      unbind_to (count, Qnil);
+      return it.glyph_row->height;
+    }
+
+  record_unwind_protect_int (restore_mode_line_cache_recording,
+			     mode_line_cache_recording);
+  mode_line_cache_recording = cache_p;
+  mode_line_cache_symbols = mode_line_cache_specs = Qnil;
+  mode_line_cache_eval_p = false;
+
+  if (!compact_p)
     {
       mode_line_target = MODE_LINE_DISPLAY;
       display_mode_element (&it, 0, 0, 0, format, Qnil, false);
@@ -25703,6 +26695,10 @@ display_mode_line (struct window *w, enum face_id face_id, Lisp_Object format)
       last->right_box_line_p = true;
     }
 
+  if (cache_p)
+    cache_mode_line (&it, face_id, format);
+  mode_line_cache_symbols = mode_line_cache_specs = Qnil;
+
   return it.glyph_row->height;
 }
 
@@ -25974,9 +26970,12 @@ display_mode_element (struct it *it, int depth, int field_width, int precision,
 		prec = precision - n;
 
 		if (c == 'M')
-		  n += display_mode_element (it, depth, field, prec,
-					     Vglobal_mode_string, props,
-					     risky);
+		  {
+		    record_mode_line_symbol (Qglobal_mode_string);
+		    n += display_mode_element (it, depth, field, prec,
+					       Vglobal_mode_string, props,
+					       risky);
+		  }
 		else if (c != 0)
 		  {
 		    bool multibyte;
@@ -26019,6 +27018,7 @@ display_mode_element (struct it *it, int depth, int field_width, int precision,
 			{
 			  int nglyphs_before, nwritten;
 
+			  record_mode_line_spec (c, field, spec, string);
 			  nglyphs_before = it->glyph_row->used[TEXT_AREA];
 			  nwritten = display_string (spec, string, elt,
 						     charpos, 0, it,
@@ -26062,6 +27062,8 @@ display_mode_element (struct it *it, int depth, int field_width, int precision,
       {
 	register Lisp_Object tem;
 
+	record_mode_line_symbol (elt);
+
 	/* If the variable is not marked as risky to set
 	   then its contents are risky to use.  */
 	if (NILP (Fget (elt, Qrisky_local_variable)))
@@ -26111,6 +27113,8 @@ display_mode_element (struct it *it, int depth, int field_width, int precision,
 	    if (CONSP (XCDR (elt)))
 	      {
 		Lisp_Object spec;
+		if (recording_mode_line_p ())
+		  mode_line_cache_eval_p = true;
 		spec = safe__eval (true, XCAR (XCDR (elt)));
 		/* The :eval form could delete the frame stored in the
 		   iterator, which will cause a crash if we try to
@@ -26140,6 +27144,7 @@ display_mode_element (struct it *it, int depth, int field_width, int precision,
 	  }
 	else if (SYMBOLP (car))
 	  {
+	    record_mode_line_symbol (car);
 	    tem = Fboundp (car);
 	    elt = XCDR (elt);
 	    if (!CONSP (elt))
@@ -35020,6 +36025,9 @@ syms_of_xdisp (void)
   defsubr (&Stool_bar_height);
   defsubr (&Slookup_image_map);
 #endif
+  defsubr (&Sredisplay_statistics);
+  defsubr (&Sclear_redisplay_statistics);
+  defsubr (&Sredisplay_statistics_log);
   defsubr (&Sline_pixel_height);
   defsubr (&Sformat_mode_line);
   defsubr (&Sinvisible_p);
@@ -35056,6 +36064,25 @@ syms_of_xdisp (void)
   DEFSYM (QCeval, ":eval");
   DEFSYM (QCpropertize, ":propertize");
   DEFSYM (QCfile, ":file");
+  DEFSYM (QCcount, ":count");
+  DEFSYM (QCwindows, ":windows");
+  DEFSYM (QCcursor_movement, ":cursor-movement");
+  DEFSYM (QCsingle_line, ":single-line");
+  DEFSYM (QCreuse_current_matrix, ":reuse-current-matrix");
+  DEFSYM (QCtry_window_id, ":try-window-id");
+  DEFSYM (QCtry_window, ":try-window");
+  DEFSYM (QCrows, ":rows");
+  DEFSYM (QCmode_lines, ":mode-lines");
+  DEFSYM (QCcached_rows, ":cached-rows");
+  DEFSYM (QCcached_mode_lines, ":cached-mode-lines");
+  DEFSYM (QCface_merges, ":face-merges");
+  DEFSYM (QCcached_face_merges, ":cached-face-merges");
+  DEFSYM (QCtime, ":time");
+  DEFSYM (QCupdate_time, ":update-time");
+  DEFSYM (QCoutput_bytes, ":output-bytes");
+  DEFSYM (QCoutput_flushes, ":output-flushes");
+  DEFSYM (QCstart, ":start");
+
   DEFSYM (Qfontified, "fontified");
   DEFSYM (Qfontification_functions, "fontification-functions");
 
@@ -35164,6 +36191,10 @@ syms_of_xdisp (void)
   staticpro (&mode_line_string_face);
   mode_line_string_face_prop = Qnil;
   staticpro (&mode_line_string_face_prop);
+  mode_line_cache_symbols = Qnil;
+  staticpro (&mode_line_cache_symbols);
+  mode_line_cache_specs = Qnil;
+  staticpro (&mode_line_cache_specs);
   Vmode_line_unwind_vector = Qnil;
   staticpro (&Vmode_line_unwind_vector);
 
@@ -35204,6 +36235,45 @@ syms_of_xdisp (void)
   Vmode_line_compact = Qnil;
   DEFSYM (Qlong, "long");
 
+  DEFVAR_BOOL ("cache-mode-lines", cache_mode_lines,
+    doc: /* Non-nil means reuse mode lines that have not changed.
+When this is non-nil, redisplay remembers each mode line, header line
+and tab line it displays, and shows it again without formatting it,
+unless the format, the buffer's modified state, a `%'-construct in the
+format, or the value of a variable that the format refers to has
+changed since.  While this is non-nil, the variables are watched with
+`add-variable-watcher'; their watchers are removed when it is set to
+nil.  Destructive modifications of their values are not noticed, and
+neither are values that Emacs stores directly into the per-buffer
+variables it implements in C, without going through `set'; call
+`force-mode-line-update' after such changes.
+
+Since the results of `:eval' forms can't be tracked, lines whose
+format has them are only reused for `mode-line-cache-eval-ttl'
+seconds.  */);
+  cache_mode_lines = false;
+  DEFSYM (Qcache_mode_lines, "cache-mode-lines");
+  {
+    static union Aligned_Lisp_Subr Swatch_cache_mode_lines =
+      {{{ PSEUDOVECTOR_FLAG | (PVEC_SUBR << PSEUDOVECTOR_AREA_BITS) },
+	{ .a4 = watch_cache_mode_lines },
+	4, 4, "watch_cache_mode_lines", {0}, 0}};
+    Lisp_Object watcher;
+    XSETSUBR (watcher, &Swatch_cache_mode_lines.s);
+    Fadd_variable_watcher (Qcache_mode_lines, watcher);
+  }
+  mode_line_cache_buffer_ticks = Qnil;
+  staticpro (&mode_line_cache_buffer_ticks);
+  mode_line_cache_watched = Qnil;
+  staticpro (&mode_line_cache_watched);
+
+  DEFVAR_LISP ("mode-line-cache-eval-ttl", Vmode_line_cache_eval_ttl,
+    doc: /* Seconds for which mode lines with `:eval' forms are reused.
+This is used when `cache-mode-lines' is non-nil.  The value nil means
+never reuse mode lines, header lines and tab lines whose format
+evaluates forms.  */);
+  Vmode_line_cache_eval_ttl = make_float (1.0);
+
   DEFVAR_LISP ("nobreak-char-display", Vnobreak_char_display,
     doc: /* Control highlighting of non-ASCII space and hyphen chars.
 If the value is t, Emacs highlights non-ASCII chars which have the
@@ -35252,6 +36322,7 @@ syms_of_xdisp (void)
 This is used for internal purposes.  */);
   Vinhibit_redisplay = Qnil;
 
+  DEFSYM (Qglobal_mode_string, "global-mode-string");
   DEFVAR_LISP ("global-mode-string", Vglobal_mode_string,
     doc: /* String (or mode line construct) included (normally) in `mode-line-format'.  */);
   Vglobal_mode_string = Qnil;
@@ -35983,6 +37054,12 @@ syms_of_xdisp (void)
 has trouble keeping up with the incoming input rate.  */);
   redisplay_skip_fontification_on_input = false;
 
+  DEFVAR_INT ("redisplay-statistics-log-size", redisplay_statistics_log_size,
+    doc: /* Number of redisplay cycles recorded by `redisplay-statistics-log'.
+If zero, the default, no log is kept.  Changing the value discards
+the log.  */);
+  redisplay_statistics_log_size = 0;
+
   DEFVAR_BOOL ("redisplay-adhoc-scroll-in-resize-mini-windows",
                redisplay_adhoc_scroll_in_resize_mini_windows,
     doc: /* If nil always use normal scrolling in minibuffer windows.
@@ -2310,6 +2310,10 @@ merge_named_face (struct window *w,
     return false;
 }
 
+/* Set to true whenever a non-nil face filter is evaluated.  */
+
+static bool face_filter_evaluated;
+
 /* Determine whether the face filter FILTER evaluated in window W
    matches.  W can be NULL if the window context is unknown.
 
@@ -2333,6 +2337,8 @@ evaluate_face_filter (Lisp_Object filter, struct window *w,
     if (NILP (filter))
       return true;
 
+    face_filter_evaluated = true;
+
     if (face_filters_always_match)
       return true;
 
@@ -4515,6 +4521,8 @@ make_face_cache (struct frame *f)
   c->used = 0;
   c->faces_by_id = xmalloc (c->size * sizeof *c->faces_by_id);
   c->f = f;
+  c->generation = 0;
+  c->merge_cache = NULL;
   c->menu_face_changed_p = menu_face_changed_default;
   return c;
 }
@@ -4576,6 +4584,7 @@ free_realized_faces (struct face_cache *c)
       /* Forget the escape-glyph and glyphless-char faces.  */
       forget_escape_and_glyphless_faces ();
       c->used = 0;
+      c->generation++;
       size = FACE_CACHE_BUCKETS_SIZE * sizeof *c->buckets;
       memset (c->buckets, 0, size);
 
@@ -4623,6 +4632,7 @@ free_face_cache (struct face_cache *c)
       free_realized_faces (c);
       xfree (c->buckets);
       xfree (c->faces_by_id);
+      xfree (c->merge_cache);
       xfree (c);
     }
 }
@@ -4721,6 +4731,7 @@ uncache_face (struct face_cache *c, struct face *face)
   c->faces_by_id[face->id] = NULL;
   if (face->id == c->used)
     --c->used;
+  c->generation++;
 }
 
 
@@ -6297,6 +6308,100 @@ compute_char_face (struct frame *f, int ch, Lisp_Object prop)
   return face_id;
 }
 
+/* Number of entries in the face merge cache of a frame.  Must be a
+   power of 2.  */
+
+#define FACE_MERGE_CACHE_SIZE 256
+
+/* A cache mapping face property values to the IDs of the realized
+   faces face_at_buffer_position computed for them, so that recurring
+   values, such as the faces of a heavily fontified buffer, need not
+   be merged and looked up again.
+
+   Entries are looked up by the identity of the property value, so
+   the cache must be flushed when a garbage collection could have
+   freed those values.  It is also flushed when realized faces are
+   freed, which happens whenever face definitions change, so entries
+   survive from one redisplay cycle to the next as long as faces stay
+   the same.
+
+   Results that depend on `face-remapping-alist' or on face filters
+   are different: the former is usually modified in place, and the
+   latter depend on window parameters, neither of which can be
+   noticed here.  Entries for such results are only valid during the
+   redisplay cycle that made them.  */
+
+struct face_merge_cache
+{
+  /* The values of gcs_done and of the face cache's generation when
+     the entries were made.  */
+  intmax_t gcs;
+  unsigned generation;
+
+  struct face_merge_entry
+  {
+    /* The window and the face property value merged, the value of
+       `face-remapping-alist' in effect, the ID of the face the value
+       was merged into, and the attribute filter used.  W is NULL if
+       the entry is unused.  */
+    struct window *w;
+    Lisp_Object prop, remapping;
+    int base_face_id;
+    enum lface_attribute_index attr_filter;
+
+    /* If TRANSIENT_P, the entry is only valid while face_merge_cycle
+       is CYCLE.  */
+    bool transient_p;
+    unsigned cycle;
+
+    /* The resulting face ID.  */
+    int face_id;
+  } entries[FACE_MERGE_CACHE_SIZE];
+};
+
+/* Incremented at the start of every redisplay cycle, and whenever the
+   display code is used outside of redisplay.  */
+
+static unsigned face_merge_cycle;
+
+/* Invalidate the entries of face merge caches that are only valid
+   during one redisplay cycle.  Called by redisplay_internal before it
+   starts a new redisplay cycle, and by init_iterator outside of
+   redisplay.  */
+
+void
+forget_merged_faces (void)
+{
+  face_merge_cycle++;
+}
+
+/* Return the entry of frame F's face merge cache for merging PROP in
+   window W into face BASE_FACE_ID with filter ATTR_FILTER.  The entry
+   might currently be used for other arguments.  */
+
+static struct face_merge_entry *
+lookup_merged_face (struct window *w, struct frame *f, Lisp_Object prop,
+		    int base_face_id, enum lface_attribute_index attr_filter)
+{
+  struct face_cache *c = FRAME_FACE_CACHE (f);
+  struct face_merge_cache *mc = c->merge_cache;
+
+  if (!mc)
+    mc = c->merge_cache = xzalloc (sizeof *mc);
+
+  if (mc->gcs != gcs_done
+      || mc->generation != c->generation)
+    {
+      memset (mc->entries, 0, sizeof mc->entries);
+      mc->gcs = gcs_done;
+      mc->generation = c->generation;
+    }
+
+  EMACS_UINT hash = (XHASH (prop) >> GCTYPEBITS) ^ (uintptr_t) w >> 4;
+  hash ^= base_face_id * 31u;
+  return &mc->entries[hash & (FACE_MERGE_CACHE_SIZE - 1)];
+}
+
 /* Return the face ID associated with buffer position POS for
    displaying ASCII characters.  Return in *ENDPTR the position at
    which a different face is needed, as far as text properties and
@@ -6392,6 +6497,27 @@ face_at_buffer_position (struct window *w, ptrdiff_t pos,
       return default_face->id;
     }
 
+  /* If only a text property specifies the face, see whether we
+     merged the same value recently.  Face definitions changed since
+     realized faces were last freed are not reflected in the cache.  */
+  struct face_merge_entry *e = NULL;
+  if (noverlays == 0 && !face_change && !f->face_change)
+    {
+      e = lookup_merged_face (w, f, prop, default_face->id, attr_filter);
+      if (e->w == w
+	  && EQ (e->prop, prop)
+	  && EQ (e->remapping, Vface_remapping_alist)
+	  && e->base_face_id == default_face->id
+	  && e->attr_filter == attr_filter
+	  && (!e->transient_p || e->cycle == face_merge_cycle))
+	{
+	  count_face_merge (w, true);
+	  SAFE_FREE ();
+	  return e->face_id;
+	}
+      face_filter_evaluated = false;
+    }
+
   /* Begin with attributes from the default face.  */
   memcpy (attrs, default_face->lface, sizeof(attrs));
 
@@ -6399,6 +6525,28 @@ face_at_buffer_position (struct window *w, ptrdiff_t pos,
   if (!NILP (prop))
     merge_face_ref (w, f, prop, attrs, true, NULL, attr_filter);
 
+  if (e)
+    {
+      int face_id = lookup_face (f, attrs);
+
+      count_face_merge (w, false);
+      SAFE_FREE ();
+
+      /* Merging can call Lisp, e.g. to log invalid face names, so
+	 look the entry up again in case the cache was flushed.  */
+      e = lookup_merged_face (w, f, prop, default_face->id, attr_filter);
+      e->w = w;
+      e->prop = prop;
+      e->remapping = Vface_remapping_alist;
+      e->base_face_id = default_face->id;
+      e->attr_filter = attr_filter;
+      e->transient_p = (!NILP (Vface_remapping_alist)
+			|| face_filter_evaluated);
+      e->cycle = face_merge_cycle;
+      e->face_id = face_id;
+      return face_id;
+    }
+
   /* Now merge the overlay data.  */
   noverlays = sort_overlays (overlay_vec, noverlays, w);
   /* For mouse-face, we need only the single highest-priority face
@@ -26,6 +26,7 @@
 #include <libxml/tree.h>
 #include <libxml/parser.h>
 #include <libxml/HTMLparser.h>
+#include <libxml/SAX2.h>
 
 
 #ifdef WINDOWSNT
@@ -42,6 +43,22 @@ DEF_DLL_FN (xmlNodePtr, xmlDocGetRootElement, (xmlDocPtr));
 DEF_DLL_FN (void, xmlFreeDoc, (xmlDocPtr));
 DEF_DLL_FN (void, xmlCleanupParser, (void));
 DEF_DLL_FN (void, xmlCheckVersion, (int));
+DEF_DLL_FN (htmlParserCtxtPtr, htmlCreatePushParserCtxt,
+	    (htmlSAXHandlerPtr, void *, const char *, int, const char *,
+	     xmlCharEncoding));
+DEF_DLL_FN (int, htmlCtxtUseOptions, (htmlParserCtxtPtr, int));
+DEF_DLL_FN (void, htmlFreeParserCtxt, (htmlParserCtxtPtr));
+DEF_DLL_FN (int, htmlParseChunk, (htmlParserCtxtPtr, const char *, int, int));
+DEF_DLL_FN (xmlParserCtxtPtr, xmlCreatePushParserCtxt,
+	    (xmlSAXHandlerPtr, void *, const char *, int, const char *));
+DEF_DLL_FN (int, xmlCtxtResetPush,
+	    (xmlParserCtxtPtr, const char *, int, const char *, const char *));
+DEF_DLL_FN (int, xmlCtxtUseOptions, (xmlParserCtxtPtr, int));
+DEF_DLL_FN (void, xmlFreeParserCtxt, (xmlParserCtxtPtr));
+DEF_DLL_FN (int, xmlParseChunk, (xmlParserCtxtPtr, const char *, int, int));
+DEF_DLL_FN (void, xmlSAX2InitHtmlDefaultSAXHandler, (xmlSAXHandler *));
+DEF_DLL_FN (int, xmlSAXVersion, (xmlSAXHandler *, int));
+DEF_DLL_FN (void, xmlStopParser, (xmlParserCtxtPtr));
 
 static bool
 libxml2_loaded_p (void)
@@ -51,19 +68,43 @@ libxml2_loaded_p (void)
   return CONSP (found) && EQ (XCDR (found), Qt);
 }
 
+# undef htmlCreatePushParserCtxt
+# undef htmlCtxtUseOptions
+# undef htmlFreeParserCtxt
+# undef htmlParseChunk
 # undef htmlReadMemory
 # undef xmlCheckVersion
 # undef xmlCleanupParser
+# undef xmlCreatePushParserCtxt
+# undef xmlCtxtResetPush
+# undef xmlCtxtUseOptions
 # undef xmlDocGetRootElement
 # undef xmlFreeDoc
+# undef xmlFreeParserCtxt
+# undef xmlParseChunk
 # undef xmlReadMemory
-
+# undef xmlSAX2InitHtmlDefaultSAXHandler
+# undef xmlSAXVersion
+# undef xmlStopParser
+
+# define htmlCreatePushParserCtxt fn_htmlCreatePushParserCtxt
+# define htmlCtxtUseOptions fn_htmlCtxtUseOptions
+# define htmlFreeParserCtxt fn_htmlFreeParserCtxt
+# define htmlParseChunk fn_htmlParseChunk
 # define htmlReadMemory fn_htmlReadMemory
 # define xmlCheckVersion fn_xmlCheckVersion
 # define xmlCleanupParser fn_xmlCleanupParser
+# define xmlCreatePushParserCtxt fn_xmlCreatePushParserCtxt
+# define xmlCtxtResetPush fn_xmlCtxtResetPush
+# define xmlCtxtUseOptions fn_xmlCtxtUseOptions
 # define xmlDocGetRootElement fn_xmlDocGetRootElement
 # define xmlFreeDoc fn_xmlFreeDoc
+# define xmlFreeParserCtxt fn_xmlFreeParserCtxt
+# define xmlParseChunk fn_xmlParseChunk
 # define xmlReadMemory fn_xmlReadMemory
+# define xmlSAX2InitHtmlDefaultSAXHandler fn_xmlSAX2InitHtmlDefaultSAXHandler
+# define xmlSAXVersion fn_xmlSAXVersion
+# define xmlStopParser fn_xmlStopParser
 
 static bool
 load_dll_functions (HMODULE library)
@@ -74,6 +115,18 @@ load_dll_functions (HMODULE library)
   LOAD_DLL_FN (library, xmlFreeDoc);
   LOAD_DLL_FN (library, xmlCleanupParser);
   LOAD_DLL_FN (library, xmlCheckVersion);
+  LOAD_DLL_FN (library, htmlCreatePushParserCtxt);
+  LOAD_DLL_FN (library, htmlCtxtUseOptions);
+  LOAD_DLL_FN (library, htmlFreeParserCtxt);
+  LOAD_DLL_FN (library, htmlParseChunk);
+  LOAD_DLL_FN (library, xmlCreatePushParserCtxt);
+  LOAD_DLL_FN (library, xmlCtxtResetPush);
+  LOAD_DLL_FN (library, xmlCtxtUseOptions);
+  LOAD_DLL_FN (library, xmlFreeParserCtxt);
+  LOAD_DLL_FN (library, xmlParseChunk);
+  LOAD_DLL_FN (library, xmlSAX2InitHtmlDefaultSAXHandler);
+  LOAD_DLL_FN (library, xmlSAXVersion);
+  LOAD_DLL_FN (library, xmlStopParser);
   return true;
 }
 
@@ -260,6 +313,543 @@ parse_region (Lisp_Object start, Lisp_Object end, Lisp_Object base_url,
   return result;
 }
 
+/* Scanning a region for events.
+
+   Instead of building a document and then converting all of it into
+   Lisp, the region is fed in chunks to a libxml2 push parser, whose
+   SAX callbacks report each element, text and comment as an event as
+   soon as it is parsed.  The events are given to a Lisp function, or
+   recorded in a vector, so no tree is built either by libxml2 or in
+   Lisp.  */
+
+/* The number of bytes of the region given to the parser at once.  */
+enum { XML_SCAN_CHUNK_SIZE = 64 * 1024 };
+
+/* The number of events the event log has room for at first.  */
+enum { XML_SCAN_LOG_SIZE = 64 };
+
+enum xml_scan_event_type
+  {
+    XML_SCAN_START,
+    XML_SCAN_END,
+    XML_SCAN_TEXT,
+    XML_SCAN_COMMENT
+  };
+
+struct xml_scan
+{
+  xmlParserCtxtPtr ctxt;
+  bool htmlp;
+
+  /* The function to call with each event, or nil to record the events
+     in LOG instead: its slots hold the type, the data and the
+     attributes of each event in turn, and LOG_USED of them are in
+     use.  */
+  Lisp_Object handler;
+  Lisp_Object log;
+  ptrdiff_t log_used;
+
+  /* Text that has been parsed but not reported yet, since libxml2 can
+     give the text between two tags in several pieces, and whether it
+     is from a CDATA section, which is reported on its own.  */
+  char *text;
+  ptrdiff_t text_size;
+  ptrdiff_t text_used;
+  bool text_cdata;
+
+  /* The paths of the elements to report, as a vector of vectors of
+     symbols, or nil to report all of them.  For each path, MATCHED
+     says how many of its names the open elements match.  */
+  Lisp_Object paths;
+  ptrdiff_t *matched;
+
+  /* The number of open elements that are reported, and the depth of
+     the outermost of them that matches a whole path, or -1.  */
+  ptrdiff_t depth;
+  ptrdiff_t full_depth;
+
+  /* The number of open elements within an element the paths reject,
+     including it, or 0.  */
+  ptrdiff_t skip_depth;
+
+  /* The nonlocal exit of a callback, as (TYPE . VALUE) where TYPE is
+     an enum nonlocal_exit, or nil if there was none.  */
+  Lisp_Object exit;
+};
+
+/* An event to report, with the arguments of the SAX callback that
+   found it.  */
+
+struct xml_scan_event
+{
+  struct xml_scan *scan;
+  enum xml_scan_event_type type;
+  const xmlChar *name;
+
+  /* The attributes of a start event from the HTML parser, as
+     alternating names and values ending with NULL.  */
+  const xmlChar **atts;
+
+  /* The attributes of a start event from the XML parser, as
+     NB_ATTRIBUTES groups of local name, prefix, URI, value and end of
+     value.  */
+  const xmlChar **attributes;
+  int nb_attributes;
+
+  /* The text of a comment.  */
+  const xmlChar *text;
+};
+
+/* Return true if S reports the element named NAME, which has just
+   started, and account for it in the filter.  */
+
+static bool
+xml_scan_enter (struct xml_scan *s, const char *name)
+{
+  if (s->skip_depth)
+    {
+      s->skip_depth++;
+      return false;
+    }
+
+  if (! NILP (s->paths) && s->full_depth < 0)
+    {
+      bool accepted = false;
+      for (ptrdiff_t i = 0; i < ASIZE (s->paths); i++)
+	{
+	  Lisp_Object path = AREF (s->paths, i);
+	  if (s->matched[i] == s->depth && s->depth < ASIZE (path)
+	      && strcmp (name,
+			 SSDATA (SYMBOL_NAME (AREF (path, s->depth)))) == 0)
+	    {
+	      accepted = true;
+	      if (++s->matched[i] == ASIZE (path))
+		s->full_depth = s->depth;
+	    }
+	}
+      if (!accepted)
+	{
+	  s->skip_depth = 1;
+	  return false;
+	}
+    }
+
+  s->depth++;
+  return true;
+}
+
+/* Return true if S reports the end of the element that has just
+   ended, and account for it in the filter.  */
+
+static bool
+xml_scan_leave (struct xml_scan *s)
+{
+  if (s->skip_depth)
+    {
+      s->skip_depth--;
+      return false;
+    }
+
+  s->depth--;
+  if (s->full_depth == s->depth)
+    s->full_depth = -1;
+  if (! NILP (s->paths) && s->full_depth < 0)
+    for (ptrdiff_t i = 0; i < ASIZE (s->paths); i++)
+      if (s->matched[i] == s->depth + 1)
+	s->matched[i] = s->depth;
+  return true;
+}
+
+/* Return true if S reports text and comments where the parser is.  */
+
+static bool
+xml_scan_content_p (struct xml_scan *s)
+{
+  return !s->skip_depth && (NILP (s->paths) || 0 <= s->full_depth);
+}
+
+/* Report an event of TYPE with DATA and ATTRIBUTES to the handler of
+   S, or record it in the log of S.  */
+
+static void
+xml_scan_report (struct xml_scan *s, enum xml_scan_event_type type,
+		 Lisp_Object data, Lisp_Object attributes)
+{
+  Lisp_Object type_symbol = (type == XML_SCAN_START ? Qstart
+			     : type == XML_SCAN_END ? Qend
+			     : type == XML_SCAN_TEXT ? Qtext
+			     : Qcomment);
+
+  if (NILP (s->handler))
+    {
+      if (ASIZE (s->log) - s->log_used < 3)
+	s->log = larger_vector (s->log, 3, -1);
+      ASET (s->log, s->log_used++, type_symbol);
+      ASET (s->log, s->log_used++, data);
+      ASET (s->log, s->log_used++, attributes);
+    }
+  else
+    call3 (s->handler, type_symbol, data, attributes);
+}
+
+/* Report the text of S not reported yet, if any.  */
+
+static void
+xml_scan_report_text (struct xml_scan *s)
+{
+  if (s->text_used)
+    {
+      Lisp_Object text = make_string (s->text, s->text_used);
+      s->text_used = 0;
+      xml_scan_report (s, XML_SCAN_TEXT, text, Qnil);
+    }
+}
+
+/* Report the event that ARG, a pointer to a struct xml_scan_event,
+   describes, after any text before it.  Return nil.  */
+
+static Lisp_Object
+xml_scan_report_event (void *arg)
+{
+  struct xml_scan_event *e = arg;
+  struct xml_scan *s = e->scan;
+  Lisp_Object plist = Qnil;
+
+  xml_scan_report_text (s);
+  switch (e->type)
+    {
+    case XML_SCAN_START:
+      /* The attributes are given as make_dom gives them: without the
+	 empty ones, and with the value of an HTML attribute that has
+	 none being its name.  */
+      if (e->atts)
+	for (const xmlChar **a = e->atts; a[0]; a += 2)
+	  {
+	    const xmlChar *value = a[1] ? a[1] : a[0];
+	    if (value[0])
+	      plist = Fcons (Fcons (intern ((char *) a[0]),
+				    build_string ((char *) value)),
+			     plist);
+	  }
+      for (int i = 0; i < e->nb_attributes; i++)
+	{
+	  const xmlChar **a = e->attributes + 5 * i;
+	  if (a[3] < a[4])
+	    plist = Fcons (Fcons (intern ((char *) a[0]),
+				  make_string ((char *) a[3], a[4] - a[3])),
+			   plist);
+	}
+      xml_scan_report (s, XML_SCAN_START, intern ((char *) e->name),
+		       Fnreverse (plist));
+      break;
+
+    case XML_SCAN_END:
+      xml_scan_report (s, XML_SCAN_END, intern ((char *) e->name), Qnil);
+      break;
+
+    case XML_SCAN_COMMENT:
+      xml_scan_report (s, XML_SCAN_COMMENT, build_string ((char *) e->text),
+		       Qnil);
+      break;
+
+    case XML_SCAN_TEXT:
+      break;
+    }
+  return Qnil;
+}
+
+static Lisp_Object
+xml_scan_nonlocal_exit (enum nonlocal_exit type, Lisp_Object val)
+{
+  return Fcons (make_fixnum (type), val);
+}
+
+/* Report the event E, catching any nonlocal exit from the handler:
+   the exit can't go through libxml2, so it is recorded, the parser
+   is stopped, and the exit is made when the parser has returned.  */
+
+static void
+xml_scan_event (struct xml_scan_event *e)
+{
+  struct xml_scan *s = e->scan;
+  Lisp_Object exit = internal_catch_all (xml_scan_report_event, e,
+					 xml_scan_nonlocal_exit);
+  if (! NILP (exit))
+    {
+      s->exit = exit;
+      xmlStopParser (s->ctxt);
+    }
+}
+
+/* The SAX callbacks.  CTX is the parser, whose _private field points
+   to the struct xml_scan.  */
+
+static void
+xml_scan_start_element (void *ctx, const xmlChar *name,
+			const xmlChar **atts)
+{
+  struct xml_scan *s = ((xmlParserCtxtPtr) ctx)->_private;
+  if (NILP (s->exit) && xml_scan_enter (s, (const char *) name))
+    {
+      struct xml_scan_event e = { s, XML_SCAN_START, name, atts };
+      xml_scan_event (&e);
+    }
+}
+
+static void
+xml_scan_end_element (void *ctx, const xmlChar *name)
+{
+  struct xml_scan *s = ((xmlParserCtxtPtr) ctx)->_private;
+  if (NILP (s->exit) && xml_scan_leave (s))
+    {
+      struct xml_scan_event e = { s, XML_SCAN_END, name };
+      xml_scan_event (&e);
+    }
+}
+
+static void
+xml_scan_start_element_ns (void *ctx, const xmlChar *localname,
+			   const xmlChar *prefix, const xmlChar *uri,
+			   int nb_namespaces, const xmlChar **namespaces,
+			   int nb_attributes, int nb_defaulted,
+			   const xmlChar **attributes)
+{
+  struct xml_scan *s = ((xmlParserCtxtPtr) ctx)->_private;
+  if (NILP (s->exit) && xml_scan_enter (s, (const char *) localname))
+    {
+      struct xml_scan_event e = { s, XML_SCAN_START, localname, NULL,
+				  attributes, nb_attributes };
+      xml_scan_event (&e);
+    }
+}
+
+static void
+xml_scan_end_element_ns (void *ctx, const xmlChar *localname,
+			 const xmlChar *prefix, const xmlChar *uri)
+{
+  xml_scan_end_element (ctx, localname);
+}
+
+static void
+xml_scan_text (xmlParserCtxtPtr ctxt, const xmlChar *ch, int len,
+	       bool cdata)
+{
+  struct xml_scan *s = ctxt->_private;
+  if (NILP (s->exit) && xml_scan_content_p (s))
+    {
+      if (s->text_used && s->text_cdata != cdata)
+	{
+	  struct xml_scan_event e = { s, XML_SCAN_TEXT };
+	  xml_scan_event (&e);
+	  if (! NILP (s->exit))
+	    return;
+	}
+      s->text_cdata = cdata;
+      if (s->text_size - s->text_used < len)
+	s->text = xpalloc (s->text, &s->text_size,
+			   len - (s->text_size - s->text_used), -1, 1);
+      memcpy (s->text + s->text_used, ch, len);
+      s->text_used += len;
+    }
+}
+
+static void
+xml_scan_characters (void *ctx, const xmlChar *ch, int len)
+{
+  xml_scan_text (ctx, ch, len, false);
+}
+
+static void
+xml_scan_cdata_block (void *ctx, const xmlChar *value, int len)
+{
+  xml_scan_text (ctx, value, len, true);
+}
+
+static void
+xml_scan_comment (void *ctx, const xmlChar *value)
+{
+  struct xml_scan *s = ((xmlParserCtxtPtr) ctx)->_private;
+  if (NILP (s->exit) && xml_scan_content_p (s))
+    {
+      struct xml_scan_event e = { s, XML_SCAN_COMMENT };
+      e.text = value;
+      xml_scan_event (&e);
+    }
+}
+
+static void
+xml_scan_done (void *arg)
+{
+  struct xml_scan *s = arg;
+  if (s->ctxt)
+    {
+      if (s->ctxt->myDoc)
+	xmlFreeDoc (s->ctxt->myDoc);
+      if (s->htmlp)
+	htmlFreeParserCtxt (s->ctxt);
+      else
+	xmlFreeParserCtxt (s->ctxt);
+    }
+  xfree (s->text);
+  xfree (s->matched);
+}
+
+static Lisp_Object
+scan_region (Lisp_Object start, Lisp_Object end, Lisp_Object handler,
+	     Lisp_Object base_url, Lisp_Object filter, bool htmlp)
+{
+  ptrdiff_t count = SPECPDL_INDEX ();
+  const char *burl = "";
+  struct buffer *buffer = current_buffer;
+  xmlSAXHandler sax;
+  struct xml_scan s;
+
+  xmlCheckVersion (LIBXML_VERSION);
+
+  validate_region (&start, &end);
+  ptrdiff_t pos_byte = CHAR_TO_BYTE (XFIXNUM (start));
+  ptrdiff_t end_byte = CHAR_TO_BYTE (XFIXNUM (end));
+
+  if (! NILP (base_url))
+    {
+      CHECK_STRING (base_url);
+      burl = SSDATA (base_url);
+    }
+
+  s.ctxt = NULL;
+  s.htmlp = htmlp;
+  s.handler = handler;
+  s.log = NILP (handler) ? make_nil_vector (3 * XML_SCAN_LOG_SIZE) : Qnil;
+  s.log_used = 0;
+  s.text = NULL;
+  s.text_size = s.text_used = 0;
+  s.text_cdata = false;
+  s.paths = Qnil;
+  s.matched = NULL;
+  s.depth = s.skip_depth = 0;
+  s.full_depth = -1;
+  s.exit = Qnil;
+  record_unwind_protect_ptr (xml_scan_done, &s);
+
+  if (! NILP (filter))
+    {
+      ptrdiff_t npaths = list_length (filter);
+      s.paths = make_nil_vector (npaths);
+      s.matched = xzalloc (npaths * sizeof *s.matched);
+      for (ptrdiff_t i = 0; i < npaths; i++, filter = XCDR (filter))
+	{
+	  Lisp_Object path = XCAR (filter);
+	  for (Lisp_Object tail = path; ! NILP (tail); tail = XCDR (tail))
+	    {
+	      CHECK_CONS (tail);
+	      CHECK_SYMBOL (XCAR (tail));
+	    }
+	  /* An empty path accepts everything.  */
+	  if (NILP (path))
+	    {
+	      s.paths = Qnil;
+	      break;
+	    }
+	  ASET (s.paths, i, Fvconcat (1, &path));
+	}
+    }
+
+  /* Start from the handlers that build a document, so that the DTD is
+     taken into account as usual, but report the content instead of
+     adding it to the document.  */
+  memset (&sax, 0, sizeof sax);
+  if (htmlp)
+    {
+      xmlSAX2InitHtmlDefaultSAXHandler (&sax);
+      sax.startElement = xml_scan_start_element;
+      sax.endElement = xml_scan_end_element;
+    }
+  else
+    {
+      xmlSAXVersion (&sax, 2);
+      sax.startElementNs = xml_scan_start_element_ns;
+      sax.endElementNs = xml_scan_end_element_ns;
+    }
+  sax.characters = xml_scan_characters;
+  sax.cdataBlock = xml_scan_cdata_block;
+  sax.ignorableWhitespace = NULL;
+  sax.comment = xml_scan_comment;
+  sax.reference = NULL;
+  sax.processingInstruction = NULL;
+
+  if (htmlp)
+    {
+      s.ctxt = htmlCreatePushParserCtxt (&sax, NULL, NULL, 0, burl,
+					 XML_CHAR_ENCODING_UTF8);
+      if (s.ctxt)
+	htmlCtxtUseOptions (s.ctxt,
+			    HTML_PARSE_RECOVER|HTML_PARSE_NONET|
+			    HTML_PARSE_NOWARNING|HTML_PARSE_NOERROR|
+			    HTML_PARSE_NOBLANKS);
+    }
+  else
+    {
+      s.ctxt = xmlCreatePushParserCtxt (&sax, NULL, NULL, 0, burl);
+      if (s.ctxt)
+	{
+	  xmlCtxtResetPush (s.ctxt, NULL, 0, burl, "utf-8");
+	  xmlCtxtUseOptions (s.ctxt,
+			     XML_PARSE_NONET|XML_PARSE_NOWARNING|
+			     XML_PARSE_NOBLANKS|XML_PARSE_NOERROR);
+	}
+    }
+  if (!s.ctxt)
+    memory_full (SIZE_MAX);
+  s.ctxt->_private = &s;
+
+  /* Feed the region to the parser a chunk at a time, never across the
+     gap.  The parser copies each chunk before it parses it, so the
+     handler can't invalidate it, but it can change the buffer
+     between chunks.  */
+  record_unwind_current_buffer ();
+  for (bool done = false; !done && NILP (s.exit); )
+    {
+      if (!BUFFER_LIVE_P (buffer))
+	error ("Buffer killed while it was being parsed");
+      set_buffer_internal (buffer);
+      if (Z_BYTE < end_byte)
+	error ("Buffer changed while it was being parsed");
+
+      ptrdiff_t chunk_end = min (end_byte, pos_byte + XML_SCAN_CHUNK_SIZE);
+      if (pos_byte < GPT_BYTE && GPT_BYTE < chunk_end)
+	chunk_end = GPT_BYTE;
+      done = chunk_end == end_byte;
+      char *chunk = (char *) BYTE_POS_ADDR (pos_byte);
+      int size = chunk_end - pos_byte;
+      pos_byte = chunk_end;
+
+      if (htmlp)
+	htmlParseChunk (s.ctxt, chunk, size, done);
+      else
+	xmlParseChunk (s.ctxt, chunk, size, done);
+      maybe_quit ();
+    }
+
+  if (NILP (s.exit))
+    {
+      struct xml_scan_event e = { &s, XML_SCAN_TEXT };
+      xml_scan_event (&e);
+    }
+  if (! NILP (s.exit))
+    {
+      Lisp_Object exit = XCDR (s.exit);
+      if (XFIXNUM (XCAR (s.exit)) == NONLOCAL_EXIT_SIGNAL)
+	xsignal (XCAR (exit), XCDR (exit));
+      else
+	Fthrow (XCAR (exit), XCDR (exit));
+    }
+
+  Lisp_Object result = Qnil;
+  if (NILP (handler))
+    result = Fvector (s.log_used, XVECTOR (s.log)->contents);
+  return unbind_to (count, result);
+}
+
 void
 xml_cleanup_parser (void)
 {
@@ -296,6 +886,58 @@ DEFUN ("libxml-parse-xml-region", Flibxml_parse_xml_region,
     return parse_region (start, end, base_url, discard_comments, false);
   return Qnil;
 }
+
+DEFUN ("libxml-scan-html-region", Flibxml_scan_html_region,
+       Slibxml_scan_html_region,
+       3, 5, 0,
+       doc: /* Parse the region as an HTML document, reporting events.
+Instead of returning a parse tree, report the elements, text and
+comments in the region as a series of events as they are parsed, so
+that no parse tree is built.  Each event consists of a type, some data
+and a list of attributes:
+
+  start   NAME ATTRIBUTES  at the start of an element.  NAME is a
+                          symbol, and ATTRIBUTES is an alist as in
+                          the parse tree.
+  end     NAME nil         at the end of an element.
+  text    STRING nil       for the text between two of the other
+                          events.
+  comment STRING nil       for a comment.
+
+If HANDLER is a function, it is called with these three arguments
+for each event, and the value is nil.  If HANDLER is nil, the value is
+a vector of the types, data and attributes of all the events in turn.
+
+If BASE-URL is non-nil, it is used to expand relative URLs.
+
+If FILTER is non-nil, it is a list of paths, each of which is a list
+of element names from the root element down, like (html body p).
+Only the elements that match a path or a part of a path at its start
+are reported, and text and comments only within the elements that
+match a whole path.  The subtrees of other elements are skipped
+without any Lisp objects being made for them.
+
+HANDLER must not modify the text of the current buffer.  */)
+  (Lisp_Object start, Lisp_Object end, Lisp_Object handler,
+   Lisp_Object base_url, Lisp_Object filter)
+{
+  if (init_libxml2_functions ())
+    return scan_region (start, end, handler, base_url, filter, true);
+  return Qnil;
+}
+
+DEFUN ("libxml-scan-xml-region", Flibxml_scan_xml_region,
+       Slibxml_scan_xml_region,
+       3, 5, 0,
+       doc: /* Parse the region as an XML document, reporting events.
+This is like `libxml-scan-html-region', which see, for XML.  */)
+  (Lisp_Object start, Lisp_Object end, Lisp_Object handler,
+   Lisp_Object base_url, Lisp_Object filter)
+{
+  if (init_libxml2_functions ())
+    return scan_region (start, end, handler, base_url, filter, false);
+  return Qnil;
+}
 #endif /* HAVE_LIBXML2 */
 
 
@@ -333,6 +975,13 @@ syms_of_xml (void)
 #ifdef HAVE_LIBXML2
   defsubr (&Slibxml_parse_html_region);
   defsubr (&Slibxml_parse_xml_region);
+  defsubr (&Slibxml_scan_html_region);
+  defsubr (&Slibxml_scan_xml_region);
+
+  DEFSYM (Qstart, "start");
+  DEFSYM (Qend, "end");
+  DEFSYM (Qtext, "text");
+  DEFSYM (Qcomment, "comment");
 #endif
   defsubr (&Slibxml_available_p);
 }
@@ -34,6 +34,70 @@ timer-tests-sit-for
     (sit-for 0 t)
     (should timer-ran)))
 
+(ert-deftest timer-tests-run-in-order ()
+  (let ((timer-list nil)
+        (ran nil)
+        timers)
+    (dolist (n '(3 1 2))
+      (push (run-at-time (list 0 n 0 0) nil (lambda () (push n ran)))
+            timers))
+    ;; Timers canceled before they are due are not run.
+    (cancel-timer (nth 1 timers))
+    (should (= (length timer-list) 2))
+    (input-pending-p t)
+    (should (equal (nreverse ran) '(2 3)))
+    (should-not timer-list)))
+
+(ert-deftest timer-tests-reschedule ()
+  (let ((timer-list nil)
+        (ran 0)
+        (timer (timer-create)))
+    (timer-set-function timer (lambda () (setq ran (1+ ran))))
+    (timer-set-time timer (time-add nil 3600))
+    (timer-activate timer)
+    ;; Move the timer to an earlier time; it runs once.
+    (cancel-timer timer)
+    (timer-set-time timer '(0 1 0 0))
+    (timer-activate timer)
+    (should (= (length timer-list) 1))
+    (input-pending-p t)
+    (should (= ran 1))
+    (should-not timer-list)))
+
+(ert-deftest timer-tests-cancel ()
+  (let ((timer-list nil)
+        (ran nil)
+        timers)
+    (dotimes (n 10)
+      (push (run-at-time (list 0 (- 10 n) 0 0) nil (lambda () (push n ran)))
+            timers))
+    ;; New timers are added in front of the list, whatever their time.
+    (should (equal timer-list timers))
+    (should (timer--active-p (car timers)))
+    (dolist (timer (list (nth 0 timers) (nth 4 timers) (nth 9 timers)))
+      (cancel-timer timer)
+      (should-not (timer--active-p timer)))
+    (should (equal timer-list (cl-set-difference timers
+                                                 (list (nth 0 timers)
+                                                       (nth 4 timers)
+                                                       (nth 9 timers)))))
+    ;; Canceling a timer that isn't active does nothing.
+    (cancel-timer (nth 4 timers))
+    (should (= (length timer-list) 7))
+    (input-pending-p t)
+    (should (equal (nreverse ran) '(8 7 6 4 3 2 1)))
+    (should-not timer-list)))
+
+(ert-deftest timer-tests-statistics ()
+  (let ((timer-list nil)
+        stats)
+    (timer-statistics t)
+    (run-at-time '(0 0 0 0) nil #'ignore)
+    (input-pending-p t)
+    (setq stats (timer-statistics))
+    (should (= (plist-get stats :dispatched) 1))
+    (should (> (plist-get stats :max-latency) 0))))
+
 (ert-deftest timer-tests-debug-timer-check ()
   ;; This function exists only if --enable-checking.
   (skip-unless (fboundp 'debug-timer-check))
@@ -110,6 +110,18 @@ returns-3
   (jsonrpc--with-emacsrpc-fixture (conn)
     (should (= 3 (jsonrpc-request conn '+ [1 2])))))
 
+(ert-deftest survives-invalid-json ()
+  "Invalid JSON is warned about, and the connection keeps going."
+  (jsonrpc--with-emacsrpc-fixture (conn)
+    (let ((debug-on-error nil)
+          (warned nil))
+      (cl-letf (((symbol-function 'jsonrpc--warn)
+                 (lambda (format &rest _) (push format warned))))
+        (process-send-string (jsonrpc--process conn)
+                             "Content-Length: 5\r\n\r\n{bad}")
+        (should (= 3 (jsonrpc-request conn '+ [1 2]))))
+      (should (equal warned '("Invalid JSON: %s %s"))))))
+
 (ert-deftest errors-with--32601 ()
   "Errors with -32601"
   (jsonrpc--with-emacsrpc-fixture (conn)
@@ -375,6 +375,165 @@ benchmark-decoder
 			 (with-temp-buffer (insert-file-contents (car file))))))
 	  (insert (format "%s: %s\n" (car file) result)))))))
 
+;;; The following benchmarks decoding of UTF-8 text in which most
+;;; lines mix several scripts.  Evaluate e.g.
+;;; (coding-tests-benchmark-utf-8-decoder (* 64 1024 1024)) for a
+;;; quicker run than with the default of 1 GB.
+
+(defconst coding-tests-utf-8-sample-lines
+  '("The quick brown fox jumps over the lazy dog.\n"
+    "Příliš žluťoučký kůň úpěl ďábelské ódy.\n"
+    "Съешь же ещё этих мягких французских булок, да выпей чаю.\n"
+    "いろはにほへと ちりぬるを わかよたれそ つねならむ\n"
+    "敏捷的棕色狐狸跳过了懒狗。 🦊🐕\n"
+    "Mixed: naïve café — «東京» and Ελληνικά, 한국어 too.\n"))
+
+(defun coding-tests-utf-8-sample (size)
+  "Return a unibyte string of about SIZE bytes of mixed UTF-8 text."
+  (let* ((chunk (encode-coding-string
+                 (apply #'concat coding-tests-utf-8-sample-lines)
+                 'utf-8-unix))
+         (copies (max 1 (/ size (length chunk)))))
+    (apply #'concat (make-list copies chunk))))
+
+(defun coding-tests-benchmark-utf-8-decoder (&optional size)
+  "Benchmark decoding SIZE bytes of mixed-language UTF-8 text.
+SIZE defaults to 1 GB.  Compare strings and file insertion, with
+and without the optimizations for valid UTF-8."
+  (let* ((size (or size (* 1024 1024 1024)))
+         (text (coding-tests-utf-8-sample size))
+         (file (make-temp-file "coding-tests-utf-8")))
+    (unwind-protect
+        (progn
+          (let ((coding-system-for-write 'no-conversion))
+            (write-region text nil file nil 'silent))
+          (dolist (disable '(t nil))
+            (let ((disable-ascii-optimization disable))
+              (dolist (coding '(utf-8-unix utf-8 undecided))
+                (garbage-collect)
+                (message "%s%s string: %S"
+                         coding (if disable " (unoptimized)" "")
+                         (benchmark-run 1
+                           (decode-coding-string text coding)))
+                (message "%s%s file: %S"
+                         coding (if disable " (unoptimized)" "")
+                         (benchmark-run 1
+                           (with-temp-buffer
+                             (let ((coding-system-for-read coding))
+                               (insert-file-contents file)))))))))
+      (delete-file file))))
+
+(defconst coding-tests-utf-8-edge-cases
+  '(""
+    "a"
+    "\303\251"                          ; 2-byte sequence at the end
+    "abc\343\201\202"                   ; 3-byte sequence at the end
+    "\360\237\246\212xyzzy"             ; 4-byte sequence
+    "0123456789abcdef\303\2510123456789abcdef"
+    "\303"                              ; truncated sequences
+    "abc\343\201"
+    "\360\237\246"
+    "\300\200"                          ; overlong sequences
+    "\340\201\200"
+    "\360\200\200\200"
+    "\355\240\200"                      ; surrogate
+    "\364\220\200\200"                  ; above #x10FFFF
+    "\370\210\200\200\200"              ; 5-byte sequence
+    "\200abc\377"                       ; raw bytes
+    "line\nline\n\316\273\n"
+    "line\r\nline\r\n\316\273\r\n"
+    "line\rline\r\316\273\r"
+    "\357\273\277BOM \316\273")
+  "Unibyte strings exercising the UTF-8 decoder.")
+
+(ert-deftest coding-utf-8-decode-fast-path ()
+  "Check that decoding UTF-8 is unaffected by its optimizations."
+  (let ((text (coding-tests-utf-8-sample 5000)))
+    (dolist (s (append (list text
+                             (concat text "\377" text)
+                             (concat text "\343\201"))
+                       coding-tests-utf-8-edge-cases))
+      (dolist (coding '(utf-8-unix utf-8 utf-8-dos utf-8-mac
+                        utf-8-with-signature utf-8-auto prefer-utf-8))
+        (let* ((optimized (decode-coding-string s coding))
+               (optimized-coding last-coding-system-used)
+               (plain (let ((disable-ascii-optimization t))
+                        (decode-coding-string s coding))))
+          (should (equal optimized plain))
+          (should (eq optimized-coding last-coding-system-used)))
+        ;; Decoding a multibyte string doesn't use the fast paths for
+        ;; unibyte text.
+        (when (memq coding '(utf-8-unix utf-8 utf-8-dos utf-8-mac))
+          (should (equal (decode-coding-string s coding)
+                         (decode-coding-string (string-to-multibyte s)
+                                               coding))))
+        (let ((file (make-temp-file "coding-tests-utf-8")))
+          (unwind-protect
+              (let ((coding-system-for-write 'no-conversion)
+                    (coding-system-for-read coding))
+                (write-region s nil file nil 'silent)
+                (should (equal (with-temp-buffer
+                                 (insert-file-contents file)
+                                 (list (buffer-string)
+                                       last-coding-system-used))
+                               (with-temp-buffer
+                                 (let ((disable-ascii-optimization t))
+                                   (insert-file-contents file))
+                                 (list (buffer-string)
+                                       last-coding-system-used)))))
+            (delete-file file)))))))
+
+(ert-deftest coding-detect-by-sampling ()
+  "Check that detecting a coding system from samples changes nothing."
+  (let* ((text (coding-tests-utf-8-sample 100000))
+         (middle (/ (length text) 2))
+         (file (make-temp-file "coding-tests-sample")))
+    (unwind-protect
+        (dolist (s (list text
+                         ;; Invalid sequences and other bytes that
+                         ;; affect detection, away from the samples.
+                         (concat (substring text 0 middle) "\377"
+                                 (substring text middle))
+                         (concat (substring text 0 middle) "\300\200"
+                                 (substring text middle))
+                         (concat (substring text 0 middle) "\0"
+                                 (substring text middle))
+                         (concat (substring text 0 middle) "\e$B"
+                                 (substring text middle))
+                         (concat text "\343\201")
+                         (concat "\357\273\277" text)
+                         (encode-coding-string
+                          (decode-coding-string text 'utf-8-unix)
+                          'utf-8-dos)
+                         ;; Too few non-ASCII characters to be sure.
+                         (concat (make-string 50000 ?a) "\303\251"
+                                 (make-string 50000 ?a))
+                         (encode-coding-string (make-string 50000 ?é)
+                                               'iso-latin-1)))
+          (let ((coding-system-for-write 'no-conversion))
+            (write-region s nil file nil 'silent))
+          (dolist (coding '(undecided undecided-unix prefer-utf-8))
+            (let ((decode
+                   (lambda ()
+                     (list (decode-coding-string s coding)
+                           last-coding-system-used
+                           (with-temp-buffer
+                             (let ((coding-system-for-read coding))
+                               (insert-file-contents file))
+                             (list (buffer-string) last-coding-system-used))
+                           (with-temp-buffer
+                             (set-buffer-multibyte nil)
+                             (insert s)
+                             (decode-coding-region (point-min) (point-max)
+                                                   coding)
+                             (list (buffer-string)
+                                   last-coding-system-used))))))
+              (should (equal (let ((detect-coding-sample-threshold 0))
+                               (funcall decode))
+                             (let ((detect-coding-sample-threshold nil))
+                               (funcall decode)))))))
+      (delete-file file))))
+
 (ert-deftest coding-nocopy-trivial ()
   "Check that the NOCOPY parameter works for the trivial coding system."
   (let ((s "abc"))
@@ -464,6 +464,55 @@ fns-tests-base64-decode-string
   (should (eq :got-error (condition-case () (base64-decode-string "Zm9vYmFy=") (error :got-error))))
   (should (eq :got-error (condition-case () (base64-decode-string "Zg=Zg=") (error :got-error)))))
 
+(ert-deftest fns-tests-base64-decode-ignore-invalid ()
+  (should (equal (base64-decode-string "YW!Jj" nil t) "abc"))
+  (should (equal (base64-decode-string "Zm9v\x01YmFy" nil t) "foobar"))
+  (should (equal (base64-decode-string "Zm9v-_YmFy" nil t) "foobar"))
+  (should (equal (base64-decode-string "Zm9v+/YmFy" t t) "foobar"))
+  (should (equal (base64-decode-string "YQ==YWI=" nil t) "aab"))
+  (should (equal (fns-tests--with-region base64-decode-region "Zm9v*YmFy" nil t)
+                 "foobar"))
+  (should (eq :got-error (condition-case () (base64-decode-string "YW!Jj")
+                           (error :got-error)))))
+
+(defun fns-tests--base64-spaced (string)
+  "Return STRING with a space after each character.
+Base 64 decoding of the result cannot use its fast path for runs of
+four valid characters."
+  (mapconcat #'char-to-string string " "))
+
+(ert-deftest fns-tests-base64-fast-path ()
+  "Check that coding several characters at a time agrees with the slow path."
+  (random "fns-tests-base64-fast-path")
+  (dotimes (n 200)
+    (let* ((bytes (apply #'unibyte-string
+                         (cl-loop repeat (+ n (random 100))
+                                  collect (random 256))))
+           ;; Multibyte text with raw bytes is encoded a character at
+           ;; a time.
+           (multi (string-to-multibyte bytes)))
+      (dolist (url '(nil t))
+        (let ((enc (if url
+                       (base64url-encode-string bytes)
+                     (base64-encode-string bytes t))))
+          (should (equal enc (if url
+                                 (base64url-encode-string multi)
+                               (base64-encode-string multi t))))
+          (should (equal (base64-decode-string enc url) bytes))
+          (should (equal (base64-decode-string
+                          (fns-tests--base64-spaced enc) url)
+                         bytes))
+          (should (equal (base64-decode-string
+                          (fns-tests--base64-spaced enc) url t)
+                         bytes))))
+      (should (equal (base64-encode-string bytes)
+                     (base64-encode-string multi)))
+      (should (equal (fns-tests--with-region base64-encode-region multi)
+                     (base64-encode-string bytes)))
+      (should (equal (fns-tests--with-region base64-decode-region
+                       (base64-encode-string bytes))
+                     multi)))))
+
 (ert-deftest fns-tests-hash-buffer ()
   (should (equal (sha1 "foo") "0beec7b5ea3f0fdbc95d0dd47f3c5bc275da8a33"))
   (should (equal (with-temp-buffer
@@ -480,6 +529,57 @@ fns-tests-hash-buffer
                    (buffer-hash))
                  (sha1 "foo"))))
 
+(ert-deftest fns-tests-secure-hash-buffer ()
+  "Check that hashing a buffer agrees with hashing its encoded text."
+  ;; Long enough to be encoded in several chunks, and with the gap in
+  ;; the middle of it.
+  (let ((text (apply #'concat (make-list 20000 "abc\n\u00e9\u65e5\u672c "))))
+    (dolist (coding '(utf-8-unix utf-8-dos utf-16 iso-2022-jp raw-text))
+      (with-temp-buffer
+        (insert text)
+        (goto-char (/ (point-max) 3))
+        (insert "x")
+        (delete-char -1)
+        (dolist (algorithm '(md5 sha1 sha512))
+          (let ((coding-system-for-write coding))
+            (should (equal (secure-hash algorithm (current-buffer))
+                           (secure-hash algorithm
+                                        (encode-coding-string text coding))))
+            (should (equal (secure-hash algorithm (current-buffer) 10 70000)
+                           (secure-hash algorithm
+                                        (encode-coding-string
+                                         (substring text 9 69999)
+                                         coding))))))))))
+
+(ert-deftest fns-tests-hash-buffer-incremental ()
+  "Check `buffer-hash' after changes to a buffer it hashed before."
+  (with-temp-buffer
+    (dotimes (i 30000)
+      (insert (format "line %d\n" i)))
+    (buffer-hash)
+    (dolist (change (list (lambda () (goto-char (point-max)) (insert "end"))
+                          (lambda () (goto-char 100000) (insert "\u00e9"))
+                          (lambda () (delete-region 50 70000))
+                          (lambda () (upcase-region 20000 20010))
+                          (lambda () (subst-char-in-region 1 (point-max) ?1 ?2))
+                          (lambda ()
+                            (with-current-buffer
+                                (make-indirect-buffer (current-buffer)
+                                                      " *indirect*")
+                              (goto-char 30000)
+                              (insert "indirect")
+                              (kill-buffer)))
+                          (lambda () (set-buffer-multibyte nil))
+                          #'erase-buffer))
+      (funcall change)
+      (should (equal (buffer-hash)
+                     (let ((buffer (current-buffer))
+                           (multibyte enable-multibyte-characters))
+                       (with-temp-buffer
+                         (set-buffer-multibyte multibyte)
+                         (insert-buffer-substring buffer)
+                         (buffer-hash))))))))
+
 (ert-deftest fns-tests-mapconcat ()
   (should (string= (mapconcat #'identity '()) ""))
   (should (string= (mapconcat #'identity '("a" "b")) "ab"))
@@ -184,6 +184,87 @@ font-parse-xlfd-test
                   :family)
                  'name-with-lots-of-dashes)))
 
+(defun font-tests--shape (string)
+  "Shape STRING with the font used for its first character.
+Return a list of copies of the glyphs, or nil if that font can't be
+used for shaping."
+  (let* ((font (font-at 0 nil string))
+         (gstring (and font
+                       (font-shape-gstring
+                        (composition-get-gstring 0 (length string)
+                                                 font string)
+                        nil))))
+    (and gstring
+         (let (glyphs)
+           (dotimes (i (lgstring-glyph-len gstring))
+             (let ((glyph (lgstring-glyph gstring i)))
+               (when glyph
+                 (push (copy-sequence glyph) glyphs))))
+           (nreverse glyphs)))))
+
+(ert-deftest font-tests-shaping-cache ()
+  (skip-unless (display-graphic-p))
+  (let ((font-shaping-cache-size (* 1024 1024))
+        ;; Runs starting with the same characters.
+        (strings (mapcar (lambda (i) (format "abcdefgh%d" i))
+                         (number-sequence 1 20))))
+    (clear-composition-cache)
+    (font-shaping-cache-statistics t)
+    (let ((glyphs (mapcar #'font-tests--shape strings)))
+      (skip-unless (car glyphs))
+      (let ((stats (font-shaping-cache-statistics)))
+        (should (= (plist-get stats :misses) (length strings)))
+        (should (= (plist-get stats :hits) 0))
+        (should (= (plist-get stats :entries) (length strings))))
+      ;; After the glyph-strings of composite.c are discarded, the
+      ;; same runs are found in the cache, with the same glyphs.
+      (clear-composition-cache)
+      (should (equal (mapcar #'font-tests--shape strings) glyphs))
+      (let ((stats (font-shaping-cache-statistics)))
+        (should (= (plist-get stats :misses) (length strings)))
+        (should (= (plist-get stats :hits) (length strings))))
+      ;; Modifying the glyphs found in the cache doesn't change the
+      ;; cached ones.
+      (clear-composition-cache)
+      (let* ((string (car strings))
+             (font (font-at 0 nil string))
+             (gstring (font-shape-gstring
+                       (composition-get-gstring 0 (length string)
+                                                font string)
+                       nil)))
+        (lglyph-set-code (lgstring-glyph gstring 0) -1))
+      (clear-composition-cache)
+      (should (equal (font-tests--shape (car strings)) (car glyphs))))))
+
+(ert-deftest font-tests-shaping-cache-eviction ()
+  (skip-unless (display-graphic-p))
+  (let ((font-shaping-cache-size (* 1024 1024)))
+    (clear-composition-cache)
+    (font-shaping-cache-statistics t)
+    (skip-unless (font-tests--shape "run 1"))
+    ;; Make room for two runs like this one.
+    (setq font-shaping-cache-size
+          (1+ (* 2 (plist-get (font-shaping-cache-statistics t) :bytes))))
+    (clear-composition-cache)
+    (font-tests--shape "run 1")
+    (font-tests--shape "run 2")
+    ;; Using run 1 makes run 2 the least recently used one, which is
+    ;; discarded to make room for run 3.
+    (clear-composition-cache)
+    (font-tests--shape "run 1")
+    (font-tests--shape "run 3")
+    (should (= (plist-get (font-shaping-cache-statistics) :entries) 2))
+    (clear-composition-cache)
+    (let ((hits (plist-get (font-shaping-cache-statistics) :hits)))
+      (font-tests--shape "run 1")
+      (font-tests--shape "run 3")
+      (should (= (plist-get (font-shaping-cache-statistics) :hits)
+                 (+ hits 2)))
+      (font-tests--shape "run 2")
+      (should (= (plist-get (font-shaping-cache-statistics) :hits)
+                 (+ hits 2))))
+    (font-shaping-cache-statistics t)))
+
 ;; Local Variables:
 ;; no-byte-compile: t
 ;; End:
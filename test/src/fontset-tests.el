@@ -0,0 +1,55 @@
+;;; fontset-tests.el --- tests for fontset.c           -*- lexical-binding: t -*-
+
+;; Copyright (C) 2021 Free Software Foundation, Inc.
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.
+
+;;; Code:
+
+(require 'ert)
+
+(ert-deftest fontset-tests-char-font-cached ()
+  "Check that the fonts found for characters are remembered."
+  (skip-unless (display-graphic-p))
+  (clear-face-cache)
+  (dolist (c '(?a ?é ?α ?あ ?한 ?€ ?😀))
+    (let ((font (internal-char-font nil c))
+          (searches fontset-fallback-searches))
+      ;; Looking up the same character again doesn't search any
+      ;; fallback fonts, and finds the same font.
+      (should (equal (internal-char-font nil c) font))
+      (should (= fontset-fallback-searches searches))
+      ;; A character that replaces it in the cache doesn't change
+      ;; the font found for it.
+      (internal-char-font nil (+ c 128))
+      (should (equal (internal-char-font nil c) font)))))
+
+(ert-deftest fontset-tests-char-font-cache-charset-priority ()
+  "Check that changing charset priorities doesn't use stale fonts."
+  (skip-unless (display-graphic-p))
+  (let ((priority (charset-priority-list)))
+    (unwind-protect
+        (let ((c ?α))
+          (internal-char-font nil c)
+          (apply #'set-charset-priority 'iso-8859-7 priority)
+          (let ((cached (internal-char-font nil c)))
+            (clear-face-cache)
+            (should (equal (internal-char-font nil c) cached))))
+      (apply #'set-charset-priority priority))))
+
+(provide 'fontset-tests)
+
+;;; fontset-tests.el ends here
@@ -227,6 +227,123 @@ image-tests-image-metadata/error-on-nongraphical-display
   (skip-unless (not (display-images-p)))
   (should-error (image-metadata (cdr (assq 'xpm image-tests--images)))))
 
+;;;; image-cache-size-limit
+
+(ert-deftest image-tests-image-cache-size-limit ()
+  (image-skip-unless 'xpm)
+  (clear-image-cache)
+  (let* ((image-cache-size-limit 0)
+         (xpm (cdr (assq 'xpm image-tests--images)))
+         (xbm (cdr (assq 'xbm image-tests--images)))
+         (size (image-size xpm t))
+         (mask (image-mask-p xpm)))
+    (image-size xbm)
+    ;; The pixels of the least recently used image were freed, but
+    ;; its size is still known and its mask is reloaded on demand.
+    (let ((stats (image-cache-statistics)))
+      (should (= (plist-get stats :images) 2))
+      (should (> (plist-get stats :evictions) 0))
+      (should (>= (plist-get stats :peak-bytes)
+                  (plist-get stats :bytes))))
+    (should (equal (image-size xpm t) size))
+    (should (eq (image-mask-p xpm) mask))))
+
+(ert-deftest image-tests-image-cache-size-limit-displayed ()
+  "Check that the pixels of images shown in windows are kept."
+  (image-skip-unless 'xpm)
+  (clear-image-cache)
+  (let ((image-cache-size-limit 0)
+        (xpm (cdr (assq 'xpm image-tests--images)))
+        (xbm (cdr (assq 'xbm image-tests--images))))
+    (save-window-excursion
+      (with-temp-buffer
+        (switch-to-buffer (current-buffer))
+        (insert-image xpm)
+        (redisplay t)
+        ;; Looking up another image doesn't evict the displayed one,
+        ;; since exposing the window would have to load it again.
+        (image-size xbm)
+        (should (= (plist-get (image-cache-statistics) :evictions) 0))))))
+
+(ert-deftest image-tests-image-cache-statistics ()
+  (skip-unless (fboundp 'image-cache-statistics))
+  (let ((stats (image-cache-statistics)))
+    (should (natnump (plist-get stats :images)))
+    (should (natnump (plist-get stats :bytes)))
+    (should (natnump (plist-get stats :evictions)))))
+
+;;;; image-load-asynchronously
+
+;; This runs in batch mode: the worker threads need no frame.
+(ert-deftest image-tests-load-asynchronously ()
+  "Check that the worker threads decode images correctly."
+  (skip-unless (and (fboundp 'image--decode-asynchronously)
+                    (image-type-available-p 'png)
+                    (image-type-available-p 'jpeg)))
+  (let* ((png (expand-file-name "test/data/image/blank-100x200.png"
+                                source-directory))
+         (jpeg (cdr (assq 'jpeg image-tests--images)))
+         (png-data (with-temp-buffer
+                     (set-buffer-multibyte nil)
+                     (insert-file-contents-literally png)
+                     (buffer-string)))
+         (jpeg-data (with-temp-buffer
+                      (set-buffer-multibyte nil)
+                      (insert-file-contents-literally jpeg)
+                      (buffer-string)))
+         (specs nil)
+         (expected nil))
+    (dotimes (_ 10)
+      (dolist (image `(((:type png :file ,png) . (100 . 200))
+                       ((:type png :data ,png-data) . (100 . 200))
+                       ((:type jpeg :file ,jpeg) . (100 . 75))
+                       ((:type jpeg :data ,jpeg-data) . (100 . 75))))
+        (push (cons 'image (car image)) specs)
+        (push (cdr image) expected)))
+    ;; All the images are decoded concurrently, and have the same
+    ;; size as when they are decoded one by one.
+    (should (equal (image--decode-asynchronously specs) expected))
+    (should (equal (image--decode-asynchronously (reverse specs))
+                   (reverse expected)))
+    ;; Errors are reported for each image.
+    (let ((values (image--decode-asynchronously
+                   `((image :type png :file ,png)
+                     (image :type png :data ,jpeg-data)
+                     (image :type jpeg :data ,(substring jpeg-data 0 100))
+                     (image :type png :file "nonexistent.png")))))
+      (should (equal (nth 0 values) '(100 . 200)))
+      (should (stringp (nth 1 values)))
+      (should (stringp (nth 2 values)))
+      (should (stringp (nth 3 values))))
+    (let ((max-image-size 50))
+      (should (equal (image--decode-asynchronously
+                      `((image :type png :file ,png)
+                        (image :type jpeg :file ,jpeg)))
+                     '("Image too large" "Image too large"))))))
+
+(ert-deftest image-tests-load-asynchronously-display ()
+  (skip-unless (display-images-p))
+  (dolist (spec (list (cdr (assq 'png image-tests--images))
+                      (create-image (cdr (assq 'jpeg image-tests--images))
+                                    'jpeg)))
+    (when (image-type-available-p (image-property spec :type))
+      (clear-image-cache)
+      (let* ((size (image-size spec t))
+             (mask (image-mask-p spec))
+             (image-load-asynchronously t)
+             ;; Make the specifications different, so that each of
+             ;; them is a different image in the cache.
+             (images (mapcar (lambda (i) (append spec (list :ascent i)))
+                             (number-sequence 1 50))))
+        ;; The size of an image is known before its pixels have been
+        ;; decoded by the worker threads.
+        (dolist (image images)
+          (should (equal (image-size image t) size)))
+        ;; Asking for the mask waits for the pixels.
+        (dolist (image images)
+          (should (eq (image-mask-p image) mask)))
+        (should (> (plist-get (image-cache-statistics) :bytes) 0))))))
+
 ;;;; ImageMagick
 
 (ert-deftest image-tests-imagemagick-types ()
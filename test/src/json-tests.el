@@ -246,6 +246,96 @@ json-parse-buffer/trailing
     (should-not (bobp))
     (should (looking-at-p (rx " [456]" eos)))))
 
+(ert-deftest json-parse-string/number ()
+  (skip-unless (fboundp 'json-parse-string))
+  (should (equal (json-parse-string "[0, -0, 123, -456, 1.5, -2.5e3, 1E2, 3e-1]")
+                 [0 0 123 -456 1.5 -2500.0 100.0 0.3]))
+  (should (equal (json-parse-string
+                  (format "[%d,%d]"
+                          (1+ most-positive-fixnum)
+                          (1- most-negative-fixnum)))
+                 (vector (1+ most-positive-fixnum)
+                         (1- most-negative-fixnum))))
+  (should (equal (json-parse-string "123456789012345678901234567890")
+                 123456789012345678901234567890))
+  (should-error (json-parse-string "[01]") :type 'json-parse-error)
+  (should-error (json-parse-string "[1.]") :type 'json-parse-error)
+  (should-error (json-parse-string "[.5]") :type 'json-parse-error)
+  (should-error (json-parse-string "[+1]") :type 'json-parse-error)
+  (should-error (json-parse-string "1e") :type 'json-end-of-file)
+  (should-error (json-parse-string "-") :type 'json-end-of-file))
+
+(ert-deftest json-parse-string/escapes ()
+  (skip-unless (fboundp 'json-parse-string))
+  (should (equal (json-parse-string "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"")
+                 "\"\\/\b\f\n\r\t"))
+  (should (equal (json-parse-string "\"\\u00e9\\u20AC\"") "é€"))
+  (should-error (json-parse-string "\"\\x\"") :type 'json-parse-error)
+  (should-error (json-parse-string "\"\\u12G4\"") :type 'json-parse-error)
+  (should-error (json-parse-string "\"\\uD834\"") :type 'json-parse-error)
+  (should-error (json-parse-string "\"\\uD834\\u0041\"")
+                :type 'json-parse-error)
+  (should-error (json-parse-string "\"\\uDD1E\"") :type 'json-parse-error)
+  (should-error (json-parse-string "\"abc") :type 'json-end-of-file))
+
+(ert-deftest json-parse-string/repeated-keys ()
+  "Check objects whose keys are shared through the key cache."
+  (skip-unless (fboundp 'json-parse-string))
+  (let ((input (concat "["
+                       (mapconcat (lambda (i)
+                                    (format "{\"id\":%d,\"näme\":\"n%d\"}"
+                                            i i))
+                                  (number-sequence 1 100) ",")
+                       "]")))
+    (let ((result (json-parse-string input)))
+      (should (= (length result) 100))
+      (dotimes (i 100)
+        (should (equal (gethash "id" (aref result i)) (1+ i)))
+        (should (equal (gethash "näme" (aref result i))
+                       (format "n%d" (1+ i))))))
+    (let ((result (json-parse-string input :object-type 'alist)))
+      (should (equal (aref result 99) '((id . 100) (näme . "n100"))))
+      (should (eq (caar (aref result 0)) 'id)))
+    (let ((result (json-parse-string input :object-type 'plist
+                                     :array-type 'list)))
+      (should (equal (nth 41 result) '(:id 42 :näme "n42"))))))
+
+(ert-deftest json-parse-string/duplicate-keys ()
+  (skip-unless (fboundp 'json-parse-string))
+  (let* ((keys (mapcar (lambda (i) (format "k%d" i)) (number-sequence 1 40)))
+         (input (concat "{"
+                        (mapconcat (lambda (k) (format "\"%s\":1" k)) keys ",")
+                        ",\"k3\":2,\"k30\":3}")))
+    (let ((alist (json-parse-string input :object-type 'alist)))
+      (should (= (length alist) 40))
+      (should (equal (mapcar #'car alist) (mapcar #'intern keys)))
+      (should (equal (alist-get 'k3 alist) 2))
+      (should (equal (alist-get 'k30 alist) 3)))
+    (let ((table (json-parse-string input)))
+      (should (= (hash-table-count table) 40))
+      (should (equal (gethash "k30" table) 3)))))
+
+(ert-deftest json-parse-string/too-deep ()
+  (skip-unless (fboundp 'json-parse-string))
+  (should-error (json-parse-string (make-string 100000 ?\[))
+                :type 'json-object-too-deep))
+
+(ert-deftest json-parse-buffer/gap ()
+  "Check parsing text on both sides of the gap."
+  (skip-unless (fboundp 'json-parse-buffer))
+  (let ((input "[\"abcdéf\\u00e9\", 12345, {\"key\": true}]"))
+    (dotimes (i (length input))
+      (with-temp-buffer
+        (insert input)
+        ;; Move the gap to position I.
+        (goto-char (1+ i))
+        (insert "x")
+        (delete-char -1)
+        (goto-char (point-min))
+        (let ((result (json-parse-buffer :object-type 'alist)))
+          (should (equal result ["abcdéfé" 12345 ((key . t))])))
+        (should (eobp))))))
+
 (ert-deftest json-parse-with-custom-null-and-false-objects ()
   (skip-unless (and (fboundp 'json-serialize)
                     (fboundp 'json-parse-string)))
@@ -336,5 +426,164 @@ json-serialize/wrong-hash-key-type
     (puthash 1 2 table)
     (should-error (json-serialize table) :type 'wrong-type-argument)))
 
+;; The following tests cover the built-in serializer.
+
+(ert-deftest json-serialize/float ()
+  (skip-unless (fboundp 'json-serialize))
+  (should (equal (json-serialize [0.1 -2.5 1.0 1e100 -0.0])
+                 "[0.1,-2.5,1.0,1e+100,-0.0]"))
+  (should-error (json-serialize (/ 0.0 0.0)) :type 'wrong-type-argument)
+  (should-error (json-serialize [1.0e+INF]) :type 'wrong-type-argument))
+
+(ert-deftest json-serialize/big-integer ()
+  (skip-unless (fboundp 'json-serialize))
+  (let ((n (expt 10 30)))
+    (should (equal (json-serialize (vector n (- n)))
+                   (format "[%d,%d]" n (- n))))))
+
+(ert-deftest json-serialize/escapes ()
+  (skip-unless (fboundp 'json-serialize))
+  (should (equal (json-serialize "\"\\/\b\f\n\r\t\e")
+                 "\"\\\"\\\\/\\b\\f\\n\\r\\t\\u001B\""))
+  (should (equal (json-serialize '((a\"b . 1))) "{\"a\\\"b\":1}")))
+
+(ert-deftest json-serialize/duplicate-keys-in-big-objects ()
+  "Check that only the first of many duplicate keys is used."
+  (skip-unless (fboundp 'json-serialize))
+  (let ((alist (mapcar (lambda (i) (cons (intern (format "k%d" (% i 50))) i))
+                       (number-sequence 0 199)))
+        (plist (mapcan (lambda (i) (list (intern (format ":k%d" (% i 50))) i))
+                       (number-sequence 0 199))))
+    (should (equal (json-parse-string (json-serialize alist)
+                                      :object-type 'alist)
+                   (seq-take alist 50)))
+    (should (equal (json-parse-string (json-serialize plist)
+                                      :object-type 'plist)
+                   (seq-take plist 100)))
+    ;; Keys are unique per object, not across objects.
+    (should (equal (json-serialize `((a . ((a . 1) (b . ((a . 2)))))
+                                     (b . [((a . 3) (a . 4))])))
+                   "{\"a\":{\"a\":1,\"b\":{\"a\":2}},\"b\":[{\"a\":3}]}"))))
+
+(ert-deftest json-insert/unibyte ()
+  (skip-unless (fboundp 'json-insert))
+  (with-temp-buffer
+    (set-buffer-multibyte nil)
+    (insert "<>")
+    (goto-char 2)
+    (json-insert ["é" 1])
+    (should (equal (buffer-string) "<[\"\303\251\",1]>"))
+    (should (equal (point) 10))))
+
+(ert-deftest json-insert/gap ()
+  "Check that large insertions in the middle of a buffer work."
+  (skip-unless (fboundp 'json-insert))
+  (let ((object (make-vector 5000 "αβγ")))
+    (with-temp-buffer
+      (insert "<>")
+      (goto-char 2)
+      (json-insert object)
+      (should (equal (buffer-string)
+                     (concat "<" (json-serialize object) ">")))
+      (should (equal (point) (1- (point-max)))))))
+
+(ert-deftest json-insert/error ()
+  "Check that an invalid object doesn't change the buffer."
+  (skip-unless (fboundp 'json-insert))
+  (with-temp-buffer
+    (insert "abc")
+    (set-buffer-modified-p nil)
+    (goto-char 2)
+    (should-error (json-insert ["x" [1 2 (1 . 2)]])
+                  :type 'wrong-type-argument)
+    (should (equal (buffer-string) "abc"))
+    (should (equal (point) 2))
+    (should-not (buffer-modified-p))))
+
+(ert-deftest json-send-to-process ()
+  (skip-unless (and (fboundp 'json-send-to-process)
+                    (executable-find "cat")))
+  (with-temp-buffer
+    (let* ((proc (make-process :name "json-test" :command '("cat")
+                               :buffer (current-buffer)
+                               :coding 'utf-8-dos
+                               :connection-type 'pipe
+                               :sentinel #'ignore))
+           (object '(:id 1 :result [t "αβγ"]))
+           (json (json-serialize object)))
+      (unwind-protect
+          (progn
+            (json-send-to-process proc object)
+            (process-send-eof proc)
+            (while (accept-process-output proc 5))
+            (should (equal (buffer-string)
+                           (format "Content-Length: %d\n\n%s"
+                                   (string-bytes json) json))))
+        (delete-process proc)))))
+
+;;; The following is for benchmark testing of the JSON parser and
+;;; serializer, not for regression testing.
+
+(defun json-tests--benchmark-text (n)
+  "Return the JSON text of an array of N objects with the same keys."
+  (concat "["
+          (mapconcat
+           (lambda (i)
+             (format "{\"uri\":\"file:///src/file%d.c\",\
+\"range\":{\"start\":{\"line\":%d,\"character\":4},\
+\"end\":{\"line\":%d,\"character\":12}},\
+\"kind\":%d,\"detail\":\"symbol \\u00e9%d\",\"deprecated\":false}"
+                     i i i (% i 20) i))
+           (number-sequence 1 n) ",")
+          "]"))
+
+(defun json-tests-benchmark-parse (&optional n object-type)
+  "Return the time it takes to parse a JSON array of N objects.
+N defaults to 20000, and OBJECT-TYPE is passed to `json-parse-string'
+and `json-parse-buffer'.  Return an alist of the `benchmark-run'
+results of those functions and, for comparison, of
+`json-read-from-string' from json.el."
+  (require 'json)
+  (let* ((text (json-tests--benchmark-text (or n 20000)))
+         (object-type (or object-type 'hash-table))
+         (json-object-type object-type))
+    (garbage-collect)
+    (list (cons 'json-parse-string
+                (benchmark-run 5
+                  (json-parse-string text :object-type object-type)))
+          (cons 'json-parse-buffer
+                (with-temp-buffer
+                  (insert text)
+                  (benchmark-run 5
+                    (goto-char (point-min))
+                    (json-parse-buffer :object-type object-type))))
+          (cons 'json-read-from-string
+                (benchmark-run 5
+                  (json-read-from-string text))))))
+
+(defun json-tests-benchmark-serialize (&optional n object-type)
+  "Return the time it takes to serialize a JSON array of N objects.
+N defaults to 20000, and OBJECT-TYPE is the Lisp representation of
+the objects, as for `json-parse-string'.  Return an alist of the
+`benchmark-run' results of `json-serialize', `json-insert' and, for
+comparison, `json-encode' from json.el."
+  (require 'json)
+  (let* ((object-type (or object-type 'hash-table))
+         (object (json-parse-string (json-tests--benchmark-text (or n 20000))
+                                    :object-type object-type))
+         (json-object-type object-type))
+    (garbage-collect)
+    (list (cons 'json-serialize
+                (benchmark-run 5
+                  (json-serialize object)))
+          (cons 'json-insert
+                (with-temp-buffer
+                  (benchmark-run 5
+                    (erase-buffer)
+                    (json-insert object))))
+          (cons 'json-encode
+                (benchmark-run 5
+                  (json-encode object))))))
+
 (provide 'json-tests)
 ;;; json-tests.el ends here
@@ -190,6 +190,140 @@ set-process-filter-t
         (accept-process-output proc))   ; Read "Two".
       (should (equal (buffer-string) "0> one\n1> two\n2> "))))))
 
+(ert-deftest process-tests/default-filter-insertion ()
+  "Check how the default filter inserts output into the buffer."
+  (skip-unless (executable-find "cat"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (with-temp-buffer
+      (insert "ab")
+      (let* ((marker (copy-marker 2))
+             (changes ())
+             (proc (make-process :name "cat" :buffer (current-buffer)
+                                 :command '("cat")
+                                 :connection-type 'pipe
+                                 :coding 'utf-8-unix
+                                 :sentinel #'ignore
+                                 :noquery t)))
+        (set-marker (process-mark proc) 2)
+        (goto-char 2)
+        (narrow-to-region 1 2)
+        (add-hook 'after-change-functions
+                  (lambda (beg end len) (push (list beg end len) changes))
+                  nil t)
+        ;; Split a character between two writes.
+        (process-send-string proc "\303")
+        (accept-process-output proc 0.1)
+        (process-send-string proc "\251\346\227\245\n")
+        (process-send-eof proc)
+        (while (accept-process-output proc))
+        (widen)
+        (should (equal (buffer-string) "aé日\nb"))
+        (should (= (point) 5))
+        (should (= (process-mark proc) 5))
+        (should (= marker 5))
+        (should (= (apply #'+ (mapcar (lambda (c) (- (nth 1 c) (nth 0 c)))
+                                      changes))
+                   3))))))
+
+;; Large enough that the pipe fills and input has to be queued.
+(defconst process-tests--send-region-text
+  (let ((line (concat "abc é日本 " (string (unibyte-char-to-multibyte #o351))
+                      " xyz\n")))
+    (apply #'concat (make-list 20000 line))))
+
+(ert-deftest process-tests/send-region-round-trip ()
+  "Check that input sent in several pieces arrives intact and in order."
+  (skip-unless (executable-find "cat"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (with-temp-buffer
+      (let* ((text process-tests--send-region-text)
+             (output (generate-new-buffer " *cat output*"))
+             (proc (make-process :name "cat" :buffer output
+                                 :command '("cat")
+                                 :connection-type 'pipe
+                                 :coding 'utf-8-unix
+                                 :sentinel #'ignore
+                                 :noquery t)))
+        (unwind-protect
+            (progn
+              (insert text)
+              (process-send-region proc (point-min) (point-max))
+              (process-send-string proc text)
+              (process-send-string proc (encode-coding-string text 'utf-8))
+              (process-send-eof proc)
+              (while (accept-process-output proc))
+              (with-current-buffer output
+                (should (equal (buffer-string)
+                               (concat text text text)))))
+          (kill-buffer output))))))
+
+(defun process-tests--message (body &optional header)
+  "Return BODY framed as a message, with the header fields HEADER."
+  (let ((body (encode-coding-string body 'utf-8)))
+    (format "%sContent-Length: %d\r\n\r\n%s"
+            (or header "") (length body) body)))
+
+(ert-deftest process-tests/message-framing ()
+  "Check that the output of a process is split into messages."
+  (skip-unless (executable-find "cat"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (dolist (framing '(content-length json))
+      (let* ((messages nil)
+             (big (make-string 300000 ?é))
+             (proc (make-process :name "cat" :command '("cat")
+                                 :connection-type 'pipe
+                                 :coding 'binary
+                                 :filter (lambda (_proc message)
+                                           (push message messages))
+                                 :sentinel #'ignore
+                                 :noquery t)))
+        (unwind-protect
+            (progn
+              (if (eq framing 'json)
+                  (set-process-message-framing proc 'json
+                                               :object-type 'plist)
+                (set-process-message-framing proc 'content-length))
+              (should (eq (process-message-framing proc) framing))
+              (let ((output
+                     (concat (process-tests--message "{\"a\":[1,2]}")
+                             (process-tests--message
+                              "\"αβγ\"" "Content-Type: text/json\r\n")
+                             (process-tests--message (format "%S" big))
+                             (replace-regexp-in-string
+                              "Content-Length" "content-length"
+                              (process-tests--message "null")))))
+                ;; Split the output in the middle of a header and of
+                ;; a body.
+                (process-send-string proc (substring output 0 10))
+                (accept-process-output proc 0.1)
+                (process-send-string proc (substring output 10 30))
+                (accept-process-output proc 0.1)
+                (process-send-string proc (substring output 30)))
+              (process-send-eof proc)
+              (while (accept-process-output proc))
+              (should (equal (nreverse messages)
+                             (if (eq framing 'json)
+                                 `((:a [1 2]) "αβγ" ,big :null)
+                               `("{\"a\":[1,2]}" "\"αβγ\""
+                                 ,(format "%S" big) "null")))))
+          (delete-process proc))))))
+
+(ert-deftest process-tests/message-framing-args ()
+  "Check the arguments of `set-process-message-framing'."
+  (let ((proc (make-pipe-process :name "pipe" :noquery t)))
+    (unwind-protect
+        (progn
+          (should (eq (process-message-framing proc) nil))
+          (should-error (set-process-message-framing proc 'http))
+          (should-error (set-process-message-framing proc 'json :foo 1))
+          (should-error (set-process-message-framing
+                         proc 'content-length :object-type 'plist))
+          (set-process-message-framing proc 'json :object-type 'alist)
+          (should (eq (process-message-framing proc) 'json))
+          (set-process-message-framing proc nil)
+          (should (eq (process-message-framing proc) nil)))
+      (delete-process proc))))
+
 (ert-deftest start-process-should-not-modify-arguments ()
   "`start-process' must not modify its arguments in-place."
   ;; See bug#21831.
@@ -713,6 +847,33 @@ process-tests/fd-setsize-no-crash/make-serial-process
             ;; We should have managed to start at least one process.
             (should processes)))))))
 
+(ert-deftest process-tests/fd-setsize/read-output ()
+  "Check that output from a process is read even when its file
+descriptors are above FD_SETSIZE."
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (let ((cat (executable-find "cat")))
+      (skip-unless cat)
+      (process-tests--fd-setsize-test
+        (process-tests--with-processes processes
+          (let* ((output ())
+                 (process (process-tests--ignore-EMFILE
+                            (make-process :name "cat"
+                                          :command (list cat)
+                                          :connection-type 'pipe
+                                          :coding 'no-conversion
+                                          :filter (lambda (_proc string)
+                                                    (push string output))
+                                          :noquery t))))
+            ;; Builds that still wait with `select' can't use
+            ;; descriptors that large.
+            (skip-unless process)
+            (push process processes)
+            (process-send-string process "hello\n")
+            (process-send-eof process)
+            (while (accept-process-output process))
+            (should (equal (apply #'concat (nreverse output))
+                           "hello\n"))))))))
+
 (defvar process-tests--EMFILE-message :unknown
   "Cached result of the function `process-tests--EMFILE-message'.")
 
@@ -786,6 +947,70 @@ process-tests/sentinel-with-multiple-processes
             (should (equal calls
                            (list (list process "finished\n"))))))))))
 
+(ert-deftest process-tests/status-changes ()
+  "Check that stops, continues and exits of a process are noticed."
+  (skip-unless (executable-find "sleep"))
+  (skip-unless (not (memq system-type '(windows-nt ms-dos))))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (process-tests--with-processes processes
+      (let* ((events ())
+             (process (make-process :name "sleep"
+                                    :command '("sleep" "60")
+                                    :connection-type 'pipe
+                                    :noquery t
+                                    :sentinel (lambda (_proc event)
+                                                (push event events)))))
+        (push process processes)
+        (signal-process process 'SIGSTOP)
+        (while (not (eq (process-status process) 'stop))
+          (accept-process-output nil 0.05))
+        (signal-process process 'SIGCONT)
+        (while (eq (process-status process) 'stop)
+          (accept-process-output nil 0.05))
+        (signal-process process 'SIGTERM)
+        (while (process-live-p process)
+          (accept-process-output nil 0.05))
+        (should (eq (process-status process) 'signal))
+        (should (equal (car events) "terminated\n"))))))
+
+(ert-deftest process-tests/many-exits ()
+  "Check that the exits of many processes are all noticed."
+  (skip-unless (executable-find "true"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (process-tests--with-processes processes
+      (let ((exited 0))
+        (dotimes (i 50)
+          (push (make-process :name (format "true %d" i)
+                              :command '("true")
+                              :connection-type 'pipe
+                              :noquery t
+                              :sentinel (lambda (_proc _event)
+                                          (setq exited (1+ exited))))
+                processes))
+        (while (< exited 50)
+          (accept-process-output nil 0.05))
+        (dolist (process processes)
+          (should (eq (process-status process) 'exit))
+          (should (eql (process-exit-status process) 0)))))))
+
+(ert-deftest process-tests/exit-noticed-without-waiting ()
+  "Check that an exit is noticed without waiting for process output."
+  (skip-unless (executable-find "true"))
+  (skip-unless (not (memq system-type '(windows-nt ms-dos))))
+  (process-tests--with-processes processes
+    (let ((process (make-process :name "true"
+                                 :command '("true")
+                                 :connection-type 'pipe
+                                 :noquery t
+                                 :sentinel #'ignore))
+          (end (time-add nil 10)))
+      (push process processes)
+      ;; Busy-wait, so that only the SIGCHLD handler can notice the
+      ;; exit.
+      (while (and (eq (process-status process) 'run)
+                  (time-less-p nil end)))
+      (should (eq (process-status process) 'exit)))))
+
 (ert-deftest process-tests/multiple-threads-waiting ()
   (skip-unless (fboundp 'make-thread))
   (with-timeout (60 (ert-fail "Test timed out"))
@@ -876,6 +1101,26 @@ process-tests--usable-file-for-reinvoke
          (file-regular-p filename)
          filename)))
 
+;; This is for benchmark testing of process input, not for regression
+;; testing.
+(defun process-tests-benchmark-send-region (&optional coding)
+  "Return the time it takes to send a large region to a process.
+The process discards its input.  CODING is the coding system to
+use, `utf-8-unix' by default."
+  (with-temp-buffer
+    (dotimes (_ 50)
+      (insert process-tests--send-region-text))
+    (benchmark-run 10
+      (let ((proc (make-process :name "sink"
+                                :command '("sh" "-c" "cat > /dev/null")
+                                :connection-type 'pipe
+                                :coding (or coding 'utf-8-unix)
+                                :sentinel #'ignore
+                                :noquery t)))
+        (process-send-region proc (point-min) (point-max))
+        (process-send-eof proc)
+        (while (accept-process-output proc))))))
+
 ;; Bug#46284
 (ert-deftest process-sentinel-interrupt-event ()
   "Test that interrupting a process on Windows sends \"interrupt\" to sentinel."
@@ -506,4 +506,114 @@ test-from-to-parse-partial-sexp
     (should (parse-partial-sexp 1 1))
     (should-error (parse-partial-sexp 2 1))))
 
+;;; `skip-chars-forward' and `skip-syntax-forward' have a fast path
+;;; for runs of ASCII text; check that it agrees with the general one.
+
+(ert-deftest skip-chars-ascii-runs ()
+  (dolist (multibyte '(t nil))
+    (with-temp-buffer
+      (set-buffer-multibyte multibyte)
+      (insert "foo_bar-baz  \t qux"
+              (if multibyte "été" "\351t\351")
+              "42 end")
+      (goto-char (point-min))
+      (should (= (skip-chars-forward "a-z_") 7))
+      (should (= (skip-chars-forward "^ ") 4))
+      (should (= (skip-chars-forward "[:space:]") 4))
+      (should (= (skip-chars-forward "a-z") 3))
+      (should (= (skip-chars-forward "^0-9") 3))
+      (should (= (skip-chars-forward "0-9") 2))
+      (goto-char (point-max))
+      (should (= (skip-chars-backward "^ ") -3))
+      (should (= (skip-chars-backward " 0-9") -3))
+      (should (= (skip-chars-backward "^a-z") -1))
+      (should (= (skip-chars-backward "a-z") -1))
+      (should (= (skip-chars-backward "^a-z") -1))
+      (should (= (skip-chars-backward "a-z") -3))
+      (should (= (skip-chars-backward "[:space:]") -4)))))
+
+(ert-deftest skip-chars-ascii-gap ()
+  "Check that skipping ASCII runs crosses the gap correctly."
+  (with-temp-buffer
+    (insert (make-string 100 ?a) "é" (make-string 100 ?b))
+    (goto-char 50)
+    (insert "a")
+    (goto-char (point-min))
+    (should (= (skip-chars-forward "a") 101))
+    (should (= (skip-chars-forward "^b") 1))
+    (should (= (skip-chars-forward "b") 100))
+    (goto-char (point-max))
+    (should (= (skip-chars-backward "b") -100))
+    (should (= (skip-chars-backward "^a") -1))
+    (should (= (skip-chars-backward "a") -101))))
+
+(ert-deftest skip-syntax-ascii-runs ()
+  (with-temp-buffer
+    (emacs-lisp-mode)
+    (insert "foo-bar  (baz été)")
+    (goto-char (point-min))
+    (should (= (skip-syntax-forward "w_") 7))
+    (should (= (skip-syntax-forward " ") 2))
+    (should (= (skip-syntax-forward "^w") 1))
+    (should (= (skip-syntax-forward "w") 3))
+    (goto-char (1- (point-max)))
+    (should (= (skip-syntax-backward "w") -3))
+    (should (= (skip-syntax-backward "^(") -4))
+    ;; The syntax table can change between calls; make sure no stale
+    ;; result is used.
+    (with-syntax-table (make-syntax-table (syntax-table))
+      (modify-syntax-entry ?- "w")
+      (goto-char (point-min))
+      (should (= (skip-syntax-forward "w") 7)))))
+
+(ert-deftest skip-syntax-ascii-syntax-table-property ()
+  "Check that `syntax-table' properties are honored in ASCII runs."
+  (with-temp-buffer
+    (insert "aaaa-bbbb")
+    (put-text-property 5 6 'syntax-table (string-to-syntax "w"))
+    (let ((parse-sexp-lookup-properties t))
+      (goto-char (point-min))
+      (should (= (skip-syntax-forward "w") 9))
+      (should (= (skip-syntax-backward "w") -9)))
+    (let ((parse-sexp-lookup-properties nil))
+      (goto-char (point-min))
+      (should (= (skip-syntax-forward "w") 4))
+      (goto-char (point-max))
+      (should (= (skip-syntax-backward "w") -4)))))
+
+;;; The following is for benchmarking `skip-chars-forward' and
+;;; `skip-syntax-forward' over large buffers, not for regression
+;;; testing.
+
+(defun syntax-tests--generate-tokens (lines &optional nonascii)
+  "Insert LINES lines of identifier-like tokens.
+If NONASCII is non-nil, add a non-ASCII character to every line."
+  (dotimes (i lines)
+    (insert (format "(defun foo-%d (bar baz) \"doc\" (+ bar baz %d))" i i))
+    (when nonascii
+      (insert " ;; é"))
+    (insert "\n")))
+
+(defun benchmark-skip-chars (&optional lines)
+  "Benchmark tokenizing LINES lines with the skip functions."
+  (let ((lines (or lines 200000))
+        (gc-cons-threshold (max gc-cons-threshold 4000000)))
+    (dolist (nonascii '(nil t))
+      (with-temp-buffer
+        (emacs-lisp-mode)
+        (syntax-tests--generate-tokens lines nonascii)
+        (pcase-dolist (`(,skip . ,arg) '((skip-chars-forward . "^ \n")
+                                         (skip-chars-forward . "[:alnum:]-")
+                                         (skip-syntax-forward . "w_")
+                                         (skip-syntax-forward . "^ ")))
+          (let ((result
+                 (benchmark-run 1
+                   (goto-char (point-min))
+                   (while (not (eobp))
+                     (funcall skip arg)
+                     (unless (eobp)
+                       (forward-char))))))
+            (message "%s %S%s: %s" skip arg
+                     (if nonascii " (non-ASCII)" "") result)))))))
+
 ;;; syntax-tests.el ends here
@@ -154,4 +154,291 @@ xdisp-tests--find-directional-overrides-case-3
                                                      nil)
                 138))))
 
+(ert-deftest xdisp-tests--redisplay-statistics ()
+  (let ((redisplay-skip-initial-frame nil)
+        (redisplay-statistics-log-size 3))
+    (clear-redisplay-statistics)
+    (should (eq (plist-get (redisplay-statistics) :count) 0))
+    (should (eq (plist-get (redisplay-statistics (selected-window)) :count)
+                0))
+    (should (null (redisplay-statistics-log)))
+    (xdisp-tests--in-minibuffer
+      (dotimes (i 5)
+        (insert (format "line %d" i))
+        (redisplay 'force)))
+    (let ((stats (redisplay-statistics)))
+      (should (>= (plist-get stats :count) 5))
+      (should (>= (plist-get stats :windows) 5))
+      (should (> (plist-get stats :rows) 0))
+      (should (floatp (plist-get stats :time)))
+      (should (natnump (plist-get stats :output-bytes))))
+    (let ((log (redisplay-statistics-log)))
+      (should (= (length log) 3))
+      (should (plist-get (car log) :start)))
+    (clear-redisplay-statistics)
+    (should (eq (plist-get (redisplay-statistics) :count) 0))
+    (should (null (redisplay-statistics-log)))))
+
+(defun xdisp-tests--drain-output (proc count &optional min)
+  "Read output from PROC until COUNT's value reaches MIN and stops changing.
+Leaving output unread could block the terminal when its frame is
+deleted."
+  (let ((last -1)
+        (deadline (+ (float-time) 10)))
+    (while (and (or (/= (funcall count) last)
+                    (< (funcall count) (or min 0)))
+                (< (float-time) deadline))
+      (setq last (funcall count))
+      (accept-process-output proc 0.2 nil t))))
+
+(defun xdisp-tests--tty-update-output (write-at-once)
+  "Update a terminal frame on a pty, and return its output statistics.
+Bind `tty-write-updates-at-once' to WRITE-AT-ONCE.  Return a list of
+the `redisplay-statistics' values of :output-bytes and :output-flushes
+for a complete update of the frame, and of the number of bytes read
+from the pty."
+  (let* ((received 0)
+         (proc (make-process :name "xdisp-tests tty"
+                             :command (list (executable-find "sleep") "60")
+                             :connection-type 'pty
+                             :coding 'binary
+                             :noquery t
+                             :filter (lambda (_proc string)
+                                       (setq received
+                                             (+ received (length string))))))
+         (tty-write-updates-at-once write-at-once)
+         (old-frame (selected-frame))
+         frame)
+    (unwind-protect
+        (progn
+          (set-process-window-size proc 40 120)
+          (setq frame (make-terminal-frame
+                       `((tty . ,(process-tty-name proc))
+                         (tty-type . "xterm"))))
+          (select-frame frame)
+          (with-temp-buffer
+            (switch-to-buffer (current-buffer))
+            ;; Emacs doesn't read from the pty while updating the
+            ;; frame, so the output must fit in the pty's buffers.
+            (dotimes (i 35)
+              (insert (make-string 100 (+ ?a (% i 26))) "\n"))
+            (goto-char (point-min))
+            (redisplay 'force)
+            (xdisp-tests--drain-output proc (lambda () received))
+            (setq received 0)
+            (clear-redisplay-statistics)
+            (upcase-region (point-min) (point-max))
+            (redisplay 'force)
+            (let ((stats (redisplay-statistics)))
+              (xdisp-tests--drain-output proc (lambda () received)
+                                         (plist-get stats :output-bytes))
+              (list (plist-get stats :output-bytes)
+                    (plist-get stats :output-flushes)
+                    received))))
+      (select-frame old-frame)
+      (when (frame-live-p frame)
+        (delete-frame frame t))
+      (delete-process proc))))
+
+(ert-deftest xdisp-tests--tty-output-buffering ()
+  "Check how terminal output is flushed during frame updates."
+  (skip-unless (and (executable-find "sleep")
+                    (not (memq system-type '(windows-nt ms-dos)))))
+  ;; By default, the output is flushed every 1000 bytes or so.
+  (pcase-let ((`(,bytes ,flushes ,received)
+               (xdisp-tests--tty-update-output nil)))
+    (should (> bytes 3000))
+    (should (>= flushes (/ bytes 1000)))
+    (should (= received bytes)))
+  ;; Otherwise it is all sent when the update is complete.
+  (pcase-let ((`(,bytes ,flushes ,received)
+               (xdisp-tests--tty-update-output t)))
+    (should (> bytes 3000))
+    (should (= flushes 1))
+    (should (= received bytes))))
+
+;; Used in the mode line format of the test below.
+(defvar xdisp-tests--mode-line-string "foo")
+
+(ert-deftest xdisp-tests--cache-mode-lines ()
+  (let ((redisplay-skip-initial-frame nil)
+        (cache-mode-lines t))
+    (with-temp-buffer
+      (switch-to-buffer (current-buffer))
+      (setq mode-line-format '("%b " xdisp-tests--mode-line-string))
+      (redisplay 'force)
+      ;; Unchanged mode lines are reused.
+      (clear-redisplay-statistics)
+      (dotimes (_ 3)
+        (set-buffer-redisplay nil nil nil nil)
+        (redisplay 'force))
+      (let ((stats (redisplay-statistics (selected-window))))
+        (should (= (plist-get stats :mode-lines) 3))
+        (should (= (plist-get stats :cached-mode-lines) 3)))
+      ;; Setting a variable used by the format, or changing what a
+      ;; %-construct shows, invalidates the cached mode line.
+      (clear-redisplay-statistics)
+      (setq xdisp-tests--mode-line-string "bar")
+      (set-buffer-redisplay nil nil nil nil)
+      (redisplay 'force)
+      (rename-buffer (generate-new-buffer-name "xdisp-tests"))
+      (set-buffer-redisplay nil nil nil nil)
+      (redisplay 'force)
+      (let ((stats (redisplay-statistics (selected-window))))
+        (should (= (plist-get stats :mode-lines) 2))
+        (should (= (plist-get stats :cached-mode-lines) 0)))
+      ;; Setting a buffer-local binding in another buffer doesn't.
+      (redisplay 'force)
+      (clear-redisplay-statistics)
+      (with-temp-buffer
+        (setq-local xdisp-tests--mode-line-string "baz"))
+      (set-buffer-redisplay nil nil nil nil)
+      (redisplay 'force)
+      (let ((stats (redisplay-statistics (selected-window))))
+        (should (= (plist-get stats :cached-mode-lines) 1)))
+      (should (get-variable-watchers 'xdisp-tests--mode-line-string))))
+  ;; Turning the cache off removes the watchers.
+  (should-not (get-variable-watchers 'xdisp-tests--mode-line-string)))
+
+(ert-deftest xdisp-tests--cache-compact-mode-lines ()
+  (let ((redisplay-skip-initial-frame nil)
+        (cache-mode-lines t)
+        (mode-line-compact t))
+    (with-temp-buffer
+      (switch-to-buffer (current-buffer))
+      (setq mode-line-format '("%b    " xdisp-tests--mode-line-string))
+      (redisplay 'force)
+      ;; Compact mode lines are not cached, so changing a variable
+      ;; used by the format is noticed.
+      (clear-redisplay-statistics)
+      (dotimes (_ 3)
+        (set-buffer-redisplay nil nil nil nil)
+        (redisplay 'force))
+      (let ((stats (redisplay-statistics (selected-window))))
+        (should (= (plist-get stats :mode-lines) 3))
+        (should (= (plist-get stats :cached-mode-lines) 0)))
+      (should-not (get-variable-watchers 'xdisp-tests--mode-line-string)))))
+
+;; Display the second half of the current buffer, and then its start.
+;; Value is the number of glyph rows copied from the glyph row cache
+;; when displaying the start.
+(defun xdisp-tests--redisplay-start-again ()
+  (goto-char (/ (point-max) 2))
+  (set-window-start nil (point))
+  (redisplay 'force)
+  (clear-redisplay-statistics)
+  (goto-char (point-max))
+  (set-window-start nil (point-min))
+  (redisplay 'force)
+  (plist-get (redisplay-statistics (selected-window)) :cached-rows))
+
+(ert-deftest xdisp-tests--glyph-row-cache ()
+  (let ((redisplay-skip-initial-frame nil)
+        (redisplay-glyph-row-cache-size 64))
+    (with-temp-buffer
+      (switch-to-buffer (current-buffer))
+      (dotimes (i 200)
+        (insert (format "line %d  \n" i)))
+      (set-window-start nil (point-min))
+      (redisplay 'force)
+      ;; Rows displayed earlier are reused.
+      (should (> (xdisp-tests--redisplay-start-again) 0))
+      ;; Changing a setting that affects how text is displayed, or
+      ;; killing a buffer, invalidates the cache.
+      (setq show-trailing-whitespace t)
+      (should (= (xdisp-tests--redisplay-start-again) 0))
+      (should (> (xdisp-tests--redisplay-start-again) 0))
+      (kill-buffer (generate-new-buffer "xdisp-tests"))
+      (should (= (xdisp-tests--redisplay-start-again) 0))
+      (should (> (xdisp-tests--redisplay-start-again) 0))
+      ;; So do changing the invisibility spec and modifying a display
+      ;; table in place.
+      (add-to-invisibility-spec 'xdisp-tests)
+      (should (= (xdisp-tests--redisplay-start-again) 0))
+      (setq buffer-display-table (make-display-table))
+      (should (= (xdisp-tests--redisplay-start-again) 0))
+      (should (> (xdisp-tests--redisplay-start-again) 0))
+      (aset buffer-display-table ?l [?L])
+      (should (= (xdisp-tests--redisplay-start-again) 0)))))
+
+(defface xdisp-tests--face '((t :underline t))
+  "Face used by `xdisp-tests--face-merge-cache'.")
+
+(ert-deftest xdisp-tests--face-merge-cache ()
+  (let ((redisplay-skip-initial-frame nil))
+    (with-temp-buffer
+      (switch-to-buffer (current-buffer))
+      (dotimes (_ 20)
+        (insert (propertize "foo" 'face 'xdisp-tests--face) " bar\n"))
+      (set-window-start nil (point-min))
+      (redisplay 'force)
+      ;; Faces merged in an earlier redisplay cycle are reused.
+      (clear-redisplay-statistics)
+      (set-buffer-redisplay nil nil nil nil)
+      (redisplay 'force)
+      (let ((stats (redisplay-statistics)))
+        (should (> (plist-get stats :face-merges) 0))
+        (should (= (plist-get stats :cached-face-merges)
+                   (plist-get stats :face-merges))))
+      ;; Changing the face invalidates them.
+      (unwind-protect
+          (progn
+            (set-face-attribute 'xdisp-tests--face nil :inverse-video t)
+            (clear-redisplay-statistics)
+            (set-buffer-redisplay nil nil nil nil)
+            (redisplay 'force)
+            (let ((stats (redisplay-statistics)))
+              (should (< (plist-get stats :cached-face-merges)
+                         (plist-get stats :face-merges)))))
+        (set-face-attribute 'xdisp-tests--face nil
+                            :inverse-video 'unspecified)))))
+
+(defun xdisp-tests--visual-successors (text from to)
+  "Return the positions displayed to the right of FROM...TO in TEXT.
+TEXT is displayed as a line of its own, and positions are counted
+from 1."
+  (with-temp-buffer
+    (switch-to-buffer (current-buffer))
+    (insert text "\n")
+    ;; Have the text on both sides of the gap.
+    (goto-char (/ (point-max) 3))
+    (insert "a")
+    (delete-char -1)
+    (mapcar (lambda (pos)
+              (goto-char pos)
+              (ignore-errors (move-point-visually 1))
+              (point))
+            (number-sequence from to))))
+
+(defun xdisp-tests--check-ltr-fast-path (text from to)
+  "Check that TEXT is displayed between FROM and TO as by the UBA."
+  ;; A strong R2L character at the end of the line, after a strong
+  ;; L2R one, doesn't change the levels of the characters before
+  ;; them, but prevents using the fast path for L2R lines.
+  (should (equal (xdisp-tests--visual-successors text from to)
+                 (xdisp-tests--visual-successors (concat text " x א")
+                                                 from to))))
+
+(ert-deftest xdisp-tests--bidi-ltr-fast-path ()
+  (let ((prefix (make-string 4090 ?a)))
+    ;; Lines without R2L characters, longer than the text scanned at
+    ;; a time, with multibyte characters and a newline across the
+    ;; boundaries of the scanned parts.
+    (dolist (filler '("é" "€ 12" "(x) [1.5]" "\nü"))
+      (let ((text (concat prefix (apply #'concat
+                                        (make-list 10 filler)))))
+        (xdisp-tests--check-ltr-fast-path text 4080 (length text))
+        (should (equal (xdisp-tests--visual-successors text 4080 4090)
+                       (number-sequence 4081 4091)))))
+    ;; A line too long to be scanned completely.
+    (xdisp-tests--check-ltr-fast-path (make-string 70000 ?b) 69997 70000)
+    ;; A bracket pair across the boundary of the text scanned at a
+    ;; time, enclosing R2L text.  By rule N0 of the UBA, both brackets
+    ;; are at the level of the L2R text before them.
+    (let* ((text (concat prefix "xyzw (אבג) דה x"))
+           (close (1+ (string-search ")" text))))
+      (xdisp-tests--check-ltr-fast-path text 4090 (+ close 5))
+      (should (equal (xdisp-tests--visual-successors text close close)
+                     (list (1+ close)))))))
+
 ;;; xdisp-tests.el ends here
@@ -52,4 +52,102 @@ libxml-tests
       (should (equal (cdr test)
                      (libxml-parse-xml-region (point-min) (point-max)))))))
 
+(defun libxml-tests--events-to-dom (events)
+  "Return the parse tree that the vector of EVENTS describes."
+  (let ((stack (list (list nil nil))))
+    (dotimes (i (/ (length events) 3))
+      (let ((data (aref events (1+ (* i 3)))))
+        (pcase (aref events (* i 3))
+          ('start (push (list (aref events (+ (* i 3) 2)) data) stack))
+          ('end (let ((node (pop stack)))
+                  (push (cons (cadr node) (cons (car node)
+                                                (nreverse (cddr node))))
+                        (cddr (car stack)))))
+          ('text (push data (cddr (car stack))))
+          ('comment (push (list 'comment nil data) (cddr (car stack)))))))
+    (car (last (cddr (car stack))))))
+
+(ert-deftest libxml-tests/scan ()
+  "Test that scanning a region gives the events of its parse tree."
+  (skip-unless (fboundp 'libxml-scan-xml-region))
+  (with-temp-buffer
+    (insert "<?xml version=\"1.0\"?><feed xmlns:x=\"urn:x\" lang=\"en\">")
+    (dotimes (i 3000)
+      (insert (format "<entry id=\"%d\"><title>Entry é%d &amp; more</title>\
+<x:link href=\"/e/%d\"/><!--c%d--><body><![CDATA[<p>%d</p>]]> text</body>\
+</entry>"
+                      i i i i i)))
+    (insert "</feed>")
+    ;; Put the gap in the middle, so that the text is read from both
+    ;; of its sides.
+    (goto-char (/ (point-max) 2))
+    (insert "x")
+    (delete-char -1)
+    (let ((dom (libxml-parse-xml-region (point-min) (point-max))))
+      (should (> (buffer-size) (* 3 64 1024)))
+      (should (equal (libxml-tests--events-to-dom
+                      (libxml-scan-xml-region (point-min) (point-max) nil))
+                     dom))
+      (let ((events nil))
+        (should-not (libxml-scan-xml-region
+                     (point-min) (point-max)
+                     (lambda (type data attributes)
+                       (push (list type data attributes) events))))
+        (should (equal (libxml-tests--events-to-dom
+                        (vconcat (apply #'append (nreverse events))))
+                       dom))))))
+
+(ert-deftest libxml-tests/scan-filter ()
+  "Test scanning a region for the elements on some paths only."
+  (skip-unless (fboundp 'libxml-scan-xml-region))
+  (with-temp-buffer
+    (insert "<feed><title>Feed</title><entry><title>A</title><id>1</id>\
+</entry><other><entry><title>B</title></entry></other>\
+<entry><title>C<b>!</b></title></entry></feed>")
+    (should (equal (libxml-scan-xml-region (point-min) (point-max) nil nil
+                                           '((feed entry title)))
+                   [start feed nil
+                    start entry nil start title nil text "A" nil
+                    end title nil end entry nil
+                    start entry nil start title nil text "C" nil
+                    start b nil text "!" nil end b nil
+                    end title nil end entry nil
+                    end feed nil]))
+    (should (equal (libxml-scan-xml-region (point-min) (point-max) nil nil
+                                           '((feed title) (feed other)))
+                   (libxml-scan-xml-region
+                    (point-min) (point-max) nil nil
+                    '((feed other entry title) (feed title) (feed other)))))
+    (should (equal (libxml-scan-xml-region (point-min) (point-max) nil nil
+                                           '((item)))
+                   []))))
+
+(ert-deftest libxml-tests/scan-html ()
+  "Test scanning a region of HTML."
+  (skip-unless (fboundp 'libxml-scan-html-region))
+  (with-temp-buffer
+    (insert "<p class=x>one<br>two<input checked><!-- c --></p>")
+    (should (equal (libxml-tests--events-to-dom
+                    (libxml-scan-html-region (point-min) (point-max) nil))
+                   (libxml-parse-html-region (point-min) (point-max))))))
+
+(ert-deftest libxml-tests/scan-nonlocal-exit ()
+  "Test that the handler can exit nonlocally from a scan."
+  (skip-unless (fboundp 'libxml-scan-xml-region))
+  (with-temp-buffer
+    (insert "<a><b>text</b><c/></a>")
+    (let ((n 0))
+      (should (equal (catch 'done
+                    (libxml-scan-xml-region
+                     (point-min) (point-max)
+                     (lambda (type data _)
+                       (setq n (1+ n))
+                       (when (eq type 'text)
+                         (throw 'done data)))))
+                     "text"))
+      (should (= n 3)))
+    (should-error (libxml-scan-xml-region (point-min) (point-max)
+                                          (lambda (&rest _) (error "Boom")))
+                  :type 'error)))
+
 ;;; xml-tests.el ends here